@@ -69,6 +69,7 @@ func (d *DurationArrayFlags) Set(value string) error {
 
 type Config struct {
 	ConnectionString  string
+	RouteStrings      []string
 	BenchmarkDuration time.Duration
 	ClientParallels   []int
 	ConnectTimeouts   []time.Duration
@@ -91,10 +92,20 @@ var (
 	connectionsCounter int64 = 0
 	selectCounter      int64 = 0
 	errorsCounter      int64 = 0
+	routeCounter       int64 = 0
 )
 
+func nextConnectionString(cfg *Config) string {
+	if len(cfg.RouteStrings) == 0 {
+		return cfg.ConnectionString
+	}
+
+	n := atomic.AddInt64(&routeCounter, 1)
+	return cfg.RouteStrings[n%int64(len(cfg.RouteStrings))]
+}
+
 func doConnect(cfg *Config, connectTimeout time.Duration) {
-	db, err := sql.Open("postgres", cfg.ConnectionString)
+	db, err := sql.Open("postgres", nextConnectionString(cfg))
 	if err != nil {
 		fmt.Printf("connect error: %v\n", err)
 		atomic.AddInt64(&errorsCounter, 1)
@@ -289,6 +300,7 @@ func readConfig() *Config {
 	benchDuration := flag.Duration("bench-duration", time.Second*5, "one benchmark run duration")
 	pauseDuration := flag.Duration("pause-duration", time.Second*3, "pause between runs")
 	outputFile := flag.String("output-file", "./result.csv", "result filename")
+	routes := flag.Int("routes", 1, "number of distinct routes to connect to, users are named <user>0..<user>N-1 when > 1")
 
 	clients := newIntArrayFlags([]int{10, 20, 30, 40, 50, 60, 70, 80, 90, 100})
 	flag.Var(clients, "clients", "numbers of parallel connecting clients")
@@ -311,8 +323,21 @@ func readConfig() *Config {
 	password, err := term.ReadPassword(0)
 	noerror(err)
 
+	connStr := func(user string) string {
+		return fmt.Sprintf("host=%s port=%d user=%s password=%s dbname=%s sslmode=verify-full sslrootcert=%s", *host, *port, user, string(password), *dbName, *sslRoot)
+	}
+
+	// many routes are used to check that routing cost does not grow with number of routes
+	routeStrings := []string{}
+	if *routes > 1 {
+		for i := range *routes {
+			routeStrings = append(routeStrings, connStr(fmt.Sprintf("%s%d", *user, i)))
+		}
+	}
+
 	return &Config{
-		ConnectionString:  fmt.Sprintf("host=%s port=%d user=%s password=%s dbname=%s sslmode=verify-full sslrootcert=%s", *host, *port, *user, string(password), *dbName, *sslRoot),
+		ConnectionString:  connStr(*user),
+		RouteStrings:      routeStrings,
 		BenchmarkDuration: *benchDuration,
 		ClientParallels:   *clients,
 		PauseDuration:     *pauseDuration,
@@ -35,6 +35,7 @@ const (
 	showStatsCommand           = "show stats;"
 	showDatabasesCommand       = "show databases;"
 	showPoolsExtendedCommand   = "show pools_extended;"
+	showWorkersCommand         = "show workers;"
 	poolModeColumnName         = "pool_mode"
 	queryQuantilePrefix        = "query_"
 	transactionQuantilePrefix  = "transaction_"
@@ -59,6 +60,30 @@ var (
 		nil, nil,
 	)
 
+	workerClientsDescription = prometheus.NewDesc(
+		prometheus.BuildFQName(namespace, "worker", "clients"),
+		"Clients running on the worker (SHOW WORKERS clients)",
+		[]string{"worker"}, nil,
+	)
+
+	workerPendingDescription = prometheus.NewDesc(
+		prometheus.BuildFQName(namespace, "worker", "pending"),
+		"Clients passed to the worker, but not started yet (SHOW WORKERS pending)",
+		[]string{"worker"}, nil,
+	)
+
+	workerLoadDescription = prometheus.NewDesc(
+		prometheus.BuildFQName(namespace, "worker", "load"),
+		"Worker load used for clients placement (SHOW WORKERS load)",
+		[]string{"worker"}, nil,
+	)
+
+	workerBusyRatioDescription = prometheus.NewDesc(
+		prometheus.BuildFQName(namespace, "worker", "busy_ratio"),
+		"Share of the worker event loop time spent out of poll wait (SHOW WORKERS busy / 100)",
+		[]string{"worker"}, nil,
+	)
+
 	avgTxCountDescription = prometheus.NewDesc(
 		prometheus.BuildFQName(namespace, "database", "avg_tx_per_second"),
 		"Average number of transactions per second reported by Odyssey cron",
@@ -206,12 +231,43 @@ var (
 		"dns_queries": prometheus.NewDesc(
 			prometheus.BuildFQName(namespace, "lists", "in_flight_dns_queries"),
 			"Count of in-flight DNS queries", nil, nil),
+		"router_lock_acquired": prometheus.NewDesc(
+			prometheus.BuildFQName(namespace, "lists", "router_lock_acquired"),
+			"Count of router lock acquisitions", nil, nil),
+		"router_lock_contended": prometheus.NewDesc(
+			prometheus.BuildFQName(namespace, "lists", "router_lock_contended"),
+			"Count of router lock acquisitions, that had to wait for the lock", nil, nil),
+		"server_affinity_hits": prometheus.NewDesc(
+			prometheus.BuildFQName(namespace, "lists", "server_affinity_hits"),
+			"Count of server attaches to the worker, that used it last time", nil, nil),
+		"server_affinity_migrations": prometheus.NewDesc(
+			prometheus.BuildFQName(namespace, "lists", "server_affinity_migrations"),
+			"Count of server attaches, that moved it to another worker", nil, nil),
+		"scram_cache_entries": prometheus.NewDesc(
+			prometheus.BuildFQName(namespace, "lists", "scram_cache_entries"),
+			"Count of SCRAM secrets cached for plain text passwords", nil, nil),
+		"scram_cache_hits": prometheus.NewDesc(
+			prometheus.BuildFQName(namespace, "lists", "scram_cache_hits"),
+			"Count of SCRAM authentications, that used cached secret", nil, nil),
+		"scram_cache_misses": prometheus.NewDesc(
+			prometheus.BuildFQName(namespace, "lists", "scram_cache_misses"),
+			"Count of SCRAM authentications, that derived secret from plain text password", nil, nil),
+		"server_scram_cache_hits": prometheus.NewDesc(
+			prometheus.BuildFQName(namespace, "lists", "server_scram_cache_hits"),
+			"Count of server SCRAM authentications, that used cached keys", nil, nil),
+		"server_scram_cache_misses": prometheus.NewDesc(
+			prometheus.BuildFQName(namespace, "lists", "server_scram_cache_misses"),
+			"Count of server SCRAM authentications, that derived keys from password", nil, nil),
 	}
 
 	describeMetricDescs = []*prometheus.Desc{
 		versionDescription,
 		exporterUpDescription,
 		isPausedDescription,
+		workerClientsDescription,
+		workerPendingDescription,
+		workerLoadDescription,
+		workerBusyRatioDescription,
 		avgTxCountDescription,
 		avgQueryCountDescription,
 		avgRecvBytesPerSecondDescription,
@@ -429,6 +485,7 @@ func (exporter *Exporter) collectWithDB(ctx context.Context, ch chan<- prometheu
 	runStep("is_paused", func() error { return exporter.sendIsPausedMetric(ctx, ch, db) })
 	runStep("errors", func() error { return exporter.sendErrorMetrics(ctx, ch, db) })
 	runStep("stats", func() error { return exporter.sendStatsMetrics(ctx, ch, db) })
+	runStep("workers", func() error { return exporter.sendWorkersMetrics(ctx, ch, db) })
 
 	var poolCapacities map[routeKey]float64
 	runStep("databases", func() error {
@@ -740,6 +797,84 @@ func (exporter *Exporter) sendErrorMetrics(ctx context.Context, ch chan<- promet
 	return nil
 }
 
+func (exporter *Exporter) sendWorkersMetrics(ctx context.Context, ch chan<- prometheus.Metric, db *sql.DB) error {
+	rows, err := db.QueryContext(ctx, showWorkersCommand)
+	if err != nil {
+		return fmt.Errorf("error getting workers: %w", err)
+	}
+	defer rows.Close()
+
+	columns, err := rows.Columns()
+	if err != nil {
+		return fmt.Errorf("can't get columns of workers")
+	}
+
+	workerIdx := -1
+	gauges := map[int]*prometheus.Desc{}
+	scales := map[int]float64{}
+	for idx, name := range columns {
+		switch name {
+		case "worker":
+			workerIdx = idx
+		case "clients":
+			gauges[idx] = workerClientsDescription
+		case "pending":
+			gauges[idx] = workerPendingDescription
+		case "load":
+			gauges[idx] = workerLoadDescription
+		case "busy":
+			gauges[idx] = workerBusyRatioDescription
+			scales[idx] = 0.01
+		}
+	}
+
+	if workerIdx == -1 {
+		return fmt.Errorf("unexpected workers columns, worker=%d", workerIdx)
+	}
+
+	values := make([]any, len(columns))
+	pointers := make([]any, len(columns))
+	for i := range values {
+		pointers[i] = &values[i]
+	}
+
+	for rows.Next() {
+		if err := rows.Scan(pointers...); err != nil {
+			return fmt.Errorf("error scanning workers row: %w", err)
+		}
+
+		worker, err := extractString(values[workerIdx], "worker")
+		if err != nil {
+			// worker ids may be returned as integers
+			number, ok, floatErr := extractFloat(values[workerIdx], "worker")
+			if floatErr != nil || !ok {
+				return err
+			}
+			worker = strconv.FormatFloat(number, 'f', -1, 64)
+		}
+
+		for idx, description := range gauges {
+			value, ok, err := extractFloat(values[idx], columns[idx])
+			if err != nil {
+				return err
+			}
+			if !ok {
+				continue
+			}
+			if scale, ok := scales[idx]; ok {
+				value *= scale
+			}
+			ch <- prometheus.MustNewConstMetric(description, prometheus.GaugeValue, value, worker)
+		}
+	}
+
+	if err := rows.Err(); err != nil {
+		return fmt.Errorf("error iterating workers rows: %w", err)
+	}
+
+	return nil
+}
+
 func (exporter *Exporter) sendStatsMetrics(ctx context.Context, ch chan<- prometheus.Metric, db *sql.DB) error {
 	rows, err := db.QueryContext(ctx, showStatsCommand)
 	if err != nil {
@@ -11,6 +11,7 @@ import (
 
 	sqlmock "github.com/DATA-DOG/go-sqlmock"
 	"github.com/prometheus/client_golang/prometheus"
+	dto "github.com/prometheus/client_model/go"
 )
 
 func TestExporterDescribeDoesNotTouchDatabase(t *testing.T) {
@@ -115,6 +116,10 @@ func TestCollectWithDBContinuesAfterStepFailure(t *testing.T) {
 		WillReturnRows(sqlmock.NewRows([]string{"database", "avg_xact_count", "avg_query_count"}).
 			AddRow("db1", 1, 2))
 
+	mock.ExpectQuery(regexp.QuoteMeta(showWorkersCommand)).
+		WillReturnRows(sqlmock.NewRows([]string{"worker", "clients", "load", "busy"}).
+			AddRow("0", 3, 4, []byte("12.5")))
+
 	mock.ExpectQuery(regexp.QuoteMeta(showDatabasesCommand)).
 		WillReturnRows(sqlmock.NewRows([]string{"name", "pool_size"}).AddRow("db1", "4"))
 
@@ -145,6 +150,63 @@ func TestCollectWithDBContinuesAfterStepFailure(t *testing.T) {
 	}
 }
 
+func TestSendWorkersMetricsScalesBusy(t *testing.T) {
+	logger := slog.New(slog.NewTextHandler(io.Discard, nil))
+	exporter := &Exporter{
+		logger: logger,
+	}
+
+	db, mock, err := sqlmock.New()
+	if err != nil {
+		t.Fatalf("failed to create sqlmock: %v", err)
+	}
+	defer db.Close()
+
+	rows := sqlmock.
+		NewRows([]string{"worker", "clients", "pending", "ready", "load", "busy", "clients_processed"}).
+		AddRow([]byte("0"), []byte("10"), []byte("1"), []byte("2"), []byte("63"), []byte("50.0"), []byte("100")).
+		AddRow([]byte("1"), []byte("2"), []byte("0"), []byte("0"), []byte("2"), []byte("0.0"), []byte("40"))
+
+	mock.ExpectQuery(regexp.QuoteMeta(showWorkersCommand)).WillReturnRows(rows)
+
+	ch := make(chan prometheus.Metric, 16)
+	err = exporter.sendWorkersMetrics(context.Background(), ch, db)
+	if err != nil {
+		t.Fatalf("sendWorkersMetrics returned error: %v", err)
+	}
+	close(ch)
+
+	count := 0
+	foundBusy := false
+	for metric := range ch {
+		count++
+		if metric.Desc().String() != workerBusyRatioDescription.String() {
+			continue
+		}
+		var m dto.Metric
+		if err := metric.Write(&m); err != nil {
+			t.Fatalf("failed to write metric: %v", err)
+		}
+		if m.GetLabel()[0].GetValue() == "0" {
+			foundBusy = true
+			if m.GetGauge().GetValue() != 0.5 {
+				t.Fatalf("expected busy ratio 0.5, got %v", m.GetGauge().GetValue())
+			}
+		}
+	}
+
+	if count != 8 {
+		t.Fatalf("expected 8 worker metrics, got %d", count)
+	}
+	if !foundBusy {
+		t.Fatalf("expected busy ratio of worker 0")
+	}
+
+	if err := mock.ExpectationsWereMet(); err != nil {
+		t.Fatalf("unmet expectations: %v", err)
+	}
+}
+
 func TestSendListsMetricsReturnsRowsErr(t *testing.T) {
 	logger := slog.New(slog.NewTextHandler(io.Discard, nil))
 	exporter := &Exporter{
@@ -192,6 +254,7 @@ func TestCollectWithDBRespectsContextCancellation(t *testing.T) {
 		showIsPausedCommand,
 		showErrorsCommand,
 		showStatsCommand,
+		showWorkersCommand,
 		showDatabasesCommand,
 		showPoolsExtendedCommand,
 	} {
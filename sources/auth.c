@@ -615,8 +615,9 @@ od_auth_frontend_scram_sha_256_internal(od_client_t *client,
 
 	rc = od_scram_parse_verifier(scram_state, query_password.password);
 	if (rc == -1) {
-		rc = od_scram_init_from_plain_password(scram_state,
-						       query_password.password);
+		rc = od_scram_init_from_plain_password_cached(
+			&client->global->scram_cache, scram_state,
+			client->startup.user.value, query_password.password);
 	}
 
 	if (rc == -1) {
@@ -1128,9 +1129,17 @@ static inline int od_auth_backend_sasl_continue(od_server_t *server,
 			 "pass-through SCRAM key" :
 			 "password");
 
+	/* keys derived from the storage password are reused by connections */
+	od_scram_cache_t *cache = &server->global->server_scram_cache;
+	char *user = route->rule->storage_user;
+	if (user == NULL) {
+		user = route->id.user;
+	}
+
 	/* SASLResponse Message */
 	machine_msg_t *msg = od_scram_create_client_final_message(
-		&server->scram_state, password, auth_data, auth_data_size);
+		&server->scram_state, password, auth_data, auth_data_size,
+		cache, user);
 	if (msg == NULL) {
 		od_error(&instance->logger, "auth", NULL, server,
 			 "malformed SASLResponse message");
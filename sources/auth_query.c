@@ -229,7 +229,15 @@ static void pswd_update_task(void *a)
 		od_route_pswd_t *new = od_route_pswd_create(password.password);
 		od_free(password.password);
 		if (new != NULL) {
-			od_route_pswd_unref(route->auth_query_cache.password);
+			od_route_pswd_t *prev;
+			prev = route->auth_query_cache.password;
+			if (prev != NULL &&
+			    strcmp(prev->value, new->value) != 0) {
+				/* drop secrets derived from old password */
+				od_scram_cache_invalidate_user(
+					&global->scram_cache, arg->user);
+			}
+			od_route_pswd_unref(prev);
 			route->auth_query_cache.password = new;
 			route->auth_query_cache.valid_until_ms = until;
 		}
@@ -29,6 +29,7 @@
 #include <query.h>
 #include <stream.h>
 #include <tls.h>
+#include <compression.h>
 
 void od_backend_close(od_server_t *server)
 {
@@ -63,6 +64,7 @@ void od_backend_close_connection(od_server_t *server)
 		od_backend_terminate(server);
 	}
 
+	od_compression_backend_account(server);
 	od_io_close(&server->io);
 
 	if (server->error_connect) {
@@ -174,7 +176,7 @@ static inline void od_backend_reset_for_retry(od_server_t *server)
 	od_scram_state_init(&server->scram_state);
 
 	kiwi_key_init(&server->key);
-	kiwi_vars_init(&server->vars);
+	kiwi_vars_free(&server->vars);
 
 	/*
 	 * do not reset client key here
@@ -190,6 +192,8 @@ static inline void od_backend_reset_for_retry(od_server_t *server)
 	server->msg_broken = 0;
 	server->oom = 0;
 	server->synced_settings = false;
+	server->deploy_pending = 0;
+	server->deploy_stamp_valid = 0;
 	server->need_startup = 1;
 }
 
@@ -337,8 +341,9 @@ int od_backend_startup(od_server_t *server, kiwi_params_t *route_params,
 	od_route_t *route = server->route;
 
 #define DEFAULT_ARGV_SIZE 6
+#define COMPRESSION_ARGV_SIZE 2
 
-	kiwi_fe_arg_t argv[DEFAULT_ARGV_SIZE +
+	kiwi_fe_arg_t argv[DEFAULT_ARGV_SIZE + COMPRESSION_ARGV_SIZE +
 			   2 * route->rule->backend_startup_vars_sz];
 
 	kiwi_fe_arg_t default_argv[] = {
@@ -382,6 +387,17 @@ int od_backend_startup(od_server_t *server, kiwi_params_t *route_params,
 		argc += 2;
 	}
 
+	od_rule_storage_t *storage = route->rule->storage;
+	char compression_algorithms[MM_ZPQ_MAX_ALGORITHMS];
+	od_compression_backend_algorithms(storage, compression_algorithms);
+	if (compression_algorithms[0] != '\0') {
+		argv[argc].name = "compression";
+		argv[argc].len = 12;
+		argv[argc + 1].name = compression_algorithms;
+		argv[argc + 1].len = strlen(compression_algorithms) + 1;
+		argc += 2;
+	}
+
 	machine_msg_t *msg;
 	msg = kiwi_fe_write_startup_message(NULL, argc, argv);
 	if (msg == NULL) {
@@ -426,6 +442,14 @@ int od_backend_startup(od_server_t *server, kiwi_params_t *route_params,
 				return -1;
 			}
 			break;
+		case KIWI_BE_COMPRESSION:
+			rc = od_compression_backend_setup(
+				server, storage, msg, &instance->logger);
+			machine_msg_free(msg);
+			if (rc == -1) {
+				return -1;
+			}
+			break;
 		case KIWI_BE_BACKEND_KEY_DATA:
 			rc = kiwi_fe_read_key(machine_msg_data(msg),
 					      machine_msg_size(msg),
@@ -573,11 +597,12 @@ int od_backend_connect_to(od_server_t *server, char *context,
 		mm_io_free(io);
 		return -1;
 	}
+	server->last_machine = machine_self();
 
 	/* set tls options */
 	int negotiate_tls = od_backend_tls_negotiate(tlsopts, tls_attempt);
 	if (negotiate_tls) {
-		server->tls = od_tls_backend(tlsopts);
+		server->tls = od_tls_backend(tlsopts, address);
 		if (server->tls == NULL) {
 			return -1;
 		}
@@ -198,13 +198,6 @@ static size_t roundrobin(od_storage_balancing_t *b, od_rule_storage_t *storage,
 	return count;
 }
 
-static int addr_filter(void *arg, const od_multi_pool_key_t *key)
-{
-	const od_storage_endpoint_t *endp = (const od_storage_endpoint_t *)arg;
-
-	return od_address_cmp(&key->address, &endp->address) == 0;
-}
-
 typedef struct {
 	od_route_t *route;
 	od_storage_balancing_t *b;
@@ -233,8 +226,8 @@ static int conncount_cmp(void *arg, const void *a, const void *b)
 	}
 
 	od_multi_pool_t *mp = od_route_server_pools(route);
-	int f_cnt = od_multi_pool_total_locked(mp, addr_filter, (void *)f);
-	int s_cnt = od_multi_pool_total_locked(mp, addr_filter, (void *)s);
+	int f_cnt = od_multi_pool_total_by_address_locked(mp, &f->address);
+	int s_cnt = od_multi_pool_total_by_address_locked(mp, &s->address);
 
 	/* let less count be the first */
 	return f_cnt - s_cnt;
@@ -0,0 +1,190 @@
+
+/*
+ * Odyssey.
+ *
+ * Scalable PostgreSQL connection pooler.
+ */
+
+#include <odyssey.h>
+
+#include <machinarium/ds/hm.h>
+
+#include <cancel_table.h>
+#include <server.h>
+#include <storage.h>
+#include <od_memory.h>
+
+static inline uint64_t od_cancel_table_hash(kiwi_key_t *key)
+{
+	uint64_t value = ((uint64_t)key->key_pid << 32) | key->key;
+	return mm_xxh64_hash(&value, sizeof(value), 0);
+}
+
+static inline od_cancel_table_stripe_t *
+od_cancel_table_stripe(od_cancel_table_t *table, uint64_t hash)
+{
+	/* high bits for stripe, low bits for bucket */
+	return &table->stripes[(hash >> 32) % OD_CANCEL_TABLE_STRIPES];
+}
+
+static inline od_list_t *
+od_cancel_table_bucket(od_cancel_table_stripe_t *stripe, uint64_t hash)
+{
+	return &stripe->buckets[hash & (stripe->size - 1)];
+}
+
+void od_cancel_table_init(od_cancel_table_t *table)
+{
+	for (int i = 0; i < OD_CANCEL_TABLE_STRIPES; ++i) {
+		od_cancel_table_stripe_t *stripe = &table->stripes[i];
+		mm_sleeplock_init(&stripe->lock);
+		stripe->buckets = NULL;
+		stripe->size = 0;
+		stripe->count = 0;
+	}
+}
+
+void od_cancel_table_free(od_cancel_table_t *table)
+{
+	for (int i = 0; i < OD_CANCEL_TABLE_STRIPES; ++i) {
+		od_cancel_table_stripe_t *stripe = &table->stripes[i];
+		if (stripe->buckets != NULL) {
+			od_free(stripe->buckets);
+			stripe->buckets = NULL;
+		}
+		stripe->size = 0;
+		stripe->count = 0;
+	}
+}
+
+static int od_cancel_table_resize(od_cancel_table_stripe_t *stripe,
+				  size_t size)
+{
+	od_list_t *buckets = od_malloc(sizeof(od_list_t) * size);
+	if (buckets == NULL) {
+		return NOT_OK_RESPONSE;
+	}
+	for (size_t i = 0; i < size; ++i) {
+		od_list_init(&buckets[i]);
+	}
+
+	od_list_t *prev = stripe->buckets;
+	size_t prev_size = stripe->size;
+
+	stripe->buckets = buckets;
+	stripe->size = size;
+
+	/* rehash servers into the new buckets */
+	for (size_t b = 0; b < prev_size; ++b) {
+		od_list_t *i, *n;
+		od_list_foreach_safe (&prev[b], i, n) {
+			od_server_t *server;
+			server = od_container_of(i, od_server_t, cancel_link);
+			od_list_unlink(&server->cancel_link);
+			od_list_append(
+				od_cancel_table_bucket(
+					stripe, od_cancel_table_hash(
+							&server->key_client)),
+				&server->cancel_link);
+		}
+	}
+
+	if (prev != NULL) {
+		od_free(prev);
+	}
+
+	return OK_RESPONSE;
+}
+
+void od_cancel_table_add(od_cancel_table_t *table, od_server_t *server)
+{
+	/* internal clients have no cancel key */
+	kiwi_key_t *key = &server->key_client;
+	if (key->key == 0 && key->key_pid == 0) {
+		return;
+	}
+
+	uint64_t hash = od_cancel_table_hash(key);
+	od_cancel_table_stripe_t *stripe = od_cancel_table_stripe(table, hash);
+
+	mm_sleeplock_lock(&stripe->lock);
+
+	if (stripe->buckets == NULL) {
+		if (od_cancel_table_resize(stripe,
+					   OD_CANCEL_TABLE_STRIPE_MIN_SIZE) !=
+		    OK_RESPONSE) {
+			/* server just can't be canceled */
+			mm_sleeplock_unlock(&stripe->lock);
+			return;
+		}
+	} else if (stripe->count >= stripe->size) {
+		/* failed growth is not fatal - chains become longer */
+		od_cancel_table_resize(stripe, stripe->size * 2);
+	}
+
+	od_list_append(od_cancel_table_bucket(stripe, hash),
+		       &server->cancel_link);
+	stripe->count++;
+
+	mm_sleeplock_unlock(&stripe->lock);
+}
+
+void od_cancel_table_remove(od_cancel_table_t *table, od_server_t *server)
+{
+	kiwi_key_t *key = &server->key_client;
+	uint64_t hash = od_cancel_table_hash(key);
+	od_cancel_table_stripe_t *stripe = od_cancel_table_stripe(table, hash);
+
+	mm_sleeplock_lock(&stripe->lock);
+
+	/* was not added, see od_cancel_table_add */
+	if (!od_list_empty(&server->cancel_link)) {
+		od_list_unlink(&server->cancel_link);
+		od_list_init(&server->cancel_link);
+		od_assert(stripe->count > 0);
+		stripe->count--;
+	}
+
+	mm_sleeplock_unlock(&stripe->lock);
+}
+
+int od_cancel_table_begin(od_cancel_table_t *table, kiwi_key_t *key,
+			  od_router_cancel_t *cancel)
+{
+	uint64_t hash = od_cancel_table_hash(key);
+	od_cancel_table_stripe_t *stripe = od_cancel_table_stripe(table, hash);
+
+	mm_sleeplock_lock(&stripe->lock);
+
+	if (stripe->buckets == NULL) {
+		mm_sleeplock_unlock(&stripe->lock);
+		return NOT_OK_RESPONSE;
+	}
+
+	od_list_t *i;
+	od_list_foreach (od_cancel_table_bucket(stripe, hash), i) {
+		od_server_t *server;
+		server = od_container_of(i, od_server_t, cancel_link);
+		if (!kiwi_key_cmp(&server->key_client, key)) {
+			continue;
+		}
+
+		/*
+		 * server is in the table only while attached to client,
+		 * which holds a reference, so it is safe to take another one
+		 */
+		cancel->id = server->id;
+		cancel->key = server->key;
+		cancel->storage =
+			od_rules_storage_ref(server->endpoint->storage);
+		cancel->address = od_server_pool_address(server);
+		cancel->server = server;
+		od_server_cancel_begin(server);
+
+		mm_sleeplock_unlock(&stripe->lock);
+		return OK_RESPONSE;
+	}
+
+	mm_sleeplock_unlock(&stripe->lock);
+	return NOT_OK_RESPONSE;
+}
@@ -434,6 +434,7 @@ int convert_global(const od_cfg_global_t *cfg, od_config_t *config,
 	COPY_BOOL(cfg->virtual_processing, config->virtual_processing);
 	COPY_BOOL(cfg->virtual_transaction, config->virtual_transaction);
 	COPY_BOOL(cfg->bindwith_reuseport, config->bindwith_reuseport);
+	COPY_BOOL(cfg->listen_per_worker, config->listen_per_worker);
 	COPY_BOOL(cfg->enable_host_watcher, config->host_watcher_enabled);
 	COPY_BOOL(cfg->log_debug, config->log_debug);
 	COPY_BOOL(cfg->log_to_stdout, config->log_to_stdout);
@@ -445,6 +446,7 @@ int convert_global(const od_cfg_global_t *cfg, od_config_t *config,
 	COPY_BOOL(cfg->log_syslog, config->log_syslog);
 	COPY_BOOL(cfg->smart_search_path_enquoting,
 		  config->smart_search_path_enquoting);
+	COPY_BOOL(cfg->pipeline_deploy, config->pipeline_deploy);
 	COPY_BOOL(cfg->nodelay, config->nodelay);
 	COPY_BOOL(cfg->disable_nolinger, config->disable_nolinger);
 	COPY_BOOL(cfg->log_general_stats_prom, config->log_general_stats_prom);
@@ -462,6 +464,8 @@ int convert_global(const od_cfg_global_t *cfg, od_config_t *config,
 	COPY_INT(cfg->client_max_routing, config->client_max_routing);
 	COPY_INT(cfg->server_login_retry, config->server_login_retry);
 	COPY_INT(cfg->readahead, config->readahead);
+	COPY_INT(cfg->readahead_release_timeout_ms,
+		 config->readahead_release_timeout_ms);
 	COPY_INT(cfg->keepalive, config->keepalive);
 	COPY_INT(cfg->keepalive_keep_interval, config->keepalive_keep_interval);
 	COPY_INT(cfg->keepalive_probes, config->keepalive_probes);
@@ -472,8 +476,14 @@ int convert_global(const od_cfg_global_t *cfg, od_config_t *config,
 	COPY_INT(cfg->cancel_timeout_ms, config->cancel_timeout_ms);
 	COPY_INT(cfg->cancel_queue_timeout_ms, config->cancel_queue_timeout_ms);
 	COPY_INT(cfg->cancel_max_inflight, config->cancel_max_inflight);
+	COPY_INT(cfg->scram_cache_size, config->scram_cache_size);
+	COPY_INT(cfg->scram_cache_ttl, config->scram_cache_ttl);
+	COPY_INT(cfg->tls_ticket_key_rotation_interval,
+		 config->tls_ticket_key_rotation_interval);
+	COPY_INT(cfg->scram_derive_workers, config->scram_derive_workers);
 	COPY_INT(cfg->resolvers, config->resolvers);
 	COPY_INT(cfg->dns_cache_ttl, config->dns_ttl_ms);
+	COPY_BOOL(cfg->timer_wheel, config->timer_wheel);
 	COPY_INT(cfg->cache_msg_gc_size, config->cache_msg_gc_size);
 	COPY_INT(cfg->cache_coroutine, config->cache_coroutine);
 	COPY_INT(cfg->coroutine_stack_size, config->coroutine_stack_size);
@@ -545,6 +555,26 @@ int convert_global(const od_cfg_global_t *cfg, od_config_t *config,
 		strcpy(config->availability_zone, val);
 	}
 
+	if (cfg->worker_placement.seen.is_set) {
+		const char *val = cfg->worker_placement.value;
+		if (strcmp(val, "round_robin") == 0) {
+			config->worker_placement =
+				OD_CONFIG_WORKER_PLACEMENT_ROUND_ROBIN;
+		} else if (strcmp(val, "least_loaded") == 0) {
+			config->worker_placement =
+				OD_CONFIG_WORKER_PLACEMENT_LEAST_LOADED;
+		} else if (strcmp(val, "p2c") == 0) {
+			config->worker_placement =
+				OD_CONFIG_WORKER_PLACEMENT_P2C;
+		} else {
+			od_cfg_diag_error(
+				diags, cfg->worker_placement.seen.location,
+				"unknown worker_placement '%s', expected round_robin, least_loaded or p2c",
+				val);
+			return -1;
+		}
+	}
+
 	if (cfg->cpu_affinity.seen.is_set) {
 		config->cpu_affinity = od_malloc(sizeof(od_affinity_config_t));
 		if (config->cpu_affinity == NULL) {
@@ -715,6 +745,7 @@ static int convert_rule_settings(const od_cfg_route_t *cfg, od_list_t *spools,
 			goto error;
 		}
 	}
+	COPY_INT(cfg->quantiles_window, rule->quantiles_window);
 	COPY_BOOL(cfg->application_name_add_host,
 		  rule->application_name_add_host);
 	COPY_BOOL(cfg->server_drop_on_backend_plan_error,
@@ -738,6 +769,7 @@ static int convert_rule_settings(const od_cfg_route_t *cfg, od_list_t *spools,
 	COPY_BOOL(cfg->pool_cancel, rule->pool->cancel);
 	COPY_BOOL(cfg->pool_rollback, rule->pool->rollback);
 	COPY_U64(cfg->pool_reset_timeout_ms, rule->pool->reset_timeout_ms);
+	COPY_BOOL(cfg->pool_reset_async, rule->pool->reset_async);
 	COPY_BOOL(cfg->pool_reserve_prepared_statement,
 		  rule->pool->reserve_prepared_statement);
 	COPY_BOOL(cfg->pool_pin_on_listen, rule->pool->pin_on_listen);
@@ -1046,7 +1078,9 @@ static int convert_listen(convert_ctx_t *ctx, const od_cfg_listen_t *cfg)
 	COPY_STR(cfg->tls_cert_file, listen->tls_opts->tls_cert_file, diags);
 	COPY_STR(cfg->tls_protocols, listen->tls_opts->tls_protocols, diags);
 
-	/* no compression field */
+	COPY_BOOL(cfg->compression, listen->compression);
+	COPY_INT(cfg->compression_level, listen->compression_level);
+	COPY_INT(cfg->compression_buffer_size, listen->compression_buffer_size);
 
 	listen->storage_count = cfg->storages_count;
 	if (listen->storage_count > 0) {
@@ -1167,6 +1201,8 @@ static int convert_storage(const od_cfg_storage_t *cfg, od_list_t *spools,
 	COPY_INT(cfg->server_max_routing, storage->server_max_routing);
 	COPY_INT(cfg->endpoints_status_poll_interval_ms,
 		 storage->endpoints_status_poll_interval_ms);
+	COPY_BOOL(cfg->compression, storage->compression);
+	COPY_INT(cfg->compression_level, storage->compression_level);
 
 	if (cfg->host.seen.is_set) {
 		int rc = od_storage_parse_endpoints(cfg->host.value,
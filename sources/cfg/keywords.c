@@ -23,6 +23,8 @@ static const od_cfg_keyword_t keywords[] = {
 	{ "virtual_processing", VIRTUAL_PROCESSING },
 	{ "graceful_die_on_errors", GRACEFUL_DIE_ON_ERRORS },
 	{ "bindwith_reuseport", BINDWITH_REUSEPORT },
+	{ "listen_per_worker", LISTEN_PER_WORKER },
+	{ "worker_placement", WORKER_PLACEMENT },
 	{ "enable_host_watcher", ENABLE_HOST_WATCHER },
 	{ "log_debug", LOG_DEBUG },
 	{ "log_to_stdout", LOG_TO_STDOUT },
@@ -33,6 +35,8 @@ static const od_cfg_keyword_t keywords[] = {
 	{ "log_async", LOG_ASYNC },
 	{ "log_syslog", LOG_SYSLOG },
 	{ "smart_search_path_enquoting", SMART_SEARCH_PATH_ENQUOTING },
+	{ "pipeline_deploy", PIPELINE_DEPLOY },
+	{ "timer_wheel", TIMER_WHEEL },
 	{ "nodelay", NODELAY },
 	{ "disable_nolinger", DISABLE_NOLINGER },
 	{ "log_general_stats_prom", LOG_GENERAL_STATS_PROM },
@@ -57,6 +61,7 @@ static const od_cfg_keyword_t keywords[] = {
 	{ "client_max_routing", CLIENT_MAX_ROUTING },
 	{ "server_login_retry", SERVER_LOGIN_RETRY },
 	{ "readahead", READAHEAD },
+	{ "readahead_release_timeout_ms", READAHEAD_RELEASE_TIMEOUT_MS },
 	{ "keepalive", KEEPALIVE },
 	{ "keepalive_keep_interval", KEEPALIVE_KEEP_INTERVAL },
 	{ "keepalive_probes", KEEPALIVE_PROBES },
@@ -66,6 +71,11 @@ static const od_cfg_keyword_t keywords[] = {
 	{ "cancel_timeout_ms", CANCEL_TIMEOUT_MS },
 	{ "cancel_queue_timeout_ms", CANCEL_QUEUE_TIMEOUT_MS },
 	{ "cancel_max_inflight", CANCEL_MAX_INFLIGHT },
+	{ "scram_cache_size", SCRAM_CACHE_SIZE },
+	{ "scram_cache_ttl", SCRAM_CACHE_TTL },
+	{ "tls_ticket_key_rotation_interval",
+	  TLS_TICKET_KEY_ROTATION_INTERVAL },
+	{ "scram_derive_workers", SCRAM_DERIVE_WORKERS },
 	{ "resolvers", RESOLVERS },
 	{ "dns_cache_ttl", DNS_CACHE_TTL },
 	{ "cache_msg_gc_size", CACHE_MSG_GC_SIZE },
@@ -102,6 +112,8 @@ static const od_cfg_keyword_t keywords[] = {
 	{ "method", METHOD },
 	{ "show_notice_messages", SHOW_NOTICE_MESSAGES },
 	{ "compression", COMPRESSION },
+	{ "compression_level", COMPRESSION_LEVEL },
+	{ "compression_buffer_size", COMPRESSION_BUFFER_SIZE },
 	{ "workers", WORKERS },
 	{ "pipeline", PIPELINE },
 	{ "cache", CACHE },
@@ -152,6 +164,7 @@ static const od_cfg_keyword_t keywords[] = {
 	{ "reserve_session_server_connection",
 	  RESERVE_SESSION_SERVER_CONNECTION },
 	{ "quantiles", QUANTILES },
+	{ "quantiles_window", QUANTILES_WINDOW },
 	{ "application_name_add_host", APPLICATION_NAME_ADD_HOST },
 	{ "server_drop_on_cached_plan_error",
 	  SERVER_DROP_ON_CACHED_PLAN_ERROR },
@@ -171,6 +184,7 @@ static const od_cfg_keyword_t keywords[] = {
 	{ "pool_cancel", POOL_CANCEL },
 	{ "pool_rollback", POOL_ROLLBACK },
 	{ "pool_reset_timeout_ms", POOL_RESET_TIMEOUT_MS },
+	{ "pool_reset_async", POOL_RESET_ASYNC },
 	{ "pool_reserve_prepared_statement", POOL_RESERVE_PREPARED_STATEMENT },
 	{ "pool_pin_on_listen", POOL_PIN_ON_LISTEN },
 	{ "pool_attach_check", POOL_ATTACH_CHECK },
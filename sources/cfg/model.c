@@ -91,6 +91,10 @@ static void dump_listen(FILE *file, const od_cfg_listen_t *l)
 	dump_string(file, "tls_cert_file", 1, &l->tls_cert_file);
 	dump_string(file, "tls_protocols", 1, &l->tls_protocols);
 	dump_int(file, "catchup_timeout", 1, &l->catchup_timeout);
+	dump_bool(file, "compression", 1, &l->compression);
+	dump_int(file, "compression_level", 1, &l->compression_level);
+	dump_int(file, "compression_buffer_size", 1,
+		 &l->compression_buffer_size);
 	fprintf(file, "}\n");
 }
 
@@ -111,6 +115,8 @@ static void dump_storage(FILE *file, const od_cfg_storage_t *s)
 	dump_int(file, "server_max_routing", 1, &s->server_max_routing);
 	dump_int(file, "endpoints_status_poll_interval_ms", 1,
 		 &s->endpoints_status_poll_interval_ms);
+	dump_bool(file, "compression", 1, &s->compression);
+	dump_int(file, "compression_level", 1, &s->compression_level);
 
 	if (s->balancing.seen.is_set) {
 		fprintf(file, "\tbalancing {\n");
@@ -269,6 +275,7 @@ static void dump_user(FILE *file, const char *type, const od_cfg_route_t *user)
 	dump_bool(file, "reserve_session_server_connection", 2,
 		  &user->reserve_session_server_connection);
 	dump_string(file, "quantiles", 2, &user->quantiles);
+	dump_int(file, "quantiles_window", 2, &user->quantiles_window);
 	dump_bool(file, "application_name_add_host", 2,
 		  &user->application_name_add_host);
 	dump_bool(file, "server_drop_on_backend_plan_error", 2,
@@ -306,6 +313,7 @@ static void dump_user(FILE *file, const char *type, const od_cfg_route_t *user)
 	dump_bool(file, "pool_rollback", 2, &user->pool_rollback);
 	dump_uint64(file, "pool_reset_timeout_ms", 2,
 		    &user->pool_reset_timeout_ms);
+	dump_bool(file, "pool_reset_async", 2, &user->pool_reset_async);
 	dump_bool(file, "pool_reserve_prepared_statement", 2,
 		  &user->pool_reserve_prepared_statement);
 	dump_bool(file, "pool_pin_on_listen", 2, &user->pool_pin_on_listen);
@@ -387,6 +395,10 @@ void od_cfg_model_dumpf(FILE *file, const od_cfg_model_t *model)
 		  &model->global.virtual_processing);
 	dump_bool(file, "bindwith_reuseport", 0,
 		  &model->global.bindwith_reuseport);
+	dump_bool(file, "listen_per_worker", 0,
+		  &model->global.listen_per_worker);
+	dump_string(file, "worker_placement", 0,
+		    &model->global.worker_placement);
 	dump_bool(file, "enable_host_watcher", 0,
 		  &model->global.enable_host_watcher);
 	dump_bool(file, "log_debug", 0, &model->global.log_debug);
@@ -403,6 +415,8 @@ void od_cfg_model_dumpf(FILE *file, const od_cfg_model_t *model)
 		  &model->global.log_route_stats_prom);
 	dump_bool(file, "smart_search_path_enquoting", 0,
 		  &model->global.smart_search_path_enquoting);
+	dump_bool(file, "pipeline_deploy", 0, &model->global.pipeline_deploy);
+	dump_bool(file, "timer_wheel", 0, &model->global.timer_wheel);
 	dump_bool(file, "nodelay", 0, &model->global.nodelay);
 	dump_bool(file, "disable_nolinger", 0, &model->global.disable_nolinger);
 
@@ -435,6 +449,8 @@ void od_cfg_model_dumpf(FILE *file, const od_cfg_model_t *model)
 	dump_int(file, "server_login_retry", 0,
 		 &model->global.server_login_retry);
 	dump_int(file, "readahead", 0, &model->global.readahead);
+	dump_int(file, "readahead_release_timeout_ms", 0,
+		 &model->global.readahead_release_timeout_ms);
 	dump_int(file, "keepalive", 0, &model->global.keepalive);
 	dump_int(file, "keepalive_keep_interval", 0,
 		 &model->global.keepalive_keep_interval);
@@ -451,6 +467,12 @@ void od_cfg_model_dumpf(FILE *file, const od_cfg_model_t *model)
 		 &model->global.cancel_queue_timeout_ms);
 	dump_int(file, "cancel_max_inflight", 0,
 		 &model->global.cancel_max_inflight);
+	dump_int(file, "scram_cache_size", 0, &model->global.scram_cache_size);
+	dump_int(file, "scram_cache_ttl", 0, &model->global.scram_cache_ttl);
+	dump_int(file, "tls_ticket_key_rotation_interval", 0,
+		 &model->global.tls_ticket_key_rotation_interval);
+	dump_int(file, "scram_derive_workers", 0,
+		 &model->global.scram_derive_workers);
 	dump_int(file, "resolvers", 0, &model->global.resolvers);
 	dump_int(file, "dns_cache_ttl", 0, &model->global.dns_cache_ttl);
 	dump_int(file, "cache_msg_gc_size", 0,
@@ -585,6 +607,8 @@ static void od_cfg_listen_free(od_cfg_listen_t *listen)
 	od_cfg_string_field_free(&listen->tls_cert_file);
 	od_cfg_string_field_free(&listen->tls_protocols);
 	od_cfg_int_field_free(&listen->catchup_timeout);
+	od_cfg_int_field_free(&listen->compression_level);
+	od_cfg_int_field_free(&listen->compression_buffer_size);
 
 	for (size_t i = 0; i < listen->storages_count; ++i) {
 		od_cfg_location_free(&listen->storages[i]->location);
@@ -621,6 +645,7 @@ static void od_cfg_storage_free(od_cfg_storage_t *storage)
 	od_cfg_string_field_free(&storage->tls_cert_file);
 	od_cfg_string_field_free(&storage->tls_protocols);
 	od_cfg_int_field_free(&storage->server_max_routing);
+	od_cfg_int_field_free(&storage->compression_level);
 	od_cfg_int_field_free(&storage->endpoints_status_poll_interval_ms);
 
 	od_cfg_seen_free(&storage->balancing.seen);
@@ -743,6 +768,7 @@ static void od_cfg_user_route_free(od_cfg_route_t *user)
 	od_cfg_bool_field_free(&user->client_show_id);
 	od_cfg_bool_field_free(&user->reserve_session_server_connection);
 	od_cfg_string_field_free(&user->quantiles);
+	od_cfg_int_field_free(&user->quantiles_window);
 	od_cfg_bool_field_free(&user->application_name_add_host);
 	od_cfg_bool_field_free(&user->server_drop_on_backend_plan_error);
 	od_cfg_u64_field_free(&user->server_lifetime);
@@ -762,6 +788,7 @@ static void od_cfg_user_route_free(od_cfg_route_t *user)
 	od_cfg_bool_field_free(&user->pool_cancel);
 	od_cfg_bool_field_free(&user->pool_rollback);
 	od_cfg_u64_field_free(&user->pool_reset_timeout_ms);
+	od_cfg_bool_field_free(&user->pool_reset_async);
 	od_cfg_bool_field_free(&user->pool_reserve_prepared_statement);
 	od_cfg_bool_field_free(&user->pool_pin_on_listen);
 	od_cfg_bool_field_free(&user->pool_attach_check);
@@ -836,6 +863,8 @@ void od_cfg_model_free(od_cfg_model_t *model)
 	od_cfg_bool_field_free(&model->global.enable_online_restart);
 	od_cfg_bool_field_free(&model->global.virtual_processing);
 	od_cfg_bool_field_free(&model->global.bindwith_reuseport);
+	od_cfg_bool_field_free(&model->global.listen_per_worker);
+	od_cfg_string_field_free(&model->global.worker_placement);
 	od_cfg_bool_field_free(&model->global.enable_host_watcher);
 	od_cfg_bool_field_free(&model->global.log_debug);
 	od_cfg_bool_field_free(&model->global.log_to_stdout);
@@ -846,6 +875,8 @@ void od_cfg_model_free(od_cfg_model_t *model)
 	od_cfg_bool_field_free(&model->global.log_async);
 	od_cfg_bool_field_free(&model->global.log_syslog);
 	od_cfg_bool_field_free(&model->global.smart_search_path_enquoting);
+	od_cfg_bool_field_free(&model->global.pipeline_deploy);
+	od_cfg_bool_field_free(&model->global.timer_wheel);
 	od_cfg_bool_field_free(&model->global.nodelay);
 	od_cfg_bool_field_free(&model->global.disable_nolinger);
 	od_cfg_bool_field_free(&model->global.log_general_stats_prom);
@@ -874,6 +905,7 @@ void od_cfg_model_free(od_cfg_model_t *model)
 	od_cfg_int_field_free(&model->global.client_max_routing);
 	od_cfg_int_field_free(&model->global.server_login_retry);
 	od_cfg_int_field_free(&model->global.readahead);
+	od_cfg_int_field_free(&model->global.readahead_release_timeout_ms);
 	od_cfg_int_field_free(&model->global.keepalive);
 	od_cfg_int_field_free(&model->global.keepalive_keep_interval);
 	od_cfg_int_field_free(&model->global.keepalive_probes);
@@ -883,6 +915,10 @@ void od_cfg_model_free(od_cfg_model_t *model)
 	od_cfg_int_field_free(&model->global.cancel_timeout_ms);
 	od_cfg_int_field_free(&model->global.cancel_queue_timeout_ms);
 	od_cfg_int_field_free(&model->global.cancel_max_inflight);
+	od_cfg_int_field_free(&model->global.scram_cache_size);
+	od_cfg_int_field_free(&model->global.scram_cache_ttl);
+	od_cfg_int_field_free(&model->global.tls_ticket_key_rotation_interval);
+	od_cfg_int_field_free(&model->global.scram_derive_workers);
 	od_cfg_int_field_free(&model->global.resolvers);
 	od_cfg_int_field_free(&model->global.dns_cache_ttl);
 	od_cfg_int_field_free(&model->global.cache_msg_gc_size);
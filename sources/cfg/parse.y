@@ -143,6 +143,8 @@
 %token VIRTUAL_PROCESSING "virtual_processing"
 %token GRACEFUL_DIE_ON_ERRORS "graceful_die_on_errors"
 %token BINDWITH_REUSEPORT "bindwith_reuseport"
+%token LISTEN_PER_WORKER "listen_per_worker"
+%token WORKER_PLACEMENT "worker_placement"
 %token ENABLE_HOST_WATCHER "enable_host_watcher"
 %token LOG_DEBUG "log_debug"
 %token LOG_TO_STDOUT "log_to_stdout"
@@ -153,6 +155,8 @@
 %token LOG_ASYNC "log_async"
 %token LOG_SYSLOG "log_syslog"
 %token SMART_SEARCH_PATH_ENQUOTING "smart_search_path_enquoting"
+%token PIPELINE_DEPLOY "pipeline_deploy"
+%token TIMER_WHEEL "timer_wheel"
 %token NODELAY "nodelay"
 %token DISABLE_NOLINGER "disable_nolinger"
 %token LOG_GENERAL_STATS_PROM "log_general_stats_prom"
@@ -177,6 +181,7 @@
 %token CLIENT_MAX_ROUTING "client_max_routing"
 %token SERVER_LOGIN_RETRY "server_login_retry"
 %token READAHEAD "readahead"
+%token READAHEAD_RELEASE_TIMEOUT_MS "readahead_release_timeout_ms"
 %token KEEPALIVE "keepalive"
 %token KEEPALIVE_KEEP_INTERVAL "keepalive_keep_interval"
 %token KEEPALIVE_PROBES "keepalive_probes"
@@ -186,6 +191,10 @@
 %token CANCEL_TIMEOUT_MS "cancel_timeout_ms"
 %token CANCEL_QUEUE_TIMEOUT_MS "cancel_queue_timeout_ms"
 %token CANCEL_MAX_INFLIGHT "cancel_max_inflight"
+%token SCRAM_CACHE_SIZE "scram_cache_size"
+%token SCRAM_CACHE_TTL "scram_cache_ttl"
+%token TLS_TICKET_KEY_ROTATION_INTERVAL "tls_ticket_key_rotation_interval"
+%token SCRAM_DERIVE_WORKERS "scram_derive_workers"
 %token RESOLVERS "resolvers"
 %token DNS_CACHE_TTL "dns_cache_ttl"
 %token CACHE_MSG_GC_SIZE "cache_msg_gc_size"
@@ -223,6 +232,8 @@
 %token METHOD "method"
 %token SHOW_NOTICE_MESSAGES "show_notice_messages"
 %token COMPRESSION "compression"
+%token COMPRESSION_LEVEL "compression_level"
+%token COMPRESSION_BUFFER_SIZE "compression_buffer_size"
 %token WORKERS "workers"
 %token PIPELINE "pipeline"
 %token CACHE "cache"
@@ -272,6 +283,7 @@
 %token CLIENT_SHOW_ID "client_show_id"
 %token RESERVE_SESSION_SERVER_CONNECTION "reserve_session_server_connection"
 %token QUANTILES "quantiles"
+%token QUANTILES_WINDOW "quantiles_window"
 %token APPLICATION_NAME_ADD_HOST "application_name_add_host"
 %token SERVER_DROP_ON_CACHED_PLAN_ERROR "server_drop_on_cached_plan_error"
 %token SERVER_LIFETIME "server_lifetime"
@@ -290,6 +302,7 @@
 %token POOL_CANCEL "pool_cancel"
 %token POOL_ROLLBACK "pool_rollback"
 %token POOL_RESET_TIMEOUT_MS "pool_reset_timeout_ms"
+%token POOL_RESET_ASYNC "pool_reset_async"
 %token POOL_RESERVE_PREPARED_STATEMENT "pool_reserve_prepared_statement"
 %token POOL_PIN_ON_LISTEN "pool_pin_on_listen"
 %token POOL_ATTACH_CHECK "pool_attach_check"
@@ -411,6 +424,23 @@ top_item:
 							@1,
 							"bindwith_reuseport");
 		}
+	| LISTEN_PER_WORKER bool_value
+		{
+			od_cfg_set_bool(ctx->diags,
+							&ctx->model->global.listen_per_worker,
+							$2,
+							@1,
+							"listen_per_worker");
+		}
+	| WORKER_PLACEMENT string_value
+		{
+			od_cfg_set_string(ctx->diags,
+							  &ctx->model->global.worker_placement,
+							  $2,
+							  @1,
+							  "worker_placement");
+			$2 = NULL;
+		}
 	| ENABLE_HOST_WATCHER bool_value
 		{
 			od_cfg_set_bool(ctx->diags,
@@ -491,6 +521,22 @@ top_item:
 							@1,
 							"smart_search_path_enquoting");
 		}
+	| PIPELINE_DEPLOY bool_value
+		{
+			od_cfg_set_bool(ctx->diags,
+							&ctx->model->global.pipeline_deploy,
+							$2,
+							@1,
+							"pipeline_deploy");
+		}
+	| TIMER_WHEEL bool_value
+		{
+			od_cfg_set_bool(ctx->diags,
+							&ctx->model->global.timer_wheel,
+							$2,
+							@1,
+							"timer_wheel");
+		}
 	| NODELAY bool_value
 		{
 			od_cfg_set_bool(ctx->diags,
@@ -695,6 +741,16 @@ top_item:
 							@1,
 							"readahead");
 		}
+	| READAHEAD_RELEASE_TIMEOUT_MS int_value
+		{
+			od_cfg_set_int_range_from_i64(ctx->diags,
+							&ctx->model->global.readahead_release_timeout_ms,
+							$2,
+							0,
+							INT_MAX,
+							@1,
+							"readahead_release_timeout_ms");
+		}
 	| KEEPALIVE int_value
 		{
 			od_cfg_set_int_from_i64(ctx->diags,
@@ -767,6 +823,46 @@ top_item:
 							@1,
 							"cancel_max_inflight");
 		}
+	| SCRAM_CACHE_SIZE int_value
+		{
+			od_cfg_set_int_range_from_i64(ctx->diags,
+							&ctx->model->global.scram_cache_size,
+							$2,
+							0,
+							INT_MAX,
+							@1,
+							"scram_cache_size");
+		}
+	| SCRAM_CACHE_TTL int_value
+		{
+			od_cfg_set_int_range_from_i64(ctx->diags,
+							&ctx->model->global.scram_cache_ttl,
+							$2,
+							0,
+							INT_MAX,
+							@1,
+							"scram_cache_ttl");
+		}
+	| TLS_TICKET_KEY_ROTATION_INTERVAL int_value
+		{
+			od_cfg_set_int_range_from_i64(ctx->diags,
+							&ctx->model->global.tls_ticket_key_rotation_interval,
+							$2,
+							0,
+							INT_MAX,
+							@1,
+							"tls_ticket_key_rotation_interval");
+		}
+	| SCRAM_DERIVE_WORKERS int_value
+		{
+			od_cfg_set_int_range_from_i64(ctx->diags,
+							&ctx->model->global.scram_derive_workers,
+							$2,
+							0,
+							INT_MAX,
+							@1,
+							"scram_derive_workers");
+		}
 	| RESOLVERS int_value
 		{
 			od_cfg_set_int_range_from_i64(ctx->diags,
@@ -1307,6 +1403,17 @@ route_item:
 							  "quantiles");
 			$2 = NULL;
 		}
+	| QUANTILES_WINDOW int_value
+		{
+			od_cfg_route_t *ur = ctx->current_user;
+			od_cfg_set_int_range_from_i64(ctx->diags,
+										  &ur->quantiles_window,
+										  $2,
+										  1,
+										  1024,
+										  @1,
+										  "quantiles_window");
+		}
 	| APPLICATION_NAME_ADD_HOST bool_value
 		{
 			od_cfg_route_t *ur = ctx->current_user;
@@ -1502,6 +1609,15 @@ route_item:
 							   "pool_reset_timeout_ms");
 			}
 		}
+	| POOL_RESET_ASYNC bool_value
+		{
+			od_cfg_route_t *ur = ctx->current_user;
+			od_cfg_set_bool(ctx->diags,
+							&ur->pool_reset_async,
+							$2,
+							@1,
+							"pool_reset_async");
+		}
 	| POOL_RESERVE_PREPARED_STATEMENT bool_value
 		{
 			od_cfg_route_t *ur = ctx->current_user;
@@ -2149,6 +2265,23 @@ storage_item:
 				@1,
 				"endpoints_status_poll_interval");
 		}
+	| COMPRESSION bool_value
+		{
+			od_cfg_set_bool(ctx->diags,
+							&ctx->current_storage->compression,
+							$2,
+							@1,
+							"compression");
+		}
+	| COMPRESSION_LEVEL int_value
+		{
+			od_cfg_set_int_range_from_i64(ctx->diags,
+									&ctx->current_storage->compression_level,
+									$2,
+									0, 22,
+									@1,
+									"compression_level");
+		}
 	| WATCHDOG
 		{
 			od_cfg_storage_t *s = ctx->current_storage;
@@ -2396,9 +2529,29 @@ listen_item:
 		}
 	| COMPRESSION bool_value
 		{
-			od_cfg_diag_deprecated_ignored(ctx->diags,
-										@1,
-										"compression");
+			od_cfg_set_bool(ctx->diags,
+							&ctx->current_listen->compression,
+							$2,
+							@1,
+							"compression");
+		}
+	| COMPRESSION_LEVEL int_value
+		{
+			od_cfg_set_int_range_from_i64(ctx->diags,
+								&ctx->current_listen->compression_level,
+								$2,
+								0, 22,
+								@1,
+								"compression_level");
+		}
+	| COMPRESSION_BUFFER_SIZE int_value
+		{
+			od_cfg_set_int_range_from_i64(ctx->diags,
+								&ctx->current_listen->compression_buffer_size,
+								$2,
+								0, 1048576,
+								@1,
+								"compression_buffer_size");
 		}
 	| STORAGE string_value
 		{
@@ -23,6 +23,7 @@ void od_client_init(od_client_t *client)
 	client->tls = NULL;
 	client->rule = NULL;
 	client->config_listen = NULL;
+	client->listener = NULL;
 	client->server = NULL;
 	client->route = NULL;
 	client->global = NULL;
@@ -81,6 +82,7 @@ void od_client_free(od_client_t *client)
 	od_relay_destroy(&client->relay);
 
 	od_io_free(&client->io);
+	kiwi_vars_free(&client->vars);
 	/* clear password if saved any */
 	kiwi_password_free(&client->password);
 	kiwi_password_free(&client->received_password);
@@ -8,16 +8,21 @@
 #include <odyssey.h>
 
 #include <machinarium/machinarium.h>
+#include <machinarium/compression.h>
+#include <machinarium/zpq_stream.h>
 
 #include <types.h>
 #include <client.h>
+#include <server.h>
+#include <storage.h>
 #include <config.h>
+#include <compression.h>
 
 int od_compression_frontend_setup(od_client_t *client,
 				  od_config_listen_t *config,
 				  od_logger_t *logger)
 {
-	kiwi_var_t *compression_var =
+	kiwi_vars_entry_t *compression_var =
 		kiwi_vars_get(&client->vars, KIWI_VAR_COMPRESSION);
 
 	if (compression_var == NULL) {
@@ -56,7 +61,9 @@ int od_compression_frontend_setup(od_client_t *client,
 	}
 
 	/* initialize compression */
-	rc = mm_io_set_compression(client->io.io, compression_algorithm);
+	rc = mm_io_set_compression(
+		client->io.io, compression_algorithm, config->compression_level,
+		(size_t)config->compression_buffer_size, NULL, 0);
 	if (rc == -1) {
 		od_debug(logger, "compression", client, NULL,
 			 "failed to initialize compression w/ algorithm %c",
@@ -66,3 +73,92 @@ int od_compression_frontend_setup(od_client_t *client,
 
 	return 0;
 }
+
+/*
+ * Backend compression is negotiated the same way as the frontend one:
+ * the list of algorithms is sent as the compression startup parameter
+ * and the server answers with CompressionAck before authentication.
+ *
+ * PostgreSQL itself does not implement it, so the server must be
+ * another Odyssey with compression enabled on its listen endpoint,
+ * running next to PostgreSQL.
+ */
+void od_compression_backend_algorithms(od_rule_storage_t *storage,
+				       char *algorithms)
+{
+	algorithms[0] = '\0';
+	if (storage->compression) {
+		mm_zpq_get_supported_algorithms(algorithms);
+	}
+}
+
+int od_compression_backend_setup(od_server_t *server,
+				 od_rule_storage_t *storage,
+				 machine_msg_t *msg, od_logger_t *logger)
+{
+	if (machine_msg_size(msg) != sizeof(kiwi_header_t) + sizeof(char)) {
+		od_error(logger, "compression", NULL, server,
+			 "malformed CompressionAck message");
+		return -1;
+	}
+
+	char compression_algorithm =
+		((char *)machine_msg_data(msg))[sizeof(kiwi_header_t)];
+
+	if (compression_algorithm == MM_ZPQ_NO_COMPRESSION) {
+		od_debug(logger, "compression", NULL, server,
+			 "server declined compression");
+		return 0;
+	}
+
+	/*
+	 * server starts to compress right after the ack, so bytes already
+	 * read ahead are compressed and must be fed to the stream first
+	 */
+	struct iovec rx = od_readahead_read_begin(&server->io.readahead);
+
+	int rc = mm_io_set_compression(server->io.io, compression_algorithm,
+				       storage->compression_level, 0,
+				       rx.iov_base, rx.iov_len);
+	if (rc == -1) {
+		od_error(logger, "compression", NULL, server,
+			 "failed to initialize compression w/ algorithm %c",
+			 compression_algorithm);
+		return -1;
+	}
+	od_readahead_read_commit(&server->io.readahead, rx.iov_len);
+
+	memset(&server->compression_reported, 0,
+	       sizeof(server->compression_reported));
+
+	od_debug(logger, "compression", NULL, server,
+		 "compression enabled w/ algorithm %c", compression_algorithm);
+	return 0;
+}
+
+/* add bytes passed since the last call to the storage counters */
+void od_compression_backend_account(od_server_t *server)
+{
+	if (server->io.io == NULL || server->endpoint == NULL) {
+		return;
+	}
+
+	mm_zpq_stats_t stats;
+	if (mm_compression_stats(server->io.io, &stats) == -1) {
+		return;
+	}
+
+	od_rule_storage_t *storage = server->endpoint->storage;
+	mm_zpq_stats_t *reported = &server->compression_reported;
+
+	od_atomic_u64_add(&storage->compression_tx_raw,
+			  stats.tx_raw - reported->tx_raw);
+	od_atomic_u64_add(&storage->compression_tx,
+			  stats.tx_compressed - reported->tx_compressed);
+	od_atomic_u64_add(&storage->compression_rx_raw,
+			  stats.rx_raw - reported->rx_raw);
+	od_atomic_u64_add(&storage->compression_rx,
+			  stats.rx_compressed - reported->rx_compressed);
+
+	*reported = stats;
+}
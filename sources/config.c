@@ -45,6 +45,8 @@ void od_config_init(od_config_t *config)
 	config->conn_drop_options.rate = 1;
 	config->conn_drop_options.interval_ms = 1000; /* 1 sec */
 	config->bindwith_reuseport = 1;
+	config->listen_per_worker = 0;
+	config->worker_placement = OD_CONFIG_WORKER_PLACEMENT_ROUND_ROBIN;
 	config->graceful_die_on_errors = 0;
 	config->unix_socket_mode = NULL;
 
@@ -55,6 +57,7 @@ void od_config_init(od_config_t *config)
 	config->log_syslog_facility = NULL;
 
 	config->readahead = sysconf(_SC_PAGESIZE);
+	config->readahead_release_timeout_ms = 0;
 	config->nodelay = 1;
 	config->disable_nolinger = 0;
 
@@ -85,6 +88,10 @@ void od_config_init(od_config_t *config)
 	config->cancel_timeout_ms = 1U * 1000U; /* 1 seconds */
 	config->cancel_queue_timeout_ms = -1;
 	config->cancel_max_inflight = -1;
+	config->scram_cache_size = 1024;
+	config->scram_cache_ttl = 3600; /* 1 hour */
+	config->scram_derive_workers = 0;
+	config->tls_ticket_key_rotation_interval = 3600; /* 1 hour */
 	config->virtual_processing = 0;
 
 	config->graceful_shutdown_timeout_ms = 30 * 1000; /* 30 seconds */
@@ -105,7 +112,10 @@ void od_config_init(od_config_t *config)
 
 	config->smart_search_path_enquoting = 0;
 
+	config->pipeline_deploy = 0;
+
 	config->dns_ttl_ms = 30 * 1000;
+	config->timer_wheel = 0;
 }
 
 void od_config_reload(od_config_t *current_config, od_config_t *new_config)
@@ -124,9 +134,15 @@ void od_config_reload(od_config_t *current_config, od_config_t *new_config)
 	current_config->backend_connect_timeout_ms =
 		new_config->backend_connect_timeout_ms;
 	current_config->cancel_timeout_ms = new_config->cancel_timeout_ms;
+	current_config->scram_cache_size = new_config->scram_cache_size;
+	current_config->scram_cache_ttl = new_config->scram_cache_ttl;
 	current_config->smart_search_path_enquoting =
 		new_config->smart_search_path_enquoting;
+	current_config->pipeline_deploy = new_config->pipeline_deploy;
+	current_config->worker_placement = new_config->worker_placement;
 	current_config->disable_nolinger = new_config->disable_nolinger;
+	current_config->readahead_release_timeout_ms =
+		new_config->readahead_release_timeout_ms;
 	current_config->keepalive = new_config->keepalive;
 	current_config->keepalive_keep_interval =
 		new_config->keepalive_keep_interval;
@@ -329,6 +345,12 @@ int od_config_validate(od_config_t *config, od_logger_t *logger)
 		return NOT_OK_RESPONSE;
 	}
 
+	if (config->listen_per_worker && !config->bindwith_reuseport) {
+		od_error(logger, "config", NULL, NULL,
+			 "listen_per_worker requires bindwith_reuseport");
+		return NOT_OK_RESPONSE;
+	}
+
 	return OK_RESPONSE;
 }
 
@@ -337,6 +359,20 @@ static inline char *od_config_yes_no(int value)
 	return value ? "yes" : "no";
 }
 
+static inline const char *
+od_config_worker_placement_to_str(od_config_worker_placement_t placement)
+{
+	switch (placement) {
+	case OD_CONFIG_WORKER_PLACEMENT_ROUND_ROBIN:
+		return "round_robin";
+	case OD_CONFIG_WORKER_PLACEMENT_LEAST_LOADED:
+		return "least_loaded";
+	case OD_CONFIG_WORKER_PLACEMENT_P2C:
+		return "p2c";
+	}
+	return "unknown";
+}
+
 void od_config_print(od_config_t *config, od_logger_t *logger)
 {
 	od_log(logger, "config", NULL, NULL, "daemonize               %s",
@@ -396,6 +432,9 @@ void od_config_print(od_config_t *config, od_logger_t *logger)
 	       config->stats_interval);
 	od_log(logger, "config", NULL, NULL, "readahead               %d",
 	       config->readahead);
+	od_log(logger, "config", NULL, NULL,
+	       "readahead_release_timeout_ms %d",
+	       config->readahead_release_timeout_ms);
 	od_log(logger, "config", NULL, NULL, "nodelay                 %s",
 	       od_config_yes_no(config->nodelay));
 	od_log(logger, "config", NULL, NULL, "disable_nolinger        %s",
@@ -436,8 +475,19 @@ void od_config_print(od_config_t *config, od_logger_t *logger)
 	       config->cancel_queue_timeout_ms);
 	od_log(logger, "config", NULL, NULL, "cancel_max_inflight       %d",
 	       config->cancel_max_inflight);
+	od_log(logger, "config", NULL, NULL, "scram_cache_size        %d",
+	       config->scram_cache_size);
+	od_log(logger, "config", NULL, NULL, "scram_cache_ttl         %d",
+	       config->scram_cache_ttl);
+	od_log(logger, "config", NULL, NULL, "scram_derive_workers    %d",
+	       config->scram_derive_workers);
+	od_log(logger, "config", NULL, NULL,
+	       "tls_ticket_key_rotation_interval %d",
+	       config->tls_ticket_key_rotation_interval);
 	od_log(logger, "config", NULL, NULL, "dns_ttl_ms              %d",
 	       config->dns_ttl_ms);
+	od_log(logger, "config", NULL, NULL, "timer_wheel             %s",
+	       od_config_yes_no(config->timer_wheel));
 	od_log(logger, "config", NULL, NULL, "group_checker_interval  %d",
 	       config->group_checker_interval);
 	od_log(logger, "config", NULL, NULL, "max_sigterms_to_die     %d",
@@ -448,6 +498,8 @@ void od_config_print(od_config_t *config, od_logger_t *logger)
 	       od_config_yes_no(config->virtual_transaction));
 	od_log(logger, "config", NULL, NULL, "smart_search_path_enquoting %s",
 	       od_config_yes_no(config->smart_search_path_enquoting));
+	od_log(logger, "config", NULL, NULL, "pipeline_deploy         %s",
+	       od_config_yes_no(config->pipeline_deploy));
 	if (config->availability_zone[0]) {
 		od_log(logger, "config", NULL, NULL,
 		       "availability_zone       %s", config->availability_zone);
@@ -463,6 +515,10 @@ void od_config_print(od_config_t *config, od_logger_t *logger)
 
 	od_log(logger, "config", NULL, NULL, "bindwith_reuseport:     %d",
 	       config->bindwith_reuseport);
+	od_log(logger, "config", NULL, NULL, "listen_per_worker       %s",
+	       od_config_yes_no(config->listen_per_worker));
+	od_log(logger, "config", NULL, NULL, "worker_placement        %s",
+	       od_config_worker_placement_to_str(config->worker_placement));
 
 	if (config->hba_file) {
 		od_log(logger, "config", NULL, NULL,
@@ -518,6 +574,20 @@ void od_config_print(od_config_t *config, od_logger_t *logger)
 			od_log(logger, "config", NULL, NULL,
 			       "  catchup_timeout %d", listen->catchup_timeout);
 		}
+		if (listen->compression) {
+			od_log(logger, "config", NULL, NULL,
+			       "  compression yes");
+		}
+		if (listen->compression_level) {
+			od_log(logger, "config", NULL, NULL,
+			       "  compression_level %d",
+			       listen->compression_level);
+		}
+		if (listen->compression_buffer_size) {
+			od_log(logger, "config", NULL, NULL,
+			       "  compression_buffer_size %d",
+			       listen->compression_buffer_size);
+		}
 		if (listen->tls_opts->tls) {
 			od_log(logger, "config", NULL, NULL,
 			       "  tls           %s", listen->tls_opts->tls);
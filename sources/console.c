@@ -28,6 +28,7 @@
 #include <frontend.h>
 #include <extension.h>
 #include <cron.h>
+#include <worker_pool.h>
 
 typedef enum {
 	OD_LKILL_CLIENT,
@@ -61,6 +62,7 @@ typedef enum {
 	OD_LIS_PAUSED,
 	OD_LHOST_UTILIZATION,
 	OD_LRULES,
+	OD_LWORKERS,
 } od_console_keywords_t;
 
 static od_keyword_t od_console_keywords[] = {
@@ -95,12 +97,14 @@ static od_keyword_t od_console_keywords[] = {
 	od_keyword("is_paused", OD_LIS_PAUSED),
 	od_keyword("host_utilization", OD_LHOST_UTILIZATION),
 	od_keyword("rules", OD_LRULES),
+	od_keyword("workers", OD_LWORKERS),
 	{ 0, 0, 0 }
 };
 
 static inline int od_console_show_stats_add(machine_msg_t *stream,
 					    char *database, int database_len,
-					    od_stat_t *total, od_stat_t *avg)
+					    od_stat_t *total, od_stat_t *avg,
+					    uint64_t readahead_resident)
 {
 	od_assert(stream);
 	int offset;
@@ -138,7 +142,8 @@ static inline int od_console_show_stats_add(machine_msg_t *stream,
 
 		total->count_parse, /* count of backend parse msgs */
 		total->count_parse_reuse, /* count of backend parse msgs reuse */
-		total->count_cancel /* total_cancel_count */
+		total->count_cancel, /* total_cancel_count */
+		readahead_resident /* readahead_resident */
 	};
 
 	for (size_t i = 0; i < sizeof(stats) / sizeof(stats[0]); i++) {
@@ -236,13 +241,72 @@ od_console_show_router_stats_err_add(machine_msg_t *stream,
 	return OK_RESPONSE;
 }
 
+static int od_console_readahead_resident_client_cb(od_client_t *client,
+						   void **argv)
+{
+	uint64_t *resident = argv[0];
+	*resident += od_readahead_resident(&client->io.readahead);
+	return 0;
+}
+
+static int od_console_readahead_resident_server_cb(od_server_t *server,
+						   void **argv)
+{
+	uint64_t *resident = argv[0];
+	*resident += od_readahead_resident(&server->io.readahead);
+	return 0;
+}
+
+/* readahead buffers held by clients and servers of the database */
+static uint64_t od_console_readahead_resident(od_router_t *router,
+					      char *database, int database_len)
+{
+	uint64_t resident = 0;
+	void *argv[] = { &resident };
+
+	od_list_t *i;
+	od_list_foreach (&router->route_pool.list, i) {
+		od_route_t *route;
+		route = od_container_of(i, od_route_t, link);
+		if (route->id.database_len != database_len + 1) {
+			continue;
+		}
+		if (memcmp(route->id.database, database, database_len) != 0) {
+			continue;
+		}
+
+		od_route_lock(route);
+		od_client_pool_foreach(&route->client_pool, OD_CLIENT_ACTIVE,
+				       od_console_readahead_resident_client_cb,
+				       argv);
+		od_client_pool_foreach(&route->client_pool, OD_CLIENT_PENDING,
+				       od_console_readahead_resident_client_cb,
+				       argv);
+		od_client_pool_foreach(&route->client_pool, OD_CLIENT_QUEUE,
+				       od_console_readahead_resident_client_cb,
+				       argv);
+		od_route_server_pool_foreach_locked(
+			route, OD_SERVER_ACTIVE,
+			od_console_readahead_resident_server_cb, argv);
+		od_route_server_pool_foreach_locked(
+			route, OD_SERVER_IDLE,
+			od_console_readahead_resident_server_cb, argv);
+		od_route_unlock(route);
+	}
+
+	return resident;
+}
+
 static int od_console_show_stats_cb(char *database, int database_len,
 				    od_stat_t *total, od_stat_t *avg,
 				    void **argv)
 {
 	machine_msg_t *stream = argv[0];
+	od_router_t *router = argv[1];
+	uint64_t readahead_resident =
+		od_console_readahead_resident(router, database, database_len);
 	return od_console_show_stats_add(stream, database, database_len, total,
-					 avg);
+					 avg, readahead_resident);
 }
 
 static int od_console_show_err_frontend_stats_cb(od_route_pool_t *pool,
@@ -267,7 +331,7 @@ static inline int od_console_show_help(machine_msg_t *stream)
 		"\n"
 		"Console usage\n"
 		"\tSHOW STATS|HELP|POOLS|POOLS_EXTENDED|DATABASES|SERVER_PREP_STMTS|SERVERS|CLIENTS|HOST_UTILIZATION\n"
-		"\tSHOW LISTS|ERRORS|ERRORS_PER_ROUTE|VERSION|LISTEN|STORAGES\n"
+		"\tSHOW LISTS|ERRORS|ERRORS_PER_ROUTE|VERSION|LISTEN|STORAGES|WORKERS\n"
 		"\tKILL_CLIENT <client_id>\n"
 		"\tRELOAD\n"
 		"\tSET key=arg\n"
@@ -287,7 +351,7 @@ static inline int od_console_show_stats(od_client_t *client,
 	od_cron_t *cron = client->global->cron;
 
 	if (kiwi_be_write_row_descriptionf(
-		    stream, "slllllllllllllllllll", "database",
+		    stream, "sllllllllllllllllllll", "database",
 		    "total_xact_count", "total_query_count",
 		    "total_server_assignment_count", "total_received",
 		    "total_sent", "total_xact_time", "total_query_time",
@@ -295,11 +359,11 @@ static inline int od_console_show_stats(od_client_t *client,
 		    "avg_server_assignment_count", "avg_recv", "avg_sent",
 		    "avg_xact_time", "avg_query_time", "avg_wait_time",
 		    "total_parse_count", "total_parse_count_reuse",
-		    "total_cancel_count") == NULL) {
+		    "total_cancel_count", "readahead_resident") == NULL) {
 		return NOT_OK_RESPONSE;
 	}
 
-	void *argv[] = { stream };
+	void *argv[] = { stream, router };
 	od_route_pool_stat_database(&router->route_pool,
 				    od_console_show_stats_cb,
 				    cron->stat_time_us, argv);
@@ -742,16 +806,20 @@ static inline int od_console_show_pools_add_cb(od_route_t *route, void **argv)
 	}
 
 	if (*extended) {
+		od_stat_t stats;
+		od_stat_init(&stats);
+		od_stat_copy(&stats, &route->stats);
+
 		/* bytes received */
 		data_len = od_snprintf(data, sizeof(data), "%" PRIu64,
-				       route->stats.recv_client);
+				       stats.recv_client);
 		rc = kiwi_be_write_data_row_add(stream, offset, data, data_len);
 		if (rc == NOT_OK_RESPONSE) {
 			goto error;
 		}
 		/* bytes sent */
 		data_len = od_snprintf(data, sizeof(data), "%" PRIu64,
-				       route->stats.recv_server);
+				       stats.recv_server);
 		rc = kiwi_be_write_data_row_add(stream, offset, data, data_len);
 		if (rc == NOT_OK_RESPONSE) {
 			goto error;
@@ -769,14 +837,9 @@ static inline int od_console_show_pools_add_cb(od_route_t *route, void **argv)
 		queries_hgram = td_new(QUANTILES_COMPRESSION);
 		freeze_hgram = td_new(QUANTILES_COMPRESSION);
 		if (route->stats.enable_quantiles) {
-			for (size_t i = 0; i < QUANTILES_WINDOW; ++i) {
-				td_copy(freeze_hgram,
-					route->stats.transaction_hgram[i]);
-				td_merge(transactions_hgram, freeze_hgram);
-				td_copy(freeze_hgram,
-					route->stats.query_hgram[i]);
-				td_merge(queries_hgram, freeze_hgram);
-			}
+			od_stat_quantiles_merge(&route->stats,
+						transactions_hgram,
+						queries_hgram, freeze_hgram);
 			td_merge(common_transactions_hgram, transactions_hgram);
 			td_merge(common_queries_hgram, queries_hgram);
 		}
@@ -1226,6 +1289,20 @@ static inline int od_console_show_servers_server_cb(od_server_t *server,
 	if (rc == NOT_OK_RESPONSE) {
 		return NOT_OK_RESPONSE;
 	}
+	/* affinity_hits */
+	data_len = od_snprintf(data, sizeof(data), "%" PRIu64,
+			       server->affinity_hits);
+	rc = kiwi_be_write_data_row_add(msg, offset, data, data_len);
+	if (rc == NOT_OK_RESPONSE) {
+		return NOT_OK_RESPONSE;
+	}
+	/* affinity_migrations */
+	data_len = od_snprintf(data, sizeof(data), "%" PRIu64,
+			       server->affinity_migrations);
+	rc = kiwi_be_write_data_row_add(msg, offset, data, data_len);
+	if (rc == NOT_OK_RESPONSE) {
+		return NOT_OK_RESPONSE;
+	}
 	return 0;
 }
 
@@ -1279,8 +1356,8 @@ static inline int od_console_show_fds_server_cb(od_server_t *server,
 	return 0;
 }
 
-static inline int show_server_pstmt_cb_internal(mm_hashmap_t *server_map,
-						mm_hashmap_kvp_t *kvp,
+static inline int show_server_pstmt_cb_internal(mm_oahm_t *server_map,
+						void *key, void *val,
 						void **argv)
 {
 	od_server_t *server = argv[1];
@@ -1327,8 +1404,10 @@ static inline int show_server_pstmt_cb_internal(mm_hashmap_t *server_map,
 		goto error;
 	}
 
-	const od_pstmt_t *pstmt =
-		*(const od_pstmt_t **)mm_hashmap_kvp_val_const(server_map, kvp);
+	(void)server_map;
+	(void)key;
+
+	const od_pstmt_t *pstmt = *(const od_pstmt_t **)val;
 
 	/* name */
 	rc = kiwi_be_write_data_row_add(stream, offset, pstmt->name,
@@ -1360,14 +1439,14 @@ error:
 static inline int od_console_show_server_prep_stmt_cb(od_server_t *server,
 						      void **argv)
 {
-	mm_hashmap_t *hm = server->prep_stmts;
+	mm_oahm_t *hm = server->prep_stmts;
 
 	void *eargv[2] = {
 		argv[0],
 		(void *)server,
 	};
 
-	int rc = mm_hashmap_foreach(hm, show_server_pstmt_cb_internal, eargv);
+	int rc = mm_oahm_foreach(hm, show_server_pstmt_cb_internal, eargv);
 
 	return rc;
 }
@@ -1406,10 +1485,10 @@ static inline int od_console_show_server_prep_stmts_cb(od_route_t *route,
 {
 	od_route_lock(route);
 
-	od_route_server_pool_foreach_locked(route, OD_SERVER_ACTIVE,
-					    od_console_show_server_prep_stmt_cb,
-					    argv);
-
+	/*
+	 * server pstmt map is not locked and is changed by attached
+	 * client without route lock, so only idle servers are listed
+	 */
 	od_route_server_pool_foreach_locked(route, OD_SERVER_IDLE,
 					    od_console_show_server_prep_stmt_cb,
 					    argv);
@@ -1426,10 +1505,11 @@ static inline int od_console_show_servers(od_client_t *client,
 
 	machine_msg_t *msg;
 	msg = kiwi_be_write_row_descriptionf(
-		stream, "sssssdsdssddssdss", "type", "user", "database",
+		stream, "sssssdsdssddssdssll", "type", "user", "database",
 		"state", "addr", "port", "local_addr", "local_port",
 		"connect_time", "request_time", "wait", "wait_us", "ptr",
-		"link", "remote_pid", "tls", "offline");
+		"link", "remote_pid", "tls", "offline", "affinity_hits",
+		"affinity_migrations");
 	if (msg == NULL) {
 		return NOT_OK_RESPONSE;
 	}
@@ -1605,6 +1685,76 @@ static inline int od_console_show_host_utilization(od_client_t *client,
 				      sizeof("HOST_UTILIZATION"));
 }
 
+static inline int od_console_show_workers(od_client_t *client,
+					  machine_msg_t *stream)
+{
+	od_worker_pool_t *worker_pool = client->global->worker_pool;
+
+	machine_msg_t *msg;
+	msg = kiwi_be_write_row_descriptionf(
+		stream, "dddddfl", "worker", "clients", "pending", "ready",
+		"load", "busy", "clients_processed");
+	if (msg == NULL) {
+		return NOT_OK_RESPONSE;
+	}
+
+	for (uint32_t i = 0; i < worker_pool->count; ++i) {
+		od_worker_t *worker = &worker_pool->pool[i];
+
+		int offset;
+		if (kiwi_be_write_data_row(stream, &offset) == NULL) {
+			return NOT_OK_RESPONSE;
+		}
+
+		uint32_t ready = 0;
+		machine_load_t *loop_load = atomic_load(&worker->loop_load);
+		if (loop_load != NULL) {
+			ready = machine_load_ready(loop_load);
+		}
+
+		uint64_t values[] = {
+			(uint64_t)worker->id,
+			od_atomic_u32_of(&worker->clients),
+			od_atomic_u32_of(&worker->pending),
+			ready,
+			od_worker_load(worker),
+		};
+
+		char data[64];
+		int data_len;
+		int rc;
+		for (size_t j = 0; j < sizeof(values) / sizeof(values[0]);
+		     ++j) {
+			data_len = od_snprintf(data, sizeof(data), "%" PRIu64,
+					       values[j]);
+			rc = kiwi_be_write_data_row_add(stream, offset, data,
+							data_len);
+			if (rc != OK_RESPONSE) {
+				return rc;
+			}
+		}
+
+		/* busy, percent of event loop time */
+		data_len = od_snprintf(
+			data, sizeof(data), "%.1f",
+			od_atomic_u32_of(&worker->busy_permille) / 10.0);
+		rc = kiwi_be_write_data_row_add(stream, offset, data, data_len);
+		if (rc != OK_RESPONSE) {
+			return rc;
+		}
+
+		/* clients_processed */
+		data_len = od_snprintf(data, sizeof(data), "%" PRIu64,
+				       worker->clients_processed);
+		rc = kiwi_be_write_data_row_add(stream, offset, data, data_len);
+		if (rc != OK_RESPONSE) {
+			return rc;
+		}
+	}
+
+	return kiwi_be_write_complete(stream, "SHOW", 5);
+}
+
 static inline int od_console_show_rules(machine_msg_t *stream)
 {
 	int offset;
@@ -1884,7 +2034,7 @@ static inline int od_console_show_clients(od_client_t *client,
 }
 
 static inline int od_console_show_lists_add(machine_msg_t *stream, char *list,
-					    int items)
+					    int64_t items)
 {
 	int offset;
 	machine_msg_t *msg;
@@ -1901,7 +2051,7 @@ static inline int od_console_show_lists_add(machine_msg_t *stream, char *list,
 	/* items */
 	char data[64];
 	int data_len;
-	data_len = od_snprintf(data, sizeof(data), "%d", items);
+	data_len = od_snprintf(data, sizeof(data), "%" PRId64, items);
 	rc = kiwi_be_write_data_row_add(stream, offset, data, data_len);
 	if (rc == NOT_OK_RESPONSE) {
 		return NOT_OK_RESPONSE;
@@ -1941,6 +2091,17 @@ static inline int od_console_show_lists(od_client_t *client,
 	int router_free_servers = 0;
 	int router_pools = router->route_pool.count;
 	int router_clients = od_atomic_u32_of(&router->clients);
+	uint64_t router_lock_acquired =
+		od_atomic_u64_of(&router->lock_acquired);
+	uint64_t router_lock_contended =
+		od_atomic_u64_of(&router->lock_contended);
+	uint64_t server_affinity_hits =
+		od_atomic_u64_of(&router->server_affinity_hits);
+	uint64_t server_affinity_migrations =
+		od_atomic_u64_of(&router->server_affinity_migrations);
+	od_scram_cache_t *scram_cache = &client->global->scram_cache;
+	od_scram_cache_t *server_scram_cache =
+		&client->global->server_scram_cache;
 
 	void *argv[] = { &router_used_servers, &router_free_servers };
 	od_route_pool_foreach(&router->route_pool, od_console_show_lists_cb,
@@ -2023,6 +2184,65 @@ static inline int od_console_show_lists(od_client_t *client,
 	if (rc == NOT_OK_RESPONSE) {
 		return NOT_OK_RESPONSE;
 	}
+	/* router_lock_acquired */
+	rc = od_console_show_lists_add(stream, "router_lock_acquired",
+				       (int64_t)router_lock_acquired);
+	if (rc == NOT_OK_RESPONSE) {
+		return NOT_OK_RESPONSE;
+	}
+	/* router_lock_contended */
+	rc = od_console_show_lists_add(stream, "router_lock_contended",
+				       (int64_t)router_lock_contended);
+	if (rc == NOT_OK_RESPONSE) {
+		return NOT_OK_RESPONSE;
+	}
+	/* server_affinity_hits */
+	rc = od_console_show_lists_add(stream, "server_affinity_hits",
+				       (int64_t)server_affinity_hits);
+	if (rc == NOT_OK_RESPONSE) {
+		return NOT_OK_RESPONSE;
+	}
+	/* server_affinity_migrations */
+	rc = od_console_show_lists_add(stream, "server_affinity_migrations",
+				       (int64_t)server_affinity_migrations);
+	if (rc == NOT_OK_RESPONSE) {
+		return NOT_OK_RESPONSE;
+	}
+	/* scram_cache_entries */
+	rc = od_console_show_lists_add(
+		stream, "scram_cache_entries",
+		(int64_t)od_scram_cache_count(scram_cache));
+	if (rc == NOT_OK_RESPONSE) {
+		return NOT_OK_RESPONSE;
+	}
+	/* scram_cache_hits */
+	rc = od_console_show_lists_add(
+		stream, "scram_cache_hits",
+		(int64_t)od_atomic_u64_of(&scram_cache->hits));
+	if (rc == NOT_OK_RESPONSE) {
+		return NOT_OK_RESPONSE;
+	}
+	/* scram_cache_misses */
+	rc = od_console_show_lists_add(
+		stream, "scram_cache_misses",
+		(int64_t)od_atomic_u64_of(&scram_cache->misses));
+	if (rc == NOT_OK_RESPONSE) {
+		return NOT_OK_RESPONSE;
+	}
+	/* server_scram_cache_hits */
+	rc = od_console_show_lists_add(
+		stream, "server_scram_cache_hits",
+		(int64_t)od_atomic_u64_of(&server_scram_cache->hits));
+	if (rc == NOT_OK_RESPONSE) {
+		return NOT_OK_RESPONSE;
+	}
+	/* server_scram_cache_misses */
+	rc = od_console_show_lists_add(
+		stream, "server_scram_cache_misses",
+		(int64_t)od_atomic_u64_of(&server_scram_cache->misses));
+	if (rc == NOT_OK_RESPONSE) {
+		return NOT_OK_RESPONSE;
+	}
 	return kiwi_be_write_complete(stream, "SHOW", 5);
 }
 
@@ -2085,62 +2305,116 @@ static inline int od_console_show_tls_options(od_tls_opts_t *tls_opts,
 	return OK_RESPONSE;
 }
 
-static inline int od_console_show_listen(od_client_t *client,
-					 machine_msg_t *stream)
+static inline int od_console_show_listen_server(od_system_server_t *server,
+						machine_msg_t *stream)
 {
-	od_assert(stream);
-	od_router_t *router = client->global->router;
+	char data[64];
+	int data_len;
+	int rc;
+	int offset;
 
-	machine_msg_t *msg;
-	msg = kiwi_be_write_row_descriptionf(stream, "sdsssss", "host", "port",
-					     "tls", "tls_cert_file",
-					     "tls_key_file", "tls_ca_file",
-					     "tls_protocols");
+	od_config_listen_t *listen_config = server->config;
 
+	machine_msg_t *msg = kiwi_be_write_data_row(stream, &offset);
 	if (msg == NULL) {
 		return NOT_OK_RESPONSE;
 	}
+	/* host */
 
-	od_instance_t *instance = router->global->instance;
-	od_config_t *config = &instance->config;
+	rc = od_console_write_nullable_str(stream, offset, listen_config->host);
+	if (rc != OK_RESPONSE) {
+		return rc;
+	}
 
-	char data[64];
-	int data_len;
-	int rc;
-	int offset;
+	/* port */
+	data_len = od_snprintf(data, sizeof(data), "%d", listen_config->port);
+	rc = kiwi_be_write_data_row_add(stream, offset, data, data_len);
 
-	od_list_t *i;
-	od_list_foreach (&config->listen, i) {
-		od_config_listen_t *listen_config;
-		listen_config = od_container_of(i, od_config_listen_t, link);
+	if (rc != OK_RESPONSE) {
+		return rc;
+	}
 
-		msg = kiwi_be_write_data_row(stream, &offset);
-		if (msg == NULL) {
-			return NOT_OK_RESPONSE;
-		}
-		/* host */
+	rc = od_console_show_tls_options(listen_config->tls_opts, offset,
+					 stream);
+	if (rc != OK_RESPONSE) {
+		return rc;
+	}
 
-		rc = od_console_write_nullable_str(stream, offset,
-						   listen_config->host);
-		if (rc != OK_RESPONSE) {
-			return rc;
-		}
+	/* worker, -1 for system machine accept loop */
+	int worker_id = server->worker ? server->worker->id : -1;
+	data_len = od_snprintf(data, sizeof(data), "%d", worker_id);
+	rc = kiwi_be_write_data_row_add(stream, offset, data, data_len);
+	if (rc != OK_RESPONSE) {
+		return rc;
+	}
 
-		/* port */
-		data_len = od_snprintf(data, sizeof(data), "%d",
-				       listen_config->port);
-		rc = kiwi_be_write_data_row_add(stream, offset, data, data_len);
+	/* accepted */
+	data_len = od_snprintf(data, sizeof(data), "%" PRIu64,
+			       od_atomic_u64_of(&server->accepted));
+	rc = kiwi_be_write_data_row_add(stream, offset, data, data_len);
+	if (rc != OK_RESPONSE) {
+		return rc;
+	}
 
-		if (rc != OK_RESPONSE) {
-			return rc;
-		}
+	/* accept_rate */
+	data_len = od_snprintf(data, sizeof(data), "%" PRIu64,
+			       server->accept_rate);
+	rc = kiwi_be_write_data_row_add(stream, offset, data, data_len);
+	if (rc != OK_RESPONSE) {
+		return rc;
+	}
+
+	/* tls_full */
+	data_len = od_snprintf(data, sizeof(data), "%" PRIu64,
+			       od_atomic_u64_of(&server->tls_full));
+	rc = kiwi_be_write_data_row_add(stream, offset, data, data_len);
+	if (rc != OK_RESPONSE) {
+		return rc;
+	}
+
+	/* tls_resumed */
+	data_len = od_snprintf(data, sizeof(data), "%" PRIu64,
+			       od_atomic_u64_of(&server->tls_resumed));
+	rc = kiwi_be_write_data_row_add(stream, offset, data, data_len);
+	if (rc != OK_RESPONSE) {
+		return rc;
+	}
+
+	return OK_RESPONSE;
+}
+
+static inline int od_console_show_listen(od_client_t *client,
+					 machine_msg_t *stream)
+{
+	od_assert(stream);
+	od_router_t *router = client->global->router;
 
-		rc = od_console_show_tls_options(listen_config->tls_opts,
-						 offset, stream);
+	machine_msg_t *msg;
+	msg = kiwi_be_write_row_descriptionf(
+		stream, "sdsssssdllll", "host", "port", "tls", "tls_cert_file",
+		"tls_key_file", "tls_ca_file", "tls_protocols", "worker",
+		"accepted", "accept_rate", "tls_full", "tls_resumed");
+
+	if (msg == NULL) {
+		return NOT_OK_RESPONSE;
+	}
+
+	/* one row per listen socket: per worker with listen_per_worker */
+	int rc = OK_RESPONSE;
+	od_router_lock(router);
+	od_list_t *i;
+	od_list_foreach (&router->servers, i) {
+		od_system_server_t *server;
+		server = od_container_of(i, od_system_server_t, link);
+		rc = od_console_show_listen_server(server, stream);
 		if (rc != OK_RESPONSE) {
-			return rc;
+			break;
 		}
 	}
+	od_router_unlock(router);
+	if (rc != OK_RESPONSE) {
+		return rc;
+	}
 
 	return kiwi_be_write_complete(stream, "SHOW", 5);
 }
@@ -2152,10 +2426,12 @@ static inline int od_console_show_storages(od_client_t *client,
 	od_router_t *router = client->global->router;
 
 	machine_msg_t *msg;
-	msg = kiwi_be_write_row_descriptionf(stream, "ssdsssss", "type", "host",
-					     "port", "tls", "tls_cert_file",
-					     "tls_key_file", "tls_ca_file",
-					     "tls_protocols");
+	msg = kiwi_be_write_row_descriptionf(
+		stream, "ssdssssssllllll", "type", "host", "port", "tls",
+		"tls_cert_file", "tls_key_file", "tls_ca_file", "tls_protocols",
+		"compression", "compression_tx_raw", "compression_tx",
+		"compression_rx_raw", "compression_rx", "tls_session_hits",
+		"tls_session_misses");
 
 	if (msg == NULL) {
 		return NOT_OK_RESPONSE;
@@ -2219,6 +2495,38 @@ static inline int od_console_show_storages(od_client_t *client,
 		if (rc != OK_RESPONSE) {
 			goto error;
 		}
+
+		/* compression */
+		char *compression = storage->compression ? "yes" : "no";
+		rc = kiwi_be_write_data_row_add(stream, offset, compression,
+						strlen(compression));
+		if (rc == NOT_OK_RESPONSE) {
+			goto error;
+		}
+
+		uint64_t tls_session_hits = 0;
+		uint64_t tls_session_misses = 0;
+		machine_tls_session_cache_stats(
+			storage->tls_opts->session_cache, &tls_session_hits,
+			&tls_session_misses);
+
+		uint64_t stats[] = {
+			od_atomic_u64_of(&storage->compression_tx_raw),
+			od_atomic_u64_of(&storage->compression_tx),
+			od_atomic_u64_of(&storage->compression_rx_raw),
+			od_atomic_u64_of(&storage->compression_rx),
+			tls_session_hits,
+			tls_session_misses,
+		};
+		for (size_t j = 0; j < sizeof(stats) / sizeof(stats[0]); j++) {
+			data_len = od_snprintf(data, sizeof(data), "%" PRIu64,
+					       stats[j]);
+			rc = kiwi_be_write_data_row_add(stream, offset, data,
+							data_len);
+			if (rc == NOT_OK_RESPONSE) {
+				goto error;
+			}
+		}
 	}
 
 	od_rules_unlock(rules);
@@ -2288,6 +2596,8 @@ static inline int od_console_show(od_client_t *client, machine_msg_t *stream,
 		return od_console_show_host_utilization(client, stream);
 	case OD_LRULES:
 		return od_console_show_rules(stream);
+	case OD_LWORKERS:
+		return od_console_show_workers(client, stream);
 	}
 	return NOT_OK_RESPONSE;
 }
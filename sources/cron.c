@@ -18,6 +18,7 @@
 #include <backend.h>
 #include <worker_pool.h>
 #include <router.h>
+#include <system.h>
 #include <util.h>
 
 static int od_cron_stat_cb(od_route_t *route, od_stat_t *current,
@@ -128,6 +129,29 @@ static inline void request_worker_stats(od_worker_pool_t *worker_pool)
 	}
 }
 
+static inline void od_cron_accept_rate(od_cron_t *cron)
+{
+	od_router_t *router = cron->global->router;
+
+	uint64_t interval_us = machine_time_us() - cron->stat_time_us;
+	if (interval_us == 0) {
+		return;
+	}
+
+	od_router_lock(router);
+	od_list_t *i;
+	od_list_foreach (&router->servers, i) {
+		od_system_server_t *server;
+		server = od_container_of(i, od_system_server_t, link);
+
+		uint64_t accepted = od_atomic_u64_of(&server->accepted);
+		server->accept_rate = (accepted - server->accepted_prev) *
+				      1000000 / interval_us;
+		server->accepted_prev = accepted;
+	}
+	od_router_unlock(router);
+}
+
 static inline void od_cron_stat(od_cron_t *cron)
 {
 	od_router_t *router = cron->global->router;
@@ -198,10 +222,38 @@ static inline void od_cron_stat(od_cron_t *cron)
 #endif
 		       stat_cb, argv);
 
+	od_cron_accept_rate(cron);
+
 	/* update current stat time mark */
 	cron->stat_time_us = machine_time_us();
 }
 
+static inline void od_cron_worker_load(od_cron_t *cron)
+{
+	od_worker_pool_t *worker_pool = cron->global->worker_pool;
+
+	uint64_t now_us = machine_time_us();
+	uint64_t interval_us = now_us - cron->load_time_us;
+	cron->load_time_us = now_us;
+	if (interval_us == 0) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < worker_pool->count; ++i) {
+		od_worker_t *worker = &worker_pool->pool[i];
+		machine_load_t *loop_load = atomic_load(&worker->loop_load);
+		if (loop_load == NULL) {
+			continue;
+		}
+
+		uint64_t busy_us = machine_load_busy_us(loop_load);
+		uint64_t busy = (busy_us - worker->busy_us_prev) * 1000 /
+				interval_us;
+		worker->busy_us_prev = busy_us;
+		worker->busy_permille = (uint32_t)od_min(busy, 1000);
+	}
+}
+
 static inline void od_cron_keep_min_pool_sizes(od_cron_t *cron)
 {
 	od_router_t *router = cron->global->router;
@@ -274,15 +326,46 @@ static void od_cron_err_stat(od_cron_t *cron)
 	od_route_pool_unlock(&router->route_pool);
 }
 
+static void od_cron_tls_ticket_keys(od_cron_t *cron)
+{
+	od_instance_t *instance = cron->global->instance;
+
+	/* keys are created on start only, see od_instance_main */
+	int interval = instance->config.tls_ticket_key_rotation_interval;
+	if (interval <= 0) {
+		return;
+	}
+
+	uint64_t now_us = machine_time_us();
+	if (now_us - cron->tls_ticket_keys_time_us <
+	    (uint64_t)interval * 1000000) {
+		return;
+	}
+	cron->tls_ticket_keys_time_us = now_us;
+
+	if (machine_tls_ticket_keys_rotate() == -1) {
+		od_error(&instance->logger, "cron", NULL, NULL,
+			 "failed to rotate tls ticket keys");
+		return;
+	}
+	od_log(&instance->logger, "cron", NULL, NULL,
+	       "tls ticket keys rotated");
+}
+
 static void od_cron(void *arg)
 {
 	od_cron_t *cron = arg;
 	od_instance_t *instance = cron->global->instance;
 
 	cron->stat_time_us = machine_time_us();
+	cron->load_time_us = machine_time_us();
+	cron->tls_ticket_keys_time_us = machine_time_us();
 
 	int stats_tick = 0;
 	for (;;) {
+		/* update workers load for clients placement */
+		od_cron_worker_load(cron);
+
 		/* mark and sweep expired idle server connections */
 		od_cron_expire(cron);
 
@@ -297,6 +380,8 @@ static void od_cron(void *arg)
 
 		od_cron_err_stat(cron);
 
+		od_cron_tls_ticket_keys(cron);
+
 		int rc = machine_wait_flag_wait(cron->online, 1000);
 		if (rc == 0) {
 			od_log(&instance->logger, "cron", NULL, NULL,
@@ -322,6 +407,8 @@ static void od_cron(void *arg)
 od_retcode_t od_cron_init(od_cron_t *cron)
 {
 	cron->stat_time_us = 0;
+	cron->load_time_us = 0;
+	cron->tls_ticket_keys_time_us = 0;
 	cron->global = NULL;
 	cron->startup_errors = 0;
 
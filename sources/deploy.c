@@ -1,4 +1,3 @@
-
 /*
  * Odyssey.
  *
@@ -16,6 +15,7 @@
 #include <route.h>
 #include <instance.h>
 #include <stream.h>
+#include <deploy.h>
 
 static inline int complete_deploy(od_instance_t *instance, od_server_t *server,
 				  char *context)
@@ -30,19 +30,30 @@ static inline int complete_deploy(od_instance_t *instance, od_server_t *server,
 	return OK_RESPONSE;
 }
 
-int od_deploy(od_client_t *client, char *context)
+static inline int deploy_is_cached(od_client_t *client, od_server_t *server)
+{
+	return server->deploy_stamp_valid &&
+	       server->deploy_client_stamp == client->vars.stamp &&
+	       server->deploy_server_stamp == server->vars.stamp;
+}
+
+/*
+ * build the query, which sets options which are differs from server
+ *
+ * *msg is left NULL if there is nothing to set
+ */
+static inline int build_deploy(od_client_t *client, char *context,
+			       machine_msg_t **msg)
 {
 	od_instance_t *instance = client->global->instance;
 	od_server_t *server = client->server;
-	od_route_t *route = client->route;
 
-	if (route->id.physical_rep || route->id.logical_rep) {
-		return 0;
-	}
+	*msg = NULL;
 
-	/* compare and set options which are differs from server */
-	int query_count;
-	query_count = 0;
+	if (deploy_is_cached(client, server)) {
+		server->synced_settings = true;
+		return OK_RESPONSE;
+	}
 
 	char query[OD_QRY_MAX_SZ];
 	int query_size;
@@ -51,35 +62,96 @@ int od_deploy(od_client_t *client, char *context)
 			      sizeof(query) - 1,
 			      instance->config.smart_search_path_enquoting);
 
-	if (query_size > 0) {
-		query[query_size] = 0;
-		query_size++;
-		machine_msg_t *msg;
-		msg = kiwi_fe_write_query(NULL, query, query_size);
-		if (msg == NULL) {
-			return -1;
+	if (query_size <= 0) {
+		if (query_size == 0) {
+			/* next attach of same pair can skip the compare */
+			server->deploy_client_stamp = client->vars.stamp;
+			server->deploy_server_stamp = server->vars.stamp;
+			server->deploy_stamp_valid = 1;
 		}
+		server->synced_settings = true;
+		return OK_RESPONSE;
+	}
 
-		int rc;
-		rc = od_write(&server->io, msg);
-		if (rc == -1) {
-			return -1;
-		}
+	query[query_size] = 0;
+	query_size++;
+	*msg = kiwi_fe_write_query(NULL, query, query_size);
+	if (*msg == NULL) {
+		return NOT_OK_RESPONSE;
+	}
+
+	server->synced_settings = false;
+
+	od_debug(&instance->logger, context, client, server, "deploy: %s",
+		 query);
+
+	return OK_RESPONSE;
+}
+
+int od_deploy(od_client_t *client, char *context)
+{
+	od_instance_t *instance = client->global->instance;
+	od_server_t *server = client->server;
+	od_route_t *route = client->route;
 
-		query_count++;
-		client->server->synced_settings = false;
+	if (route->id.physical_rep || route->id.logical_rep) {
+		return 0;
+	}
+
+	server->deploy_pending = 1;
+
+	if (instance->config.pipeline_deploy) {
+		/* will be sent together with the first client query */
+		return OK_RESPONSE;
+	}
+
+	return od_deploy_flush(client, context);
+}
+
+int od_deploy_prepare(od_client_t *client, char *context, machine_msg_t **msg)
+{
+	od_server_t *server = client->server;
 
-		od_debug(&instance->logger, context, client, server,
-			 "deploy: %s", query);
-	} else {
-		client->server->synced_settings = true;
+	*msg = NULL;
+
+	if (!server->deploy_pending) {
+		return OK_RESPONSE;
 	}
+	server->deploy_pending = 0;
 
-	if (query_count > 0) {
-		od_server_sync_request(server, query_count);
+	int rc = build_deploy(client, context, msg);
+	if (rc != OK_RESPONSE) {
+		return rc;
+	}
 
-		return complete_deploy(instance, server, context);
+	if (*msg != NULL) {
+		od_server_sync_request(server, 1);
 	}
 
 	return OK_RESPONSE;
 }
+
+int od_deploy_complete(od_client_t *client, char *context)
+{
+	od_instance_t *instance = client->global->instance;
+
+	return complete_deploy(instance, client->server, context);
+}
+
+int od_deploy_flush(od_client_t *client, char *context)
+{
+	od_server_t *server = client->server;
+
+	machine_msg_t *msg;
+	int rc = od_deploy_prepare(client, context, &msg);
+	if (rc != OK_RESPONSE || msg == NULL) {
+		return rc;
+	}
+
+	rc = od_write(&server->io, msg);
+	if (rc == -1) {
+		return NOT_OK_RESPONSE;
+	}
+
+	return od_deploy_complete(client, context);
+}
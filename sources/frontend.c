@@ -204,7 +204,7 @@ static void reject_unsupported_proto_version(od_client_t *client)
 
 static int has_unsupported_features(od_client_t *client)
 {
-	kiwi_var_t *pq_tpn = kiwi_vars_get(
+	kiwi_vars_entry_t *pq_tpn = kiwi_vars_get(
 		&client->vars, KIWI_VAR_PQ_TEST_PROTOCOL_NEGOTIATION);
 
 	return pq_tpn != NULL;
@@ -620,7 +620,7 @@ static uint32_t get_effective_catchup_timeout(od_client_t *client)
 
 	effective_timeout = (uint32_t)default_timeout;
 
-	kiwi_var_t *timeout_var =
+	kiwi_vars_entry_t *timeout_var =
 		kiwi_vars_get(&client->vars, KIWI_VAR_ODYSSEY_CATCHUP_TIMEOUT);
 
 	if (timeout_var != NULL) {
@@ -974,7 +974,7 @@ static inline od_frontend_status_t od_frontend_setup_params(od_client_t *client)
 		kiwi_var_type_t type;
 		type = kiwi_vars_find(&client->vars, kiwi_param_name(param),
 				      param->name_len);
-		kiwi_var_t *var;
+		kiwi_vars_entry_t *var;
 		var = kiwi_vars_get(&client->vars, type);
 
 		machine_msg_t *msg;
@@ -2010,6 +2010,18 @@ static od_frontend_status_t process_possible_detach(od_client_t *client)
 
 	/* should detach */
 
+	if (route->rule->pool->reset_async) {
+		od_debug(&instance->logger, "detach", client, server,
+			 "client %s%.*s detached from %s%.*s, reset in background",
+			 client->id.id_prefix,
+			 (int)sizeof(client->id.id_prefix), client->id.id,
+			 server->id.id_prefix,
+			 (int)sizeof(server->id.id_prefix), server->id.id);
+
+		od_reset_async(client);
+		return OD_OK;
+	}
+
 	/* cleanup server */
 	int rc = od_reset(server);
 	if (rc != 1) {
@@ -2072,11 +2084,40 @@ static od_frontend_status_t client_process_message(od_client_t *client,
 	return status;
 }
 
+/*
+ * empty readahead of the client, that is idle long enough, goes back
+ * to the cache and is taken again when the client sends something
+ */
+static inline void client_release_idle_readahead(od_client_t *client)
+{
+	od_instance_t *instance = client->global->instance;
+	uint64_t timeout_ms =
+		(uint64_t)instance->config.readahead_release_timeout_ms;
+	if (timeout_ms == 0) {
+		return;
+	}
+	if (od_readahead_released(&client->io.readahead)) {
+		return;
+	}
+
+	uint64_t idle_since = client->time_last_active;
+	if (idle_since < client->time_accept) {
+		idle_since = client->time_accept;
+	}
+	if (machine_time_us() - idle_since < timeout_ms * 1000) {
+		return;
+	}
+
+	od_io_release_readahead(&client->io);
+}
+
 static od_frontend_status_t client_read_header(od_client_t *client,
 					       kiwi_header_t *header)
 {
 	while (od_readahead_unread(&client->io.readahead) <
 	       (int)sizeof(kiwi_header_t)) {
+		client_release_idle_readahead(client);
+
 		int rc = od_io_read_some(&client->io, 1000);
 		if (rc != 0) {
 			int err = machine_errno();
@@ -2566,6 +2607,12 @@ static void od_frontend_on_client_disconnect(od_frontend_status_t status,
 		return;
 	}
 
+	if (route->rule->pool->reset_async) {
+		/* server is returned to pool by the reset coroutine */
+		od_reset_async(client);
+		return;
+	}
+
 	rc = od_reset(server);
 	if (rc != 1) {
 		/* close backend connection */
@@ -2795,7 +2842,7 @@ static void od_application_name_add_host(od_client_t *client)
 	char peer_name[KIWI_MAX_VAR_SIZE];
 	int app_name_len = 7;
 	char *app_name = "unknown";
-	kiwi_var_t *app_name_var =
+	kiwi_vars_entry_t *app_name_var =
 		kiwi_vars_get(&client->vars, KIWI_VAR_APPLICATION_NAME);
 	if (app_name_var != NULL) {
 		app_name_len = app_name_var->value_len;
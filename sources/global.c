@@ -35,6 +35,9 @@ int od_global_init(od_global_t *global, od_instance_t *instance,
 
 	memset(&global->host_watcher, 0, sizeof(global->host_watcher));
 
+	od_scram_cache_init(&global->scram_cache);
+	od_scram_cache_init(&global->server_scram_cache);
+
 	return 0;
 }
 
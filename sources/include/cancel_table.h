@@ -0,0 +1,51 @@
+#pragma once
+
+/*
+ * Odyssey.
+ *
+ * Scalable PostgreSQL connection pooler.
+ */
+
+#include <machinarium/sleep_lock.h>
+
+#include <kiwi/kiwi.h>
+
+#include <types.h>
+#include <list.h>
+#include <router_cancel.h>
+
+/*
+ * map of client-facing cancel keys to servers attached to that clients,
+ * so CancelRequest is routed without scanning every route
+ *
+ * table is split to stripes with own lock and own resizable
+ * buckets array, servers are linked by server->cancel_link
+ */
+
+#define OD_CANCEL_TABLE_STRIPES 64
+#define OD_CANCEL_TABLE_STRIPE_MIN_SIZE 16
+
+typedef struct {
+	mm_sleeplock_t lock;
+	od_list_t *buckets;
+	size_t size;
+	size_t count;
+} od_cancel_table_stripe_t;
+
+typedef struct {
+	od_cancel_table_stripe_t stripes[OD_CANCEL_TABLE_STRIPES];
+} od_cancel_table_t;
+
+void od_cancel_table_init(od_cancel_table_t *table);
+void od_cancel_table_free(od_cancel_table_t *table);
+
+/* uses server->key_client as a key */
+void od_cancel_table_add(od_cancel_table_t *table, od_server_t *server);
+void od_cancel_table_remove(od_cancel_table_t *table, od_server_t *server);
+
+/*
+ * find server by client key and begin cancel on it,
+ * cancel must be finished by od_server_cancel_end
+ */
+int od_cancel_table_begin(od_cancel_table_t *table, kiwi_key_t *key,
+			  od_router_cancel_t *cancel);
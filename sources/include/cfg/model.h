@@ -48,6 +48,8 @@ typedef struct od_cfg_global {
 	od_cfg_bool_field_t virtual_processing;
 	od_cfg_bool_field_t virtual_transaction;
 	od_cfg_bool_field_t bindwith_reuseport;
+	od_cfg_bool_field_t listen_per_worker;
+	od_cfg_string_field_t worker_placement;
 	od_cfg_bool_field_t enable_host_watcher;
 	od_cfg_bool_field_t log_debug;
 	od_cfg_bool_field_t log_to_stdout;
@@ -58,6 +60,8 @@ typedef struct od_cfg_global {
 	od_cfg_bool_field_t log_async;
 	od_cfg_bool_field_t log_syslog;
 	od_cfg_bool_field_t smart_search_path_enquoting;
+	od_cfg_bool_field_t pipeline_deploy;
+	od_cfg_bool_field_t timer_wheel;
 	od_cfg_bool_field_t nodelay;
 	od_cfg_bool_field_t disable_nolinger;
 	od_cfg_bool_field_t log_general_stats_prom;
@@ -84,6 +88,7 @@ typedef struct od_cfg_global {
 	od_cfg_int_field_t client_max_routing;
 	od_cfg_int_field_t server_login_retry;
 	od_cfg_int_field_t readahead;
+	od_cfg_int_field_t readahead_release_timeout_ms;
 	od_cfg_int_field_t keepalive;
 	od_cfg_int_field_t keepalive_keep_interval;
 	od_cfg_int_field_t keepalive_probes;
@@ -93,6 +98,10 @@ typedef struct od_cfg_global {
 	od_cfg_int_field_t cancel_timeout_ms;
 	od_cfg_int_field_t cancel_queue_timeout_ms;
 	od_cfg_int_field_t cancel_max_inflight;
+	od_cfg_int_field_t scram_cache_size;
+	od_cfg_int_field_t scram_cache_ttl;
+	od_cfg_int_field_t scram_derive_workers;
+	od_cfg_int_field_t tls_ticket_key_rotation_interval;
 	od_cfg_int_field_t resolvers;
 	od_cfg_int_field_t dns_cache_ttl;
 	od_cfg_int_field_t cache_msg_gc_size;
@@ -129,6 +138,10 @@ typedef struct od_cfg_listen {
 
 	od_cfg_int_field_t catchup_timeout;
 
+	od_cfg_bool_field_t compression;
+	od_cfg_int_field_t compression_level;
+	od_cfg_int_field_t compression_buffer_size;
+
 	od_cfg_listen_storage_t **storages;
 	size_t storages_count;
 	size_t storages_capacity;
@@ -175,6 +188,9 @@ typedef struct od_cfg_storage {
 	od_cfg_int_field_t server_max_routing;
 	od_cfg_int_field_t endpoints_status_poll_interval_ms;
 
+	od_cfg_bool_field_t compression;
+	od_cfg_int_field_t compression_level;
+
 	od_cfg_balancing_t balancing;
 
 	od_cfg_route_t *watchdog;
@@ -342,6 +358,7 @@ struct od_cfg_route {
 	od_cfg_bool_field_t client_show_id;
 	od_cfg_bool_field_t reserve_session_server_connection;
 	od_cfg_string_field_t quantiles;
+	od_cfg_int_field_t quantiles_window;
 	od_cfg_bool_field_t application_name_add_host;
 	od_cfg_bool_field_t server_drop_on_backend_plan_error;
 	od_cfg_u64_field_t server_lifetime;
@@ -361,6 +378,7 @@ struct od_cfg_route {
 	od_cfg_bool_field_t pool_cancel;
 	od_cfg_bool_field_t pool_rollback;
 	od_cfg_u64_field_t pool_reset_timeout_ms;
+	od_cfg_bool_field_t pool_reset_async;
 	od_cfg_bool_field_t pool_reserve_prepared_statement;
 	od_cfg_bool_field_t pool_pin_on_listen;
 	od_cfg_bool_field_t pool_attach_check;
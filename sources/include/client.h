@@ -44,6 +44,8 @@ struct od_client {
 	od_relay_t relay;
 	od_rule_t *rule;
 	od_config_listen_t *config_listen;
+	/* accept loop of the client, NULL for internal clients */
+	od_system_server_t *listener;
 
 	uint64_t time_accept;
 	uint64_t time_setup;
@@ -61,10 +63,10 @@ struct od_client {
 	char peer[OD_CLIENT_MAX_PEERLEN];
 
 	/* desc preparet statements ids */
-	mm_hashmap_t *prep_stmt_ids;
+	mm_oahm_t *prep_stmt_ids;
 
 	/* portal name -> *od_pstmt_t (extended protocol portals tracking) */
-	mm_hashmap_t *portals;
+	mm_oahm_t *portals;
 
 	/* passwd from config rule */
 	kiwi_password_t password;
@@ -11,3 +11,9 @@
 
 int od_compression_frontend_setup(od_client_t *, od_config_listen_t *,
 				  od_logger_t *);
+
+/* algorithms to request in the startup packet, empty if none */
+void od_compression_backend_algorithms(od_rule_storage_t *, char *);
+int od_compression_backend_setup(od_server_t *, od_rule_storage_t *,
+				 machine_msg_t *, od_logger_t *);
+void od_compression_backend_account(od_server_t *);
@@ -29,6 +29,9 @@ struct od_config_listen {
 
 	int client_login_timeout;
 	int compression;
+	/* zero means default of the algorithm */
+	int compression_level;
+	int compression_buffer_size;
 
 	od_list_t link;
 
@@ -71,6 +74,12 @@ typedef struct {
 	size_t mem_limit_bytes;
 } od_config_query_parsing_t;
 
+typedef enum {
+	OD_CONFIG_WORKER_PLACEMENT_ROUND_ROBIN,
+	OD_CONFIG_WORKER_PLACEMENT_LEAST_LOADED,
+	OD_CONFIG_WORKER_PLACEMENT_P2C,
+} od_config_worker_placement_t;
+
 struct od_config {
 	int daemonize;
 	int priority;
@@ -107,8 +116,12 @@ struct od_config {
 	int enable_online_restart_feature;
 	od_config_conn_drop_options_t conn_drop_options;
 	int bindwith_reuseport;
+	int listen_per_worker;
+	od_config_worker_placement_t worker_placement;
 	/*                         */
 	int readahead;
+	/* ms, 0 keeps readahead of idle clients */
+	int readahead_release_timeout_ms;
 	int nodelay;
 	int disable_nolinger;
 
@@ -132,6 +145,7 @@ struct od_config {
 	int coroutine_stack_size;
 	int system_coroutine_stack_size;
 	int dns_ttl_ms;
+	int timer_wheel;
 	char *hba_file;
 	/* Soft interval between group checks */
 	int group_checker_interval;
@@ -142,6 +156,13 @@ struct od_config {
 	int cancel_queue_timeout_ms;
 	int cancel_max_inflight;
 
+	int scram_cache_size;
+	int scram_cache_ttl;
+	int scram_derive_workers;
+
+	/* seconds, 0 disables shared keys of TLS session tickets */
+	int tls_ticket_key_rotation_interval;
+
 	int virtual_processing; /* enables some cases for full-virtual query processing */
 	int virtual_transaction;
 
@@ -157,6 +178,8 @@ struct od_config {
 
 	int smart_search_path_enquoting;
 
+	int pipeline_deploy;
+
 	od_affinity_config_t *cpu_affinity;
 };
 
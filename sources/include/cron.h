@@ -20,6 +20,8 @@
 
 struct od_cron {
 	uint64_t stat_time_us;
+	uint64_t load_time_us;
+	uint64_t tls_ticket_keys_time_us;
 	od_global_t *global;
 	od_atomic_u64_t startup_errors;
 
@@ -10,3 +10,14 @@
 #include <common_const.h>
 
 int od_deploy(od_client_t *, char *);
+
+/*
+ * pipelined deploy: take the pending deploy query, if any,
+ * so it can be written together with the client query;
+ * od_deploy_complete must be called after the write
+ */
+int od_deploy_prepare(od_client_t *, char *, machine_msg_t **);
+int od_deploy_complete(od_client_t *, char *);
+
+/* send the pending deploy query and wait for it */
+int od_deploy_flush(od_client_t *, char *);
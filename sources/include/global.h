@@ -14,6 +14,7 @@
 #include <host_watcher.h>
 #include <logger.h>
 #include <od_memory.h>
+#include <scram_cache.h>
 
 struct od_global {
 	od_instance_t *instance;
@@ -34,6 +35,9 @@ struct od_global {
 	mm_sem_t cancel_sem;
 
 	mm_sem_t routing_sem;
+
+	od_scram_cache_t scram_cache;
+	od_scram_cache_t server_scram_cache;
 };
 
 od_global_t *od_global_create(od_instance_t *instance, od_system_t *system,
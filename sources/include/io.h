@@ -49,6 +49,20 @@ static inline int od_io_prepare(od_io_t *io, mm_io_t *io_obj)
 	return 0;
 }
 
+/* readahead buf of idle connection is acquired again on read */
+static inline void od_io_release_readahead(od_io_t *io)
+{
+	od_readahead_release(&io->readahead);
+}
+
+static inline int od_io_acquire_readahead(od_io_t *io)
+{
+	if (!od_readahead_released(&io->readahead)) {
+		return 0;
+	}
+	return od_readahead_prepare(&io->readahead);
+}
+
 static inline int od_io_close(od_io_t *io)
 {
 	if (io->io == NULL) {
@@ -100,6 +114,11 @@ static inline int od_io_read(od_io_t *io, char *dest, int size,
 			break;
 		}
 
+		rc = od_io_acquire_readahead(io);
+		if (rc == -1) {
+			return -1;
+		}
+
 		for (;;) {
 			struct iovec vec =
 				od_readahead_write_begin(&io->readahead);
@@ -70,8 +70,36 @@ struct untyped_kiwi_var {
 	size_t value_len;
 };
 
+/*
+ * var set in kiwi_vars_t, name points to the static names table,
+ * common values are interned and shared by all vars, other values
+ * are owned by the vars
+ */
+typedef struct {
+	kiwi_var_type_t type;
+	char *name;
+	int name_len;
+	char *value;
+	int value_len;
+	int interned;
+	uint64_t hash;
+} kiwi_vars_entry_t;
+
+/*
+ * clients usually set a few vars of many known ones, so only set vars
+ * are stored, ordered by type
+ */
 struct kiwi_vars {
-	kiwi_var_t vars[KIWI_VAR_MAX];
+	kiwi_vars_entry_t *entries;
+	int count;
+	int allocated;
+	/* hash of all set vars, kept by kiwi_vars_set/unset */
+	uint64_t hash;
+	/*
+	 * stamp of the last change, unique over all vars, unlike the hash
+	 * equal stamps always mean the same values, 0 for no vars
+	 */
+	uint64_t stamp;
 };
 
 static inline void kiwi_var_init(kiwi_var_t *var, char *name, int name_len)
@@ -94,156 +122,35 @@ static inline int kiwi_var_set(kiwi_var_t *var, kiwi_var_type_t type,
 	return 0;
 }
 
-static inline void kiwi_var_unset(kiwi_var_t *var)
-{
-	var->type = KIWI_VAR_UNDEF;
-	var->value_len = 0;
-}
-
-static inline int kiwi_var_compare(kiwi_var_t *a, kiwi_var_t *b)
-{
-	if (a->type != b->type) {
-		return 0;
-	}
-	if (a->value_len != b->value_len) {
-		return 0;
-	}
-	return memcmp(a->value, b->value, a->value_len) == 0;
-}
-
-static inline kiwi_var_t *kiwi_vars_of(kiwi_vars_t *vars, kiwi_var_type_t type)
+static inline void kiwi_vars_init(kiwi_vars_t *vars)
 {
-	return &vars->vars[type];
+	vars->entries = NULL;
+	vars->count = 0;
+	vars->allocated = 0;
+	vars->hash = 0;
+	vars->stamp = 0;
 }
 
-static inline kiwi_var_t *kiwi_vars_get(kiwi_vars_t *vars, kiwi_var_type_t type)
-{
-	if (type == KIWI_VAR_UNDEF) {
-		return NULL;
-	}
-	if (vars->vars[type].type != KIWI_VAR_UNDEF) {
-		return &vars->vars[type];
-	}
-	return NULL;
-}
+void kiwi_vars_free(kiwi_vars_t *vars);
 
-static inline void kiwi_vars_init(kiwi_vars_t *vars)
-{
-	kiwi_var_init(&vars->vars[KIWI_VAR_CLIENT_ENCODING], "client_encoding",
-		      16);
-	kiwi_var_init(&vars->vars[KIWI_VAR_DATESTYLE], "DateStyle", 10);
-	kiwi_var_init(&vars->vars[KIWI_VAR_TIMEZONE], "TimeZone", 9);
-	kiwi_var_init(&vars->vars[KIWI_VAR_STANDARD_CONFORMING_STRINGS],
-		      "standard_conforming_strings", 28);
-	kiwi_var_init(&vars->vars[KIWI_VAR_APPLICATION_NAME],
-		      "application_name", 17);
-	kiwi_var_init(&vars->vars[KIWI_VAR_COMPRESSION], "compression", 12);
-	kiwi_var_init(&vars->vars[KIWI_VAR_SEARCH_PATH], "search_path", 12);
-	kiwi_var_init(&vars->vars[KIWI_VAR_STATEMENT_TIMEOUT],
-		      "statement_timeout", sizeof("statement_timeout"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_WORK_MEM], "work_mem",
-		      sizeof("work_mem"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_LOCK_TIMEOUT], "lock_timeout",
-		      sizeof("lock_timeout"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_LOG_STATEMENT], "log_statement",
-		      sizeof("log_statement"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_LOG_MIN_MESSAGES],
-		      "log_min_messages", sizeof("log_min_messages"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_LOG_MIN_ERROR_STATEMENT],
-		      "log_min_error_statement",
-		      sizeof("log_min_error_statement"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_LOG_MIN_DURATION_STATEMENT],
-		      "log_min_duration_statement",
-		      sizeof("log_min_duration_statement"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_IDLE_IN_TRANSACTION_SESSION_TIMEOUT],
-		      "idle_in_transaction_session_timeout",
-		      sizeof("idle_in_transaction_session_timeout"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_DEFAULT_TABLE_ACCESS_METHOD],
-		      "default_table_access_method",
-		      sizeof("default_table_access_method"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_DEFAULT_TOAST_COMPRESSION],
-		      "default_toast_compression",
-		      sizeof("default_toast_compression"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_CHECK_FUNCTION_BODIES],
-		      "check_function_bodies", sizeof("check_function_bodies"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_DEFAULT_TRANSACTION_ISOLATION],
-		      "default_transaction_isolation",
-		      sizeof("default_transaction_isolation"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_DEFAULT_TRANSACTION_READ_ONLY],
-		      "default_transaction_read_only",
-		      sizeof("default_transaction_read_only"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_DEFAULT_TRANSACTION_DEFERRABLE],
-		      "default_transaction_deferrable",
-		      sizeof("default_transaction_deferrable"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_TRANSACTION_ISOLATION],
-		      "transaction_isolation", sizeof("transaction_isolation"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_TRANSACTION_READ_ONLY],
-		      "transaction_read_only", sizeof("transaction_read_only"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_IDLE_SESSION_TIMEOUT],
-		      "idle_session_timeout", sizeof("idle_session_timeout"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_GP_SESSION_ROLE], "gp_session_role",
-		      sizeof("gp_session_role"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_IS_HOT_STANDBY], "is_hot_standby",
-		      sizeof("is_hot_standby"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_ODYSSEY_CATCHUP_TIMEOUT],
-		      "odyssey_catchup_timeout",
-		      sizeof("odyssey_catchup_timeout"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_PQ_TEST_PROTOCOL_NEGOTIATION],
-		      "_pq_.test_protocol_negotiation",
-		      sizeof("_pq_.test_protocol_negotiation"));
-	/* XXX: todo - also accept aliases */
-	kiwi_var_init(&vars->vars[KIWI_VAR_ODYSSEY_TARGET_SESSION_ATTRS],
-		      "odyssey.target_session_attrs",
-		      sizeof("odyssey.target_session_attrs"));
-	kiwi_var_init(&vars->vars[KIWI_VAR_ROLE], "role", sizeof("role"));
-	kiwi_var_init(
-		&vars->vars[KIWI_VAR_SPQRGUARD_PREVENT_DISTRIBUTED_TABLE_MODIFY],
-		"spqrguard.prevent_distributed_table_modify",
-		sizeof("spqrguard.prevent_distributed_table_modify"));
-	kiwi_var_init(
-		&vars->vars[KIWI_VAR_SPQRGUARD_PREVENT_REFERENCE_TABLE_MODIFY],
-		"spqrguard.prevent_reference_table_modify",
-		sizeof("spqrguard.prevent_reference_table_modify"));
-}
+kiwi_vars_entry_t *kiwi_vars_get(kiwi_vars_t *vars, kiwi_var_type_t type);
 
-static inline int kiwi_vars_set(kiwi_vars_t *vars, kiwi_var_type_t type,
-				const char *value, int value_len)
-{
-	return kiwi_var_set(kiwi_vars_of(vars, type), type, value, value_len);
-}
+int kiwi_vars_set(kiwi_vars_t *vars, kiwi_var_type_t type, const char *value,
+		  int value_len);
 
-static inline void kiwi_vars_unset(kiwi_vars_t *vars, kiwi_var_type_t type)
-{
-	kiwi_var_unset(kiwi_vars_of(vars, type));
-}
+void kiwi_vars_unset(kiwi_vars_t *vars, kiwi_var_type_t type);
 
-static inline kiwi_var_type_t kiwi_vars_find(kiwi_vars_t *vars, char *name,
-					     int name_len)
-{
-	kiwi_var_type_t type;
-	type = KIWI_VAR_CLIENT_ENCODING;
-	for (; type < KIWI_VAR_MAX; type++) {
-		kiwi_var_t *var = kiwi_vars_of(vars, type);
-		if (var->name_len != name_len) {
-			continue;
-		}
-		if (!strncasecmp(var->name, name, name_len)) {
-			return type;
-		}
-	}
-	return KIWI_VAR_UNDEF;
-}
+kiwi_var_type_t kiwi_vars_find(kiwi_vars_t *vars, char *name, int name_len);
 
 static inline int kiwi_vars_override(kiwi_vars_t *vars,
 				     kiwi_vars_t *override_vars)
 {
-	kiwi_var_type_t type = 0;
-	for (; type < KIWI_VAR_MAX; type++) {
-		kiwi_var_t *var = kiwi_vars_of(override_vars, type);
+	for (int i = 0; i < override_vars->count; i++) {
+		kiwi_vars_entry_t *var = &override_vars->entries[i];
 		if (!var->value_len) {
 			continue;
 		}
-		kiwi_vars_set(vars, type, var->value, var->value_len);
+		kiwi_vars_set(vars, var->type, var->value, var->value_len);
 	}
 	return 0;
 }
@@ -303,5 +210,8 @@ static inline int kiwi_enquote(char *src, char *dst, int dst_len)
 	return (int)(pos - dst);
 }
 
+/* same vars with the same values */
+int kiwi_vars_equal(kiwi_vars_t *a, kiwi_vars_t *b);
+
 int kiwi_vars_cas(kiwi_vars_t *client, kiwi_vars_t *server, char *query,
 		  int query_len, int smart_enquoting);
@@ -6,16 +6,21 @@
  * Scalable PostgreSQL connection pooler.
  */
 
-#include <machinarium/ds/queue.h>
 #include <machinarium/wait_list.h>
-#include <machinarium/spinlock.h>
 
 #include <types.h>
 #include <list.h>
 #include <pid.h>
+#include <logger_ring.h>
 
 #define OD_LOGLINE_MAXLEN 1024
 
+/* ring bytes per log_queue_depth line */
+#define OD_LOGGER_RING_LINE_SIZE 128
+
+/* wake up the logger machine every that many pending bytes */
+#define OD_LOGGER_RING_NOTIFY_SIZE 4096
+
 #define OD_LOGGER_GLOBAL NULL
 
 typedef struct od_logger od_logger_t;
@@ -33,13 +38,6 @@ typedef enum {
 	OD_LOGGER_FORMAT_JSON
 } od_logger_format_type_t;
 
-typedef struct {
-	od_logger_level_t level;
-	od_list_t link;
-	size_t len;
-	char text[OD_LOGLINE_MAXLEN];
-} od_logger_slot_t;
-
 struct od_logger {
 	od_pid_t *pid;
 	int log_debug;
@@ -57,12 +55,17 @@ struct od_logger {
 	atomic_uint_fast64_t state;
 	int64_t machine;
 
-	od_logger_slot_t *slots;
-	mm_queue_t tasks;
-
-	od_list_t free_slots;
-	size_t free_slots_count;
-	mm_spinlock_t free_slots_lock;
+	/*
+	 * rings of the threads that write to the async logger, a ring is
+	 * created on the first line of the thread and pushed to the head
+	 */
+	_Atomic(od_logger_ring_t *) rings;
+	size_t ring_size;
+	/* unique per rings list, thread local ring caches are checked by it */
+	atomic_uint_fast64_t generation;
+
+	/* the logger machine or flush on assert reads the rings */
+	atomic_int draining;
 
 	mm_wait_list_t notifier;
 
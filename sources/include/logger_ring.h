@@ -0,0 +1,89 @@
+#pragma once
+
+/*
+ * Odyssey.
+ *
+ * Scalable PostgreSQL connection pooler.
+ */
+
+/*
+ * single producer single consumer ring of log lines
+ *
+ * every thread writing to the async logger has own ring and the logger
+ * machine is the only reader, so neither side takes a lock
+ *
+ * lines are packed as variable-length records: a header and the text
+ * padded to the header size, a record never wraps, if it does not fit
+ * to the end of the buffer, the rest of the buffer is skipped by a
+ * padding record
+ *
+ * head and tail are byte offsets, which only grow
+ */
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/uio.h>
+
+#define OD_LOGGER_RING_MIN_SIZE (16 * 1024)
+#define OD_LOGGER_RING_CACHELINE 64
+
+typedef struct od_logger_ring od_logger_ring_t;
+
+typedef struct {
+	/* text length or OD_LOGGER_RING_PADDING */
+	uint32_t len;
+	uint32_t level;
+} od_logger_ring_record_t;
+
+#define OD_LOGGER_RING_PADDING UINT32_MAX
+
+struct od_logger_ring {
+	/* written by the producer only */
+	atomic_size_t tail;
+	char tail_pad[OD_LOGGER_RING_CACHELINE - sizeof(atomic_size_t)];
+
+	/* written by the consumer only */
+	atomic_size_t head;
+	char head_pad[OD_LOGGER_RING_CACHELINE - sizeof(atomic_size_t)];
+
+	size_t size;
+	size_t mask;
+	char *buf;
+
+	/* rings list of the logger, immutable after it is published */
+	od_logger_ring_t *next;
+};
+
+/* size is rounded up to the power of two */
+int od_logger_ring_init(od_logger_ring_t *ring, size_t size);
+void od_logger_ring_free(od_logger_ring_t *ring);
+
+/*
+ * producer side, returns -1 if there is no room for the line,
+ * pending is set to the bytes that were not read before the push
+ */
+int od_logger_ring_push(od_logger_ring_t *ring, int level, const char *text,
+			size_t len, size_t *pending);
+
+/*
+ * consumer side, fills up to max lines starting from the head, which
+ * stay valid until the ring is advanced by the returned bytes
+ */
+size_t od_logger_ring_peek(od_logger_ring_t *ring, struct iovec *iovecs,
+			   int *levels, size_t max, size_t *bytes);
+
+static inline void od_logger_ring_advance(od_logger_ring_t *ring,
+					  size_t bytes)
+{
+	size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	atomic_store_explicit(&ring->head, head + bytes, memory_order_release);
+}
+
+/* bytes written and not read yet, can be called by any thread */
+static inline size_t od_logger_ring_pending(od_logger_ring_t *ring)
+{
+	size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+	return tail - head;
+}
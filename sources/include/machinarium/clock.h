@@ -11,6 +11,7 @@
 #include <machinarium/ds/heap.h>
 #include <machinarium/buf.h>
 #include <machinarium/timer.h>
+#include <machinarium/timer_wheel.h>
 
 typedef struct mm_clock mm_clock_t;
 
@@ -24,16 +25,28 @@ struct mm_clock {
 
 	mm_heap_t timers;
 	int timers_seq;
+
+	/* used instead of the heap, if set */
+	mm_timer_wheel_t *wheel;
 };
 
-void mm_clock_init(mm_clock_t *);
+int mm_clock_init(mm_clock_t *, int wheel);
 void mm_clock_free(mm_clock_t *);
 void mm_clock_update(mm_clock_t *);
 void mm_clock_step(mm_clock_t *);
 int mm_clock_timer_add(mm_clock_t *, mm_timer_t *);
 int mm_clock_timer_del(mm_clock_t *, mm_timer_t *);
 
-mm_timer_t *mm_clock_timer_min(mm_clock_t *);
+/* earliest timeout of the timers, -1 if there are no timers */
+int mm_clock_timer_next(mm_clock_t *, uint64_t *timeout);
+
+static inline size_t mm_clock_timers_count(mm_clock_t *clock)
+{
+	if (clock->wheel != NULL) {
+		return clock->wheel->count;
+	}
+	return mm_heap_size(&clock->timers);
+}
 
 static inline void mm_clock_reset(mm_clock_t *clock)
 {
@@ -56,7 +69,7 @@ static inline void mm_timer_stop(mm_timer_t *timer)
 	}
 	mm_clock_t *clock = timer->clock;
 	mm_clock_timer_del(clock, timer);
-	if (mm_heap_size(&clock->timers) == 0) {
+	if (mm_clock_timers_count(clock) == 0) {
 		clock->active = 0;
 	}
 }
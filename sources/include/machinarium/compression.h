@@ -17,9 +17,12 @@ static inline int mm_compression_is_active(mm_io_t *io)
 	return io->zpq_stream != NULL;
 }
 
-int mm_compression_writev(mm_io_t *io, struct iovec *iov, int n,
+int mm_compression_writev(mm_io_t *io, const struct iovec *iov, int n,
 			  size_t *processed);
 
+/* -1 if compression is not active on io */
+int mm_compression_stats(mm_io_t *io, mm_zpq_stats_t *stats);
+
 int mm_compression_read_pending(mm_io_t *io);
 
 int mm_compression_write_pending(mm_io_t *io);
@@ -0,0 +1,99 @@
+#pragma once
+
+/*
+ * machinarium.
+ *
+ * cooperative multitasking engine.
+ */
+
+/*
+ * open addressing hashmap with inline keys and values
+ *
+ * this one is NOT thread-safe, it is for maps owned by one coroutine
+ * (like client or server prepared statements) where mm_hashmap_t locks
+ * and per-entry allocations are pure overhead
+ *
+ * slots are allocated on the first insert, table grows by doubling and
+ * entries are moved to the new table incrementally by next inserts and
+ * removes, so there is no long pause on resize
+ *
+ * pointers to keys and values are valid only till next insert or remove
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <machinarium/ds/hm.h>
+
+#define MM_OAHM_CTRL_EMPTY 0
+#define MM_OAHM_CTRL_DELETED 1
+
+typedef struct mm_oahm mm_oahm_t;
+
+typedef int (*mm_oahm_cb_fn)(mm_oahm_t *hm, void *key, void *val,
+			     void **argv);
+
+typedef struct {
+	/* MM_OAHM_CTRL_* or 7 hash bits with high bit set */
+	uint8_t *ctrl;
+	uint8_t *slots;
+	size_t capacity;
+	/* occupied and deleted slots */
+	size_t used;
+} mm_oahm_table_t;
+
+struct mm_oahm {
+	size_t keysz;
+	size_t valsz;
+
+	size_t keyoff;
+	size_t valoff;
+	size_t slotsz;
+
+	mm_hm_key_cmp_fn kcmp;
+	mm_hm_key_hash_fn khash;
+	mm_hm_key_dtor_fn kdtor;
+	mm_hm_value_dtor_fn vdtor;
+	mm_hm_key_copy_fn kcopy;
+
+	/* inserts go here */
+	mm_oahm_table_t table;
+
+	/* previous table, until all its entries are moved */
+	mm_oahm_table_t old;
+	size_t old_pos;
+	/* live entries of the old table, which are not moved yet */
+	size_t old_count;
+
+	size_t count;
+};
+
+mm_oahm_t *mm_oahm_create(size_t keysz, size_t valsz, mm_hm_key_cmp_fn kcmp,
+			  mm_hm_key_hash_fn khash, mm_hm_key_dtor_fn kdtor,
+			  mm_hm_value_dtor_fn vdtor, mm_hm_key_copy_fn kcopy);
+void mm_oahm_free(mm_oahm_t *hm);
+void mm_oahm_clear(mm_oahm_t *hm);
+int mm_oahm_foreach(mm_oahm_t *hm, mm_oahm_cb_fn cb, void **argv);
+
+/* value of the key or NULL */
+void *mm_oahm_get(mm_oahm_t *hm, const void *key);
+
+/*
+ * value of the key, zeroed value is created if key not found,
+ * NULL on allocation failure
+ */
+void *mm_oahm_insert(mm_oahm_t *hm, const void *key, int *found);
+
+/* zero if key not found */
+int mm_oahm_remove(mm_oahm_t *hm, const void *key);
+
+static inline size_t mm_oahm_count(const mm_oahm_t *hm)
+{
+	return hm->count;
+}
+
+/* allocated slots, for tests and stats */
+static inline size_t mm_oahm_capacity(const mm_oahm_t *hm)
+{
+	return hm->table.capacity + hm->old.capacity;
+}
@@ -13,6 +13,7 @@
 #include <machinarium/fd.h>
 #include <machinarium/cond.h>
 #include <machinarium/tls.h>
+#include <machinarium/tls_session_cache.h>
 
 typedef struct mm_tls mm_tls_t;
 typedef struct mm_tls_ctx mm_tls_ctx_t;
@@ -27,6 +28,8 @@ struct mm_tls {
 	char *ca_file;
 	char *cert_file;
 	char *key_file;
+	mm_tls_session_cache_t *session_cache;
+	char *session_key;
 };
 
 struct mm_tls_ctx {
@@ -98,6 +101,8 @@ int mm_io_format_socket_addr(mm_io_t *io, char *buf, size_t buflen);
 int mm_io_attach(mm_io_t *);
 int mm_io_detach(mm_io_t *);
 int mm_io_is_tls(mm_io_t *);
+/* handshake resumed the session, instead of the full one */
+int mm_io_is_tls_resumed(mm_io_t *);
 char *mm_io_error(mm_io_t *);
 int mm_io_fd(mm_io_t *);
 int mm_io_set_nodelay(mm_io_t *, int enable);
@@ -106,7 +111,12 @@ int mm_io_set_keepalive(mm_io_t *, int enable, int delay, int interval,
 int mm_io_set_nolinger(mm_io_t *io);
 int mm_io_advice_keepalive_usr_timeout(int delay, int interval, int probes);
 int mm_io_set_tls(mm_io_t *, machine_tls_t *, uint32_t);
-int mm_io_set_compression(mm_io_t *, char algorithm);
+/*
+ * zero level or buffer size means default, rx_data is compressed data
+ * already read from the socket, it must be shorter than the buffer
+ */
+int mm_io_set_compression(mm_io_t *, char algorithm, int level,
+			  size_t buffer_size, char *rx_data, size_t rx_size);
 int mm_io_connect(mm_io_t *, struct sockaddr *, uint32_t time_ms);
 int mm_io_connected(mm_io_t *);
 int mm_io_bind(mm_io_t *, struct sockaddr *, int);
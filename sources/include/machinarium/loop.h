@@ -6,16 +6,32 @@
  * cooperative multitasking engine.
  */
 
+#include <stdatomic.h>
+
 #include <machinarium/clock.h>
 #include <machinarium/idle.h>
 #include <machinarium/poll.h>
 
 typedef struct mm_loop mm_loop_t;
 
+/*
+ * event loop load, written by the loop owner
+ * and readable from other threads
+ */
+struct machine_load {
+	/* time spent out of poll wait */
+	atomic_uint_fast64_t busy_us;
+	/* events returned by the last poll */
+	atomic_uint_fast32_t ready;
+	/* private: time of the last poll return */
+	uint64_t poll_end_us;
+};
+
 struct mm_loop {
 	mm_clock_t clock;
 	mm_idle_t idle;
 	mm_poll_t *poll;
+	machine_load_t load;
 };
 
 int mm_loop_init(mm_loop_t *);
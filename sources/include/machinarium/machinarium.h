@@ -56,10 +56,12 @@ typedef struct machine_cond_private machine_cond_t;
 typedef struct machine_msg_private machine_msg_t;
 typedef struct machine_channel_private machine_channel_t;
 typedef struct machine_tls_private machine_tls_t;
+typedef struct machine_tls_session_cache_private machine_tls_session_cache_t;
 typedef struct machine_iov_private machine_iov_t;
 typedef struct machine_wait_flag machine_wait_flag_t;
 typedef struct machine_wait_group machine_wait_group_t;
 typedef struct machine_ring_buffer machine_ring_buffer_t;
+typedef struct machine_load machine_load_t;
 
 /* configuration */
 
@@ -75,6 +77,9 @@ MACHINE_API void machinarium_set_msg_cache_gc_size(int size);
 
 MACHINE_API void machinarium_set_dns_ttl_ms(int ttl_ms);
 
+/* timers of machines in a timing wheel instead of a heap */
+MACHINE_API void machinarium_set_timer_wheel(int enable);
+
 /* main */
 
 MACHINE_API int machinarium_init(void);
@@ -110,6 +115,16 @@ machine_stat(uint64_t *coroutine_count, uint64_t *coroutine_cache_count,
 	     uint64_t *msg_allocated, uint64_t *msg_cache_count,
 	     uint64_t *msg_cache_gc_count, uint64_t *msg_cache_size);
 
+/*
+ * event loop load of the current machine, the pointer
+ * stays valid and readable from any thread until the machine exits
+ */
+MACHINE_API machine_load_t *machine_load_self(void);
+
+MACHINE_API uint64_t machine_load_busy_us(machine_load_t *load);
+
+MACHINE_API uint32_t machine_load_ready(machine_load_t *load);
+
 /* signals */
 
 MACHINE_API int machine_signal_init(sigset_t *, sigset_t *);
@@ -222,6 +237,37 @@ MACHINE_API int machine_tls_set_cert_file(machine_tls_t *, char *);
 
 MACHINE_API int machine_tls_set_key_file(machine_tls_t *, char *);
 
+/*
+ * client connections offer sessions of the peer with the same key
+ * from the cache, cache must outlive the tls object
+ */
+MACHINE_API int machine_tls_set_session_cache(machine_tls_t *,
+					      machine_tls_session_cache_t *,
+					      const char *key);
+
+MACHINE_API machine_tls_session_cache_t *machine_tls_session_cache_create(void);
+
+MACHINE_API void
+machine_tls_session_cache_free(machine_tls_session_cache_t *);
+
+/* handshakes which resumed session from the cache and which did not */
+MACHINE_API void
+machine_tls_session_cache_stats(machine_tls_session_cache_t *,
+				uint64_t *hits, uint64_t *misses);
+
+/*
+ * keys of server side TLS session tickets, shared by all machines,
+ * used by tls contexts created after the first rotation or import
+ */
+#define MACHINE_TLS_TICKET_KEYS_EXPORT_SIZE 168
+
+MACHINE_API int machine_tls_ticket_keys_rotate(void);
+
+/* size of exported keys, 0 if there are no keys, -1 on error */
+MACHINE_API ssize_t machine_tls_ticket_keys_export(void *buf, size_t size);
+
+MACHINE_API int machine_tls_ticket_keys_import(const void *buf, size_t size);
+
 /* dns */
 
 MACHINE_API int machine_getsockname(mm_io_t *, struct sockaddr *, int *);
@@ -251,6 +297,12 @@ MACHINE_API ssize_t machine_read_raw(mm_io_t *, void *, size_t);
  */
 MACHINE_API int machine_read_pending(mm_io_t *);
 
+/*
+ * Returns 1 if compressed data is buffered and must be sent
+ * by next write.
+ */
+MACHINE_API int machine_write_pending(mm_io_t *);
+
 MACHINE_API machine_msg_t *machine_read(mm_io_t *, size_t, uint32_t time_ms);
 
 /* write */
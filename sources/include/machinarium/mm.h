@@ -8,6 +8,7 @@
 
 #include <machinarium/machine_mgr.h>
 #include <machinarium/task_mgr.h>
+#include <machinarium/tls_ticket_keys.h>
 
 typedef struct mm_config mm_config_t;
 typedef struct mm mm_t;
@@ -20,12 +21,14 @@ struct mm_config {
 	int coroutine_cache_size;
 	int msg_cache_gc_size;
 	uint64_t dns_ttl_ms;
+	int timer_wheel;
 };
 
 struct mm {
 	mm_config_t config;
 	mm_machinemgr_t machine_mgr;
 	mm_taskmgr_t task_mgr;
+	mm_tls_ticket_keys_t tls_ticket_keys;
 };
 
 extern mm_t machinarium;
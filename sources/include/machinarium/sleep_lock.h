@@ -38,3 +38,64 @@ static inline void mm_sleeplock_unlock(mm_sleeplock_t *lock)
 {
 	atomic_exchange(lock, 0);
 }
+
+/*
+ * readers-writer variant: readers do not serialize each other,
+ * writer waits for active readers and blocks new ones
+ */
+
+typedef atomic_uint mm_rwsleeplock_t;
+
+#define MM_RWSLEEPLOCK_WRITER (1U << 31)
+
+static inline void mm_rwsleeplock_init(mm_rwsleeplock_t *lock)
+{
+	atomic_init(lock, 0);
+}
+
+static inline void mm_rwsleeplock_rdlock(mm_rwsleeplock_t *lock)
+{
+	unsigned int spin_count = 0U;
+	for (;;) {
+		unsigned int value = atomic_load(lock);
+		if (!(value & MM_RWSLEEPLOCK_WRITER) &&
+		    atomic_compare_exchange_weak(lock, &value, value + 1)) {
+			return;
+		}
+		MM_SLEEPLOCK_BACKOFF;
+		if (++spin_count > 30U) {
+			usleep(1);
+		}
+	}
+}
+
+static inline void mm_rwsleeplock_rdunlock(mm_rwsleeplock_t *lock)
+{
+	atomic_fetch_sub(lock, 1);
+}
+
+static inline void mm_rwsleeplock_wrlock(mm_rwsleeplock_t *lock)
+{
+	unsigned int spin_count = 0U;
+	while (atomic_fetch_or(lock, MM_RWSLEEPLOCK_WRITER) &
+	       MM_RWSLEEPLOCK_WRITER) {
+		MM_SLEEPLOCK_BACKOFF;
+		if (++spin_count > 30U) {
+			usleep(1);
+		}
+	}
+
+	/* wait for readers, which entered before writer bit was set */
+	spin_count = 0U;
+	while (atomic_load(lock) != MM_RWSLEEPLOCK_WRITER) {
+		MM_SLEEPLOCK_BACKOFF;
+		if (++spin_count > 30U) {
+			usleep(1);
+		}
+	}
+}
+
+static inline void mm_rwsleeplock_wrunlock(mm_rwsleeplock_t *lock)
+{
+	atomic_fetch_and(lock, ~MM_RWSLEEPLOCK_WRITER);
+}
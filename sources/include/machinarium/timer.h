@@ -10,6 +10,7 @@
 #include <stddef.h>
 
 #include <machinarium/ds/heap.h>
+#include <machinarium/list.h>
 
 typedef struct mm_timer mm_timer_t;
 
@@ -17,6 +18,8 @@ typedef void (*mm_timer_callback_t)(mm_timer_t *);
 
 struct mm_timer {
 	mm_heap_node_t heap;
+	/* node of the timing wheel slot */
+	mm_list_t link;
 	int active;
 	uint64_t timeout;
 	uint32_t interval;
@@ -39,4 +42,5 @@ static inline void mm_timer_init(mm_timer_t *timer, mm_timer_callback_t cb,
 	timer->heap.parent = NULL;
 	timer->heap.left = NULL;
 	timer->heap.right = NULL;
+	mm_list_init(&timer->link);
 }
@@ -0,0 +1,64 @@
+#pragma once
+
+/*
+ * machinarium.
+ *
+ * cooperative multitasking engine.
+ */
+
+/*
+ * hierarchical timing wheel with 1 ms tick
+ *
+ * every level has 256 slots, slot of level N covers 256^N ms, so four
+ * levels cover any uint32_t interval, timers beyond the top level window
+ * wait in the overflow list
+ *
+ * timers are kept in intrusive lists, so add and delete are O(1), which
+ * matters for io waits where almost every timer is deleted before it
+ * fires, timers of upper levels move down when their slot is reached
+ *
+ * delete only unlinks the timer, bits of the emptied slots are cleared
+ * lazily by the step and the next timeout lookup
+ *
+ * this one is NOT thread-safe, it is owned by the machine clock
+ */
+
+#include <stdint.h>
+
+#include <machinarium/list.h>
+#include <machinarium/timer.h>
+
+#define MM_TIMER_WHEEL_LEVELS 4
+#define MM_TIMER_WHEEL_BITS 8
+#define MM_TIMER_WHEEL_SLOTS (1 << MM_TIMER_WHEEL_BITS)
+#define MM_TIMER_WHEEL_MASK (MM_TIMER_WHEEL_SLOTS - 1)
+
+typedef struct {
+	mm_list_t slots[MM_TIMER_WHEEL_SLOTS];
+	/* non-empty slots */
+	uint64_t bitmap[MM_TIMER_WHEEL_SLOTS / 64];
+} mm_timer_wheel_level_t;
+
+typedef struct {
+	mm_timer_wheel_level_t levels[MM_TIMER_WHEEL_LEVELS];
+	mm_list_t overflow;
+	/* timers that were due when added, fired on the next step */
+	mm_list_t expired;
+	/* first ms that is not processed yet */
+	uint64_t current;
+	size_t count;
+} mm_timer_wheel_t;
+
+void mm_timer_wheel_init(mm_timer_wheel_t *wheel);
+void mm_timer_wheel_add(mm_timer_wheel_t *wheel, mm_timer_t *timer,
+			uint64_t now);
+void mm_timer_wheel_del(mm_timer_wheel_t *wheel, mm_timer_t *timer);
+
+/* fires timers with timeout up to now */
+void mm_timer_wheel_step(mm_timer_wheel_t *wheel, uint64_t now);
+
+/*
+ * lower bound of the earliest timeout, which is exact for timers
+ * of the current 256 ms window, -1 if there are no timers
+ */
+int mm_timer_wheel_next(mm_timer_wheel_t *wheel, uint64_t *timeout);
@@ -21,6 +21,7 @@ void mm_tls_engine_free(void);
 int mm_tls_is_active(mm_io_t *io);
 void mm_tls_init(mm_io_t *);
 void mm_tls_free(mm_io_t *);
+void mm_tls_shutdown(mm_io_t *);
 void mm_tls_error_reset(mm_io_t *);
 int mm_tls_handshake(mm_io_t *, uint32_t);
 int mm_tls_write(mm_io_t *, const char *, int);
@@ -0,0 +1,53 @@
+#pragma once
+
+/*
+ * machinarium.
+ *
+ * cooperative multitasking engine.
+ */
+
+/*
+ * client side TLS sessions, shared by connections to the same peers
+ *
+ * session of the last full handshake with a peer is kept and offered
+ * by the next connections to this peer, so they can resume it with an
+ * abbreviated handshake instead of the full one
+ *
+ * peers are identified by a key chosen by the user (address of the peer),
+ * cache keeps a few of them, least recently used peer is evicted
+ */
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include <openssl/ssl.h>
+
+#include <machinarium/sleep_lock.h>
+
+#define MM_TLS_SESSION_CACHE_SIZE 16
+
+typedef struct mm_tls_session_cache mm_tls_session_cache_t;
+
+typedef struct {
+	char *key;
+	SSL_SESSION *session;
+	uint64_t last_used;
+} mm_tls_session_entry_t;
+
+struct mm_tls_session_cache {
+	mm_sleeplock_t lock;
+	mm_tls_session_entry_t entries[MM_TLS_SESSION_CACHE_SIZE];
+	uint64_t clock;
+
+	atomic_uint_fast64_t hits;
+	atomic_uint_fast64_t misses;
+};
+
+/* session with the reference taken or NULL */
+SSL_SESSION *mm_tls_session_cache_get(mm_tls_session_cache_t *cache,
+				      const char *key);
+/* takes the reference of the session */
+void mm_tls_session_cache_put(mm_tls_session_cache_t *cache, const char *key,
+			      SSL_SESSION *session);
+void mm_tls_session_cache_remove(mm_tls_session_cache_t *cache,
+				 const char *key);
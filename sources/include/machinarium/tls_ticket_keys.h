@@ -0,0 +1,44 @@
+#pragma once
+
+/*
+ * machinarium.
+ *
+ * cooperative multitasking engine.
+ */
+
+/*
+ * process-wide keys of server side TLS session tickets
+ *
+ * tickets issued by any machine can be resumed by any other one, keys
+ * can be exported and imported, so tickets survive restart of the process
+ *
+ * current key encrypts new tickets, previous one is kept after rotation,
+ * tickets of the previous key are accepted and renewed
+ */
+
+#include <stdint.h>
+
+#include <openssl/ssl.h>
+
+#include <machinarium/sleep_lock.h>
+
+#define MM_TLS_TICKET_KEYS_MAX 2
+
+typedef struct {
+	unsigned char name[16];
+	unsigned char aes_key[32];
+	unsigned char hmac_key[32];
+} mm_tls_ticket_key_t;
+
+typedef struct {
+	mm_sleeplock_t lock;
+	/* current key first */
+	mm_tls_ticket_key_t keys[MM_TLS_TICKET_KEYS_MAX];
+	int count;
+} mm_tls_ticket_keys_t;
+
+void mm_tls_ticket_keys_init(mm_tls_ticket_keys_t *keys);
+void mm_tls_ticket_keys_free(mm_tls_ticket_keys_t *keys);
+
+/* makes ctx issue tickets with the shared keys, if there are any */
+void mm_tls_ticket_keys_setup(SSL_CTX *ctx);
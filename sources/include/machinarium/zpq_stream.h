@@ -7,28 +7,56 @@
  */
 
 #include <stdlib.h>
+#include <stdint.h>
+#include <sys/uio.h>
 
 #define MM_ZPQ_IO_ERROR (-1)
 #define MM_ZPQ_DECOMPRESS_ERROR (-2)
 #define MM_ZPQ_MAX_ALGORITHMS (8)
 #define MM_ZPQ_NO_COMPRESSION 'n'
 
+/*
+ * We have to flush stream after each protocol command and command is
+ * mostly limited by record length, which in turn usually less than page
+ * size (except TOAST)
+ */
+#define MM_ZPQ_DEFAULT_BUFFER_SIZE (8 * 1024)
+
+/*
+ * Experiments shows that default (fastest) compression level provides the
+ * best size/speed ratio. It is significantly (times) faster than more
+ * expensive levels and differences in compression ratio is not so large
+ */
+#define MM_ZPQ_DEFAULT_LEVEL 1
+
 struct mm_zpq_stream;
 typedef struct mm_zpq_stream mm_zpq_stream_t;
 
+/* bytes passed through the stream since creation */
+typedef struct {
+	uint64_t tx_raw;
+	uint64_t tx_compressed;
+	uint64_t rx_raw;
+	uint64_t rx_compressed;
+} mm_zpq_stats_t;
+
 typedef ssize_t (*mm_zpq_tx_func)(void *arg, void const *data, size_t size);
 typedef ssize_t (*mm_zpq_rx_func)(void *arg, void *data, size_t size);
 
-mm_zpq_stream_t *zpq_create(int impl, mm_zpq_tx_func tx_func,
-			    mm_zpq_rx_func rx_func, void *arg, char *rx_data,
-			    size_t rx_data_size);
+/* zero level or buffer size means default */
+mm_zpq_stream_t *zpq_create(int impl, int level, size_t buffer_size,
+			    mm_zpq_tx_func tx_func, mm_zpq_rx_func rx_func,
+			    void *arg, char *rx_data, size_t rx_data_size);
 ssize_t mm_zpq_read(mm_zpq_stream_t *zs, void *buf, size_t size);
 ssize_t mm_zpq_write(mm_zpq_stream_t *zs, void const *buf, size_t size,
 		     size_t *processed);
+ssize_t mm_zpq_writev(mm_zpq_stream_t *zs, const struct iovec *iov, int n,
+		      size_t *processed);
 char const *mm_zpq_error(mm_zpq_stream_t *zs);
 size_t mm_zpq_buffered_tx(mm_zpq_stream_t *zs);
 size_t mm_zpq_buffered_rx(mm_zpq_stream_t *zs);
 _Bool mm_zpq_deferred_rx(mm_zpq_stream_t *zs);
+void mm_zpq_stats(mm_zpq_stream_t *zs, mm_zpq_stats_t *stats);
 void mm_zpq_free(mm_zpq_stream_t *zs);
 
 void mm_zpq_get_supported_algorithms(char *algorithms);
@@ -9,6 +9,7 @@
 typedef enum {
 	OD_MSG_STAT,
 	OD_MSG_CLIENT_NEW,
+	OD_MSG_LISTEN,
 	OD_MSG_LOG,
 	OD_MSG_SHUTDOWN,
 	OD_MSG_SIGNAL_RECEIVED,
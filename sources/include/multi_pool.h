@@ -28,11 +28,41 @@ struct od_multi_pool_key {
 	od_address_t address;
 };
 
+/*
+ * chained hash index, entries are linked by od_multi_pool_index_link_t
+ * and keep their hash for rehashing
+ */
+typedef struct {
+	od_list_t link;
+	uint64_t hash;
+} od_multi_pool_index_link_t;
+
+typedef struct {
+	od_list_t *buckets;
+	size_t size;
+	size_t count;
+} od_multi_pool_index_t;
+
+#define OD_MULTI_POOL_INDEX_MIN_SIZE 16
+
+/* servers counters of all elements with the same address */
+typedef struct {
+	od_address_t address;
+	int count_active;
+	int count_idle;
+	od_multi_pool_index_link_t index_link;
+	od_list_t link;
+} od_multi_pool_address_t;
+
 struct od_multi_pool_element {
 	od_multi_pool_key_t key;
 	od_server_pool_t pool;
 	mm_wait_list_t wait_bus;
 	od_list_t link;
+
+	od_multi_pool_t *mpool;
+	od_multi_pool_address_t *address;
+	od_multi_pool_index_link_t index_link;
 };
 
 typedef int (*od_multi_pool_element_cb_t)(od_multi_pool_element_t *, void **);
@@ -41,6 +71,15 @@ struct od_multi_pool {
 	od_list_t pools;
 	od_server_pool_free_fn_t pool_free_fn;
 
+	/* elements by key and servers counters by address */
+	od_multi_pool_index_t index;
+	od_multi_pool_index_t address_index;
+	od_list_t addresses;
+
+	/* servers counters of all elements */
+	int count_active;
+	int count_idle;
+
 	mm_mutex_t lock;
 
 	/* should increase every time servers in the route's pool are changed */
@@ -96,3 +135,12 @@ int od_multi_pool_total_locked(od_multi_pool_t *mpool,
 
 od_server_t *od_multi_pool_peek_any_locked(od_multi_pool_t *mpool,
 					   od_server_state_t state);
+
+/* total servers of all elements with address, without elements walk */
+int od_multi_pool_total_by_address_locked(od_multi_pool_t *mpool,
+					  const od_address_t *address);
+
+/* keeps multi pool counters up to date, called on server state change */
+void od_multi_pool_element_set_state(od_multi_pool_element_t *el,
+				     od_server_state_t prev,
+				     od_server_state_t state);
@@ -46,6 +46,7 @@ struct od_rule_pool {
 	int attach_check;
 	int acquire_fail_fast;
 	uint64_t reset_timeout_ms;
+	int reset_async;
 
 	/* --------  makes sense only for transaction pooling --------------------------- */
 	int reserve_prepared_statement;
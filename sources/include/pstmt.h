@@ -29,6 +29,7 @@
  */
 
 #include <machinarium/ds/hm.h>
+#include <machinarium/ds/oahm.h>
 #include <machinarium/machinarium.h>
 
 #include <types.h>
@@ -71,8 +72,8 @@ struct od_pstmt {
 };
 
 /* "P_0" -> *od_pstmt_t */
-mm_hashmap_t *od_client_pstmt_hashmap_create(void);
-void od_client_pstmt_hashmap_free(mm_hashmap_t *hm);
+mm_oahm_t *od_client_pstmt_hashmap_create(void);
+void od_client_pstmt_hashmap_free(mm_oahm_t *hm);
 
 int od_client_add_pstmt(od_client_t *client, const char *name,
 			od_pstmt_t *pstmt);
@@ -82,8 +83,8 @@ od_pstmt_t *od_client_get_pstmt(od_client_t *client, const char *name);
 void od_client_pstmts_clear(od_client_t *client);
 
 /* "portal_name" -> *od_pstmt_t (portal tracking, extended protocol) */
-mm_hashmap_t *od_client_portal_hashmap_create(void);
-void od_client_portal_hashmap_free(mm_hashmap_t *hm);
+mm_oahm_t *od_client_portal_hashmap_create(void);
+void od_client_portal_hashmap_free(mm_oahm_t *hm);
 
 int od_client_add_portal(od_client_t *client, const char *portal_name,
 			 od_pstmt_t *pstmt);
@@ -92,8 +93,8 @@ int od_client_remove_portal(od_client_t *client, const char *portal_name);
 void od_client_portals_clear(od_client_t *client);
 
 /* "odyssey_pstmt_0" -> *od_pstmt_t */
-mm_hashmap_t *od_server_pstmt_hashmap_create(void);
-void od_server_pstmt_hashmap_free(mm_hashmap_t *hm);
+mm_oahm_t *od_server_pstmt_hashmap_create(void);
+void od_server_pstmt_hashmap_free(mm_oahm_t *hm);
 
 int od_server_has_pstmt(od_server_t *server, const od_pstmt_t *pstmt);
 int od_server_add_pstmt(od_server_t *server, od_pstmt_t *pstmt);
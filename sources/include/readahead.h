@@ -10,19 +10,39 @@
 
 typedef struct od_readahead od_readahead_t;
 
+/*
+ * buf can be released back to the cache while it is empty, then it is
+ * NULL and all read functions see no unread bytes
+ */
 struct od_readahead {
 	mm_virtual_rbuf_t *buf;
+	/* capacity of buf, readable by other threads for stats */
+	size_t resident;
 };
 
 static inline void od_readahead_init(od_readahead_t *readahead)
 {
 	readahead->buf = NULL;
+	readahead->resident = 0;
 }
 
 void od_readahead_free(od_readahead_t *readahead);
 
 int od_readahead_prepare(od_readahead_t *readahead);
 
+/* returns buf to the cache if there is no unread bytes in it */
+void od_readahead_release(od_readahead_t *readahead);
+
+static inline int od_readahead_released(od_readahead_t *readahead)
+{
+	return readahead->buf == NULL;
+}
+
+static inline size_t od_readahead_resident(od_readahead_t *readahead)
+{
+	return readahead->resident;
+}
+
 static inline size_t od_readahead_capacity(od_readahead_t *readahead)
 {
 	od_assert(readahead->buf);
@@ -37,13 +57,24 @@ static inline int od_readahead_left(od_readahead_t *readahead)
 
 static inline int od_readahead_unread(od_readahead_t *readahead)
 {
+	if (readahead->buf == NULL) {
+		return 0;
+	}
 	return mm_virtual_rbuf_size(readahead->buf);
 }
 
+static inline struct iovec od_readahead_read_begin(od_readahead_t *readahead)
+{
+	if (readahead->buf == NULL) {
+		return (struct iovec){ .iov_base = NULL, .iov_len = 0 };
+	}
+	return mm_virtual_rbuf_read_begin(readahead->buf);
+}
+
 static inline int od_readahead_next_byte_is(od_readahead_t *readahead,
 					    uint8_t value)
 {
-	struct iovec rvec = mm_virtual_rbuf_read_begin(readahead->buf);
+	struct iovec rvec = od_readahead_read_begin(readahead);
 	if (rvec.iov_len == 0) {
 		/* no bytes in buf */
 		return 0;
@@ -54,11 +85,6 @@ static inline int od_readahead_next_byte_is(od_readahead_t *readahead,
 	return ((uint8_t *)rvec.iov_base)[0] == value;
 }
 
-static inline struct iovec od_readahead_read_begin(od_readahead_t *readahead)
-{
-	return mm_virtual_rbuf_read_begin(readahead->buf);
-}
-
 static inline void od_readahead_read_commit(od_readahead_t *readahead,
 					    size_t count)
 {
@@ -68,11 +94,15 @@ static inline void od_readahead_read_commit(od_readahead_t *readahead,
 static inline size_t od_readahead_read(od_readahead_t *readahead, char *dest,
 				       size_t max)
 {
+	if (readahead->buf == NULL) {
+		return 0;
+	}
 	return mm_virtual_rbuf_read(readahead->buf, dest, max);
 }
 
 static inline struct iovec od_readahead_write_begin(od_readahead_t *readahead)
 {
+	od_assert(readahead->buf);
 	return mm_virtual_rbuf_write_begin(readahead->buf);
 }
 
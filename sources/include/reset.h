@@ -10,3 +10,9 @@
 #include <server.h>
 
 int od_reset(od_server_t *);
+
+/*
+ * detach the client right away and reset its server
+ * in a background coroutine, see pool_reset_async
+ */
+void od_reset_async(od_client_t *);
@@ -19,6 +19,12 @@ pid_t od_restart_get_ppid(void);
 
 pid_t od_restart_run_new_binary(void);
 
+/*
+ * import TLS ticket keys passed by the parent odyssey
+ * 1 if imported, 0 if there are no keys, -1 on error
+ */
+int od_restart_inherit_tls_ticket_keys(void);
+
 void od_restart_terminate_parent(void);
 
 DEFINE_SIMPLE_MODULE_LOGGER(online_restart, "online-restart")
@@ -28,6 +28,7 @@ typedef struct {
 } od_route_pswd_t;
 
 od_route_pswd_t *od_route_pswd_create(const char *value);
+size_t od_route_stat_shards_count(void);
 od_route_pswd_t *od_route_pswd_ref(od_route_pswd_t *p);
 void od_route_pswd_unref(od_route_pswd_t *p);
 
@@ -57,6 +58,13 @@ struct od_route {
 
 	od_list_t link;
 
+	/* route pool hash index */
+	od_list_t index_link;
+	uint64_t index_hash;
+
+	/* pinned by routing without router lock, gc skips pinned routes */
+	atomic_int_fast64_t refs;
+
 	struct {
 		od_route_pswd_t *password;
 		uint64_t valid_until_ms;
@@ -184,6 +192,7 @@ static inline int od_route_init(od_route_t *route,
 {
 	route->rule = NULL;
 	route->tcp_connections = 0;
+	atomic_init(&route->refs, 0);
 
 	od_route_id_init(&route->id);
 
@@ -222,8 +231,16 @@ static inline int od_route_init(od_route_t *route,
 
 	od_stat_init(&route->stats);
 	od_stat_init(&route->stats_prev);
+	if (od_stat_shards_init(&route->stats, od_route_stat_shards_count()) !=
+	    OK_RESPONSE) {
+		od_multi_pool_destroy(route->exclusive_pool);
+		mm_wait_flag_destroy(route->auth_query_cache.ready);
+		return NOT_OK_RESPONSE;
+	}
 	kiwi_params_lock_init(&route->params);
 	od_list_init(&route->link);
+	od_list_init(&route->index_link);
+	route->index_hash = 0;
 	mm_mutex_init(&route->lock);
 
 	return OK_RESPONSE;
@@ -245,9 +262,7 @@ static inline void od_route_free(od_route_t *route)
 
 	kiwi_params_lock_free(&route->params);
 
-	if (route->stats.enable_quantiles) {
-		od_stat_free(&route->stats);
-	}
+	od_stat_free(&route->stats);
 
 	if (route->extra_logging_enabled) {
 		od_err_logger_free(route->err_logger);
@@ -7,6 +7,8 @@
  */
 
 #include <machinarium/mutex.h>
+#include <machinarium/sleep_lock.h>
+#include <machinarium/ds/hm.h>
 
 #include <types.h>
 #include <route.h>
@@ -49,8 +51,23 @@ struct od_route_pool {
 	mm_mutex_t lock;
 
 	od_list_t list;
+
+	/*
+	 * hash index over list, keyed by (rule, route id),
+	 * so route matching does not depend on number of routes
+	 */
+	od_list_t *index;
+	size_t index_size;
+
+	/*
+	 * pool changes are serialized by router lock, this lock
+	 * only protects index from concurrent lock-free lookups
+	 */
+	mm_rwsleeplock_t index_lock;
 };
 
+#define OD_ROUTE_POOL_INDEX_MIN_SIZE 64
+
 static inline void od_route_pool_lock(od_route_pool_t *route_pool)
 {
 	mm_mutex_lock2(&route_pool->lock);
@@ -69,9 +86,78 @@ static inline void od_route_pool_init(od_route_pool_t *pool)
 	od_list_init(&pool->list);
 	pool->err_logger = od_err_logger_create_default();
 	pool->count = 0;
+	pool->index = NULL;
+	pool->index_size = 0;
+	mm_rwsleeplock_init(&pool->index_lock);
 	mm_mutex_init(&pool->lock);
 }
 
+static inline uint64_t od_route_pool_hash(od_route_id_t *id, od_rule_t *rule)
+{
+	uint64_t hash = mm_xxh64_hash(&rule, sizeof(rule), 0);
+	hash = mm_xxh64_hash(id->database, id->database_len, hash);
+	hash = mm_xxh64_hash(id->user, id->user_len, hash);
+	return hash ^ ((uint64_t)id->physical_rep << 1) ^
+	       (uint64_t)id->logical_rep;
+}
+
+static inline od_list_t *od_route_pool_bucket(od_route_pool_t *pool,
+					      uint64_t hash)
+{
+	return &pool->index[hash & (pool->index_size - 1)];
+}
+
+static inline int od_route_pool_index_resize(od_route_pool_t *pool,
+					     size_t size)
+{
+	od_list_t *index = od_malloc(sizeof(od_list_t) * size);
+	if (index == NULL) {
+		return NOT_OK_RESPONSE;
+	}
+	for (size_t i = 0; i < size; ++i) {
+		od_list_init(&index[i]);
+	}
+
+	if (pool->index) {
+		od_free(pool->index);
+	}
+	pool->index = index;
+	pool->index_size = size;
+
+	/* rehash routes into the new buckets */
+	od_list_t *i;
+	od_list_foreach (&pool->list, i) {
+		od_route_t *route;
+		route = od_container_of(i, od_route_t, link);
+		od_list_append(od_route_pool_bucket(pool, route->index_hash),
+			       &route->index_link);
+	}
+
+	return OK_RESPONSE;
+}
+
+static inline int od_route_pool_index_add(od_route_pool_t *pool,
+					  od_route_t *route)
+{
+	if (pool->index == NULL) {
+		if (od_route_pool_index_resize(pool,
+					       OD_ROUTE_POOL_INDEX_MIN_SIZE) !=
+		    OK_RESPONSE) {
+			return NOT_OK_RESPONSE;
+		}
+	} else if ((size_t)pool->count >= pool->index_size) {
+		/*
+		 * keep load factor below 1, failed growth is not fatal -
+		 * just keep longer chains in the current index
+		 */
+		od_route_pool_index_resize(pool, pool->index_size * 2);
+	}
+
+	od_list_append(od_route_pool_bucket(pool, route->index_hash),
+		       &route->index_link);
+	return OK_RESPONSE;
+}
+
 static inline void od_route_pool_free(od_route_pool_t *pool)
 {
 	if (pool == NULL) {
@@ -87,6 +173,12 @@ static inline void od_route_pool_free(od_route_pool_t *pool)
 		route = od_container_of(i, od_route_t, link);
 		od_route_free(route);
 	}
+
+	if (pool->index) {
+		od_free(pool->index);
+		pool->index = NULL;
+	}
+	pool->index_size = 0;
 }
 
 static inline od_route_t *od_route_pool_new(od_route_pool_t *pool,
@@ -105,19 +197,47 @@ static inline od_route_t *od_route_pool_new(od_route_pool_t *pool,
 	route->rule = rule;
 	od_rules_ref(rule);
 	if (rule->quantiles_count) {
-		route->stats.enable_quantiles = true;
-		for (size_t i = 0; i < QUANTILES_WINDOW; ++i) {
-			route->stats.transaction_hgram[i] =
-				td_new(QUANTILES_COMPRESSION);
-			route->stats.query_hgram[i] =
-				td_new(QUANTILES_COMPRESSION);
+		rc = od_stat_quantiles_init(&route->stats,
+					    rule->quantiles_window);
+		if (rc != OK_RESPONSE) {
+			od_route_free(route);
+			return NULL;
 		}
 	}
+	route->index_hash = od_route_pool_hash(&route->id, rule);
+
+	mm_rwsleeplock_wrlock(&pool->index_lock);
+	if (od_route_pool_index_add(pool, route) != OK_RESPONSE) {
+		mm_rwsleeplock_wrunlock(&pool->index_lock);
+		od_route_free(route);
+		return NULL;
+	}
 	od_list_append(&pool->list, &route->link);
 	pool->count++;
+	mm_rwsleeplock_wrunlock(&pool->index_lock);
+
 	return route;
 }
 
+/* fails if route is pinned by od_route_pool_match_pin */
+static inline int od_route_pool_remove(od_route_pool_t *pool,
+				       od_route_t *route)
+{
+	mm_rwsleeplock_wrlock(&pool->index_lock);
+	if (atomic_load(&route->refs) != 0) {
+		mm_rwsleeplock_wrunlock(&pool->index_lock);
+		return NOT_OK_RESPONSE;
+	}
+
+	od_assert(pool->count > 0);
+	pool->count--;
+	od_list_unlink(&route->link);
+	od_list_unlink(&route->index_link);
+	mm_rwsleeplock_wrunlock(&pool->index_lock);
+
+	return OK_RESPONSE;
+}
+
 static inline int od_route_pool_foreach(od_route_pool_t *pool,
 					od_route_pool_cb_t callback,
 					void **argv)
@@ -141,11 +261,18 @@ static inline int od_route_pool_foreach(od_route_pool_t *pool,
 static inline od_route_t *
 od_route_pool_match(od_route_pool_t *pool, od_route_id_t *key, od_rule_t *rule)
 {
+	if (pool->index == NULL) {
+		return NULL;
+	}
+
+	uint64_t hash = od_route_pool_hash(key, rule);
+
+	od_list_t *bucket = od_route_pool_bucket(pool, hash);
 	od_list_t *i;
-	od_list_foreach (&pool->list, i) {
+	od_list_foreach (bucket, i) {
 		od_route_t *route;
-		route = od_container_of(i, od_route_t, link);
-		if (route->rule == rule &&
+		route = od_container_of(i, od_route_t, index_link);
+		if (route->index_hash == hash && route->rule == rule &&
 		    od_route_id_compare(&route->id, key)) {
 			return route;
 		}
@@ -164,7 +291,6 @@ static inline void od_route_pool_stat(od_route_pool_t *pool,
 	od_list_t *i;
 	od_list_foreach (&pool->list, i) {
 		od_route_t *route;
-		uint8_t next_tdigest;
 		route = od_container_of(i, od_route_t, link);
 
 		od_stat_t current;
@@ -174,13 +300,7 @@ static inline void od_route_pool_stat(od_route_pool_t *pool,
 		/* calculate average */
 		od_stat_t avg;
 		od_stat_init(&avg);
-		if (route->stats.enable_quantiles) {
-			uint8_t current_tdigest = route->stats.current_tdigest;
-			next_tdigest = (current_tdigest + 1) % QUANTILES_WINDOW;
-			td_reset(route->stats.transaction_hgram[next_tdigest]);
-			td_reset(route->stats.query_hgram[next_tdigest]);
-			route->stats.current_tdigest = next_tdigest;
-		}
+		od_stat_quantiles_tick(&route->stats);
 
 		od_stat_average(&avg, &current, &route->stats_prev,
 				prev_time_us);
@@ -282,3 +402,28 @@ od_route_pool_stat_err_frontend(od_route_pool_t *pool,
 {
 	return callback(pool, argv);
 }
+
+/*
+ * lookup without router lock, found route stays in pool
+ * until od_route_pool_unpin
+ */
+static inline od_route_t *od_route_pool_match_pin(od_route_pool_t *pool,
+						  od_route_id_t *key,
+						  od_rule_t *rule)
+{
+	mm_rwsleeplock_rdlock(&pool->index_lock);
+	od_route_t *route = od_route_pool_match(pool, key, rule);
+	if (route != NULL) {
+		atomic_fetch_add(&route->refs, 1);
+	}
+	mm_rwsleeplock_rdunlock(&pool->index_lock);
+
+	return route;
+}
+
+static inline void od_route_pool_unpin(od_route_t *route)
+{
+	int64_t r = atomic_fetch_sub(&route->refs, 1);
+	od_assert(r >= 1);
+	(void)r;
+}
@@ -7,15 +7,30 @@
  */
 
 #include <machinarium/mutex.h>
+#include <machinarium/sleep_lock.h>
 
 #include <rules.h>
 #include <route_pool.h>
 #include <router_cancel.h>
+#include <cancel_table.h>
 
 struct od_router {
 	mm_mutex_t lock;
+	/* lock acquisitions and how many of them had to wait */
+	od_atomic_u64_t lock_acquired;
+	od_atomic_u64_t lock_contended;
+	/* server io attaches on the same worker and on another one */
+	od_atomic_u64_t server_affinity_hits;
+	od_atomic_u64_t server_affinity_migrations;
 
 	od_rules_t rules;
+	/*
+	 * rules index published after each rules change,
+	 * used for routing without router lock
+	 */
+	od_rules_index_t *rules_snapshot;
+	mm_rwsleeplock_t rules_snapshot_lock;
+
 	od_route_pool_t route_pool;
 	/* clients */
 	od_atomic_u32_t clients;
@@ -27,12 +42,23 @@ struct od_router {
 	/* global */
 	od_global_t *global;
 
-	/* router has type of list */
+	/* listen servers, protected by the lock */
 	od_list_t servers;
+
+	/* client cancel key -> attached server */
+	od_cancel_table_t cancel_table;
 };
 
 static inline void od_router_lock(od_router_t *router)
 {
+	od_atomic_u64_inc(&router->lock_acquired);
+
+	/* zero timeout - just try to take the lock */
+	if (mm_mutex_lock(&router->lock, 0)) {
+		return;
+	}
+
+	od_atomic_u64_inc(&router->lock_contended);
 	mm_mutex_lock2(&router->lock);
 }
 
@@ -44,6 +70,7 @@ static inline void od_router_unlock(od_router_t *router)
 void od_router_init(od_router_t *, od_global_t *);
 void od_router_free(od_router_t *);
 
+void od_router_publish_rules(od_router_t *);
 int od_router_reconfigure(od_router_t *, od_rules_t *);
 int od_router_expire(od_router_t *, od_list_t *);
 void od_router_keep_min_pool_size_step(od_router_t *);
@@ -66,6 +93,13 @@ od_router_status_t od_router_attach(od_router_t *, od_client_t *, bool,
 void od_router_detach(od_router_t *, od_client_t *);
 void od_router_close(od_router_t *, od_client_t *);
 
+/*
+ * detach client from server without returning the server to the pool,
+ * it stays ACTIVE until od_router_reset_complete
+ */
+od_server_t *od_router_detach_for_reset(od_router_t *, od_client_t *);
+void od_router_reset_complete(od_router_t *, od_server_t *, int success);
+
 od_router_status_t od_router_cancel(od_router_t *, kiwi_key_t *,
 				    od_router_cancel_t *);
 
@@ -108,7 +108,8 @@ struct od_rule {
 
 	/* versioning */
 	int mark;
-	int obsolete;
+	/* read without rules lock by od_router_route_lockless */
+	atomic_int obsolete;
 	int order;
 
 	/* id */
@@ -196,6 +197,7 @@ struct od_rule {
 	int enable_password_passthrough;
 	double *quantiles;
 	int quantiles_count;
+	int quantiles_window;
 	int server_drop_on_cached_plan_error;
 	uint64_t server_lifetime_us;
 	int keepalive;
@@ -218,6 +220,37 @@ struct od_rule {
 	machine_wait_flag_t *group_checker_finished;
 };
 
+/*
+ * rules matching index
+ *
+ * every rule is placed into one of the types below by its
+ * db/user specificity; entries are sorted by (type, db, user, position)
+ * so candidates for a startup packet are up to four contiguous runs,
+ * each already ordered by rule position in the sorted rules list
+ */
+typedef enum {
+	OD_RULES_INDEX_DB_USER,
+	OD_RULES_INDEX_DB,
+	OD_RULES_INDEX_USER,
+	OD_RULES_INDEX_ANY,
+	OD_RULES_INDEX_MAX
+} od_rules_index_type_t;
+
+typedef struct {
+	od_rules_index_type_t type;
+	const char *db;
+	const char *user;
+	size_t pos;
+	od_rule_t *rule;
+} od_rules_index_entry_t;
+
+typedef struct {
+	/* index pins its rules, so it can outlive rules list changes */
+	atomic_int_fast64_t refs;
+	od_rules_index_entry_t *entries;
+	size_t count;
+} od_rules_index_t;
+
 struct od_rules {
 	mm_mutex_t mu;
 	od_list_t storages;
@@ -226,6 +259,9 @@ struct od_rules {
 #endif
 	od_list_t rules;
 	int next_order;
+
+	/* NULL means linear matching over rules list */
+	od_rules_index_t *index;
 };
 
 static inline void od_rules_lock(od_rules_t *rules)
@@ -254,6 +290,10 @@ void od_rules_stop_checkers(od_rules_t *rules);
 int od_rules_cleanup(od_rules_t *rules);
 
 int od_rules_sort_for_matching(od_rules_t *rules);
+int od_rules_index_build(od_rules_t *rules);
+void od_rules_index_free(od_rules_t *rules);
+od_rules_index_t *od_rules_index_ref(od_rules_index_t *index);
+void od_rules_index_unref(od_rules_index_t *index);
 
 /* rule */
 od_rule_t *od_rules_add_new_rule(od_rules_t *rules, const char *dbname,
@@ -269,6 +309,15 @@ int od_rules_compare(od_rule_t *, od_rule_t *);
 
 od_rule_t *od_rules_forward(od_rules_t *, const kiwi_be_startup_t *startup,
 			    struct sockaddr_storage *, int);
+/*
+ * matching over index without router lock, sets need_lock
+ * if result depends on group members, which can be changed concurrently,
+ * or on the rule obsoleted by reload, which is not published yet
+ */
+od_rule_t *od_rules_index_forward(od_rules_index_t *index,
+				  const kiwi_be_startup_t *startup,
+				  struct sockaddr_storage *, int,
+				  int *need_lock);
 
 /* search rule with desored characteristik */
 od_rule_t *od_rules_match(od_rules_t *rules, const char *db_name,
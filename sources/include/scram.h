@@ -6,6 +6,7 @@
  * Scalable PostgreSQL connection pooler.
  */
 
+#include <types.h>
 #include <od_memory.h>
 
 #include <pg_compat.h>
@@ -63,7 +64,8 @@ od_scram_create_client_first_message(od_scram_state_t *scram_state);
 machine_msg_t *
 od_scram_create_client_final_message(od_scram_state_t *scram_state,
 				     char *password, char *auth_data,
-				     size_t auth_data_size);
+				     size_t auth_data_size,
+				     od_scram_cache_t *cache, const char *user);
 
 machine_msg_t *
 od_scram_create_server_first_message(od_scram_state_t *scram_state);
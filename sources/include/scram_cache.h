@@ -0,0 +1,113 @@
+#pragma once
+
+/*
+ * Odyssey.
+ *
+ * Scalable PostgreSQL connection pooler.
+ */
+
+#include <machinarium/sleep_lock.h>
+
+#include <types.h>
+#include <list.h>
+#include <atomic.h>
+#include <scram.h>
+
+/*
+ * cache of SCRAM secrets derived from plain text passwords
+ *
+ * deriving SaltedPassword costs 4096 HMAC iterations and was done
+ * for every client authenticated by plain text password (or password
+ * returned by auth_query), cache keeps derived salt and keys, keyed by
+ * user name and peppered digest of the password
+ *
+ * the same cache is used for server connections, where salt is chosen
+ * by server and keys are derived for every new connection otherwise
+ *
+ * cache is bounded by entries count (least recently used are evicted),
+ * entries expire after ttl, cache is cleared on config reload and
+ * user entries are dropped when auth_query returns a new password
+ */
+
+#define OD_SCRAM_CACHE_SALT_MAX 32
+#define OD_SCRAM_CACHE_DIGEST_LEN 32
+#define OD_SCRAM_CACHE_MIN_BUCKETS 16
+
+/*
+ * frontend cache keeps StoredKey to verify client proof,
+ * backend cache keeps ClientKey to make proof for the salt
+ * and iterations announced by server
+ */
+typedef struct {
+	int iterations;
+	char salt[OD_SCRAM_CACHE_SALT_MAX];
+	uint8_t stored_key[OD_SCRAM_MAX_KEY_LEN];
+	uint8_t client_key[OD_SCRAM_MAX_KEY_LEN];
+	uint8_t server_key[OD_SCRAM_MAX_KEY_LEN];
+} od_scram_secret_t;
+
+typedef struct {
+	od_list_t link;
+	od_list_t lru_link;
+	uint64_t hash;
+	uint64_t expire_ms;
+	char *user;
+	uint8_t digest[OD_SCRAM_CACHE_DIGEST_LEN];
+	od_scram_secret_t secret;
+} od_scram_cache_entry_t;
+
+struct od_scram_cache {
+	mm_sleeplock_t lock;
+	od_list_t *buckets;
+	size_t buckets_count;
+	/* most recently used first */
+	od_list_t lru;
+	size_t count;
+	size_t max;
+	uint64_t ttl_ms;
+	uint8_t pepper[OD_SCRAM_CACHE_DIGEST_LEN];
+
+	od_atomic_u64_t hits;
+	od_atomic_u64_t misses;
+
+	/* derivations are done by workers if not null */
+	od_thread_pool_t *derive_pool;
+};
+
+void od_scram_cache_init(od_scram_cache_t *cache);
+void od_scram_cache_free(od_scram_cache_t *cache);
+
+/* drops all entries, size 0 disables the cache, ttl 0 means no expiration */
+int od_scram_cache_configure(od_scram_cache_t *cache, int size, int ttl_sec);
+
+int od_scram_cache_start_derive_workers(od_scram_cache_t *cache,
+					size_t count);
+
+int od_scram_cache_lookup(od_scram_cache_t *cache, const char *user,
+			  const char *password, od_scram_secret_t *secret);
+/* hit only if entry has salt and iterations already set in secret */
+int od_scram_cache_lookup_salted(od_scram_cache_t *cache, const char *user,
+				 const char *password,
+				 od_scram_secret_t *secret);
+void od_scram_cache_store(od_scram_cache_t *cache, const char *user,
+			  const char *password,
+			  const od_scram_secret_t *secret);
+void od_scram_cache_invalidate_user(od_scram_cache_t *cache,
+				    const char *user);
+
+static inline size_t od_scram_cache_count(od_scram_cache_t *cache)
+{
+	mm_sleeplock_lock(&cache->lock);
+	size_t count = cache->count;
+	mm_sleeplock_unlock(&cache->lock);
+	return count;
+}
+
+/*
+ * od_scram_init_from_plain_password with cache lookup,
+ * derivation is moved to derive workers if they are started
+ */
+int od_scram_init_from_plain_password_cached(od_scram_cache_t *cache,
+					     od_scram_state_t *scram_state,
+					     const char *user,
+					     const char *password);
@@ -9,6 +9,7 @@
 #include <stdatomic.h>
 
 #include <machinarium/ds/hm.h>
+#include <machinarium/zpq_stream.h>
 
 #include <types.h>
 #include <io.h>
@@ -37,6 +38,8 @@ struct od_server {
 	 *   (od_server_attach_client and od_server_dettach_client)
 	 * - each currently running cancel on the server
 	 *   (od_server_cancel_begin and od_server_cancel_end)
+	 * - background reset of the server
+	 *   (od_server_reset_begin and od_server_reset_end)
 	 * 
 	 * every server that have ref counter > 1
 	 * should have ACTIVE state,
@@ -70,6 +73,8 @@ struct od_server {
 
 	kiwi_key_t key;
 	kiwi_key_t key_client;
+	/* router cancel table, linked while attached to client */
+	od_list_t cancel_link;
 	kiwi_vars_t vars;
 
 	machine_msg_t *error_connect;
@@ -83,6 +88,25 @@ struct od_server {
 	uint64_t init_time_us;
 	bool synced_settings;
 
+	/* client parameters deploy is postponed until the first query */
+	int deploy_pending;
+	/*
+	 * vars stamps of the last client and server pair, for which
+	 * deploy found nothing to set
+	 */
+	uint64_t deploy_client_stamp;
+	uint64_t deploy_server_stamp;
+	int deploy_stamp_valid;
+
+	/*
+	 * machine which io of the server was attached to the last time,
+	 * used to prefer idle servers of the current worker
+	 */
+	uint64_t last_machine;
+	/* io attaches on the last machine and on another one */
+	uint64_t affinity_hits;
+	uint64_t affinity_migrations;
+
 	od_list_t link;
 
 	/* xproto state fields */
@@ -90,9 +114,12 @@ struct od_server {
 	int xproto_err;
 	int cached_plan_broken;
 	int oom;
-	mm_hashmap_t *prep_stmts;
+	mm_oahm_t *prep_stmts;
 
 	int need_startup;
+
+	/* compression stats already added to the storage counters */
+	mm_zpq_stats_t compression_reported;
 };
 
 static inline void od_server_init(od_server_t *server, int reserve_prep_stmts)
@@ -115,6 +142,13 @@ static inline void od_server_init(od_server_t *server, int reserve_prep_stmts)
 	server->error_connect = NULL;
 	server->offline = 0;
 	server->synced_settings = false;
+	server->deploy_pending = 0;
+	server->deploy_client_stamp = 0;
+	server->deploy_server_stamp = 0;
+	server->deploy_stamp_valid = 0;
+	server->last_machine = UINT64_MAX;
+	server->affinity_hits = 0;
+	server->affinity_migrations = 0;
 	server->pool_element = NULL;
 	server->endpoint = NULL;
 	server->need_startup = 1;
@@ -131,6 +165,7 @@ static inline void od_server_init(od_server_t *server, int reserve_prep_stmts)
 
 	od_io_init(&server->io);
 	od_list_init(&server->link);
+	od_list_init(&server->cancel_link);
 	memset(&server->id, 0, sizeof(server->id));
 
 	server->xproto_mode = 0;
@@ -184,3 +219,5 @@ const od_address_t *od_server_pool_address(od_server_t *server);
 void od_server_set_pool_state(od_server_t *server, od_server_state_t state);
 void od_server_cancel_begin(od_server_t *server);
 void od_server_cancel_end(od_server_t *server);
+void od_server_reset_begin(od_server_t *server);
+int od_server_reset_end(od_server_t *server);
@@ -0,0 +1,29 @@
+#pragma once
+
+/*
+ * Odyssey.
+ *
+ * Scalable PostgreSQL connection pooler.
+ */
+
+/*
+ * cheap classification of the statement by its first keyword
+ *
+ * skips whitespace and comments the same way the scanner does and looks
+ * at the first token only, so the statement can be processed virtually
+ * only if the result is not OTHER, but it is not guaranteed to be parsed
+ */
+
+#include <stddef.h>
+
+typedef enum {
+	OD_SQL_MINIMAL_STMT_OTHER,
+	OD_SQL_MINIMAL_STMT_SET,
+	OD_SQL_MINIMAL_STMT_SHOW,
+	OD_SQL_MINIMAL_STMT_BEGIN,
+	OD_SQL_MINIMAL_STMT_DEALLOCATE,
+	OD_SQL_MINIMAL_STMT_DISCARD
+} od_sql_minimal_stmt_kind_t;
+
+od_sql_minimal_stmt_kind_t od_sql_minimal_classify(const char *input,
+						   size_t input_len);
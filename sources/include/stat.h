@@ -6,13 +6,20 @@
  * Scalable PostgreSQL connection pooler.
  */
 
+#include <machinarium/machinarium.h>
+#include <machinarium/sleep_lock.h>
+
 #include <atomic.h>
 #include <tdigest.h>
+#include <od_memory.h>
 
-#define QUANTILES_WINDOW 2
+#define QUANTILES_WINDOW_DEFAULT 2
 #define QUANTILES_COMPRESSION 100
 
+#define OD_STAT_SHARD_ALIGN 64
+
 typedef struct od_stat_state od_stat_state_t;
+typedef struct od_stat_shard od_stat_shard_t;
 typedef struct od_stat od_stat_t;
 
 struct od_stat_state {
@@ -20,9 +27,30 @@ struct od_stat_state {
 	uint64_t tx_time_start;
 };
 
+/*
+ * Counters updated by a single machine. Every shard occupies its own
+ * cache lines, so workers serving the same route do not bounce them.
+ */
+struct od_stat_shard {
+	od_atomic_u64_t count_query;
+	od_atomic_u64_t count_tx;
+	od_atomic_u64_t query_time;
+	od_atomic_u64_t tx_time;
+	od_atomic_u64_t count_wait;
+	od_atomic_u64_t wait_time_us;
+	od_atomic_u64_t recv_server;
+	od_atomic_u64_t recv_client;
+	od_atomic_u64_t count_parse;
+	od_atomic_u64_t count_parse_reuse;
+	od_atomic_u64_t count_cancel;
+
+	/* digests of current stats interval, created on first use */
+	td_histogram_t *transaction_hgram;
+	td_histogram_t *query_hgram;
+} __attribute__((aligned(OD_STAT_SHARD_ALIGN)));
+
 struct od_stat {
 	bool enable_quantiles;
-	uint8_t current_tdigest;
 
 	od_atomic_u64_t count_query;
 	od_atomic_u64_t count_tx;
@@ -39,8 +67,23 @@ struct od_stat {
 	od_atomic_u64_t count_parse_reuse;
 	od_atomic_u64_t count_cancel;
 
-	td_histogram_t *transaction_hgram[QUANTILES_WINDOW];
-	td_histogram_t *query_hgram[QUANTILES_WINDOW];
+	/*
+	 * ring of merged digests, one per stats interval,
+	 * filled by cron from shard digests
+	 */
+	mm_sleeplock_t quantiles_lock;
+	int quantiles_window;
+	int current_tdigest;
+	td_histogram_t **transaction_hgram;
+	td_histogram_t **query_hgram;
+
+	/*
+	 * per machine counters, NULL for stat snapshots.
+	 * counters above are not updated while shards are set
+	 */
+	od_stat_shard_t *shards;
+	size_t shards_count;
+	void *shards_mem;
 };
 
 static inline void od_stat_state_init(od_stat_state_t *state)
@@ -53,12 +96,201 @@ static inline void od_stat_init(od_stat_t *stat)
 	memset(stat, 0, sizeof(*stat));
 }
 
+static inline int od_stat_shards_init(od_stat_t *stat, size_t count)
+{
+	/* power of two, so the shard is picked by mask */
+	size_t shards_count = 1;
+	while (shards_count < count) {
+		shards_count <<= 1;
+	}
+
+	size_t size =
+		shards_count * sizeof(od_stat_shard_t) + OD_STAT_SHARD_ALIGN;
+	void *mem = od_malloc(size);
+	if (mem == NULL) {
+		return NOT_OK_RESPONSE;
+	}
+	memset(mem, 0, size);
+
+	uintptr_t aligned = ((uintptr_t)mem + OD_STAT_SHARD_ALIGN - 1) &
+			    ~((uintptr_t)OD_STAT_SHARD_ALIGN - 1);
+
+	stat->shards = (od_stat_shard_t *)aligned;
+	stat->shards_count = shards_count;
+	stat->shards_mem = mem;
+	return OK_RESPONSE;
+}
+
+static inline void od_stat_quantiles_free(od_stat_t *stat)
+{
+	for (size_t i = 0; i < stat->shards_count; ++i) {
+		td_safe_free(stat->shards[i].transaction_hgram);
+		td_safe_free(stat->shards[i].query_hgram);
+		stat->shards[i].transaction_hgram = NULL;
+		stat->shards[i].query_hgram = NULL;
+	}
+
+	for (int i = 0; i < stat->quantiles_window; ++i) {
+		if (stat->transaction_hgram != NULL) {
+			td_safe_free(stat->transaction_hgram[i]);
+		}
+		if (stat->query_hgram != NULL) {
+			td_safe_free(stat->query_hgram[i]);
+		}
+	}
+	if (stat->transaction_hgram != NULL) {
+		od_free(stat->transaction_hgram);
+		stat->transaction_hgram = NULL;
+	}
+	if (stat->query_hgram != NULL) {
+		od_free(stat->query_hgram);
+		stat->query_hgram = NULL;
+	}
+
+	stat->quantiles_window = 0;
+	stat->enable_quantiles = false;
+}
+
+/* requires shards, window is count of stats intervals to cover */
+static inline int od_stat_quantiles_init(od_stat_t *stat, int window)
+{
+	if (stat->shards == NULL || window <= 0) {
+		return NOT_OK_RESPONSE;
+	}
+
+	mm_sleeplock_init(&stat->quantiles_lock);
+	stat->current_tdigest = 0;
+	stat->quantiles_window = window;
+
+	size_t size = sizeof(td_histogram_t *) * window;
+	stat->transaction_hgram = od_malloc(size);
+	stat->query_hgram = od_malloc(size);
+	if (stat->transaction_hgram == NULL || stat->query_hgram == NULL) {
+		goto error;
+	}
+	memset(stat->transaction_hgram, 0, size);
+	memset(stat->query_hgram, 0, size);
+
+	for (int i = 0; i < window; ++i) {
+		stat->transaction_hgram[i] = td_new(QUANTILES_COMPRESSION);
+		stat->query_hgram[i] = td_new(QUANTILES_COMPRESSION);
+		if (stat->transaction_hgram[i] == NULL ||
+		    stat->query_hgram[i] == NULL) {
+			goto error;
+		}
+	}
+
+	stat->enable_quantiles = true;
+	return OK_RESPONSE;
+
+error:
+	od_stat_quantiles_free(stat);
+	return NOT_OK_RESPONSE;
+}
+
 static inline void od_stat_free(od_stat_t *stat)
 {
-	for (size_t i = 0; i < QUANTILES_WINDOW; ++i) {
-		td_free(stat->transaction_hgram[i]);
-		td_free(stat->query_hgram[i]);
+	if (stat->shards != NULL) {
+		od_stat_quantiles_free(stat);
 	}
+
+	if (stat->shards_mem != NULL) {
+		od_free(stat->shards_mem);
+		stat->shards_mem = NULL;
+		stat->shards = NULL;
+		stat->shards_count = 0;
+	}
+}
+
+static inline od_stat_shard_t *od_stat_local_shard(od_stat_t *stat)
+{
+	return &stat->shards[machine_self() & (stat->shards_count - 1)];
+}
+
+/* counter of calling machine shard, or shared one for unsharded stat */
+#define od_stat_counter(stat, name)                                  \
+	((stat)->shards != NULL ? &od_stat_local_shard(stat)->name : \
+				  &(stat)->name)
+
+static inline void od_stat_quantile_add(td_histogram_t **hgram_ptr,
+					uint64_t value)
+{
+	td_histogram_t *hgram = __atomic_load_n(hgram_ptr, __ATOMIC_ACQUIRE);
+	if (hgram == NULL) {
+		/* shard is shared by machines only on ids collision */
+		td_histogram_t *created = td_new(QUANTILES_COMPRESSION);
+		if (created == NULL) {
+			return;
+		}
+		if (__atomic_compare_exchange_n(hgram_ptr, &hgram, created,
+						false, __ATOMIC_ACQ_REL,
+						__ATOMIC_ACQUIRE)) {
+			hgram = created;
+		} else {
+			td_free(created);
+		}
+	}
+
+	td_add(hgram, value, 1);
+}
+
+/*
+ * Called by cron once per stats interval: moves the shard digests
+ * into the next window, dropping the oldest one.
+ */
+static inline void od_stat_quantiles_tick(od_stat_t *stat)
+{
+	if (!stat->enable_quantiles) {
+		return;
+	}
+
+	mm_sleeplock_lock(&stat->quantiles_lock);
+
+	int next = (stat->current_tdigest + 1) % stat->quantiles_window;
+	td_histogram_t *transactions = stat->transaction_hgram[next];
+	td_histogram_t *queries = stat->query_hgram[next];
+	td_reset(transactions);
+	td_reset(queries);
+
+	for (size_t i = 0; i < stat->shards_count; ++i) {
+		od_stat_shard_t *shard = &stat->shards[i];
+		td_histogram_t *hgram;
+
+		hgram = __atomic_load_n(&shard->transaction_hgram,
+					__ATOMIC_ACQUIRE);
+		if (hgram != NULL) {
+			td_drain(transactions, hgram);
+		}
+
+		hgram = __atomic_load_n(&shard->query_hgram, __ATOMIC_ACQUIRE);
+		if (hgram != NULL) {
+			td_drain(queries, hgram);
+		}
+	}
+
+	stat->current_tdigest = next;
+
+	mm_sleeplock_unlock(&stat->quantiles_lock);
+}
+
+/* merge all windows, freeze is a scratch digest */
+static inline void od_stat_quantiles_merge(od_stat_t *stat,
+					   td_histogram_t *transactions,
+					   td_histogram_t *queries,
+					   td_histogram_t *freeze)
+{
+	if (!stat->enable_quantiles) {
+		return;
+	}
+
+	mm_sleeplock_lock(&stat->quantiles_lock);
+	for (int i = 0; i < stat->quantiles_window; ++i) {
+		td_copy(freeze, stat->transaction_hgram[i]);
+		td_merge(transactions, freeze);
+		td_copy(freeze, stat->query_hgram[i]);
+		td_merge(queries, freeze);
+	}
+	mm_sleeplock_unlock(&stat->quantiles_lock);
 }
 
 static inline void od_stat_query_start(od_stat_state_t *state)
@@ -74,23 +306,23 @@ static inline void od_stat_query_start(od_stat_state_t *state)
 
 static inline void od_stat_wait_time(od_stat_t *stat, uint64_t wait_time_us)
 {
-	od_atomic_u64_add(&stat->wait_time_us, wait_time_us);
-	od_atomic_u64_inc(&stat->count_wait);
+	od_atomic_u64_add(od_stat_counter(stat, wait_time_us), wait_time_us);
+	od_atomic_u64_inc(od_stat_counter(stat, count_wait));
 }
 
 static inline void od_stat_parse(od_stat_t *stat)
 {
-	od_atomic_u64_inc(&stat->count_parse);
+	od_atomic_u64_inc(od_stat_counter(stat, count_parse));
 }
 
 static inline void od_stat_parse_reuse(od_stat_t *stat)
 {
-	od_atomic_u64_inc(&stat->count_parse_reuse);
+	od_atomic_u64_inc(od_stat_counter(stat, count_parse_reuse));
 }
 
 static inline void od_stat_cancel(od_stat_t *stat)
 {
-	od_atomic_u64_inc(&stat->count_cancel);
+	od_atomic_u64_inc(od_stat_counter(stat, count_cancel));
 }
 
 static inline void od_stat_query_end(od_stat_t *stat, od_stat_state_t *state,
@@ -101,11 +333,13 @@ static inline void od_stat_query_end(od_stat_t *stat, od_stat_state_t *state,
 		diff = machine_time_us() - state->query_time_start;
 		if (diff > 0) {
 			*query_time = diff;
-			od_atomic_u64_add(&stat->query_time, diff);
-			od_atomic_u64_inc(&stat->count_query);
+			od_atomic_u64_add(od_stat_counter(stat, query_time),
+					  diff);
+			od_atomic_u64_inc(od_stat_counter(stat, count_query));
 			if (stat->enable_quantiles) {
-				td_add(stat->query_hgram[stat->current_tdigest],
-				       diff, 1);
+				od_stat_shard_t *shard;
+				shard = od_stat_local_shard(stat);
+				od_stat_quantile_add(&shard->query_hgram, diff);
 			}
 		}
 		state->query_time_start = 0;
@@ -118,12 +352,13 @@ static inline void od_stat_query_end(od_stat_t *stat, od_stat_state_t *state,
 	if (state->tx_time_start) {
 		diff = machine_time_us() - state->tx_time_start;
 		if (diff > 0) {
-			od_atomic_u64_add(&stat->tx_time, diff);
-			od_atomic_u64_inc(&stat->count_tx);
+			od_atomic_u64_add(od_stat_counter(stat, tx_time), diff);
+			od_atomic_u64_inc(od_stat_counter(stat, count_tx));
 			if (stat->enable_quantiles) {
-				td_add(stat->transaction_hgram
-					       [stat->current_tdigest],
-				       diff, 1);
+				od_stat_shard_t *shard;
+				shard = od_stat_local_shard(stat);
+				od_stat_quantile_add(&shard->transaction_hgram,
+						     diff);
 			}
 		}
 		state->tx_time_start = 0;
@@ -132,16 +367,51 @@ static inline void od_stat_query_end(od_stat_t *stat, od_stat_state_t *state,
 
 static inline void od_stat_recv_server(od_stat_t *stat, uint64_t bytes)
 {
-	od_atomic_u64_add(&stat->recv_server, bytes);
+	od_atomic_u64_add(od_stat_counter(stat, recv_server), bytes);
 }
 
 static inline void od_stat_recv_client(od_stat_t *stat, uint64_t bytes)
 {
-	od_atomic_u64_add(&stat->recv_client, bytes);
+	od_atomic_u64_add(od_stat_counter(stat, recv_client), bytes);
+}
+
+static inline void od_stat_shards_sum(od_stat_t *sum, od_stat_t *stat)
+{
+	for (size_t i = 0; i < stat->shards_count; ++i) {
+		od_stat_shard_t *shard = &stat->shards[i];
+		sum->count_query += od_atomic_u64_of(&shard->count_query);
+		sum->count_tx += od_atomic_u64_of(&shard->count_tx);
+		sum->query_time += od_atomic_u64_of(&shard->query_time);
+		sum->tx_time += od_atomic_u64_of(&shard->tx_time);
+		sum->count_wait += od_atomic_u64_of(&shard->count_wait);
+		sum->wait_time_us += od_atomic_u64_of(&shard->wait_time_us);
+		sum->recv_client += od_atomic_u64_of(&shard->recv_client);
+		sum->recv_server += od_atomic_u64_of(&shard->recv_server);
+		sum->count_parse += od_atomic_u64_of(&shard->count_parse);
+		sum->count_parse_reuse +=
+			od_atomic_u64_of(&shard->count_parse_reuse);
+		sum->count_cancel += od_atomic_u64_of(&shard->count_cancel);
+	}
 }
 
 static inline void od_stat_copy(od_stat_t *dst, od_stat_t *src)
 {
+	if (src->shards != NULL) {
+		dst->count_query = 0;
+		dst->count_tx = 0;
+		dst->query_time = 0;
+		dst->tx_time = 0;
+		dst->count_wait = 0;
+		dst->wait_time_us = 0;
+		dst->recv_client = 0;
+		dst->recv_server = 0;
+		dst->count_parse = 0;
+		dst->count_parse_reuse = 0;
+		dst->count_cancel = 0;
+		od_stat_shards_sum(dst, src);
+		return;
+	}
+
 	dst->count_query = od_atomic_u64_of(&src->count_query);
 	dst->count_tx = od_atomic_u64_of(&src->count_tx);
 	dst->query_time = od_atomic_u64_of(&src->query_time);
@@ -157,6 +427,11 @@ static inline void od_stat_copy(od_stat_t *dst, od_stat_t *src)
 
 static inline void od_stat_sum(od_stat_t *sum, od_stat_t *stat)
 {
+	if (stat->shards != NULL) {
+		od_stat_shards_sum(sum, stat);
+		return;
+	}
+
 	sum->count_query += od_atomic_u64_of(&stat->count_query);
 	sum->count_tx += od_atomic_u64_of(&stat->count_tx);
 	sum->query_time += od_atomic_u64_of(&stat->query_time);
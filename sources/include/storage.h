@@ -14,6 +14,7 @@
 #include <tls_config.h>
 #include <balancing.h>
 #include <list.h>
+#include <atomic.h>
 #include <pool.h>
 #include <od_memory.h>
 #include <address.h>
@@ -96,6 +97,16 @@ struct od_rule_storage {
 	int endpoints_status_poll_interval_ms;
 	od_storage_balancing_t balancing;
 
+	/* ask servers for protocol compression, see compression.c */
+	int compression;
+	int compression_level;
+
+	/* bytes of compressed server connections, before and after */
+	od_atomic_u64_t compression_tx_raw;
+	od_atomic_u64_t compression_tx;
+	od_atomic_u64_t compression_rx_raw;
+	od_atomic_u64_t compression_rx;
+
 	atomic_int_fast64_t refs;
 };
 
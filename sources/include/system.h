@@ -12,7 +12,9 @@
 
 #include <types.h>
 #include <id.h>
+#include <atomic.h>
 #include <config.h>
+#include <worker.h>
 
 struct od_system_server {
 	mm_io_t *io;
@@ -26,11 +28,26 @@ struct od_system_server {
 
 	atomic_bool closed;
 
+	/* worker, that runs the accept loop, or NULL for system machine */
+	od_worker_t *worker;
+
+	/* accepted connections and their rate per second, updated by cron */
+	od_atomic_u64_t accepted;
+	uint64_t accepted_prev;
+	uint64_t accept_rate;
+
+	/* handshakes of TLS clients, full and resumed ones */
+	od_atomic_u64_t tls_full;
+	od_atomic_u64_t tls_resumed;
+
 	int64_t coro_id;
 };
 
 void od_system_server_free(od_system_server_t *server);
 od_system_server_t *od_system_server_init(void);
+int od_system_server_spawn(od_system_server_t *server);
+/* unregister, close and free the server, which accept loop is not started */
+void od_system_server_remove(od_system_server_t *server);
 
 void od_system_server_shutdown(od_system_server_t *server);
 
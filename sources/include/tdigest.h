@@ -40,6 +40,10 @@ void td_add(td_histogram_t *h, double val, double count);
 /* td_merge merges the data from from into into. */
 void td_merge(td_histogram_t *into, td_histogram_t *from);
 
+/* td_drain merges the data from from into into and resets from, */
+/* values added to from concurrently are not lost. */
+void td_drain(td_histogram_t *into, td_histogram_t *from);
+
 /* td_reset resets a histogram. */
 void td_reset(td_histogram_t *h);
 
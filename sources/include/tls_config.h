@@ -7,6 +7,8 @@
  * Scalable PostgreSQL connection pooler.
  */
 
+#include <machinarium/machinarium.h>
+
 typedef enum {
 	/* do not change the order */
 	OD_CONFIG_TLS_DISABLE,
@@ -43,6 +45,8 @@ struct od_tls_opts {
 	char *tls_key_file;
 	char *tls_cert_file;
 	char *tls_protocols;
+	/* sessions of server connections, storages only */
+	machine_tls_session_cache_t *session_cache;
 };
 
 typedef struct od_tls_opts od_tls_opts_t;
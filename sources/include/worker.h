@@ -6,9 +6,12 @@
  * Scalable PostgreSQL connection pooler.
  */
 
+#include <stdatomic.h>
+
 #include <machinarium/machinarium.h>
 
 #include <types.h>
+#include <atomic.h>
 
 typedef struct od_worker od_worker_t;
 
@@ -18,10 +21,40 @@ struct od_worker {
 	machine_channel_t *task_channel;
 	uint64_t clients_processed;
 	od_global_t *global;
+
+	/* clients running on the worker */
+	od_atomic_u32_t clients;
+	/* clients passed to the worker, but not started yet */
+	od_atomic_u32_t pending;
+	/* share of event loop busy time, updated by cron */
+	od_atomic_u32_t busy_permille;
+	uint64_t busy_us_prev;
+	/* set by the worker machine on start */
+	_Atomic(machine_load_t *) loop_load;
 };
 
+/*
+ * worker load for clients placement: clients running on the worker
+ * and passed to it, events returned by its last poll, and every
+ * percent of its loop busy time weighs as one more client
+ */
+static inline uint32_t od_worker_load(od_worker_t *worker)
+{
+	uint32_t load = od_atomic_u32_of(&worker->clients) +
+			od_atomic_u32_of(&worker->pending) +
+			od_atomic_u32_of(&worker->busy_permille) / 10;
+
+	machine_load_t *loop_load = atomic_load(&worker->loop_load);
+	if (loop_load != NULL) {
+		load += machine_load_ready(loop_load);
+	}
+	return load;
+}
+
 void od_worker_init(od_worker_t *, od_global_t *, int);
 int od_worker_start(od_worker_t *);
 void od_worker_shutdown(od_worker_t *);
+int od_worker_listen(od_worker_t *, od_system_server_t *);
+void od_worker_client_new(od_worker_t *, od_client_t *);
 
 od_linear_alloc_t *od_worker_get_local_linear_alloc(void);
@@ -10,6 +10,7 @@
 
 #include <types.h>
 #include <atomic.h>
+#include <config.h>
 #include <worker.h>
 #include <od_memory.h>
 
@@ -72,8 +73,7 @@ od_worker_pool_wait_gracefully_shutdown(od_worker_pool_t *pool)
 	od_free(pool->pool);
 }
 
-static inline void od_worker_pool_feed(od_worker_pool_t *pool,
-				       machine_msg_t *msg)
+static inline uint32_t od_worker_pool_next_round_robin(od_worker_pool_t *pool)
 {
 	uint32_t next;
 	uint32_t oldValue;
@@ -88,7 +88,67 @@ static inline void od_worker_pool_feed(od_worker_pool_t *pool,
 		}
 	}
 
+	return next;
+}
+
+static inline uint32_t
+od_worker_pool_next_least_loaded(od_worker_pool_t *pool)
+{
+	/* start from round robin position to spread ties */
+	uint32_t start = od_worker_pool_next_round_robin(pool);
+	uint32_t best = start;
+	uint32_t best_load = od_worker_load(&pool->pool[start]);
+
+	for (uint32_t i = 1; i < pool->count && best_load > 0; ++i) {
+		uint32_t n = (start + i) % pool->count;
+		uint32_t load = od_worker_load(&pool->pool[n]);
+		if (load < best_load) {
+			best = n;
+			best_load = load;
+		}
+	}
+
+	return best;
+}
+
+static inline uint32_t od_worker_pool_next_p2c(od_worker_pool_t *pool)
+{
+	if (pool->count < 2) {
+		return 0;
+	}
+
+	/* power of two choices: two distinct random workers */
+	uint32_t a = (uint32_t)machine_lrand48() % pool->count;
+	uint32_t b = (uint32_t)machine_lrand48() % (pool->count - 1);
+	if (b >= a) {
+		b++;
+	}
+
+	if (od_worker_load(&pool->pool[b]) < od_worker_load(&pool->pool[a])) {
+		return b;
+	}
+	return a;
+}
+
+static inline void
+od_worker_pool_feed(od_worker_pool_t *pool,
+		    od_config_worker_placement_t placement, machine_msg_t *msg)
+{
+	uint32_t next;
+	switch (placement) {
+	case OD_CONFIG_WORKER_PLACEMENT_LEAST_LOADED:
+		next = od_worker_pool_next_least_loaded(pool);
+		break;
+	case OD_CONFIG_WORKER_PLACEMENT_P2C:
+		next = od_worker_pool_next_p2c(pool);
+		break;
+	default:
+		next = od_worker_pool_next_round_robin(pool);
+		break;
+	}
+
 	od_worker_t *worker;
 	worker = &pool->pool[next];
+	od_atomic_u32_inc(&worker->pending);
 	machine_channel_write(worker->task_channel, msg);
 }
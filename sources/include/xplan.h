@@ -189,6 +189,14 @@ typedef struct {
 struct od_xplan {
 	/* od_xplan_entry_t[] */
 	mm_vector_t entries;
+
+	/*
+	 * pending deploy query, sent as a simple Query before
+	 * the entries and completed before the first of them
+	 *
+	 * can be NULL, owned by xplan
+	 */
+	machine_msg_t *deploy;
 };
 
 void od_xplan_init(od_xplan_t *xp);
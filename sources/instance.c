@@ -28,6 +28,7 @@
 #include <worker_pool.h>
 #include <system.h>
 #include <extension.h>
+#include <restart_sync.h>
 #include <od_error.h>
 #include <cfg/reader.h>
 #include <cfg/convert.h>
@@ -446,6 +447,7 @@ int od_instance_main(od_instance_t *instance, int argc, char **argv,
 	rc = od_rules_autogenerate_defaults(&router.rules, &instance->logger);
 
 	od_rules_sort_for_matching(&router.rules);
+	od_router_publish_rules(&router);
 
 	if (rc == -1) {
 		goto error;
@@ -562,6 +564,7 @@ int od_instance_main(od_instance_t *instance, int argc, char **argv,
 	machinarium_set_coroutine_cache_size(instance->config.cache_coroutine);
 	machinarium_set_msg_cache_gc_size(instance->config.cache_msg_gc_size);
 	machinarium_set_dns_ttl_ms(instance->config.dns_ttl_ms);
+	machinarium_set_timer_wheel(instance->config.timer_wheel);
 	rc = machinarium_init();
 	if (rc == -1) {
 		od_error(&instance->logger, "init", NULL, NULL,
@@ -569,6 +572,17 @@ int od_instance_main(od_instance_t *instance, int argc, char **argv,
 		goto error;
 	}
 
+	/* keys of client TLS session tickets, shared by workers */
+	if (instance->config.tls_ticket_key_rotation_interval > 0 &&
+	    od_restart_inherit_tls_ticket_keys() != 1) {
+		rc = machine_tls_ticket_keys_rotate();
+		if (rc == -1) {
+			od_error(&instance->logger, "init", NULL, NULL,
+				 "failed to generate tls ticket keys");
+			goto error;
+		}
+	}
+
 	/* create pid file */
 	if (instance->config.pid_file) {
 		rc = od_pid_create(&instance->pid, instance->config.pid_file);
@@ -122,7 +122,8 @@ int od_io_writev(od_io_t *io, struct iovec *iov, int iovcnt,
 {
 	int duplex = flags & OD_IO_WRITE_DUPLEX;
 	mm_io_set_deadline(io->io, timeout_ms);
-	while (iovcnt > 0) {
+	/* compressed io may keep some data buffered after all input is taken */
+	while (iovcnt > 0 || machine_write_pending(io->io)) {
 		ssize_t rc = machine_writev_raw(io->io, iov, iovcnt);
 		if (rc > 0) {
 			struct iovec a = iov_advance(iov, iovcnt, rc);
@@ -138,6 +139,11 @@ int od_io_writev(od_io_t *io, struct iovec *iov, int iovcnt,
 			continue;
 		}
 
+		if (rc == 0 && iovcnt == 0) {
+			/* buffered data is flushed */
+			continue;
+		}
+
 		int errno_ = machine_errno();
 		if (machine_errno_retryable(errno_)) {
 			if (duplex && !mm_io_want_write(io->io)) {
@@ -165,9 +171,41 @@ int od_io_writev(od_io_t *io, struct iovec *iov, int iovcnt,
 	return 0;
 }
 
+/*
+ * released readahead is not acquired until the io is readable,
+ * any other wakeup acquires it too, then the read reports the error
+ */
+static int od_io_wait_readable(od_io_t *io)
+{
+	if (mm_io_read_ready(io->io) || mm_io_read_pending(io->io) > 0) {
+		return 0;
+	}
+
+	int rc = mm_io_wait_deadline(io->io);
+	if (rc == MM_COND_WAIT_FAIL) {
+		/* io wait will set errno to ETIMEDOUT or ECANCELLED */
+		return -1;
+	}
+	if (rc == MM_COND_WAIT_OK_PROPAGATED) {
+		mm_errno_set(EAGAIN);
+		return -1;
+	}
+
+	return 0;
+}
+
 int od_io_read_some(od_io_t *io, uint32_t timeout_ms)
 {
 	mm_io_set_deadline(io->io, timeout_ms);
+	if (od_readahead_released(&io->readahead)) {
+		if (od_io_wait_readable(io) == -1) {
+			return -1;
+		}
+		if (od_io_acquire_readahead(io) == -1) {
+			return -1;
+		}
+	}
+
 	while (1) {
 		struct iovec vec = od_readahead_write_begin(&io->readahead);
 		if (vec.iov_len == 0) {
@@ -203,6 +241,10 @@ int od_io_read_some(od_io_t *io, uint32_t timeout_ms)
 
 int od_io_try_read_some(od_io_t *io)
 {
+	if (od_io_acquire_readahead(io) == -1) {
+		return -1;
+	}
+
 	struct iovec vec = od_readahead_write_begin(&io->readahead);
 	if (vec.iov_len == 0) {
 		if (mm_io_read_pending(io->io)) {
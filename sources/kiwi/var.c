@@ -4,8 +4,301 @@
  * postgreSQL protocol interaction library.
  */
 
+#include <stdatomic.h>
+
 #include <kiwi/kiwi.h>
 
+#define KIWI_VAR_NAME(type, name) [type] = { name, sizeof(name) }
+
+static const struct {
+	char *name;
+	int name_len;
+} kiwi_var_names[KIWI_VAR_MAX] = {
+	KIWI_VAR_NAME(KIWI_VAR_CLIENT_ENCODING, "client_encoding"),
+	KIWI_VAR_NAME(KIWI_VAR_DATESTYLE, "DateStyle"),
+	KIWI_VAR_NAME(KIWI_VAR_TIMEZONE, "TimeZone"),
+	KIWI_VAR_NAME(KIWI_VAR_STANDARD_CONFORMING_STRINGS,
+		      "standard_conforming_strings"),
+	KIWI_VAR_NAME(KIWI_VAR_APPLICATION_NAME, "application_name"),
+	KIWI_VAR_NAME(KIWI_VAR_COMPRESSION, "compression"),
+	KIWI_VAR_NAME(KIWI_VAR_SEARCH_PATH, "search_path"),
+	KIWI_VAR_NAME(KIWI_VAR_STATEMENT_TIMEOUT, "statement_timeout"),
+	KIWI_VAR_NAME(KIWI_VAR_WORK_MEM, "work_mem"),
+	KIWI_VAR_NAME(KIWI_VAR_LOCK_TIMEOUT, "lock_timeout"),
+	KIWI_VAR_NAME(KIWI_VAR_LOG_STATEMENT, "log_statement"),
+	KIWI_VAR_NAME(KIWI_VAR_LOG_MIN_MESSAGES, "log_min_messages"),
+	KIWI_VAR_NAME(KIWI_VAR_LOG_MIN_ERROR_STATEMENT,
+		      "log_min_error_statement"),
+	KIWI_VAR_NAME(KIWI_VAR_LOG_MIN_DURATION_STATEMENT,
+		      "log_min_duration_statement"),
+	KIWI_VAR_NAME(KIWI_VAR_IDLE_IN_TRANSACTION_SESSION_TIMEOUT,
+		      "idle_in_transaction_session_timeout"),
+	KIWI_VAR_NAME(KIWI_VAR_DEFAULT_TABLE_ACCESS_METHOD,
+		      "default_table_access_method"),
+	KIWI_VAR_NAME(KIWI_VAR_DEFAULT_TOAST_COMPRESSION,
+		      "default_toast_compression"),
+	KIWI_VAR_NAME(KIWI_VAR_CHECK_FUNCTION_BODIES, "check_function_bodies"),
+	KIWI_VAR_NAME(KIWI_VAR_DEFAULT_TRANSACTION_ISOLATION,
+		      "default_transaction_isolation"),
+	KIWI_VAR_NAME(KIWI_VAR_DEFAULT_TRANSACTION_READ_ONLY,
+		      "default_transaction_read_only"),
+	KIWI_VAR_NAME(KIWI_VAR_DEFAULT_TRANSACTION_DEFERRABLE,
+		      "default_transaction_deferrable"),
+	KIWI_VAR_NAME(KIWI_VAR_TRANSACTION_ISOLATION, "transaction_isolation"),
+	KIWI_VAR_NAME(KIWI_VAR_TRANSACTION_READ_ONLY, "transaction_read_only"),
+	KIWI_VAR_NAME(KIWI_VAR_IDLE_SESSION_TIMEOUT, "idle_session_timeout"),
+	KIWI_VAR_NAME(KIWI_VAR_IS_HOT_STANDBY, "is_hot_standby"),
+	KIWI_VAR_NAME(KIWI_VAR_ROLE, "role"),
+	KIWI_VAR_NAME(KIWI_VAR_SPQRGUARD_PREVENT_DISTRIBUTED_TABLE_MODIFY,
+		      "spqrguard.prevent_distributed_table_modify"),
+	KIWI_VAR_NAME(KIWI_VAR_SPQRGUARD_PREVENT_REFERENCE_TABLE_MODIFY,
+		      "spqrguard.prevent_reference_table_modify"),
+	KIWI_VAR_NAME(KIWI_VAR_PQ_TEST_PROTOCOL_NEGOTIATION,
+		      "_pq_.test_protocol_negotiation"),
+	KIWI_VAR_NAME(KIWI_VAR_GP_SESSION_ROLE, "gp_session_role"),
+	KIWI_VAR_NAME(KIWI_VAR_ODYSSEY_CATCHUP_TIMEOUT,
+		      "odyssey_catchup_timeout"),
+	/* XXX: todo - also accept aliases */
+	KIWI_VAR_NAME(KIWI_VAR_ODYSSEY_TARGET_SESSION_ATTRS,
+		      "odyssey.target_session_attrs"),
+};
+
+#define KIWI_VAR_INTERNED(value) { value, sizeof(value) }
+
+/*
+ * values reported by most servers and sent by most drivers, stored once
+ * for all clients and servers
+ */
+static const struct {
+	char *value;
+	int value_len;
+} kiwi_var_interned[] = {
+	KIWI_VAR_INTERNED("on"),
+	KIWI_VAR_INTERNED("off"),
+	KIWI_VAR_INTERNED("UTF8"),
+	KIWI_VAR_INTERNED("ISO, MDY"),
+	KIWI_VAR_INTERNED("ISO, DMY"),
+	KIWI_VAR_INTERNED("ISO, YMD"),
+	KIWI_VAR_INTERNED("UTC"),
+	KIWI_VAR_INTERNED("Etc/UTC"),
+	KIWI_VAR_INTERNED("GMT"),
+	KIWI_VAR_INTERNED("Europe/Moscow"),
+	KIWI_VAR_INTERNED("W-SU"),
+	KIWI_VAR_INTERNED("\"$user\", public"),
+	KIWI_VAR_INTERNED("read committed"),
+	KIWI_VAR_INTERNED("0"),
+	KIWI_VAR_INTERNED(""),
+};
+
+static inline char *kiwi_var_intern(const char *value, int value_len)
+{
+	int count = sizeof(kiwi_var_interned) / sizeof(kiwi_var_interned[0]);
+	for (int i = 0; i < count; i++) {
+		if (kiwi_var_interned[i].value_len != value_len) {
+			continue;
+		}
+		if (memcmp(kiwi_var_interned[i].value, value, value_len) == 0) {
+			return kiwi_var_interned[i].value;
+		}
+	}
+	return NULL;
+}
+
+static inline uint64_t kiwi_var_hash(kiwi_var_type_t type, const char *value,
+				     int value_len)
+{
+	/* fnv-1a seeded by type with a final mix */
+	uint64_t hash = 14695981039346656037ULL ^
+			((uint64_t)type * 0x9e3779b97f4a7c15ULL);
+	for (int i = 0; i < value_len; i++) {
+		hash ^= (uint8_t)value[i];
+		hash *= 1099511628211ULL;
+	}
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+static inline int kiwi_vars_entry_equal(const kiwi_vars_entry_t *a,
+					const kiwi_vars_entry_t *b)
+{
+	if (a->hash != b->hash || a->value_len != b->value_len) {
+		return 0;
+	}
+	if (a->value == b->value) {
+		/* same interned value */
+		return 1;
+	}
+	return memcmp(a->value, b->value, a->value_len) == 0;
+}
+
+static inline void kiwi_vars_entry_free_value(kiwi_vars_entry_t *var)
+{
+	if (!var->interned) {
+		free(var->value);
+	}
+	var->value = NULL;
+}
+
+/*
+ * entries are ordered by type, so the hash of the sequence does not
+ * depend on the order of sets, and unlike xor of the var hashes it is
+ * not cancelled out by equal or related values of different vars
+ */
+static inline void kiwi_vars_rehash(kiwi_vars_t *vars)
+{
+	static atomic_uint_fast64_t stamps = 0;
+
+	uint64_t hash = 0;
+	for (int i = 0; i < vars->count; i++) {
+		hash = (hash ^ vars->entries[i].hash) * 0x9e3779b97f4a7c15ULL;
+		hash ^= hash >> 29;
+	}
+	vars->hash = hash;
+
+	uint64_t stamp;
+	stamp = atomic_fetch_add_explicit(&stamps, 1, memory_order_relaxed);
+	vars->stamp = stamp + 1;
+}
+
+/* position of the type var or where it must be inserted */
+static inline int kiwi_vars_position(kiwi_vars_t *vars, kiwi_var_type_t type)
+{
+	int pos = 0;
+	while (pos < vars->count && vars->entries[pos].type < type) {
+		pos++;
+	}
+	return pos;
+}
+
+void kiwi_vars_free(kiwi_vars_t *vars)
+{
+	for (int i = 0; i < vars->count; i++) {
+		kiwi_vars_entry_free_value(&vars->entries[i]);
+	}
+	free(vars->entries);
+	kiwi_vars_init(vars);
+}
+
+kiwi_vars_entry_t *kiwi_vars_get(kiwi_vars_t *vars, kiwi_var_type_t type)
+{
+	for (int i = 0; i < vars->count; i++) {
+		if (vars->entries[i].type == type) {
+			return &vars->entries[i];
+		}
+	}
+	return NULL;
+}
+
+int kiwi_vars_set(kiwi_vars_t *vars, kiwi_var_type_t type, const char *value,
+		  int value_len)
+{
+	if (type >= KIWI_VAR_MAX) {
+		return -1;
+	}
+	if (value_len < 0 || value_len > KIWI_MAX_VAR_SIZE) {
+		return -1;
+	}
+
+	uint64_t hash = kiwi_var_hash(type, value, value_len);
+
+	int pos = kiwi_vars_position(vars, type);
+	int exists = pos < vars->count && vars->entries[pos].type == type;
+	if (exists) {
+		kiwi_vars_entry_t *var = &vars->entries[pos];
+		if (var->hash == hash && var->value_len == value_len &&
+		    memcmp(var->value, value, value_len) == 0) {
+			return 0;
+		}
+	}
+
+	char *copy = kiwi_var_intern(value, value_len);
+	int interned = copy != NULL;
+	if (!interned) {
+		/* terminated even if value is not, for kiwi_enquote() */
+		copy = malloc(value_len + 1);
+		if (copy == NULL) {
+			return -1;
+		}
+		memcpy(copy, value, value_len);
+		copy[value_len] = '\0';
+	}
+
+	if (!exists) {
+		if (vars->count == vars->allocated) {
+			int allocated = vars->allocated * 2;
+			if (allocated == 0) {
+				allocated = 4;
+			}
+			kiwi_vars_entry_t *entries;
+			entries = realloc(vars->entries,
+					  allocated * sizeof(*entries));
+			if (entries == NULL) {
+				if (!interned) {
+					free(copy);
+				}
+				return -1;
+			}
+			vars->entries = entries;
+			vars->allocated = allocated;
+		}
+		memmove(&vars->entries[pos + 1], &vars->entries[pos],
+			(vars->count - pos) * sizeof(kiwi_vars_entry_t));
+		vars->count++;
+
+		kiwi_vars_entry_t *var = &vars->entries[pos];
+		var->type = type;
+		var->name = kiwi_var_names[type].name;
+		var->name_len = kiwi_var_names[type].name_len;
+		var->value = NULL;
+		var->interned = 1;
+		var->hash = 0;
+	}
+
+	kiwi_vars_entry_t *var = &vars->entries[pos];
+	kiwi_vars_entry_free_value(var);
+	var->value = copy;
+	var->value_len = value_len;
+	var->interned = interned;
+	var->hash = hash;
+	kiwi_vars_rehash(vars);
+	return 0;
+}
+
+void kiwi_vars_unset(kiwi_vars_t *vars, kiwi_var_type_t type)
+{
+	int pos = kiwi_vars_position(vars, type);
+	if (pos == vars->count || vars->entries[pos].type != type) {
+		return;
+	}
+
+	kiwi_vars_entry_t *var = &vars->entries[pos];
+	kiwi_vars_entry_free_value(var);
+
+	memmove(&vars->entries[pos], &vars->entries[pos + 1],
+		(vars->count - pos - 1) * sizeof(kiwi_vars_entry_t));
+	vars->count--;
+	kiwi_vars_rehash(vars);
+}
+
+kiwi_var_type_t kiwi_vars_find(kiwi_vars_t *vars, char *name, int name_len)
+{
+	(void)vars;
+
+	kiwi_var_type_t type;
+	type = KIWI_VAR_CLIENT_ENCODING;
+	for (; type < KIWI_VAR_MAX; type++) {
+		if (kiwi_var_names[type].name_len != name_len) {
+			continue;
+		}
+		if (!strncasecmp(kiwi_var_names[type].name, name, name_len)) {
+			return type;
+		}
+	}
+	return KIWI_VAR_UNDEF;
+}
+
 static inline int find_id_end(const char *str, int len, int pos)
 {
 	/*
@@ -93,25 +386,48 @@ static inline int is_safe_param(const char *str, int len)
 	return 1;
 }
 
+int kiwi_vars_equal(kiwi_vars_t *a, kiwi_vars_t *b)
+{
+	/* hash is only a fast check for different sets, it can collide */
+	if (a->hash != b->hash || a->count != b->count) {
+		return 0;
+	}
+	for (int i = 0; i < a->count; i++) {
+		if (a->entries[i].type != b->entries[i].type ||
+		    !kiwi_vars_entry_equal(&a->entries[i], &b->entries[i])) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
 int kiwi_vars_cas(kiwi_vars_t *client, kiwi_vars_t *server, char *query,
 		  int query_len, int smart_enquoting_search_path)
 {
+	/* same set of vars, nothing to deploy */
+	if (kiwi_vars_equal(client, server)) {
+		return 0;
+	}
+
 	int pos = 0;
-	kiwi_var_type_t type;
-	type = KIWI_VAR_CLIENT_ENCODING;
-	for (; type < KIWI_VAR_MAX; type++) {
-		kiwi_var_t *var;
-		var = kiwi_vars_of(client, type);
-		/* we do not support odyssey-to-backend compression yet */
-		if (var->type == KIWI_VAR_UNDEF ||
-		    var->type == KIWI_VAR_COMPRESSION ||
+	int server_pos = 0;
+	for (int i = 0; i < client->count; i++) {
+		kiwi_vars_entry_t *var = &client->entries[i];
+		/* compression is negotiated per connection at startup */
+		if (var->type == KIWI_VAR_COMPRESSION ||
 		    var->type ==
 			    KIWI_VAR_ODYSSEY_TARGET_SESSION_ATTRS /* never deploy this one */) {
 			continue;
 		}
-		kiwi_var_t *server_var;
-		server_var = kiwi_vars_of(server, type);
-		if (kiwi_var_compare(var, server_var)) {
+
+		/* both are ordered by type */
+		while (server_pos < server->count &&
+		       server->entries[server_pos].type < var->type) {
+			server_pos++;
+		}
+		if (server_pos < server->count &&
+		    server->entries[server_pos].type == var->type &&
+		    kiwi_vars_entry_equal(var, &server->entries[server_pos])) {
 			continue;
 		}
 
@@ -7,6 +7,7 @@
 
 #include <odyssey.h>
 
+#include <sched.h>
 #include <syslog.h>
 #include <fcntl.h>
 #include <unistd.h>
@@ -87,6 +88,13 @@ static int have_writev(int fd)
 #endif
 }
 
+static atomic_uint_fast64_t od_logger_generations = 0;
+
+static inline uint64_t od_logger_next_generation(void)
+{
+	return atomic_fetch_add(&od_logger_generations, 1) + 1;
+}
+
 od_retcode_t od_logger_init(od_logger_t *logger, od_pid_t *pid)
 {
 	logger->pid = pid;
@@ -100,14 +108,13 @@ od_retcode_t od_logger_init(od_logger_t *logger, od_pid_t *pid)
 	atomic_init(&logger->batching, 0);
 	atomic_init(&logger->state, OD_LOGGER_OFFLINE);
 
-	memset(&logger->tasks, 0, sizeof(mm_queue_t));
-	logger->slots = NULL;
+	atomic_init(&logger->rings, NULL);
+	logger->ring_size = 0;
+	atomic_init(&logger->generation, od_logger_next_generation());
+	atomic_init(&logger->draining, 0);
 
 	atomic_init(&logger->dropped_lines, 0);
 
-	od_list_init(&logger->free_slots);
-	mm_spinlock_init(&logger->free_slots_lock);
-
 	mm_wait_list_init(&logger->notifier, &logger->state);
 
 	/* set temporary format */
@@ -128,36 +135,15 @@ od_retcode_t od_logger_load(od_logger_t *logger)
 		return NOT_OK_RESPONSE;
 	}
 
-	int rc = mm_queue_init(&logger->tasks, (size_t)logger->queue_depth,
-			       sizeof(od_logger_slot_t *), NULL);
-	if (rc != 0) {
-		return NOT_OK_RESPONSE;
-	}
-
-	logger->slots =
-		od_malloc(logger->queue_depth * sizeof(od_logger_slot_t));
-	if (logger->slots == NULL) {
-		mm_queue_destroy(&logger->tasks);
-		return NOT_OK_RESPONSE;
-	}
-
-	size_t n = (size_t)logger->queue_depth;
-	for (size_t i = 0; i < n; ++i) {
-		od_logger_slot_t *slot = &logger->slots[i];
-		memset(slot, 0, sizeof(od_logger_slot_t));
-		od_list_init(&slot->link);
-
-		od_list_append(&logger->free_slots, &slot->link);
-	}
-	logger->free_slots_count = n;
+	/* rings are created by the threads on the first line */
+	logger->ring_size =
+		(size_t)logger->queue_depth * OD_LOGGER_RING_LINE_SIZE;
 
 	char name[32];
 	od_snprintf(name, sizeof(name), "logger");
 	logger->machine = machine_create(name, od_logger, logger);
 
 	if (logger->machine == -1) {
-		od_free(logger->slots);
-		mm_queue_destroy(&logger->tasks);
 		return NOT_OK_RESPONSE;
 	}
 
@@ -554,8 +540,7 @@ od_logger_format(od_logger_t *logger, od_logger_level_t level, char *context,
 	return dst_pos - output;
 }
 
-static inline void _od_logger_write_batch(od_logger_t *l,
-					  od_logger_slot_t *slots[],
+static inline void _od_logger_write_batch(od_logger_t *l, int *levels,
 					  struct iovec *iovecs, size_t n)
 {
 	int fd = atomic_load(&l->fd);
@@ -580,7 +565,7 @@ static inline void _od_logger_write_batch(od_logger_t *l,
 	}
 	if (l->log_syslog) {
 		for (size_t i = 0; i < n; ++i) {
-			syslog(od_log_syslog_level[slots[i]->level], "%.*s",
+			syslog(od_log_syslog_level[levels[i]], "%.*s",
 			       (int)iovecs[i].iov_len,
 			       (char *)iovecs[i].iov_base);
 		}
@@ -605,6 +590,17 @@ static inline void _od_logger_write(od_logger_t *l, char *data, int len,
 	(void)rc;
 }
 
+static size_t od_logger_pending(od_logger_t *logger)
+{
+	size_t pending = 0;
+	od_logger_ring_t *ring;
+	for (ring = atomic_load(&logger->rings); ring != NULL;
+	     ring = ring->next) {
+		pending += od_logger_ring_pending(ring);
+	}
+	return pending;
+}
+
 static inline void log_machine_stats(od_logger_t *logger)
 {
 	uint64_t count_coroutine = 0;
@@ -620,11 +616,11 @@ static inline void log_machine_stats(od_logger_t *logger)
 	       "logger: msg (%" PRIu64 " allocated, %" PRIu64
 	       " cached, %" PRIu64 " freed, %" PRIu64 " cache_size), "
 	       "coroutines (%" PRIu64 " active, %" PRIu64 " cached), "
-	       "dropped lines %" PRIu64 ", queue size %zu",
+	       "dropped lines %" PRIu64 ", queue size %zu bytes",
 	       msg_allocated, msg_cache_count, msg_cache_gc_count,
 	       msg_cache_size, count_coroutine, count_coroutine_cache,
 	       atomic_load(&logger->dropped_lines),
-	       mm_queue_size(&logger->tasks));
+	       od_logger_pending(logger));
 }
 
 void od_logger_stat(od_logger_t *logger)
@@ -632,28 +628,57 @@ void od_logger_stat(od_logger_t *logger)
 	log_machine_stats(logger);
 }
 
-static void process_log_queue(od_logger_t *logger, od_logger_slot_t **slot_buf,
-			      struct iovec *iovecs, size_t max)
+/* set in the thread, which reads the rings now */
+static OD_THREAD_LOCAL int od_logger_drainer = 0;
+
+/*
+ * returns the number of lines written, or 0 if the other reader is
+ * already here and wait is not set
+ */
+static size_t process_log_queue(od_logger_t *logger, int wait)
 {
-	size_t nmsg = mm_queue_pop_batch(&logger->tasks, slot_buf, max);
+	static struct iovec iovecs[IOV_MAX];
+	static int levels[IOV_MAX];
 
-	if (nmsg == 0) {
-		return;
+	while (atomic_exchange(&logger->draining, 1)) {
+		if (!wait) {
+			return 0;
+		}
+		sched_yield();
 	}
-
-	for (size_t i = 0; i < nmsg; ++i) {
-		iovecs[i].iov_base = slot_buf[i]->text;
-		iovecs[i].iov_len = slot_buf[i]->len;
+	od_logger_drainer = 1;
+
+	size_t total = 0;
+	od_logger_ring_t *ring;
+	for (ring = atomic_load(&logger->rings); ring != NULL;
+	     ring = ring->next) {
+		size_t bytes;
+		size_t n;
+		n = od_logger_ring_peek(ring, iovecs, levels, IOV_MAX, &bytes);
+		if (n > 0) {
+			_od_logger_write_batch(logger, levels, iovecs, n);
+		}
+		od_logger_ring_advance(ring, bytes);
+		total += n;
 	}
 
-	_od_logger_write_batch(logger, slot_buf, iovecs, nmsg);
+	od_logger_drainer = 0;
+	atomic_store(&logger->draining, 0);
+	return total;
+}
 
-	mm_spinlock_lock(&logger->free_slots_lock);
-	for (size_t i = 0; i < nmsg; ++i) {
-		od_list_append(&logger->free_slots, &(slot_buf[i]->link));
+/*
+ * write lines queued so far, the loop is limited as the lines can be
+ * added concurrently
+ */
+static void drain_log_queue(od_logger_t *logger, int wait)
+{
+	size_t tail = od_logger_pending(logger);
+	for (size_t i = 0; i <= tail; ++i) {
+		if (process_log_queue(logger, wait) == 0) {
+			break;
+		}
 	}
-	logger->free_slots_count += nmsg;
-	mm_spinlock_unlock(&logger->free_slots_lock);
 }
 
 static void do_reopen_logfile(od_logger_t *logger)
@@ -676,8 +701,6 @@ static void do_reopen_logfile(od_logger_t *logger)
 static inline void od_logger(void *arg)
 {
 	od_logger_t *logger = arg;
-	static od_logger_slot_t *slot_buf[IOV_MAX];
-	static struct iovec iovecs[IOV_MAX];
 
 	atomic_store(&logger->state, OD_LOGGER_ONLINE);
 
@@ -697,29 +720,15 @@ static inline void od_logger(void *arg)
 			continue;
 		}
 
-		process_log_queue(logger, slot_buf, iovecs, IOV_MAX);
-
-		if (mm_queue_size(&logger->tasks) == 0) {
+		if (process_log_queue(logger, 0) == 0) {
 			mm_wait_list_compare_wait(
 				&logger->notifier, NULL,
 				OD_LOGGER_ONLINE /* still online? */, 500);
 		}
 	}
 
-	/*
-	 * process messages that stays in queue after shutdown
-	 * did not writen smth like plain while (queue size > 0)
-	 * because i want to be sure that this function will return in case
-	 * some bug with state
-	 *
-	 * divide by IOV_MAX because this is max chunk size
-	 * of process_log_queue
-	 */
-	size_t tail = mm_queue_size(&logger->tasks);
-	tail = 2 * ((tail + IOV_MAX - 1) / IOV_MAX);
-	for (size_t i = 0; i < tail && mm_queue_size(&logger->tasks) > 0; ++i) {
-		process_log_queue(logger, slot_buf, iovecs, IOV_MAX);
-	}
+	/* process messages that stays in rings after shutdown */
+	drain_log_queue(logger, 1);
 }
 
 void od_logger_shutdown(od_logger_t *logger)
@@ -734,10 +743,13 @@ void od_logger_flush(od_logger_t *logger)
 		return;
 	}
 
-	static od_logger_slot_t *slot_buf[IOV_MAX];
-	static struct iovec iovecs[IOV_MAX];
+	/* flush from the write path of the reader itself can not wait */
+	if (od_logger_drainer) {
+		return;
+	}
 
-	process_log_queue(logger, slot_buf, iovecs, IOV_MAX);
+	/* the logger machine can be writing right now, wait for it */
+	drain_log_queue(logger, 1);
 }
 
 void od_logger_wait_finish(od_logger_t *logger)
@@ -750,8 +762,17 @@ void od_logger_wait_finish(od_logger_t *logger)
 		abort();
 	}
 	mm_wait_list_destroy(&logger->notifier);
-	mm_queue_destroy(&logger->tasks);
-	od_free(logger->slots);
+
+	/* rings cached by threads are not valid anymore */
+	atomic_store(&logger->generation, od_logger_next_generation());
+
+	od_logger_ring_t *ring = atomic_exchange(&logger->rings, NULL);
+	while (ring != NULL) {
+		od_logger_ring_t *next = ring->next;
+		od_logger_ring_free(ring);
+		od_free(ring);
+		ring = next;
+	}
 }
 
 static char od_logger_json_escape_tab[256] = {
@@ -1019,6 +1040,48 @@ od_logger_format_json(od_logger_t *logger, od_logger_level_t level,
 	return dst - output;
 }
 
+typedef struct {
+	od_logger_t *logger;
+	uint64_t generation;
+	od_logger_ring_t *ring;
+} od_logger_local_t;
+
+static OD_THREAD_LOCAL od_logger_local_t od_logger_local;
+
+/*
+ * rings are freed only when the logger is finished, the generation
+ * check makes a new logger at the same address (or the same logger
+ * loaded again) never use the freed ring
+ */
+static od_logger_ring_t *od_logger_get_ring(od_logger_t *logger)
+{
+	uint64_t generation = atomic_load_explicit(&logger->generation,
+						   memory_order_relaxed);
+	if (od_likely(od_logger_local.logger == logger &&
+		      od_logger_local.generation == generation)) {
+		return od_logger_local.ring;
+	}
+
+	od_logger_ring_t *ring = od_malloc(sizeof(od_logger_ring_t));
+	if (ring == NULL) {
+		return NULL;
+	}
+	if (od_logger_ring_init(ring, logger->ring_size) != OK_RESPONSE) {
+		od_free(ring);
+		return NULL;
+	}
+
+	od_logger_ring_t *head = atomic_load(&logger->rings);
+	do {
+		ring->next = head;
+	} while (!atomic_compare_exchange_weak(&logger->rings, &head, ring));
+
+	od_logger_local.logger = logger;
+	od_logger_local.generation = generation;
+	od_logger_local.ring = ring;
+	return ring;
+}
+
 void od_logger_write(od_logger_t *logger, od_logger_level_t level,
 		     char *context, void *client, void *server, char *fmt,
 		     va_list args)
@@ -1056,9 +1119,7 @@ void od_logger_write(od_logger_t *logger, od_logger_level_t level,
 	}
 
 	int len;
-	char *output;
-	size_t output_max;
-	od_logger_slot_t *async_slot = NULL;
+	od_logger_ring_t *ring = NULL;
 
 	uint64_t state = atomic_load(&logger->state);
 	uint64_t async =
@@ -1069,28 +1130,13 @@ void od_logger_write(od_logger_t *logger, od_logger_level_t level,
 	}
 
 	if (async) {
-		mm_spinlock_lock(&logger->free_slots_lock);
-		if (logger->free_slots_count > 0) {
-			od_list_t *i = od_list_pop(&logger->free_slots);
-			async_slot = od_container_of(i, od_logger_slot_t, link);
-			logger->free_slots_count--;
-		}
-		mm_spinlock_unlock(&logger->free_slots_lock);
-
-		if (async_slot == NULL) {
-			/* silently drop lines for overloaded logger */
-			atomic_fetch_add(&logger->dropped_lines, 1);
-			return;
-		}
-
-		output = async_slot->text;
-		output_max = sizeof(async_slot->text);
-	} else {
-		static OD_THREAD_LOCAL char localoutput[OD_LOGLINE_MAXLEN];
-		output = localoutput;
-		output_max = sizeof(localoutput);
+		ring = od_logger_get_ring(logger);
 	}
 
+	/* lines are formatted here and copied to the ring packed */
+	static OD_THREAD_LOCAL char output[OD_LOGLINE_MAXLEN];
+	size_t output_max = sizeof(output);
+
 	/* Choose formatter based on format type */
 	if (logger->format_type == OD_LOGGER_FORMAT_JSON) {
 		len = od_logger_format_json(logger, level, context, client,
@@ -1101,14 +1147,17 @@ void od_logger_write(od_logger_t *logger, od_logger_level_t level,
 				       fmt, args, output, output_max);
 	}
 
-	if (async_slot) {
-		async_slot->len = (size_t)len;
-		async_slot->text[len] = '\0';
-		async_slot->level = level;
+	if (ring != NULL) {
+		size_t pending;
+		if (od_logger_ring_push(ring, level, output, len, &pending) ==
+		    -1) {
+			/* silently drop lines for overloaded logger */
+			atomic_fetch_add(&logger->dropped_lines, 1);
+			return;
+		}
 
-		int new_size =
-			mm_queue_push_extended(&logger->tasks, &async_slot);
-		if (new_size >= 30) {
+		if (pending / OD_LOGGER_RING_NOTIFY_SIZE !=
+		    (pending + len) / OD_LOGGER_RING_NOTIFY_SIZE) {
 			mm_wait_list_notify(&logger->notifier);
 		}
 	} else {
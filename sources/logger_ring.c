@@ -0,0 +1,114 @@
+/*
+ * Odyssey.
+ *
+ * Scalable PostgreSQL connection pooler.
+ */
+
+#include <odyssey.h>
+
+#include <logger_ring.h>
+#include <od_memory.h>
+
+static inline size_t od_logger_ring_record_size(size_t len)
+{
+	size_t align = sizeof(od_logger_ring_record_t);
+	size_t size = sizeof(od_logger_ring_record_t) + len;
+	return (size + align - 1) & ~(align - 1);
+}
+
+static inline od_logger_ring_record_t *
+od_logger_ring_record(od_logger_ring_t *ring, size_t pos)
+{
+	return (od_logger_ring_record_t *)(ring->buf + (pos & ring->mask));
+}
+
+int od_logger_ring_init(od_logger_ring_t *ring, size_t size)
+{
+	memset(ring, 0, sizeof(od_logger_ring_t));
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->tail, 0);
+
+	size_t capacity = OD_LOGGER_RING_MIN_SIZE;
+	while (capacity < size) {
+		capacity <<= 1;
+	}
+
+	ring->buf = od_malloc(capacity);
+	if (ring->buf == NULL) {
+		return NOT_OK_RESPONSE;
+	}
+	ring->size = capacity;
+	ring->mask = capacity - 1;
+	ring->next = NULL;
+
+	return OK_RESPONSE;
+}
+
+void od_logger_ring_free(od_logger_ring_t *ring)
+{
+	od_free(ring->buf);
+	ring->buf = NULL;
+}
+
+int od_logger_ring_push(od_logger_ring_t *ring, int level, const char *text,
+			size_t len, size_t *pending)
+{
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+	*pending = tail - head;
+
+	size_t need = od_logger_ring_record_size(len);
+	size_t offset = tail & ring->mask;
+	size_t padding = 0;
+	if (offset + need > ring->size) {
+		padding = ring->size - offset;
+	}
+
+	if (od_unlikely(need > ring->size / 2 ||
+			tail + padding + need - head > ring->size)) {
+		return -1;
+	}
+
+	od_logger_ring_record_t *record;
+	if (padding > 0) {
+		record = od_logger_ring_record(ring, tail);
+		record->len = OD_LOGGER_RING_PADDING;
+		tail += padding;
+	}
+
+	record = od_logger_ring_record(ring, tail);
+	record->len = (uint32_t)len;
+	record->level = (uint32_t)level;
+	memcpy(record + 1, text, len);
+
+	atomic_store_explicit(&ring->tail, tail + need, memory_order_release);
+	return 0;
+}
+
+size_t od_logger_ring_peek(od_logger_ring_t *ring, struct iovec *iovecs,
+			   int *levels, size_t max, size_t *bytes)
+{
+	size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+	size_t pos = head;
+	size_t n = 0;
+	while (pos != tail && n < max) {
+		od_logger_ring_record_t *record;
+		record = od_logger_ring_record(ring, pos);
+		if (record->len == OD_LOGGER_RING_PADDING) {
+			pos += ring->size - (pos & ring->mask);
+			continue;
+		}
+
+		iovecs[n].iov_base = record + 1;
+		iovecs[n].iov_len = record->len;
+		levels[n] = (int)record->level;
+		n++;
+
+		pos += od_logger_ring_record_size(record->len);
+	}
+
+	*bytes = pos - head;
+	return n;
+}
@@ -0,0 +1,156 @@
+/*
+ * machinarium.
+ *
+ * Cooperative multitasking engine.
+ */
+
+/*
+ * This example compares chained mm_hashmap_t with open addressing
+ * mm_oahm_t on insert, lookup and remove of prepared statement
+ * like names ("P_0", "P_1", ...).
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <machinarium/machinarium.h>
+#include <machinarium/ds/hm.h>
+#include <machinarium/ds/oahm.h>
+
+#define NAME_LEN 24
+#define ROUNDS 16
+
+typedef char name_t[NAME_LEN];
+
+static mm_hash_t name_hash(const void *key)
+{
+	return mm_xxh64_hash(key, strlen(key), 0);
+}
+
+static int name_cmp(const void *k1, const void *k2)
+{
+	return strcmp(k1, k2);
+}
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(const char *map, const char *op, size_t count,
+		   double elapsed)
+{
+	printf("%-8s %-7s %8zu keys: %12.0f ops/sec\n", map, op, count,
+	       count * ROUNDS / elapsed);
+}
+
+static void benchmark_hashmap(name_t *names, size_t count)
+{
+	mm_hashmap_t *hm = mm_hashmap_create(50, 1, sizeof(name_t),
+					     sizeof(void *), name_cmp,
+					     name_hash, NULL, NULL, NULL);
+	mm_hashmap_keylock_t klock;
+	double insert = 0, lookup = 0, remove = 0, start;
+
+	for (int r = 0; r < ROUNDS; ++r) {
+		start = now();
+		for (size_t i = 0; i < count; ++i) {
+			mm_hashmap_lock_key(hm, &klock, names[i],
+					    MM_HASHMAP_CREATE);
+			mm_hashmap_unlock_key(hm, &klock);
+		}
+		insert += now() - start;
+
+		start = now();
+		for (size_t i = 0; i < count; ++i) {
+			mm_hashmap_lock_key(hm, &klock, names[i], 0);
+			mm_hashmap_unlock_key(hm, &klock);
+		}
+		lookup += now() - start;
+
+		start = now();
+		for (size_t i = 0; i < count; ++i) {
+			mm_hashmap_lock_key(hm, &klock, names[i], 0);
+			mm_hashmap_remove(hm, &klock);
+		}
+		remove += now() - start;
+	}
+
+	report("hashmap", "insert", count, insert);
+	report("hashmap", "lookup", count, lookup);
+	report("hashmap", "remove", count, remove);
+
+	mm_hashmap_free(hm);
+}
+
+static void benchmark_oahm(name_t *names, size_t count)
+{
+	mm_oahm_t *hm = mm_oahm_create(sizeof(name_t), sizeof(void *),
+				       name_cmp, name_hash, NULL, NULL, NULL);
+	double insert = 0, lookup = 0, remove = 0, start;
+	int found;
+
+	for (int r = 0; r < ROUNDS; ++r) {
+		start = now();
+		for (size_t i = 0; i < count; ++i) {
+			mm_oahm_insert(hm, names[i], &found);
+		}
+		insert += now() - start;
+
+		start = now();
+		for (size_t i = 0; i < count; ++i) {
+			mm_oahm_get(hm, names[i]);
+		}
+		lookup += now() - start;
+
+		start = now();
+		for (size_t i = 0; i < count; ++i) {
+			mm_oahm_remove(hm, names[i]);
+		}
+		remove += now() - start;
+	}
+
+	report("oahm", "insert", count, insert);
+	report("oahm", "lookup", count, lookup);
+	report("oahm", "remove", count, remove);
+
+	mm_oahm_free(hm);
+}
+
+static void benchmark_runner(void *arg)
+{
+	(void)arg;
+
+	static const size_t counts[] = { 4, 64, 1024, 16384 };
+
+	printf("benchmark started.\n");
+
+	for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+		size_t count = counts[c];
+		name_t *names = malloc(count * sizeof(name_t));
+		for (size_t i = 0; i < count; ++i) {
+			snprintf(names[i], NAME_LEN, "P_%zu", i);
+		}
+
+		benchmark_hashmap(names, count);
+		benchmark_oahm(names, count);
+		printf("\n");
+
+		free(names);
+	}
+
+	printf("done.\n");
+}
+
+int main(int argc, char *argv[])
+{
+	machinarium_init();
+	int id = machine_create("benchmark_hashmap", benchmark_runner, NULL);
+	int rc = machine_wait(id);
+	printf("retcode from machine wait %d.\n", rc);
+	machinarium_free();
+	return 0;
+}
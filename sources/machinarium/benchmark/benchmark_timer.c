@@ -0,0 +1,107 @@
+/*
+ * machinarium.
+ *
+ * Cooperative multitasking engine.
+ */
+
+/*
+ * This example compares heap and timing wheel clocks on timer churn:
+ * every client has a timer armed for its io wait, the wait completes
+ * before the timeout and the timer is armed again for the next one.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <machinarium/machinarium.h>
+#include <machinarium/clock.h>
+
+#define ROUNDS 64
+
+typedef struct {
+	mm_timer_t timer;
+	int fired;
+} client_t;
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void on_timeout(mm_timer_t *timer)
+{
+	client_t *client = timer->arg;
+	client->fired++;
+}
+
+static void benchmark_clock(const char *name, int wheel, client_t *clients,
+			    size_t count)
+{
+	mm_clock_t clock;
+	mm_clock_init(&clock, wheel);
+	clock.time_ms = 1000;
+	clock.time_cached = 1;
+
+	/* io timeouts from 1 to 60 seconds */
+	for (size_t i = 0; i < count; ++i) {
+		uint32_t interval = 1000 + rand() % 59000;
+		mm_timer_init(&clients[i].timer, on_timeout, &clients[i],
+			      interval);
+		clients[i].fired = 0;
+		mm_clock_timer_add(&clock, &clients[i].timer);
+	}
+
+	size_t ops = 0;
+	double start = now();
+	for (int r = 0; r < ROUNDS; ++r) {
+		for (size_t i = 0; i < count; ++i) {
+			mm_timer_stop(&clients[i].timer);
+			mm_clock_timer_add(&clock, &clients[i].timer);
+			ops++;
+		}
+
+		/* one loop iteration, nothing is due yet */
+		clock.time_ms++;
+		uint64_t next;
+		mm_clock_timer_next(&clock, &next);
+		mm_clock_step(&clock);
+	}
+	double elapsed = now() - start;
+
+	for (size_t i = 0; i < count; ++i) {
+		mm_timer_stop(&clients[i].timer);
+	}
+	mm_clock_free(&clock);
+
+	printf("%-6s %8zu timers: %12.0f rearms/sec\n", name, count,
+	       ops / elapsed);
+}
+
+int main(int argc, char *argv[])
+{
+	(void)argc;
+	(void)argv;
+
+	static const size_t counts[] = { 1024, 16384, 65536, 262144 };
+
+	printf("benchmark started.\n");
+
+	for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+		size_t count = counts[c];
+		client_t *clients = malloc(count * sizeof(client_t));
+
+		srand(count);
+		benchmark_clock("heap", 0, clients, count);
+		srand(count);
+		benchmark_clock("wheel", 1, clients, count);
+		printf("\n");
+
+		free(clients);
+	}
+
+	printf("done.\n");
+	return 0;
+}
@@ -11,6 +11,7 @@
 #include <machinarium/machinarium.h>
 #include <machinarium/timer.h>
 #include <machinarium/clock.h>
+#include <machinarium/memory.h>
 
 static int mm_clock_cmp(const mm_heap_node_t *aa, const mm_heap_node_t *bb)
 {
@@ -28,9 +29,17 @@ static int mm_clock_cmp(const mm_heap_node_t *aa, const mm_heap_node_t *bb)
 	return a->seq < b->seq;
 }
 
-void mm_clock_init(mm_clock_t *clock)
+int mm_clock_init(mm_clock_t *clock, int wheel)
 {
 	mm_heap_init(&clock->timers, mm_clock_cmp);
+	clock->wheel = NULL;
+	if (wheel) {
+		clock->wheel = mm_malloc(sizeof(mm_timer_wheel_t));
+		if (clock->wheel == NULL) {
+			return -1;
+		}
+		mm_timer_wheel_init(clock->wheel);
+	}
 	clock->timers_seq = 0;
 	clock->active = 0;
 	clock->time_ms = 0;
@@ -38,11 +47,15 @@ void mm_clock_init(mm_clock_t *clock)
 	clock->time_us = 0;
 	clock->time_sec = 0;
 	clock->time_cached = 0;
+	return 0;
 }
 
 void mm_clock_free(mm_clock_t *clock)
 {
-	(void)clock;
+	if (clock->wheel != NULL) {
+		mm_free(clock->wheel);
+		clock->wheel = NULL;
+	}
 }
 
 int mm_clock_timer_add(mm_clock_t *clock, mm_timer_t *timer)
@@ -52,6 +65,11 @@ int mm_clock_timer_add(mm_clock_t *clock, mm_timer_t *timer)
 	timer->active = 1;
 	timer->clock = clock;
 
+	if (clock->wheel != NULL) {
+		mm_timer_wheel_add(clock->wheel, timer, clock->time_ms);
+		return 0;
+	}
+
 	mm_heap_push(&clock->timers, &timer->heap);
 
 	return 0;
@@ -63,25 +81,38 @@ int mm_clock_timer_del(mm_clock_t *clock, mm_timer_t *timer)
 		return -1;
 	}
 
-	mm_heap_remove(&clock->timers, &timer->heap);
+	if (clock->wheel != NULL) {
+		mm_timer_wheel_del(clock->wheel, timer);
+	} else {
+		mm_heap_remove(&clock->timers, &timer->heap);
+	}
 
 	timer->active = 0;
 
 	return 0;
 }
 
-mm_timer_t *mm_clock_timer_min(mm_clock_t *clock)
+int mm_clock_timer_next(mm_clock_t *clock, uint64_t *timeout)
 {
-	mm_heap_node_t *m = mm_heap_min(&clock->timers);
-	if (m != NULL) {
-		return mm_container_of(m, mm_timer_t, heap);
+	if (clock->wheel != NULL) {
+		return mm_timer_wheel_next(clock->wheel, timeout);
 	}
 
-	return NULL;
+	mm_heap_node_t *m = mm_heap_min(&clock->timers);
+	if (m == NULL) {
+		return -1;
+	}
+	*timeout = mm_container_of(m, mm_timer_t, heap)->timeout;
+	return 0;
 }
 
 void mm_clock_step(mm_clock_t *clock)
 {
+	if (clock->wheel != NULL) {
+		mm_timer_wheel_step(clock->wheel, clock->time_ms);
+		return;
+	}
+
 	while (1) {
 		mm_heap_node_t *n = mm_heap_min(&clock->timers);
 		if (n == NULL) {
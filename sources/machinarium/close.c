@@ -10,6 +10,7 @@
 #include <machinarium/machinarium.h>
 #include <machinarium/io.h>
 #include <machinarium/machine.h>
+#include <machinarium/tls.h>
 
 int mm_io_close(mm_io_t *obj)
 {
@@ -21,6 +22,7 @@ int mm_io_close(mm_io_t *obj)
 	if (io->attached) {
 		mm_io_detach(obj);
 	}
+	mm_tls_shutdown(io);
 	int rc;
 	rc = close(io->fd);
 	if (rc == -1) {
@@ -18,21 +18,20 @@ void mm_compression_free(mm_io_t *io)
 	}
 }
 
-int mm_compression_writev(mm_io_t *io, struct iovec *iov, int n,
+int mm_compression_writev(mm_io_t *io, const struct iovec *iov, int n,
 			  size_t *processed)
 {
-	int size = mm_iov_size_of(iov, n);
-	char *buffer = mm_malloc(size);
-	if (buffer == NULL) {
-		errno = ENOMEM;
+	/* segments are compressed in place, stream keeps its own tx buffer */
+	return mm_zpq_writev(io->zpq_stream, iov, n, processed);
+}
+
+int mm_compression_stats(mm_io_t *io, mm_zpq_stats_t *stats)
+{
+	if (io->zpq_stream == NULL) {
 		return -1;
 	}
-	mm_iovcpy(buffer, iov, n);
-
-	int rc;
-	rc = mm_zpq_write(io->zpq_stream, buffer, size, processed);
-	mm_free(buffer);
-	return rc;
+	mm_zpq_stats(io->zpq_stream, stats);
+	return 0;
 }
 
 /* Returns value > 0 when there is read operation pending. */
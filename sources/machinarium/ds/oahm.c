@@ -0,0 +1,429 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <machinarium/macro.h>
+#include <machinarium/ds/oahm.h>
+#include <machinarium/memory.h>
+
+#define MM_OAHM_MIN_CAPACITY 8
+
+/* slots of the old table moved by every insert or remove */
+#define MM_OAHM_MOVE_STEP 16
+
+static inline size_t align8(size_t sz)
+{
+	return (sz + 7) & ~(size_t)7;
+}
+
+static inline uint8_t ctrl_of(mm_hash_t hash)
+{
+	return 0x80 | (uint8_t)(hash >> 57);
+}
+
+static inline int ctrl_is_full(uint8_t ctrl)
+{
+	return (ctrl & 0x80) != 0;
+}
+
+static inline uint8_t *slot_at(const mm_oahm_t *hm, const mm_oahm_table_t *t,
+			       size_t idx)
+{
+	return t->slots + idx * hm->slotsz;
+}
+
+static inline mm_hash_t slot_hash(const uint8_t *slot)
+{
+	mm_hash_t hash;
+	memcpy(&hash, slot, sizeof(mm_hash_t));
+	return hash;
+}
+
+static inline void *slot_key(const mm_oahm_t *hm, uint8_t *slot)
+{
+	return slot + hm->keyoff;
+}
+
+static inline void *slot_val(const mm_oahm_t *hm, uint8_t *slot)
+{
+	return slot + hm->valoff;
+}
+
+static int table_alloc(const mm_oahm_t *hm, mm_oahm_table_t *t,
+		       size_t capacity)
+{
+	t->ctrl = mm_malloc(capacity);
+	if (t->ctrl == NULL) {
+		return -1;
+	}
+	t->slots = mm_malloc(capacity * hm->slotsz);
+	if (t->slots == NULL) {
+		mm_free(t->ctrl);
+		t->ctrl = NULL;
+		return -1;
+	}
+	memset(t->ctrl, MM_OAHM_CTRL_EMPTY, capacity);
+	t->capacity = capacity;
+	t->used = 0;
+	return 0;
+}
+
+static void table_free(mm_oahm_table_t *t)
+{
+	if (t->capacity != 0) {
+		mm_free(t->ctrl);
+		mm_free(t->slots);
+	}
+	memset(t, 0, sizeof(mm_oahm_table_t));
+}
+
+static uint8_t *table_find(mm_oahm_t *hm, mm_oahm_table_t *t, mm_hash_t hash,
+			   const void *key, size_t *idx_ptr)
+{
+	if (t->capacity == 0) {
+		return NULL;
+	}
+
+	size_t mask = t->capacity - 1;
+	uint8_t ctrl = ctrl_of(hash);
+	size_t idx = hash & mask;
+
+	for (size_t probe = 0; probe < t->capacity; ++probe) {
+		uint8_t c = t->ctrl[idx];
+		if (c == MM_OAHM_CTRL_EMPTY) {
+			return NULL;
+		}
+
+		if (c == ctrl) {
+			uint8_t *slot = slot_at(hm, t, idx);
+			if (slot_hash(slot) == hash &&
+			    hm->kcmp(slot_key(hm, slot), key) == 0) {
+				*idx_ptr = idx;
+				return slot;
+			}
+		}
+
+		idx = (idx + 1) & mask;
+	}
+
+	return NULL;
+}
+
+/* caller guarantees there is a free slot */
+static uint8_t *table_place(mm_oahm_t *hm, mm_oahm_table_t *t,
+			    mm_hash_t hash)
+{
+	size_t mask = t->capacity - 1;
+	size_t idx = hash & mask;
+
+	while (ctrl_is_full(t->ctrl[idx])) {
+		idx = (idx + 1) & mask;
+	}
+
+	if (t->ctrl[idx] == MM_OAHM_CTRL_EMPTY) {
+		t->used++;
+	}
+	t->ctrl[idx] = ctrl_of(hash);
+
+	return slot_at(hm, t, idx);
+}
+
+static uint8_t *find(mm_oahm_t *hm, mm_hash_t hash, const void *key,
+		     mm_oahm_table_t **table_ptr, size_t *idx_ptr)
+{
+	uint8_t *slot = table_find(hm, &hm->table, hash, key, idx_ptr);
+	if (slot != NULL) {
+		*table_ptr = &hm->table;
+		return slot;
+	}
+
+	slot = table_find(hm, &hm->old, hash, key, idx_ptr);
+	if (slot != NULL) {
+		*table_ptr = &hm->old;
+	}
+	return slot;
+}
+
+static size_t capacity_for(size_t count)
+{
+	size_t capacity = MM_OAHM_MIN_CAPACITY;
+	while (capacity < (count + 1) * 2) {
+		capacity *= 2;
+	}
+	return capacity;
+}
+
+static int grow(mm_oahm_t *hm)
+{
+	/* count includes the entries of the old table, which are not moved */
+	mm_oahm_table_t table;
+	if (table_alloc(hm, &table, capacity_for(hm->count)) == -1) {
+		return -1;
+	}
+
+	if (hm->old.capacity == 0) {
+		/* entries of the current table will be moved later */
+		hm->old = hm->table;
+		hm->old_pos = 0;
+		hm->old_count = hm->count;
+		hm->table = table;
+		return 0;
+	}
+
+	/*
+	 * previous resize is not finished yet (a lot of removed entries),
+	 * move everything at once
+	 */
+	mm_oahm_table_t *tables[2] = { &hm->table, &hm->old };
+	for (int t = 0; t < 2; ++t) {
+		for (size_t idx = 0; idx < tables[t]->capacity; ++idx) {
+			if (!ctrl_is_full(tables[t]->ctrl[idx])) {
+				continue;
+			}
+			uint8_t *src = slot_at(hm, tables[t], idx);
+			uint8_t *dst = table_place(hm, &table, slot_hash(src));
+			memcpy(dst, src, hm->slotsz);
+		}
+		table_free(tables[t]);
+	}
+
+	hm->old_pos = 0;
+	hm->old_count = 0;
+	hm->table = table;
+	return 0;
+}
+
+/*
+ * keep load factor under 3/4, deleted slots are counted too, as well as
+ * the entries of the old table, which are going to be moved here
+ */
+static inline int table_has_room(const mm_oahm_t *hm, size_t n)
+{
+	return (hm->table.used + hm->old_count + n) * 4 <=
+	       hm->table.capacity * 3;
+}
+
+static int move_old(mm_oahm_t *hm, size_t count)
+{
+	mm_oahm_table_t *old = &hm->old;
+	if (old->capacity == 0) {
+		return 0;
+	}
+
+	while (count-- > 0 && hm->old_pos < old->capacity) {
+		size_t idx = hm->old_pos++;
+		if (!ctrl_is_full(old->ctrl[idx])) {
+			continue;
+		}
+
+		/* never place into the overloaded table, move all at once */
+		if (!table_has_room(hm, 0)) {
+			hm->old_pos--;
+			return grow(hm);
+		}
+
+		uint8_t *src = slot_at(hm, old, idx);
+		uint8_t *dst = table_place(hm, &hm->table, slot_hash(src));
+		memcpy(dst, src, hm->slotsz);
+
+		/* keep probe sequences of the old table */
+		old->ctrl[idx] = MM_OAHM_CTRL_DELETED;
+		hm->old_count--;
+	}
+
+	if (hm->old_pos == old->capacity) {
+		table_free(old);
+		hm->old_pos = 0;
+		hm->old_count = 0;
+	}
+
+	return 0;
+}
+
+mm_oahm_t *mm_oahm_create(size_t keysz, size_t valsz, mm_hm_key_cmp_fn kcmp,
+			  mm_hm_key_hash_fn khash, mm_hm_key_dtor_fn kdtor,
+			  mm_hm_value_dtor_fn vdtor, mm_hm_key_copy_fn kcopy)
+{
+	mm_oahm_t *hm = mm_malloc(sizeof(mm_oahm_t));
+	if (hm == NULL) {
+		return NULL;
+	}
+	memset(hm, 0, sizeof(mm_oahm_t));
+
+	hm->keysz = keysz;
+	hm->valsz = valsz;
+	hm->kcmp = kcmp;
+	hm->khash = khash;
+	hm->kdtor = kdtor;
+	hm->vdtor = vdtor;
+	hm->kcopy = kcopy;
+
+	/* slot is hash, key and value, all 8-byte aligned */
+	hm->keyoff = sizeof(mm_hash_t);
+	hm->valoff = align8(hm->keyoff + keysz);
+	hm->slotsz = align8(hm->valoff + valsz);
+
+	return hm;
+}
+
+static void slot_free(mm_oahm_t *hm, uint8_t *slot)
+{
+	if (hm->kdtor != NULL) {
+		hm->kdtor(slot_key(hm, slot));
+	}
+
+	if (hm->vdtor != NULL) {
+		hm->vdtor(slot_val(hm, slot));
+	}
+}
+
+static void table_clear(mm_oahm_t *hm, mm_oahm_table_t *t)
+{
+	for (size_t idx = 0; idx < t->capacity; ++idx) {
+		if (ctrl_is_full(t->ctrl[idx])) {
+			slot_free(hm, slot_at(hm, t, idx));
+		}
+	}
+
+	table_free(t);
+}
+
+void mm_oahm_clear(mm_oahm_t *hm)
+{
+	/* tables are released, so emptied map costs nothing */
+	table_clear(hm, &hm->table);
+	table_clear(hm, &hm->old);
+	hm->old_pos = 0;
+	hm->old_count = 0;
+	hm->count = 0;
+}
+
+void mm_oahm_free(mm_oahm_t *hm)
+{
+	if (hm == NULL) {
+		return;
+	}
+
+	mm_oahm_clear(hm);
+	mm_free(hm);
+}
+
+static int table_foreach(mm_oahm_t *hm, mm_oahm_table_t *t, mm_oahm_cb_fn cb,
+			 void **argv)
+{
+	for (size_t idx = 0; idx < t->capacity; ++idx) {
+		if (!ctrl_is_full(t->ctrl[idx])) {
+			continue;
+		}
+
+		uint8_t *slot = slot_at(hm, t, idx);
+		int rc = cb(hm, slot_key(hm, slot), slot_val(hm, slot), argv);
+		if (rc != 0) {
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
+int mm_oahm_foreach(mm_oahm_t *hm, mm_oahm_cb_fn cb, void **argv)
+{
+	int rc = table_foreach(hm, &hm->table, cb, argv);
+	if (rc != 0) {
+		return rc;
+	}
+
+	return table_foreach(hm, &hm->old, cb, argv);
+}
+
+void *mm_oahm_get(mm_oahm_t *hm, const void *key)
+{
+	if (hm->count == 0) {
+		return NULL;
+	}
+
+	mm_oahm_table_t *t;
+	size_t idx;
+	uint8_t *slot = find(hm, hm->khash(key), key, &t, &idx);
+	if (slot == NULL) {
+		return NULL;
+	}
+
+	return slot_val(hm, slot);
+}
+
+void *mm_oahm_insert(mm_oahm_t *hm, const void *key, int *found)
+{
+	mm_hash_t hash = hm->khash(key);
+
+	if (move_old(hm, MM_OAHM_MOVE_STEP) == -1) {
+		return NULL;
+	}
+
+	mm_oahm_table_t *t;
+	size_t idx;
+	uint8_t *slot = find(hm, hash, key, &t, &idx);
+	if (slot != NULL) {
+		*found = 1;
+		return slot_val(hm, slot);
+	}
+	*found = 0;
+
+	if (!table_has_room(hm, 1)) {
+		if (grow(hm) == -1) {
+			return NULL;
+		}
+	}
+
+	slot = table_place(hm, &hm->table, hash);
+	memcpy(slot, &hash, sizeof(mm_hash_t));
+
+	void *skey = slot_key(hm, slot);
+	if (hm->kcopy != NULL) {
+		if (hm->kcopy(skey, key) != 0) {
+			size_t pidx = (slot - hm->table.slots) / hm->slotsz;
+			hm->table.ctrl[pidx] = MM_OAHM_CTRL_DELETED;
+			return NULL;
+		}
+	} else {
+		memcpy(skey, key, hm->keysz);
+	}
+
+	void *val = slot_val(hm, slot);
+	memset(val, 0, hm->valsz);
+	hm->count++;
+
+	return val;
+}
+
+int mm_oahm_remove(mm_oahm_t *hm, const void *key)
+{
+	if (hm->count == 0) {
+		return 0;
+	}
+
+	mm_hash_t hash = hm->khash(key);
+
+	/* the move is retried by the next call if the table can not grow */
+	(void)move_old(hm, MM_OAHM_MOVE_STEP);
+
+	mm_oahm_table_t *t;
+	size_t idx;
+	uint8_t *slot = find(hm, hash, key, &t, &idx);
+	if (slot == NULL) {
+		return 0;
+	}
+
+	slot_free(hm, slot);
+	t->ctrl[idx] = MM_OAHM_CTRL_DELETED;
+	if (t == &hm->old) {
+		hm->old_count--;
+	}
+	hm->count--;
+
+	if (hm->count == 0) {
+		mm_oahm_clear(hm);
+	}
+
+	return 1;
+}
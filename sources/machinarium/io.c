@@ -64,6 +64,8 @@ MACHINE_API machine_tls_t *machine_tls_create(void)
 	tls->ca_file = NULL;
 	tls->cert_file = NULL;
 	tls->key_file = NULL;
+	tls->session_cache = NULL;
+	tls->session_key = NULL;
 	return (machine_tls_t *)tls;
 }
 
@@ -89,6 +91,9 @@ MACHINE_API void machine_tls_free(machine_tls_t *obj)
 	if (tls->key_file) {
 		mm_free(tls->key_file);
 	}
+	if (tls->session_key) {
+		mm_free(tls->session_key);
+	}
 	mm_free(tls);
 }
 
@@ -203,6 +208,26 @@ MACHINE_API int machine_tls_set_key_file(machine_tls_t *obj, char *path)
 	return 0;
 }
 
+MACHINE_API int
+machine_tls_set_session_cache(machine_tls_t *obj,
+			      machine_tls_session_cache_t *cache,
+			      const char *key)
+{
+	mm_tls_t *tls = mm_cast(mm_tls_t *, obj);
+	mm_errno_set(0);
+	char *string = mm_strdup(key);
+	if (string == NULL) {
+		mm_errno_set(ENOMEM);
+		return -1;
+	}
+	if (tls->session_key) {
+		mm_free(tls->session_key);
+	}
+	tls->session_key = string;
+	tls->session_cache = mm_cast(mm_tls_session_cache_t *, cache);
+	return 0;
+}
+
 int mm_io_set_tls(mm_io_t *io, machine_tls_t *tls, uint32_t timeout)
 {
 	if (io->tls) {
@@ -218,18 +243,37 @@ int mm_io_is_tls(mm_io_t *io)
 	return io->tls != NULL;
 }
 
-int mm_io_set_compression(mm_io_t *io, char algorithm)
+int mm_io_is_tls_resumed(mm_io_t *io)
+{
+	return io->tls_ssl != NULL && SSL_session_reused(io->tls_ssl);
+}
+
+int mm_io_set_compression(mm_io_t *io, char algorithm, int level,
+			  size_t buffer_size, char *rx_data, size_t rx_size)
 {
 	if (io->zpq_stream) {
 		mm_errno_set(EINPROGRESS);
 		return -1;
 	}
 
+	if (buffer_size == 0) {
+		buffer_size = MM_ZPQ_DEFAULT_BUFFER_SIZE;
+	}
+	if (rx_size >= buffer_size) {
+		mm_errno_set(EINVAL);
+		return -1;
+	}
+
 	int impl = mm_zpq_get_algorithm_impl(algorithm);
 	if (impl >= 0) {
-		io->zpq_stream =
-			zpq_create(impl, (mm_zpq_tx_func)mm_io_write,
-				   (mm_zpq_rx_func)mm_io_read, io, NULL, 0);
+		io->zpq_stream = zpq_create(impl, level, buffer_size,
+					    (mm_zpq_tx_func)mm_io_write,
+					    (mm_zpq_rx_func)mm_io_read, io,
+					    rx_data, rx_size);
+		if (io->zpq_stream == NULL) {
+			mm_errno_set(ENOMEM);
+			return -1;
+		}
 		return 0;
 	}
 	return -1;
@@ -7,6 +7,7 @@
 
 #include <machinarium/machinarium.h>
 #include <machinarium/loop.h>
+#include <machinarium/mm.h>
 
 #if defined(__linux__)
 #include <machinarium/epoll.h>
@@ -19,15 +20,28 @@
 #error "machinarium: unsupported platform, no poll backend available"
 #endif
 
+static inline uint64_t mm_loop_time_us(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * (uint64_t)1000000 + t.tv_nsec / 1000;
+}
+
 int mm_loop_init(mm_loop_t *loop)
 {
 	loop->poll = MM_POLL_IF.create();
 	if (loop->poll == NULL) {
 		return -1;
 	}
-	mm_clock_init(&loop->clock);
+	if (mm_clock_init(&loop->clock, machinarium.config.timer_wheel) == -1) {
+		loop->poll->iface->free(loop->poll);
+		return -1;
+	}
 	mm_clock_update(&loop->clock);
 	memset(&loop->idle, 0, sizeof(loop->idle));
+	atomic_init(&loop->load.busy_us, 0);
+	atomic_init(&loop->load.ready, 0);
+	loop->load.poll_end_us = mm_loop_time_us();
 	return 0;
 }
 
@@ -66,10 +80,9 @@ int mm_loop_step(mm_loop_t *loop)
 	 this will not create cpu load
 	*/
 	int timeout_ms = 1000;
-	mm_timer_t *next;
-	next = mm_clock_timer_min(&loop->clock);
-	if (next) {
-		int64_t diff = next->timeout - loop->clock.time_ms;
+	uint64_t next;
+	if (mm_clock_timer_next(&loop->clock, &next) == 0) {
+		int64_t diff = next - loop->clock.time_ms;
 		if (diff <= 0) {
 			timeout_ms = 0;
 		} else {
@@ -80,8 +93,19 @@ int mm_loop_step(mm_loop_t *loop)
 	/* run timers */
 	mm_clock_step(&loop->clock);
 
+	/* everything since the last poll return is busy time */
+	machine_load_t *load = &loop->load;
+	uint64_t poll_start_us = mm_loop_time_us();
+	atomic_fetch_add_explicit(&load->busy_us,
+				  poll_start_us - load->poll_end_us,
+				  memory_order_relaxed);
+
 	/* poll for events */
 	rc = loop->poll->iface->step(loop->poll, timeout_ms);
+
+	load->poll_end_us = mm_loop_time_us();
+	atomic_store_explicit(&load->ready, rc > 0 ? rc : 0,
+			      memory_order_relaxed);
 	if (rc == -1) {
 		return -1;
 	}
@@ -499,6 +499,21 @@ machine_stat(uint64_t *coroutine_count, uint64_t *coroutine_cache_count,
 			 msg_cache_count, msg_cache_size);
 }
 
+MACHINE_API machine_load_t *machine_load_self(void)
+{
+	return &mm_self->loop.load;
+}
+
+MACHINE_API uint64_t machine_load_busy_us(machine_load_t *load)
+{
+	return atomic_load_explicit(&load->busy_us, memory_order_relaxed);
+}
+
+MACHINE_API uint32_t machine_load_ready(machine_load_t *load)
+{
+	return atomic_load_explicit(&load->ready, memory_order_relaxed);
+}
+
 void mm_machine_atexit(void (*fun)(void *), void *arg)
 {
 	mm_machine_t *s = mm_self;
@@ -16,6 +16,7 @@ static int machinarium_coroutine_cache_size = 0;
 static int machinarium_msg_cache_gc_size = 0;
 static int machinarium_initialized = 0;
 static int machinarium_dns_ttl_ms = -1;
+static int machinarium_timer_wheel = 0;
 mm_t machinarium;
 
 static inline size_t machinarium_page_size(void)
@@ -53,6 +54,11 @@ MACHINE_API void machinarium_set_dns_ttl_ms(int ttl_ms)
 	machinarium_dns_ttl_ms = ttl_ms;
 }
 
+MACHINE_API void machinarium_set_timer_wheel(int enable)
+{
+	machinarium_timer_wheel = enable;
+}
+
 MACHINE_API int machinarium_init(void)
 {
 	if (machinarium_initialized) {
@@ -83,9 +89,11 @@ MACHINE_API int machinarium_init(void)
 		machinarium_coroutine_cache_size;
 	machinarium.config.msg_cache_gc_size = machinarium_msg_cache_gc_size;
 	machinarium.config.dns_ttl_ms = machinarium_dns_ttl_ms;
+	machinarium.config.timer_wheel = machinarium_timer_wheel;
 
 	mm_machinemgr_init(&machinarium.machine_mgr);
 	mm_tls_engine_init();
+	mm_tls_ticket_keys_init(&machinarium.tls_ticket_keys);
 	mm_taskmgr_init(&machinarium.task_mgr);
 	mm_taskmgr_start(&machinarium.task_mgr, machinarium.config.pool_size,
 			 machinarium.config.dns_ttl_ms);
@@ -100,6 +108,7 @@ MACHINE_API void machinarium_free(void)
 	}
 	mm_taskmgr_stop(&machinarium.task_mgr);
 	mm_machinemgr_free(&machinarium.machine_mgr);
+	mm_tls_ticket_keys_free(&machinarium.tls_ticket_keys);
 	mm_tls_engine_free();
 	machinarium_initialized = 0;
 }
@@ -0,0 +1,245 @@
+
+/*
+ * machinarium.
+ *
+ * cooperative multitasking engine.
+ */
+
+#include <string.h>
+
+#include <machinarium/machinarium.h>
+#include <machinarium/timer_wheel.h>
+
+static inline void mm_timer_wheel_bit_set(mm_timer_wheel_level_t *level,
+					  int slot)
+{
+	level->bitmap[slot >> 6] |= 1ULL << (slot & 63);
+}
+
+static inline void mm_timer_wheel_bit_clear(mm_timer_wheel_level_t *level,
+					    int slot)
+{
+	level->bitmap[slot >> 6] &= ~(1ULL << (slot & 63));
+}
+
+static inline int mm_timer_wheel_bit_isset(mm_timer_wheel_level_t *level,
+					   int slot)
+{
+	return (level->bitmap[slot >> 6] >> (slot & 63)) & 1;
+}
+
+/* first non-empty slot starting from the one given or -1 */
+static inline int mm_timer_wheel_find(mm_timer_wheel_level_t *level,
+				      int from)
+{
+	for (int word = from >> 6; word < MM_TIMER_WHEEL_SLOTS / 64; word++) {
+		uint64_t bits = level->bitmap[word];
+		if (word == from >> 6) {
+			bits &= ~0ULL << (from & 63);
+		}
+		while (bits != 0) {
+			int slot = word * 64 + __builtin_ctzll(bits);
+			if (!mm_list_empty(&level->slots[slot])) {
+				return slot;
+			}
+			/* all timers of the slot were deleted */
+			mm_timer_wheel_bit_clear(level, slot);
+			bits &= bits - 1;
+		}
+	}
+	return -1;
+}
+
+/* appends all nodes of the list and leaves it empty */
+static inline void mm_timer_wheel_splice(mm_list_t *to, mm_list_t *from)
+{
+	if (mm_list_empty(from)) {
+		return;
+	}
+	from->next->prev = to->prev;
+	from->prev->next = to;
+	to->prev->next = from->next;
+	to->prev = from->prev;
+	mm_list_init(from);
+}
+
+void mm_timer_wheel_init(mm_timer_wheel_t *wheel)
+{
+	for (int l = 0; l < MM_TIMER_WHEEL_LEVELS; l++) {
+		mm_timer_wheel_level_t *level = &wheel->levels[l];
+		for (int i = 0; i < MM_TIMER_WHEEL_SLOTS; i++) {
+			mm_list_init(&level->slots[i]);
+		}
+		memset(level->bitmap, 0, sizeof(level->bitmap));
+	}
+	mm_list_init(&wheel->overflow);
+	mm_list_init(&wheel->expired);
+	wheel->current = 0;
+	wheel->count = 0;
+}
+
+static inline void mm_timer_wheel_insert(mm_timer_wheel_t *wheel,
+					 mm_timer_t *timer)
+{
+	uint64_t timeout = timer->timeout;
+	if (timeout < wheel->current) {
+		mm_list_append(&wheel->expired, &timer->link);
+		return;
+	}
+
+	/* lowest level, which window has the timeout */
+	for (int l = 0; l < MM_TIMER_WHEEL_LEVELS; l++) {
+		int shift = MM_TIMER_WHEEL_BITS * (l + 1);
+		if ((timeout >> shift) != (wheel->current >> shift)) {
+			continue;
+		}
+		mm_timer_wheel_level_t *level = &wheel->levels[l];
+		int slot = (timeout >> (MM_TIMER_WHEEL_BITS * l)) &
+			   MM_TIMER_WHEEL_MASK;
+		mm_list_append(&level->slots[slot], &timer->link);
+		mm_timer_wheel_bit_set(level, slot);
+		return;
+	}
+
+	mm_list_append(&wheel->overflow, &timer->link);
+}
+
+void mm_timer_wheel_add(mm_timer_wheel_t *wheel, mm_timer_t *timer,
+			uint64_t now)
+{
+	if (wheel->count == 0) {
+		/* nothing to process between the last step and now */
+		wheel->current = now;
+	}
+	wheel->count++;
+	mm_timer_wheel_insert(wheel, timer);
+}
+
+void mm_timer_wheel_del(mm_timer_wheel_t *wheel, mm_timer_t *timer)
+{
+	mm_list_unlink(&timer->link);
+	wheel->count--;
+}
+
+/* moves timers of the upper levels windows, that current has entered */
+static inline void mm_timer_wheel_cascade(mm_timer_wheel_t *wheel)
+{
+	uint64_t current = wheel->current;
+
+	mm_list_t moved;
+	mm_list_init(&moved);
+
+	if ((current & UINT32_MAX) == 0) {
+		mm_timer_wheel_splice(&moved, &wheel->overflow);
+	}
+
+	for (int l = 1; l < MM_TIMER_WHEEL_LEVELS; l++) {
+		int shift = MM_TIMER_WHEEL_BITS * l;
+		if ((current & ((1ULL << shift) - 1)) != 0) {
+			break;
+		}
+		mm_timer_wheel_level_t *level = &wheel->levels[l];
+		int slot = (current >> shift) & MM_TIMER_WHEEL_MASK;
+		mm_timer_wheel_splice(&moved, &level->slots[slot]);
+		mm_timer_wheel_bit_clear(level, slot);
+	}
+
+	while (!mm_list_empty(&moved)) {
+		mm_list_t *node = mm_list_pop(&moved);
+		mm_timer_wheel_insert(wheel,
+				      mm_container_of(node, mm_timer_t, link));
+	}
+}
+
+static inline void mm_timer_wheel_fire(mm_timer_wheel_t *wheel,
+				       mm_list_t *list)
+{
+	/* callbacks can add and delete timers, including ones of the list */
+	while (!mm_list_empty(list)) {
+		mm_list_t *node = mm_list_pop(list);
+		mm_timer_t *timer = mm_container_of(node, mm_timer_t, link);
+		wheel->count--;
+		timer->active = 0;
+		timer->callback(timer);
+	}
+}
+
+void mm_timer_wheel_step(mm_timer_wheel_t *wheel, uint64_t now)
+{
+	mm_list_t fired;
+	mm_list_init(&fired);
+
+	mm_timer_wheel_splice(&fired, &wheel->expired);
+	mm_timer_wheel_fire(wheel, &fired);
+
+	mm_timer_wheel_level_t *level = &wheel->levels[0];
+	while (wheel->current <= now && wheel->count > 0) {
+		uint64_t current = wheel->current;
+		int slot = current & MM_TIMER_WHEEL_MASK;
+		if (mm_timer_wheel_bit_isset(level, slot)) {
+			mm_timer_wheel_splice(&fired, &level->slots[slot]);
+			mm_timer_wheel_bit_clear(level, slot);
+		}
+
+		/*
+		 * move to the next timer of the window, the end of the
+		 * window or past now, timers added by callbacks which are
+		 * due before it will go to the expired list
+		 */
+		uint64_t base = current & ~(uint64_t)MM_TIMER_WHEEL_MASK;
+		int next = mm_timer_wheel_find(level, slot + 1);
+		uint64_t to = base + (next == -1 ? MM_TIMER_WHEEL_SLOTS : next);
+		if (to > now + 1) {
+			to = now + 1;
+		}
+		wheel->current = to;
+		if ((to & MM_TIMER_WHEEL_MASK) == 0) {
+			mm_timer_wheel_cascade(wheel);
+		}
+
+		mm_timer_wheel_fire(wheel, &fired);
+	}
+
+	if (wheel->count == 0 && wheel->current <= now) {
+		wheel->current = now + 1;
+	}
+}
+
+int mm_timer_wheel_next(mm_timer_wheel_t *wheel, uint64_t *timeout)
+{
+	if (wheel->count == 0) {
+		return -1;
+	}
+
+	if (!mm_list_empty(&wheel->expired)) {
+		mm_timer_t *timer = mm_container_of(wheel->expired.next,
+						    mm_timer_t, link);
+		*timeout = timer->timeout;
+		return 0;
+	}
+
+	uint64_t current = wheel->current;
+	for (int l = 0; l < MM_TIMER_WHEEL_LEVELS; l++) {
+		int shift = MM_TIMER_WHEEL_BITS * l;
+		int from = (current >> shift) & MM_TIMER_WHEEL_MASK;
+		/* slot of the current window on upper levels is moved */
+		if (l > 0) {
+			from++;
+		}
+		int slot = mm_timer_wheel_find(&wheel->levels[l], from);
+		if (slot == -1) {
+			continue;
+		}
+		int window = shift + MM_TIMER_WHEEL_BITS;
+		*timeout = ((current >> window) << window) +
+			   ((uint64_t)slot << shift);
+		if (*timeout < current) {
+			*timeout = current;
+		}
+		return 0;
+	}
+
+	/* overflow timers move on the next 2^32 ms boundary */
+	*timeout = ((current >> 32) + 1) << 32;
+	return 0;
+}
@@ -21,6 +21,7 @@
 #include <machinarium/iov.h>
 #include <machinarium/machine.h>
 #include <machinarium/util.h>
+#include <machinarium/tls_ticket_keys.h>
 
 #ifdef OD_ENABLE_SSL_KEYLOG
 #include <fcntl.h>
@@ -126,6 +127,24 @@ void mm_tls_free(mm_io_t *io)
 	}
 }
 
+/*
+ * OpenSSL does not resume sessions of connections freed without
+ * close_notify, so it is sent (once, without waiting) by clients
+ * which cache sessions
+ */
+void mm_tls_shutdown(mm_io_t *io)
+{
+	if (io->tls_ssl == NULL || io->tls == NULL ||
+	    io->tls->session_cache == NULL || !io->connected) {
+		return;
+	}
+	if (!SSL_is_init_finished(io->tls_ssl)) {
+		return;
+	}
+	SSL_shutdown(io->tls_ssl);
+	ERR_clear_error();
+}
+
 void mm_tls_error_reset(mm_io_t *io)
 {
 	mm_errno_set(0);
@@ -247,6 +266,67 @@ to_return:
 }
 #endif /* OD_ENABLE_SSL_KEYLOG */
 
+/*
+ * new sessions of client connections come with the handshake (TLS 1.2)
+ * or later with the session tickets (TLS 1.3)
+ */
+static int mm_tls_new_session_cb(SSL *ssl, SSL_SESSION *session)
+{
+	mm_io_t *io = SSL_get_app_data(ssl);
+	if (io == NULL || io->tls == NULL || io->tls->session_cache == NULL) {
+		return 0;
+	}
+	mm_tls_session_cache_put(io->tls->session_cache, io->tls->session_key,
+				 session);
+	/* reference is kept by the cache */
+	return 1;
+}
+
+/*
+ * session id context is derived from the settings, so sessions
+ * (tickets) of the same listen are resumed by any machine and after
+ * restart, but not by other listens
+ */
+static int mm_tls_session_id_context(mm_tls_t *tls, unsigned char *sid,
+				     unsigned int *sid_size)
+{
+	const char *fields[] = { tls->server,	 tls->protocols,
+				 tls->ca_path,	 tls->ca_file,
+				 tls->cert_file, tls->key_file };
+	unsigned char md[EVP_MAX_MD_SIZE];
+	unsigned int md_size = 0;
+	int rc = -1;
+
+	EVP_MD_CTX *md_ctx = EVP_MD_CTX_new();
+	if (md_ctx == NULL) {
+		return -1;
+	}
+	if (EVP_DigestInit_ex(md_ctx, EVP_sha256(), NULL) != 1) {
+		goto done;
+	}
+	if (EVP_DigestUpdate(md_ctx, &tls->verify, sizeof(tls->verify)) != 1) {
+		goto done;
+	}
+	for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+		/* terminator separates the fields */
+		const char *field = fields[i] ? fields[i] : "";
+		if (EVP_DigestUpdate(md_ctx, field, strlen(field) + 1) != 1) {
+			goto done;
+		}
+	}
+	if (EVP_DigestFinal_ex(md_ctx, md, &md_size) != 1) {
+		goto done;
+	}
+
+	*sid_size = md_size < SSL_MAX_SID_CTX_LENGTH ? md_size :
+						       SSL_MAX_SID_CTX_LENGTH;
+	memcpy(sid, md, *sid_size);
+	rc = 0;
+done:
+	EVP_MD_CTX_free(md_ctx);
+	return rc;
+}
+
 SSL_CTX *mm_tls_get_context(mm_io_t *io, int is_client)
 {
 	mm_tls_ctx_t *ctx_container;
@@ -351,16 +431,24 @@ SSL_CTX *mm_tls_get_context(mm_io_t *io, int is_client)
 	}
 	if (!is_client) {
 		unsigned char sid[SSL_MAX_SSL_SESSION_ID_LENGTH];
-		if (!RAND_bytes(sid, sizeof(sid))) {
+		unsigned int sid_size = 0;
+		if (mm_tls_session_id_context(io->tls, sid, &sid_size) == -1) {
 			mm_tls_error(io, 0, "failed to generate session id");
 			goto error;
 		}
-		if (!SSL_CTX_set_session_id_context(ctx, sid, sizeof(sid))) {
+		if (!SSL_CTX_set_session_id_context(ctx, sid, sid_size)) {
 			mm_tls_error(io, 0, "failed to set session id context");
 			goto error;
 		}
 
 		SSL_CTX_set_options(ctx, SSL_OP_CIPHER_SERVER_PREFERENCE);
+		mm_tls_ticket_keys_setup(ctx);
+	} else {
+		/* contexts are cached, callback checks the cache itself */
+		SSL_CTX_set_session_cache_mode(
+			ctx, SSL_SESS_CACHE_CLIENT |
+				     SSL_SESS_CACHE_NO_INTERNAL_STORE);
+		SSL_CTX_sess_set_new_cb(ctx, mm_tls_new_session_cb);
 	}
 	/* Place new ctx on top of cache */
 
@@ -413,6 +501,21 @@ static int mm_tls_prepare(mm_io_t *io, int is_client)
 		}
 	}
 
+	/* offer the session of the last handshake with the peer */
+	if (is_client && io->tls->session_cache) {
+		SSL_set_app_data(ssl, io);
+		SSL_SESSION *session = mm_tls_session_cache_get(
+			io->tls->session_cache, io->tls->session_key);
+		if (session) {
+			rc = SSL_set_session(ssl, session);
+			SSL_SESSION_free(session);
+			if (rc != 1) {
+				mm_tls_error(io, 0, "SSL_set_session()");
+				goto error;
+			}
+		}
+	}
+
 	/* set socket */
 	rc = SSL_set_rfd(ssl, io->fd);
 	if (rc == -1) {
@@ -600,12 +703,26 @@ int mm_tls_handshake(mm_io_t *io, uint32_t timeout)
 
 		if (io->connected) {
 			mm_tls_error(io, rc, "SSL_connect()");
+			if (io->tls->session_cache) {
+				/* do not offer possibly broken session again */
+				mm_tls_session_cache_remove(
+					io->tls->session_cache,
+					io->tls->session_key);
+			}
 		} else {
 			mm_tls_error(io, rc, "SSL_accept()");
 		}
 		return -1;
 	}
 
+	if (is_client && io->tls->session_cache) {
+		if (SSL_session_reused(io->tls_ssl)) {
+			atomic_fetch_add(&io->tls->session_cache->hits, 1);
+		} else {
+			atomic_fetch_add(&io->tls->session_cache->misses, 1);
+		}
+	}
+
 	if (is_client) {
 		if (io->tls->server) {
 			rc = mm_tls_verify_common_name(io, io->tls->server);
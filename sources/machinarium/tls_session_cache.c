@@ -0,0 +1,137 @@
+
+/*
+ * machinarium.
+ *
+ * cooperative multitasking engine.
+ */
+
+#include <string.h>
+
+#include <machinarium/machinarium.h>
+#include <machinarium/memory.h>
+#include <machinarium/tls_session_cache.h>
+
+MACHINE_API machine_tls_session_cache_t *machine_tls_session_cache_create(void)
+{
+	/* created on config load, which can be outside of machines */
+	mm_tls_session_cache_t *cache = mm_malloc(sizeof(*cache));
+	if (cache == NULL) {
+		return NULL;
+	}
+	memset(cache, 0, sizeof(*cache));
+	mm_sleeplock_init(&cache->lock);
+	atomic_init(&cache->hits, 0);
+	atomic_init(&cache->misses, 0);
+	return (machine_tls_session_cache_t *)cache;
+}
+
+static inline void mm_tls_session_entry_free(mm_tls_session_entry_t *entry)
+{
+	if (entry->session) {
+		SSL_SESSION_free(entry->session);
+		entry->session = NULL;
+	}
+	if (entry->key) {
+		mm_free(entry->key);
+		entry->key = NULL;
+	}
+	entry->last_used = 0;
+}
+
+MACHINE_API void
+machine_tls_session_cache_free(machine_tls_session_cache_t *obj)
+{
+	mm_tls_session_cache_t *cache = mm_cast(mm_tls_session_cache_t *, obj);
+	for (int i = 0; i < MM_TLS_SESSION_CACHE_SIZE; i++) {
+		mm_tls_session_entry_free(&cache->entries[i]);
+	}
+	mm_free(cache);
+}
+
+MACHINE_API void
+machine_tls_session_cache_stats(machine_tls_session_cache_t *obj,
+				uint64_t *hits, uint64_t *misses)
+{
+	mm_tls_session_cache_t *cache = mm_cast(mm_tls_session_cache_t *, obj);
+	*hits = atomic_load(&cache->hits);
+	*misses = atomic_load(&cache->misses);
+}
+
+static inline mm_tls_session_entry_t *
+mm_tls_session_cache_find(mm_tls_session_cache_t *cache, const char *key)
+{
+	for (int i = 0; i < MM_TLS_SESSION_CACHE_SIZE; i++) {
+		mm_tls_session_entry_t *entry = &cache->entries[i];
+		if (entry->key != NULL && strcmp(entry->key, key) == 0) {
+			return entry;
+		}
+	}
+	return NULL;
+}
+
+SSL_SESSION *mm_tls_session_cache_get(mm_tls_session_cache_t *cache,
+				      const char *key)
+{
+	SSL_SESSION *session = NULL;
+
+	mm_sleeplock_lock(&cache->lock);
+	mm_tls_session_entry_t *entry = mm_tls_session_cache_find(cache, key);
+	if (entry != NULL) {
+		if (SSL_SESSION_is_resumable(entry->session)) {
+			session = entry->session;
+			SSL_SESSION_up_ref(session);
+			entry->last_used = ++cache->clock;
+		} else {
+			mm_tls_session_entry_free(entry);
+		}
+	}
+	mm_sleeplock_unlock(&cache->lock);
+
+	return session;
+}
+
+void mm_tls_session_cache_put(mm_tls_session_cache_t *cache, const char *key,
+			      SSL_SESSION *session)
+{
+	mm_sleeplock_lock(&cache->lock);
+
+	mm_tls_session_entry_t *entry = mm_tls_session_cache_find(cache, key);
+	if (entry != NULL) {
+		SSL_SESSION_free(entry->session);
+		entry->session = session;
+		entry->last_used = ++cache->clock;
+		mm_sleeplock_unlock(&cache->lock);
+		return;
+	}
+
+	/* free slot or the least recently used one */
+	entry = &cache->entries[0];
+	for (int i = 1; i < MM_TLS_SESSION_CACHE_SIZE; i++) {
+		if (cache->entries[i].last_used < entry->last_used) {
+			entry = &cache->entries[i];
+		}
+	}
+	mm_tls_session_entry_free(entry);
+
+	entry->key = mm_strdup(key);
+	if (entry->key == NULL) {
+		mm_sleeplock_unlock(&cache->lock);
+		SSL_SESSION_free(session);
+		return;
+	}
+	entry->session = session;
+	entry->last_used = ++cache->clock;
+
+	mm_sleeplock_unlock(&cache->lock);
+}
+
+void mm_tls_session_cache_remove(mm_tls_session_cache_t *cache,
+				 const char *key)
+{
+	mm_sleeplock_lock(&cache->lock);
+	mm_tls_session_entry_t *entry = mm_tls_session_cache_find(cache, key);
+	if (entry != NULL) {
+		mm_tls_session_entry_free(entry);
+	}
+	mm_sleeplock_unlock(&cache->lock);
+}
@@ -0,0 +1,231 @@
+
+/*
+ * machinarium.
+ *
+ * cooperative multitasking engine.
+ */
+
+#include <string.h>
+
+#include <openssl/opensslv.h>
+#include <openssl/ssl.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#else
+#include <openssl/hmac.h>
+#endif
+
+#include <machinarium/machinarium.h>
+#include <machinarium/mm.h>
+#include <machinarium/tls_ticket_keys.h>
+
+/* exported keys: magic, count and the keys */
+#define MM_TLS_TICKET_KEYS_MAGIC 0x4b544d4dU
+
+void mm_tls_ticket_keys_init(mm_tls_ticket_keys_t *keys)
+{
+	memset(keys, 0, sizeof(*keys));
+	mm_sleeplock_init(&keys->lock);
+}
+
+void mm_tls_ticket_keys_free(mm_tls_ticket_keys_t *keys)
+{
+	OPENSSL_cleanse(keys->keys, sizeof(keys->keys));
+	keys->count = 0;
+}
+
+MACHINE_API int machine_tls_ticket_keys_rotate(void)
+{
+	mm_tls_ticket_key_t key;
+	if (RAND_bytes((unsigned char *)&key, sizeof(key)) != 1) {
+		return -1;
+	}
+
+	mm_tls_ticket_keys_t *keys = &machinarium.tls_ticket_keys;
+	mm_sleeplock_lock(&keys->lock);
+	memmove(&keys->keys[1], &keys->keys[0],
+		sizeof(key) * (MM_TLS_TICKET_KEYS_MAX - 1));
+	keys->keys[0] = key;
+	if (keys->count < MM_TLS_TICKET_KEYS_MAX) {
+		keys->count++;
+	}
+	mm_sleeplock_unlock(&keys->lock);
+
+	OPENSSL_cleanse(&key, sizeof(key));
+	return 0;
+}
+
+MACHINE_API ssize_t machine_tls_ticket_keys_export(void *buf, size_t size)
+{
+	if (size < MACHINE_TLS_TICKET_KEYS_EXPORT_SIZE) {
+		return -1;
+	}
+
+	mm_tls_ticket_keys_t *keys = &machinarium.tls_ticket_keys;
+	mm_sleeplock_lock(&keys->lock);
+	uint32_t count = (uint32_t)keys->count;
+	if (count == 0) {
+		mm_sleeplock_unlock(&keys->lock);
+		return 0;
+	}
+	uint32_t magic = MM_TLS_TICKET_KEYS_MAGIC;
+	char *pos = buf;
+	memcpy(pos, &magic, sizeof(magic));
+	pos += sizeof(magic);
+	memcpy(pos, &count, sizeof(count));
+	pos += sizeof(count);
+	memcpy(pos, keys->keys, sizeof(mm_tls_ticket_key_t) * count);
+	pos += sizeof(mm_tls_ticket_key_t) * count;
+	mm_sleeplock_unlock(&keys->lock);
+
+	return pos - (char *)buf;
+}
+
+MACHINE_API int machine_tls_ticket_keys_import(const void *buf, size_t size)
+{
+	uint32_t magic;
+	uint32_t count;
+	const char *pos = buf;
+	if (size < sizeof(magic) + sizeof(count)) {
+		return -1;
+	}
+	memcpy(&magic, pos, sizeof(magic));
+	pos += sizeof(magic);
+	memcpy(&count, pos, sizeof(count));
+	pos += sizeof(count);
+	if (magic != MM_TLS_TICKET_KEYS_MAGIC || count == 0 ||
+	    count > MM_TLS_TICKET_KEYS_MAX) {
+		return -1;
+	}
+	if (size != sizeof(magic) + sizeof(count) +
+			    sizeof(mm_tls_ticket_key_t) * count) {
+		return -1;
+	}
+
+	mm_tls_ticket_keys_t *keys = &machinarium.tls_ticket_keys;
+	mm_sleeplock_lock(&keys->lock);
+	OPENSSL_cleanse(keys->keys, sizeof(keys->keys));
+	memcpy(keys->keys, pos, sizeof(mm_tls_ticket_key_t) * count);
+	keys->count = (int)count;
+	mm_sleeplock_unlock(&keys->lock);
+	return 0;
+}
+
+/* 1 for the current key, 2 for the previous one, 0 if not found */
+static inline int mm_tls_ticket_keys_find(const unsigned char *name,
+					  mm_tls_ticket_key_t *key)
+{
+	mm_tls_ticket_keys_t *keys = &machinarium.tls_ticket_keys;
+	int rc = 0;
+	mm_sleeplock_lock(&keys->lock);
+	for (int i = 0; i < keys->count; i++) {
+		if (memcmp(keys->keys[i].name, name, sizeof(key->name)) == 0) {
+			*key = keys->keys[i];
+			rc = i == 0 ? 1 : 2;
+			break;
+		}
+	}
+	mm_sleeplock_unlock(&keys->lock);
+	return rc;
+}
+
+static inline int mm_tls_ticket_keys_current(mm_tls_ticket_key_t *key)
+{
+	mm_tls_ticket_keys_t *keys = &machinarium.tls_ticket_keys;
+	int rc = -1;
+	mm_sleeplock_lock(&keys->lock);
+	if (keys->count > 0) {
+		*key = keys->keys[0];
+		rc = 0;
+	}
+	mm_sleeplock_unlock(&keys->lock);
+	return rc;
+}
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+typedef EVP_MAC_CTX mm_tls_ticket_mac_t;
+
+static inline int mm_tls_ticket_mac_init(mm_tls_ticket_mac_t *mac,
+					 mm_tls_ticket_key_t *key)
+{
+	OSSL_PARAM params[] = {
+		OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST,
+						 "SHA256", 0),
+		OSSL_PARAM_construct_end()
+	};
+	return EVP_MAC_init(mac, key->hmac_key, sizeof(key->hmac_key), params);
+}
+#else
+typedef HMAC_CTX mm_tls_ticket_mac_t;
+
+static inline int mm_tls_ticket_mac_init(mm_tls_ticket_mac_t *mac,
+					 mm_tls_ticket_key_t *key)
+{
+	return HMAC_Init_ex(mac, key->hmac_key, sizeof(key->hmac_key),
+			    EVP_sha256(), NULL);
+}
+#endif
+
+/*
+ * tickets are encrypted by the current key, on decrypt
+ * -1 is error, 0 is unknown key (full handshake), 1 is ok
+ * and 2 is ok, but the ticket must be renewed
+ */
+static int mm_tls_ticket_key_cb(SSL *ssl, unsigned char *name,
+				unsigned char *iv, EVP_CIPHER_CTX *cipher_ctx,
+				mm_tls_ticket_mac_t *mac, int enc)
+{
+	(void)ssl;
+	mm_tls_ticket_key_t key;
+	const EVP_CIPHER *cipher = EVP_aes_256_cbc();
+	int iv_size = EVP_CIPHER_iv_length(cipher);
+	int rc;
+
+	if (enc) {
+		if (mm_tls_ticket_keys_current(&key) == -1) {
+			return -1;
+		}
+		rc = 1;
+		if (RAND_bytes(iv, iv_size) != 1 ||
+		    EVP_EncryptInit_ex(cipher_ctx, cipher, NULL, key.aes_key,
+				       iv) != 1) {
+			rc = -1;
+		}
+		memcpy(name, key.name, sizeof(key.name));
+	} else {
+		rc = mm_tls_ticket_keys_find(name, &key);
+		if (rc == 0) {
+			return 0;
+		}
+		if (EVP_DecryptInit_ex(cipher_ctx, cipher, NULL, key.aes_key,
+				       iv) != 1) {
+			rc = -1;
+		}
+	}
+
+	if (rc != -1 && mm_tls_ticket_mac_init(mac, &key) != 1) {
+		rc = -1;
+	}
+
+	OPENSSL_cleanse(&key, sizeof(key));
+	return rc;
+}
+
+void mm_tls_ticket_keys_setup(SSL_CTX *ctx)
+{
+	mm_tls_ticket_keys_t *keys = &machinarium.tls_ticket_keys;
+	mm_sleeplock_lock(&keys->lock);
+	int count = keys->count;
+	mm_sleeplock_unlock(&keys->lock);
+	if (count == 0) {
+		/* tickets of the ctx own keys, as before */
+		return;
+	}
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+	SSL_CTX_set_tlsext_ticket_key_evp_cb(ctx, mm_tls_ticket_key_cb);
+#else
+	SSL_CTX_set_tlsext_ticket_key_cb(ctx, mm_tls_ticket_key_cb);
+#endif
+}
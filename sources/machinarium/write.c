@@ -31,6 +31,11 @@ MACHINE_API ssize_t machine_write_raw(mm_io_t *obj, const void *buf,
 	return mm_io_write(io, buf, size);
 }
 
+MACHINE_API int machine_write_pending(mm_io_t *io)
+{
+	return mm_compression_write_pending(io) > 0;
+}
+
 MACHINE_API ssize_t machine_writev_raw(mm_io_t *io, const struct iovec *iov,
 				       int iovcnt)
 {
@@ -45,10 +50,17 @@ MACHINE_API ssize_t machine_writev_raw(mm_io_t *io, const struct iovec *iov,
 #ifdef MM_BUILD_COMPRESSION
 	if (mm_compression_is_active(io)) {
 		size_t processed = 0;
-		rc = mm_compression_writev(io, iovec, iov_to_write, &processed);
-		/* processed > 0 in case of error return code, but consumed input */
-		if (processed > 0) {
-			mm_iov_advance(iov, processed);
+		rc = mm_compression_writev(io, iov, iov_to_write, &processed);
+		/*
+		 * processed > 0 in case of error return code, but consumed
+		 * input is kept by the stream and must not be written again
+		 */
+		if (rc < 0 && processed > 0) {
+			return processed;
+		}
+		if (rc == 0 && !mm_compression_write_pending(io)) {
+			/* flush of buffered data is done */
+			return 0;
 		}
 	} else if (mm_tls_is_active(io))
 #else
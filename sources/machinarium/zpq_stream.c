@@ -7,6 +7,7 @@
 #include <unistd.h>
 #include <assert.h>
 #include <string.h>
+#include <sys/uio.h>
 
 #include <machinarium/memory.h>
 #include <machinarium/zpq_stream.h>
@@ -28,7 +29,8 @@ typedef struct {
 	 * data (compressed data already fetched from input stream) rx_data_size:
 	 * size of data fetched from input stream
 	 */
-	mm_zpq_stream_t *(*create)(mm_zpq_tx_func tx_func,
+	mm_zpq_stream_t *(*create)(int level, size_t buffer_size,
+				   mm_zpq_tx_func tx_func,
 				   mm_zpq_rx_func rx_func, void *arg,
 				   char *rx_data, size_t rx_data_size);
 
@@ -41,13 +43,14 @@ typedef struct {
 	ssize_t (*read)(mm_zpq_stream_t *zs, void *buf, size_t size);
 
 	/*
-	 * Write up to "size" raw (decompressed) bytes.
+	 * Write raw (decompressed) bytes of all iovec segments, segments are
+	 * fed to the compressor one by one, without copying them together.
 	 * Returns number of written raw bytes or error code returned by tx
 	 * function. In the last case amount of written raw bytes is stored in
 	 * *processed.
 	 */
-	ssize_t (*write)(mm_zpq_stream_t *zs, void const *buf, size_t size,
-			 size_t *processed);
+	ssize_t (*writev)(mm_zpq_stream_t *zs, const struct iovec *iov, int n,
+			  size_t *processed);
 
 	/*
 	 * Free stream created by create function.
@@ -80,6 +83,7 @@ typedef struct {
 
 struct mm_zpq_stream {
 	zpq_algorithm_t const *algorithm;
+	mm_zpq_stats_t stats;
 };
 #ifdef MM_BUILD_COMPRESSION
 #ifdef MM_HAVE_ZSTD
@@ -87,9 +91,6 @@ struct mm_zpq_stream {
 #include <stdlib.h>
 #include <zstd.h>
 
-#define MM_ZSTD_BUFFER_SIZE (8 * 1024)
-#define MM_ZSTD_COMPRESSION_LEVEL 1
-
 typedef struct zstd_stream {
 	mm_zpq_stream_t common;
 	ZSTD_CStream *tx_stream;
@@ -97,6 +98,8 @@ typedef struct zstd_stream {
 	ZSTD_outBuffer tx;
 	ZSTD_inBuffer rx;
 	size_t tx_not_flushed; /* Amount of data in internal zstd buffer */
+	/* Flag that data was compressed, but the stream is not flushed yet */
+	_Bool tx_flush_pending;
 	size_t tx_buffered; /* Data consumed by zstd_write but not yet sent */
 	size_t rx_buffered; /* Data which is needed for ztd_read */
 	/* Flag that the last call of zstd_read did not call the rx_func */
@@ -105,27 +108,38 @@ typedef struct zstd_stream {
 	mm_zpq_rx_func rx_func;
 	void *arg;
 	char const *rx_error; /* Decompress error message */
-	size_t tx_total;
-	size_t tx_total_raw;
-	size_t rx_total;
-	size_t rx_total_raw;
-	char tx_buf[MM_ZSTD_BUFFER_SIZE];
-	char rx_buf[MM_ZSTD_BUFFER_SIZE];
+	size_t buffer_size;
+	char *tx_buf;
+	char *rx_buf;
+	/* tx and rx buffers of buffer_size */
+	char buf[];
 } zstd_stream_t;
 
-static mm_zpq_stream_t *zstd_create(mm_zpq_tx_func tx_func,
+static mm_zpq_stream_t *zstd_create(int level, size_t buffer_size,
+				    mm_zpq_tx_func tx_func,
 				    mm_zpq_rx_func rx_func, void *arg,
 				    char *rx_data, size_t rx_data_size)
 {
-	zstd_stream_t *zs = (zstd_stream_t *)mm_malloc(sizeof(zstd_stream_t));
+	zstd_stream_t *zs = (zstd_stream_t *)mm_malloc(sizeof(zstd_stream_t) +
+						       2 * buffer_size);
+	if (zs == NULL) {
+		return NULL;
+	}
 
+	if (level > ZSTD_maxCLevel()) {
+		level = ZSTD_maxCLevel();
+	}
+
+	zs->buffer_size = buffer_size;
+	zs->tx_buf = zs->buf;
+	zs->rx_buf = zs->buf + buffer_size;
 	zs->tx_stream = ZSTD_createCStream();
-	ZSTD_initCStream(zs->tx_stream, MM_ZSTD_COMPRESSION_LEVEL);
+	ZSTD_initCStream(zs->tx_stream, level);
 	zs->rx_stream = ZSTD_createDStream();
 	ZSTD_initDStream(zs->rx_stream);
 	zs->tx.dst = zs->tx_buf;
 	zs->tx.pos = 0;
-	zs->tx.size = MM_ZSTD_BUFFER_SIZE;
+	zs->tx.size = buffer_size;
 	zs->rx.src = zs->rx_buf;
 	zs->rx.pos = 0;
 	zs->rx.size = 0;
@@ -134,13 +148,12 @@ static mm_zpq_stream_t *zstd_create(mm_zpq_tx_func tx_func,
 	zs->tx_buffered = 0;
 	zs->rx_buffered = 0;
 	zs->tx_not_flushed = 0;
+	zs->tx_flush_pending = 0;
 	zs->rx_error = NULL;
 	zs->arg = arg;
-	zs->tx_total = zs->tx_total_raw = 0;
-	zs->rx_total = zs->rx_total_raw = 0;
 	zs->rx.size = rx_data_size;
 	zs->deferred_rx_call = 0;
-	assert(rx_data_size < MM_ZSTD_BUFFER_SIZE);
+	assert(rx_data_size < buffer_size);
 	memcpy(zs->rx_buf, rx_data, rx_data_size);
 
 	return (mm_zpq_stream_t *)zs;
@@ -168,7 +181,7 @@ static ssize_t zstd_read(mm_zpq_stream_t *zstream, void *buf, size_t size)
 			/* Return result if we fill requested amount of bytes or read
 			 * operation was performed */
 			if (out.pos != 0) {
-				zs->rx_total_raw += out.pos;
+				zs->common.stats.rx_raw += out.pos;
 				zs->rx_buffered = 0;
 				return out.pos;
 			}
@@ -179,68 +192,99 @@ static ssize_t zstd_read(mm_zpq_stream_t *zstream, void *buf, size_t size)
 			}
 		}
 		rc = zs->rx_func(zs->arg, (char *)zs->rx.src + zs->rx.size,
-				 MM_ZSTD_BUFFER_SIZE - zs->rx.size);
+				 zs->buffer_size - zs->rx.size);
 		/* if we've made a call to rx function, reset the deferred rx flag */
 		zs->deferred_rx_call = 0;
 		if (rc > 0) /* read fetches some data */
 		{
 			zs->rx.size += rc;
-			zs->rx_total += rc;
+			zs->common.stats.rx_compressed += rc;
 		} else /* read failed */
 		{
-			zs->rx_total_raw += out.pos;
+			zs->common.stats.rx_raw += out.pos;
 			return rc;
 		}
 	}
 }
 
-static ssize_t zstd_write(mm_zpq_stream_t *zstream, void const *buf,
-			  size_t size, size_t *processed)
+/*
+ * Compress iovec segments into the tx buffer until it is full,
+ * stream is flushed when all segments are consumed
+ */
+static void zstd_compress(zstd_stream_t *zs, const struct iovec *iov, int n,
+			  int *seg, ZSTD_inBuffer *in, size_t *consumed)
+{
+	while (zs->tx.pos < zs->tx.size) {
+		if (in->pos == in->size && *seg < n) {
+			*consumed += in->size;
+			in->src = iov[*seg].iov_base;
+			in->size = iov[*seg].iov_len;
+			in->pos = 0;
+			(*seg)++;
+			continue;
+		}
+
+		if (in->pos == in->size) {
+			if (!zs->tx_flush_pending) {
+				/* nothing to compress or flush */
+				break;
+			}
+			zs->tx_not_flushed =
+				ZSTD_flushStream(zs->tx_stream, &zs->tx);
+			if (zs->tx_not_flushed == 0) {
+				zs->tx_flush_pending = 0;
+			}
+			break;
+		}
+
+		ZSTD_compressStream(zs->tx_stream, &zs->tx, in);
+		zs->tx_flush_pending = 1;
+	}
+}
+
+static ssize_t zstd_writev(mm_zpq_stream_t *zstream, const struct iovec *iov,
+			   int n, size_t *processed)
 {
 	zstd_stream_t *zs = (zstd_stream_t *)zstream;
 	ssize_t rc;
 	ZSTD_inBuffer in_buf;
-	in_buf.src = buf;
+	in_buf.src = NULL;
 	in_buf.pos = 0;
-	in_buf.size = size;
+	in_buf.size = 0;
+	size_t consumed = 0;
+	int seg = 0;
 
 	do {
 		if (zs->tx.pos == 0) /* Compress buffer is empty */
 		{
-			zs->tx.dst =
-				zs->tx_buf; /* Reset pointer to the beginning of buffer */
-
-			if (in_buf.pos <
-			    size) { /* Has something to compress in input buffer */
-				ZSTD_compressStream(zs->tx_stream, &zs->tx,
-						    &in_buf);
-			}
-
-			if (in_buf.pos ==
-			    size) /* All data is compressed: flushed internal zstd buffer */
-			{
-				zs->tx_not_flushed = ZSTD_flushStream(
-					zs->tx_stream, &zs->tx);
+			/* Reset pointer to the beginning of buffer */
+			zs->tx.dst = zs->tx_buf;
+			zstd_compress(zs, iov, n, &seg, &in_buf, &consumed);
+			if (zs->tx.pos == 0) {
+				/* nothing to compress and nothing to send */
+				break;
 			}
 		}
 		rc = zs->tx_func(zs->arg, zs->tx.dst, zs->tx.pos);
 		if (rc > 0) {
 			zs->tx.pos -= rc;
 			zs->tx.dst = (char *)zs->tx.dst + rc;
-			zs->tx_total += rc;
+			zs->common.stats.tx_compressed += rc;
 		} else {
-			*processed = in_buf.pos;
+			*processed = consumed + in_buf.pos;
 			zs->tx_buffered = zs->tx.pos;
-			zs->tx_total_raw += in_buf.pos;
+			zs->common.stats.tx_raw += *processed;
 			return rc;
 		}
-		/* repeat sending while there is some data in input or internal zstd
-		 * buffer */
-	} while (in_buf.pos < size || zs->tx_not_flushed);
+		/* repeat sending while there is some data in input,
+		 * internal zstd buffer or tx buffer */
+	} while (seg < n || in_buf.pos < in_buf.size || zs->tx_flush_pending ||
+		 zs->tx.pos != 0);
 
-	zs->tx_total_raw += in_buf.pos;
+	consumed += in_buf.pos;
+	zs->common.stats.tx_raw += consumed;
 	zs->tx_buffered = zs->tx.pos;
-	return in_buf.pos;
+	return consumed;
 }
 
 static void zstd_free(mm_zpq_stream_t *zstream)
@@ -262,7 +306,11 @@ static char const *zstd_error(mm_zpq_stream_t *zstream)
 static size_t zstd_buffered_tx(mm_zpq_stream_t *zstream)
 {
 	zstd_stream_t *zs = (zstd_stream_t *)zstream;
-	return zs != NULL ? zs->tx_buffered + zs->tx_not_flushed : 0;
+	if (zs == NULL) {
+		return 0;
+	}
+	/* flush may be pending with no bytes known to be in zstd buffer */
+	return zs->tx_buffered + zs->tx_not_flushed + zs->tx_flush_pending;
 }
 
 static size_t zstd_buffered_rx(mm_zpq_stream_t *zstream)
@@ -289,18 +337,6 @@ static char zstd_name(void)
 #include <stdlib.h>
 #include <zlib.h>
 
-#define MM_ZLIB_BUFFER_SIZE \
-	8192 /* We have to flush stream after each protocol command        \
-			      * and command is mostly limited by record length,            \
-			      * which in turn usually less than page size (except TOAST)   \
-			      */
-#define MM_ZLIB_COMPRESSION_LEVEL \
-	1 /* Experiments shows that default (fastest) compression level    \
-			   * provides the best size/speed ratio. It is significantly       \
-			   * (times) faster than more expensive levels and differences in  \
-			   * compression ratio is not so large                             \
-			   */
-
 typedef struct zlib_stream {
 	mm_zpq_stream_t common;
 
@@ -310,48 +346,67 @@ typedef struct zlib_stream {
 	mm_zpq_tx_func tx_func;
 	mm_zpq_rx_func rx_func;
 	void *arg;
-	unsigned tx_deflate_pending;
+	/* Compressed data is not sync flushed yet */
+	_Bool tx_flush_needed;
 	/* Flag that the last call of zlib_read did not call the rx_func */
 	_Bool deferred_rx_call;
 	size_t tx_buffered;
 
-	Bytef tx_buf[MM_ZLIB_BUFFER_SIZE];
-	Bytef rx_buf[MM_ZLIB_BUFFER_SIZE];
+	size_t buffer_size;
+	Bytef *tx_buf;
+	Bytef *rx_buf;
+	/* tx and rx buffers of buffer_size */
+	Bytef buf[];
 } zlib_stream_t;
 
-static mm_zpq_stream_t *zlib_create(mm_zpq_tx_func tx_func,
+static mm_zpq_stream_t *zlib_create(int level, size_t buffer_size,
+				    mm_zpq_tx_func tx_func,
 				    mm_zpq_rx_func rx_func, void *arg,
 				    char *rx_data, size_t rx_data_size)
 {
 	int rc;
-	zlib_stream_t *zs = (zlib_stream_t *)mm_malloc(sizeof(zlib_stream_t));
+	zlib_stream_t *zs = (zlib_stream_t *)mm_malloc(sizeof(zlib_stream_t) +
+						       2 * buffer_size);
+	if (zs == NULL) {
+		return NULL;
+	}
+
+	if (level > Z_BEST_COMPRESSION) {
+		level = Z_BEST_COMPRESSION;
+	}
+
+	zs->buffer_size = buffer_size;
+	zs->tx_buf = zs->buf;
+	zs->rx_buf = zs->buf + buffer_size;
+
 	memset(&zs->tx, 0, sizeof(zs->tx));
 	zs->tx.next_out = zs->tx_buf;
-	zs->tx.avail_out = MM_ZLIB_BUFFER_SIZE;
+	zs->tx.avail_out = buffer_size;
 	zs->tx_buffered = 0;
-	rc = deflateInit(&zs->tx, MM_ZLIB_COMPRESSION_LEVEL);
+	rc = deflateInit(&zs->tx, level);
 	if (rc != Z_OK) {
 		mm_free(zs);
 		return NULL;
 	}
 	assert(zs->tx.next_out == zs->tx_buf &&
-	       zs->tx.avail_out == MM_ZLIB_BUFFER_SIZE);
+	       zs->tx.avail_out == buffer_size);
 
 	memset(&zs->rx, 0, sizeof(zs->tx));
 	zs->rx.next_in = zs->rx_buf;
-	zs->rx.avail_in = MM_ZLIB_BUFFER_SIZE;
-	zs->tx_deflate_pending = 0;
+	zs->rx.avail_in = buffer_size;
+	zs->tx_flush_needed = 0;
 	zs->deferred_rx_call = 0;
 	rc = inflateInit(&zs->rx);
 	if (rc != Z_OK) {
+		deflateEnd(&zs->tx);
 		mm_free(zs);
 		return NULL;
 	}
 	assert(zs->rx.next_in == zs->rx_buf &&
-	       zs->rx.avail_in == MM_ZLIB_BUFFER_SIZE);
+	       zs->rx.avail_in == buffer_size);
 
 	zs->rx.avail_in = rx_data_size;
-	assert(rx_data_size < MM_ZLIB_BUFFER_SIZE);
+	assert(rx_data_size < buffer_size);
 	memcpy(zs->rx_buf, rx_data, rx_data_size);
 
 	zs->rx_func = rx_func;
@@ -380,6 +435,8 @@ static ssize_t zlib_read(mm_zpq_stream_t *zstream, void *buf, size_t size)
 				return MM_ZPQ_DECOMPRESS_ERROR;
 			}
 			if (zs->rx.avail_out != size) {
+				zs->common.stats.rx_raw +=
+					size - zs->rx.avail_out;
 				return size - zs->rx.avail_out;
 			}
 			if (zs->rx.avail_in == 0) {
@@ -389,62 +446,96 @@ static ssize_t zlib_read(mm_zpq_stream_t *zstream, void *buf, size_t size)
 			zs->rx.next_in = zs->rx_buf;
 		}
 		rc = zs->rx_func(zs->arg, zs->rx.next_in + zs->rx.avail_in,
-				 zs->rx_buf + MM_ZLIB_BUFFER_SIZE -
+				 zs->rx_buf + zs->buffer_size -
 					 zs->rx.next_in - zs->rx.avail_in);
 		/* if we've made a call to rx function, reset the deferred rx flag */
 		zs->deferred_rx_call = 0;
 		if (rc > 0) {
 			zs->rx.avail_in += rc;
+			zs->common.stats.rx_compressed += rc;
 		} else {
 			return rc;
 		}
 	}
 }
 
-static ssize_t zlib_write(mm_zpq_stream_t *zstream, void const *buf,
-			  size_t size, size_t *processed)
+/*
+ * Deflate iovec segments into the tx buffer until it is full,
+ * stream is sync flushed with the last segment, so every write
+ * is flushed once instead of once per segment
+ */
+static void zlib_compress(zlib_stream_t *zs, const struct iovec *iov, int n,
+			  int *seg, size_t *loaded)
+{
+	while (zs->tx.avail_out > 0) {
+		if (zs->tx.avail_in == 0 && *seg < n) {
+			zs->tx.next_in = (Bytef *)iov[*seg].iov_base;
+			zs->tx.avail_in = iov[*seg].iov_len;
+			*loaded += iov[*seg].iov_len;
+			(*seg)++;
+			continue;
+		}
+
+		if (zs->tx.avail_in == 0 && !zs->tx_flush_needed) {
+			/* nothing to compress or flush */
+			break;
+		}
+
+		int flush = *seg == n ? Z_SYNC_FLUSH : Z_NO_FLUSH;
+		int rc = deflate(&zs->tx, flush);
+		assert(rc == Z_OK || rc == Z_BUF_ERROR);
+		(void)rc;
+
+		/* sync flush is complete when some output space left */
+		zs->tx_flush_needed = flush == Z_NO_FLUSH ||
+				      zs->tx.avail_in != 0 ||
+				      zs->tx.avail_out == 0;
+	}
+}
+
+static ssize_t zlib_writev(mm_zpq_stream_t *zstream, const struct iovec *iov,
+			   int n, size_t *processed)
 {
 	zlib_stream_t *zs = (zlib_stream_t *)zstream;
 	int rc;
-	zs->tx.next_in = (Bytef *)buf;
-	zs->tx.avail_in = size;
+	size_t loaded = 0;
+	int seg = 0;
+	zs->tx.next_in = NULL;
+	zs->tx.avail_in = 0;
 	do {
 		if (zs->tx.avail_out ==
-		    MM_ZLIB_BUFFER_SIZE) /* Compress buffer is empty */
+		    zs->buffer_size) /* Compress buffer is empty */
 		{
-			zs->tx.next_out =
-				zs->tx_buf; /* Reset pointer to the  beginning of buffer */
-
-			if (zs->tx.avail_in != 0 ||
-			    (zs->tx_deflate_pending >
-			     0)) /* Has something in input or deflate buffer */
-			{
-				rc = deflate(&zs->tx, Z_SYNC_FLUSH);
-				assert(rc == Z_OK);
-				deflatePending(
-					&zs->tx, &zs->tx_deflate_pending,
-					Z_NULL); /* check if any data left in deflate buffer */
-				zs->tx.next_out =
-					zs->tx_buf; /* Reset pointer to the  beginning of buffer */
+			/* Reset pointer to the  beginning of buffer */
+			zs->tx.next_out = zs->tx_buf;
+			zlib_compress(zs, iov, n, &seg, &loaded);
+			zs->tx.next_out = zs->tx_buf;
+			if (zs->tx.avail_out == zs->buffer_size) {
+				/* nothing to compress and nothing to send */
+				break;
 			}
 		}
 		rc = zs->tx_func(zs->arg, zs->tx.next_out,
-				 MM_ZLIB_BUFFER_SIZE - zs->tx.avail_out);
+				 zs->buffer_size - zs->tx.avail_out);
 		if (rc > 0) {
 			zs->tx.next_out += rc;
 			zs->tx.avail_out += rc;
+			zs->common.stats.tx_compressed += rc;
 		} else {
-			*processed = size - zs->tx.avail_in;
-			zs->tx_buffered =
-				MM_ZLIB_BUFFER_SIZE - zs->tx.avail_out;
+			*processed = loaded - zs->tx.avail_in;
+			zs->common.stats.tx_raw += *processed;
+			zs->tx_buffered = zs->buffer_size - zs->tx.avail_out;
 			return rc;
 		}
-		/* repeat sending while there is some data in input or deflate buffer */
-	} while (zs->tx.avail_in != 0 || zs->tx_deflate_pending > 0);
+		/* repeat sending while there is some data in input, deflate
+		 * or tx buffer */
+	} while (seg < n || zs->tx.avail_in != 0 || zs->tx_flush_needed ||
+		 zs->tx.avail_out != zs->buffer_size);
 
-	zs->tx_buffered = MM_ZLIB_BUFFER_SIZE - zs->tx.avail_out;
+	zs->tx_buffered = zs->buffer_size - zs->tx.avail_out;
+	zs->common.stats.tx_raw += loaded - zs->tx.avail_in;
 
-	return size - zs->tx.avail_in;
+	return loaded - zs->tx.avail_in;
 }
 
 static void zlib_free(mm_zpq_stream_t *zstream)
@@ -466,7 +557,7 @@ static char const *zlib_error(mm_zpq_stream_t *zstream)
 static size_t zlib_buffered_tx(mm_zpq_stream_t *zstream)
 {
 	zlib_stream_t *zs = (zlib_stream_t *)zstream;
-	return zs != NULL ? zs->tx_buffered + zs->tx_deflate_pending : 0;
+	return zs != NULL ? zs->tx_buffered + zs->tx_flush_needed : 0;
 }
 
 static size_t zlib_buffered_rx(mm_zpq_stream_t *zstream)
@@ -496,11 +587,11 @@ static zpq_algorithm_t const zpq_algorithms[] = {
 
 #ifdef MM_BUILD_COMPRESSION
 #ifdef MM_HAVE_ZSTD
-	{ zstd_name, zstd_create, zstd_read, zstd_write, zstd_free, zstd_error,
+	{ zstd_name, zstd_create, zstd_read, zstd_writev, zstd_free, zstd_error,
 	  zstd_buffered_tx, zstd_buffered_rx, zstd_deferred_rx },
 #endif
 #ifdef MM_HAVE_ZLIB
-	{ zlib_name, zlib_create, zlib_read, zlib_write, zlib_free, zlib_error,
+	{ zlib_name, zlib_create, zlib_read, zlib_writev, zlib_free, zlib_error,
 	  zlib_buffered_tx, zlib_buffered_rx, zlib_deferred_rx },
 #endif
 #endif
@@ -510,14 +601,25 @@ static zpq_algorithm_t const zpq_algorithms[] = {
 /*
  * Index of used compression algorithm in zpq_algorithms array.
  */
-mm_zpq_stream_t *zpq_create(int algorithm_impl, mm_zpq_tx_func tx_func,
-			    mm_zpq_rx_func rx_func, void *arg, char *rx_data,
-			    size_t rx_data_size)
+mm_zpq_stream_t *zpq_create(int algorithm_impl, int level, size_t buffer_size,
+			    mm_zpq_tx_func tx_func, mm_zpq_rx_func rx_func,
+			    void *arg, char *rx_data, size_t rx_data_size)
 {
+	if (level <= 0) {
+		level = MM_ZPQ_DEFAULT_LEVEL;
+	}
+	if (buffer_size == 0) {
+		buffer_size = MM_ZPQ_DEFAULT_BUFFER_SIZE;
+	}
+
 	mm_zpq_stream_t *stream = zpq_algorithms[algorithm_impl].create(
-		tx_func, rx_func, arg, rx_data, rx_data_size);
+		level, buffer_size, tx_func, rx_func, arg, rx_data,
+		rx_data_size);
 	if (stream) {
 		stream->algorithm = &zpq_algorithms[algorithm_impl];
+		memset(&stream->stats, 0, sizeof(stream->stats));
+		/* already fetched from the wire by the caller */
+		stream->stats.rx_compressed = rx_data_size;
 	}
 	return stream;
 }
@@ -530,7 +632,16 @@ ssize_t mm_zpq_read(mm_zpq_stream_t *zs, void *buf, size_t size)
 ssize_t mm_zpq_write(mm_zpq_stream_t *zs, void const *buf, size_t size,
 		     size_t *processed)
 {
-	return zs->algorithm->write(zs, buf, size, processed);
+	struct iovec iov;
+	iov.iov_base = (void *)buf;
+	iov.iov_len = size;
+	return zs->algorithm->writev(zs, &iov, 1, processed);
+}
+
+ssize_t mm_zpq_writev(mm_zpq_stream_t *zs, const struct iovec *iov, int n,
+		      size_t *processed)
+{
+	return zs->algorithm->writev(zs, iov, n, processed);
 }
 
 void mm_zpq_free(mm_zpq_stream_t *zs)
@@ -560,6 +671,11 @@ _Bool mm_zpq_deferred_rx(mm_zpq_stream_t *zs)
 	return zs ? zs->algorithm->deferred_rx(zs) : 0;
 }
 
+void mm_zpq_stats(mm_zpq_stream_t *zs, mm_zpq_stats_t *stats)
+{
+	*stats = zs->stats;
+}
+
 /*
  * Get list of the supported algorithms.
  * Each algorithm is identified by one letter: 'f' - Facebook zstd, 'z' - zlib.
@@ -6,6 +6,8 @@
 
 #include <odyssey.h>
 
+#include <machinarium/ds/hm.h>
+
 #include <multi_pool.h>
 
 static inline void key_init(od_multi_pool_key_t *key)
@@ -89,6 +91,187 @@ static inline int key_cmp(const od_multi_pool_key_t *a,
 	return od_address_cmp(&a->address, &b->address);
 }
 
+static inline uint64_t address_hash(const od_address_t *address)
+{
+	/* must be consistent with od_address_cmp */
+	uint64_t hash = mm_xxh64_hash(&address->type, sizeof(address->type), 0);
+	if (address->host != NULL) {
+		hash = mm_xxh64_hash(address->host, strlen(address->host),
+				     hash);
+	}
+	if (address->type == OD_ADDRESS_TYPE_TCP) {
+		hash = mm_xxh64_hash(&address->port, sizeof(address->port),
+				     hash);
+		hash = mm_xxh64_hash(address->availability_zone,
+				     strlen(address->availability_zone), hash);
+	}
+	return hash;
+}
+
+static inline uint64_t key_hash(const od_multi_pool_key_t *key)
+{
+	uint64_t hash = address_hash(&key->address);
+	if (key->dbname != NULL) {
+		hash = mm_xxh64_hash(key->dbname, strlen(key->dbname) + 1,
+				     hash);
+	}
+	if (key->username != NULL) {
+		hash = mm_xxh64_hash(key->username, strlen(key->username) + 1,
+				     hash);
+	}
+	return hash;
+}
+
+static inline void od_multi_pool_index_init(od_multi_pool_index_t *index)
+{
+	index->buckets = NULL;
+	index->size = 0;
+	index->count = 0;
+}
+
+static inline void od_multi_pool_index_free(od_multi_pool_index_t *index)
+{
+	if (index->buckets != NULL) {
+		od_free(index->buckets);
+	}
+	od_multi_pool_index_init(index);
+}
+
+static inline od_list_t *
+od_multi_pool_index_bucket(od_multi_pool_index_t *index, uint64_t hash)
+{
+	return &index->buckets[hash & (index->size - 1)];
+}
+
+static inline int od_multi_pool_index_resize(od_multi_pool_index_t *index,
+					     size_t size)
+{
+	od_list_t *buckets = od_malloc(sizeof(od_list_t) * size);
+	if (buckets == NULL) {
+		return NOT_OK_RESPONSE;
+	}
+	for (size_t i = 0; i < size; ++i) {
+		od_list_init(&buckets[i]);
+	}
+
+	od_list_t *prev = index->buckets;
+	size_t prev_size = index->size;
+
+	index->buckets = buckets;
+	index->size = size;
+
+	/* rehash entries into the new buckets */
+	for (size_t b = 0; b < prev_size; ++b) {
+		od_list_t *i, *n;
+		od_list_foreach_safe (&prev[b], i, n) {
+			od_multi_pool_index_link_t *link;
+			link = od_container_of(i, od_multi_pool_index_link_t,
+					       link);
+			od_list_unlink(&link->link);
+			od_list_append(od_multi_pool_index_bucket(index,
+								  link->hash),
+				       &link->link);
+		}
+	}
+
+	if (prev != NULL) {
+		od_free(prev);
+	}
+
+	return OK_RESPONSE;
+}
+
+static inline int od_multi_pool_index_add(od_multi_pool_index_t *index,
+					  od_multi_pool_index_link_t *link,
+					  uint64_t hash)
+{
+	if (index->buckets == NULL) {
+		if (od_multi_pool_index_resize(
+			    index, OD_MULTI_POOL_INDEX_MIN_SIZE) !=
+		    OK_RESPONSE) {
+			return NOT_OK_RESPONSE;
+		}
+	} else if (index->count >= index->size) {
+		/* failed growth is not fatal - chains become longer */
+		od_multi_pool_index_resize(index, index->size * 2);
+	}
+
+	link->hash = hash;
+	od_list_append(od_multi_pool_index_bucket(index, hash), &link->link);
+	index->count++;
+
+	return OK_RESPONSE;
+}
+
+static inline od_multi_pool_address_t *
+od_multi_pool_address_find(od_multi_pool_t *mpool, const od_address_t *address,
+			   uint64_t hash)
+{
+	od_multi_pool_index_t *index = &mpool->address_index;
+	if (index->buckets == NULL) {
+		return NULL;
+	}
+
+	od_list_t *i;
+	od_list_foreach (od_multi_pool_index_bucket(index, hash), i) {
+		od_multi_pool_index_link_t *link;
+		link = od_container_of(i, od_multi_pool_index_link_t, link);
+		if (link->hash != hash) {
+			continue;
+		}
+
+		od_multi_pool_address_t *addr;
+		addr = od_container_of(link, od_multi_pool_address_t,
+				       index_link);
+		if (od_address_cmp(&addr->address, address) == 0) {
+			return addr;
+		}
+	}
+
+	return NULL;
+}
+
+static inline od_multi_pool_address_t *
+od_multi_pool_address_get_or_create(od_multi_pool_t *mpool,
+				    const od_address_t *address)
+{
+	uint64_t hash = address_hash(address);
+
+	od_multi_pool_address_t *addr;
+	addr = od_multi_pool_address_find(mpool, address, hash);
+	if (addr != NULL) {
+		return addr;
+	}
+
+	addr = od_malloc(sizeof(od_multi_pool_address_t));
+	if (addr == NULL) {
+		return NULL;
+	}
+	od_address_init(&addr->address);
+	addr->count_active = 0;
+	addr->count_idle = 0;
+	od_list_init(&addr->link);
+	od_list_init(&addr->index_link.link);
+
+	if (od_address_copy(&addr->address, address) != OK_RESPONSE) {
+		goto error;
+	}
+
+	if (od_multi_pool_index_add(&mpool->address_index, &addr->index_link,
+				    hash) != OK_RESPONSE) {
+		goto error;
+	}
+
+	od_list_append(&mpool->addresses, &addr->link);
+
+	return addr;
+
+error:
+	od_address_destroy(&addr->address);
+	od_free(addr);
+	return NULL;
+}
+
 static inline od_multi_pool_element_t *
 od_multi_pool_element_create(atomic_uint_fast64_t *version)
 {
@@ -102,6 +285,10 @@ od_multi_pool_element_create(atomic_uint_fast64_t *version)
 	od_server_pool_init(&element->pool);
 	od_list_init(&element->link);
 	mm_wait_list_init(&element->wait_bus, version);
+	element->mpool = NULL;
+	element->address = NULL;
+	od_list_init(&element->index_link.link);
+	element->index_link.hash = 0;
 
 	return element;
 }
@@ -126,6 +313,11 @@ od_multi_pool_t *od_multi_pool_create(od_server_pool_free_fn_t free_fn)
 
 	mpool->pool_free_fn = free_fn;
 	od_list_init(&mpool->pools);
+	od_multi_pool_index_init(&mpool->index);
+	od_multi_pool_index_init(&mpool->address_index);
+	od_list_init(&mpool->addresses);
+	mpool->count_active = 0;
+	mpool->count_idle = 0;
 	mm_mutex_init(&mpool->lock);
 
 	return mpool;
@@ -141,18 +333,40 @@ void od_multi_pool_destroy(od_multi_pool_t *mpool)
 		od_multi_pool_element_free(el, mpool->pool_free_fn);
 	}
 
+	od_list_foreach_safe (&mpool->addresses, i, s) {
+		od_multi_pool_address_t *addr;
+		addr = od_container_of(i, od_multi_pool_address_t, link);
+		od_address_destroy(&addr->address);
+		od_free(addr);
+	}
+
+	od_multi_pool_index_free(&mpool->index);
+	od_multi_pool_index_free(&mpool->address_index);
+
 	mm_mutex_destroy(&mpool->lock);
 	od_free(mpool);
 }
 
 static inline od_multi_pool_element_t *
 od_multi_pool_get_internal(od_multi_pool_t *mpool,
-			   const od_multi_pool_key_t *key)
+			   const od_multi_pool_key_t *key, uint64_t hash)
 {
+	od_multi_pool_index_t *index = &mpool->index;
+	if (index->buckets == NULL) {
+		return NULL;
+	}
+
 	od_list_t *i;
-	od_list_foreach (&mpool->pools, i) {
+	od_list_foreach (od_multi_pool_index_bucket(index, hash), i) {
+		od_multi_pool_index_link_t *link;
+		link = od_container_of(i, od_multi_pool_index_link_t, link);
+		if (link->hash != hash) {
+			continue;
+		}
+
 		od_multi_pool_element_t *element;
-		element = od_container_of(i, od_multi_pool_element_t, link);
+		element = od_container_of(link, od_multi_pool_element_t,
+					  index_link);
 		if (key_cmp(&element->key, key) == 0) {
 			return element;
 		}
@@ -167,15 +381,31 @@ od_multi_pool_get_or_create_locked(od_multi_pool_t *mpool,
 {
 	od_multi_pool_element_t *el = NULL;
 
-	el = od_multi_pool_get_internal(mpool, key);
+	uint64_t hash = key_hash(key);
+	el = od_multi_pool_get_internal(mpool, key, hash);
 
 	if (el == NULL) {
 		od_multi_pool_element_t *new_el =
 			od_multi_pool_element_create(&mpool->version);
+		if (new_el == NULL) {
+			return NULL;
+		}
 		if (key_copy(&new_el->key, key) != 0) {
 			od_multi_pool_element_free(new_el, mpool->pool_free_fn);
 			return NULL;
 		}
+		new_el->address = od_multi_pool_address_get_or_create(
+			mpool, &new_el->key.address);
+		if (new_el->address == NULL) {
+			od_multi_pool_element_free(new_el, mpool->pool_free_fn);
+			return NULL;
+		}
+		if (od_multi_pool_index_add(&mpool->index, &new_el->index_link,
+					    hash) != OK_RESPONSE) {
+			od_multi_pool_element_free(new_el, mpool->pool_free_fn);
+			return NULL;
+		}
+		new_el->mpool = mpool;
 		od_list_append(&mpool->pools, &new_el->link);
 		el = new_el;
 	}
@@ -183,6 +413,55 @@ od_multi_pool_get_or_create_locked(od_multi_pool_t *mpool,
 	return el;
 }
 
+static inline void od_multi_pool_account(int *count_active, int *count_idle,
+					 od_server_state_t state, int delta)
+{
+	switch (state) {
+	case OD_SERVER_ACTIVE:
+		*count_active += delta;
+		break;
+	case OD_SERVER_IDLE:
+		*count_idle += delta;
+		break;
+	case OD_SERVER_UNDEF:
+		break;
+	}
+}
+
+void od_multi_pool_element_set_state(od_multi_pool_element_t *el,
+				     od_server_state_t prev,
+				     od_server_state_t state)
+{
+	if (el == NULL || el->mpool == NULL || prev == state) {
+		return;
+	}
+
+	od_multi_pool_t *mpool = el->mpool;
+	od_multi_pool_account(&mpool->count_active, &mpool->count_idle, prev,
+			      -1);
+	od_multi_pool_account(&mpool->count_active, &mpool->count_idle, state,
+			      1);
+
+	od_multi_pool_address_t *addr = el->address;
+	od_multi_pool_account(&addr->count_active, &addr->count_idle, prev,
+			      -1);
+	od_multi_pool_account(&addr->count_active, &addr->count_idle, state,
+			      1);
+}
+
+int od_multi_pool_total_by_address_locked(od_multi_pool_t *mpool,
+					  const od_address_t *address)
+{
+	od_multi_pool_address_t *addr;
+	addr = od_multi_pool_address_find(mpool, address,
+					  address_hash(address));
+	if (addr == NULL) {
+		return 0;
+	}
+
+	return addr->count_active + addr->count_idle;
+}
+
 od_server_t *
 od_multi_pool_foreach_locked(od_multi_pool_t *mpool,
 			     const od_multi_pool_key_filter_t filter,
@@ -212,6 +491,10 @@ int od_multi_pool_count_active_locked(od_multi_pool_t *mpool,
 				      const od_multi_pool_key_filter_t filter,
 				      void *farg)
 {
+	if (filter == NULL) {
+		return mpool->count_active;
+	}
+
 	int count = 0;
 
 	od_list_t *i;
@@ -219,7 +502,7 @@ int od_multi_pool_count_active_locked(od_multi_pool_t *mpool,
 		od_multi_pool_element_t *el;
 		el = od_container_of(i, od_multi_pool_element_t, link);
 
-		if (filter != NULL && !filter(farg, &el->key)) {
+		if (!filter(farg, &el->key)) {
 			continue;
 		}
 
@@ -233,6 +516,10 @@ int od_multi_pool_count_idle_locked(od_multi_pool_t *mpool,
 				    const od_multi_pool_key_filter_t filter,
 				    void *farg)
 {
+	if (filter == NULL) {
+		return mpool->count_idle;
+	}
+
 	int count = 0;
 
 	od_list_t *i;
@@ -240,7 +527,7 @@ int od_multi_pool_count_idle_locked(od_multi_pool_t *mpool,
 		od_multi_pool_element_t *el;
 		el = od_container_of(i, od_multi_pool_element_t, link);
 
-		if (filter != NULL && !filter(farg, &el->key)) {
+		if (!filter(farg, &el->key)) {
 			continue;
 		}
 
@@ -254,6 +541,10 @@ int od_multi_pool_total_locked(od_multi_pool_t *mpool,
 			       const od_multi_pool_key_filter_t filter,
 			       void *farg)
 {
+	if (filter == NULL) {
+		return mpool->count_active + mpool->count_idle;
+	}
+
 	int count = 0;
 
 	od_list_t *i;
@@ -261,7 +552,7 @@ int od_multi_pool_total_locked(od_multi_pool_t *mpool,
 		od_multi_pool_element_t *el;
 		el = od_container_of(i, od_multi_pool_element_t, link);
 
-		if (filter != NULL && !filter(farg, &el->key)) {
+		if (!filter(farg, &el->key)) {
 			continue;
 		}
 
@@ -276,6 +567,12 @@ od_server_t *od_multi_pool_peek_any_locked(od_multi_pool_t *mpool,
 {
 	od_server_t *server = NULL;
 
+	int count = state == OD_SERVER_IDLE ? mpool->count_idle :
+					      mpool->count_active;
+	if (count == 0) {
+		return NULL;
+	}
+
 	od_list_t *i;
 	od_list_foreach (&mpool->pools, i) {
 		od_multi_pool_element_t *el =
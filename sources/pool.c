@@ -27,6 +27,7 @@ od_rule_pool_t *od_rule_pool_alloc(void)
 	pool->rollback = 1;
 	pool->reserve_prepared_statement = 1;
 	pool->reset_timeout_ms = 1000; /* 1 sec */
+	pool->reset_async = 0;
 	pool->notice_after_waiting_ms = -1;
 	pool->attach_check = 1;
 	pool->acquire_fail_fast = 0;
@@ -91,6 +92,11 @@ int od_rule_pool_compare(od_rule_pool_t *a, od_rule_pool_t *b)
 		return 0;
 	}
 
+	/* reset_async */
+	if (a->reset_async != b->reset_async) {
+		return 0;
+	}
+
 	/* client idle timeout */
 	if (a->client_idle_timeout != b->client_idle_timeout) {
 		return 0;
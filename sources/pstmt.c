@@ -24,110 +24,135 @@ static const uint64_t hash_seed = 0;
 /*
  * client hash map
  * "P_0" -> *od_prepared_stmt_t
+ *
+ * client and server maps are owned by one coroutine and use
+ * open addressing map without locks, short names are kept inline
+ * in the slot, so common "" and "S_1" statements need no allocations
  */
 
-static mm_hash_t xxh_str_ptr(const void *data)
+#define OD_PSTMT_KEY_INLINE_LEN 24
+
+typedef struct {
+	/* long name copy, or name of the lookup key */
+	char *heap;
+	char inline_name[OD_PSTMT_KEY_INLINE_LEN];
+} od_pstmt_key_t;
+
+static inline const char *pstmt_key_name(const od_pstmt_key_t *key)
 {
-	const char *ptr = *(const char **)data;
+	if (key->heap != NULL) {
+		return key->heap;
+	}
 
-	return mm_xxh64_hash(ptr, strlen(ptr), hash_seed);
+	return key->inline_name;
 }
 
-static int str_ptr_cmp(const void *k1, const void *k2)
+static inline od_pstmt_key_t pstmt_lookup_key(const char *name)
 {
-	const char *s1 = *(const char **)k1;
-	const char *s2 = *(const char **)k2;
+	od_pstmt_key_t key;
+	/* only heap is read by hash and cmp */
+	key.heap = (char *)name;
+	return key;
+}
 
-	return strcmp(s1, s2);
+static mm_hash_t xxh_pstmt_key(const void *data)
+{
+	const char *name = pstmt_key_name(data);
+
+	return mm_xxh64_hash(name, strlen(name), hash_seed);
 }
 
-static void str_ptr_dtor(void *k)
+static int pstmt_key_cmp(const void *k1, const void *k2)
 {
-	od_free(*(char **)k);
+	return strcmp(pstmt_key_name(k1), pstmt_key_name(k2));
 }
 
-static int str_ptr_copy(void *dst, const void *src)
+static void pstmt_key_dtor(void *k)
 {
-	const char *key = *(const char **)src;
+	od_pstmt_key_t *key = k;
 
-	char *copy = od_strdup(key);
-	if (copy == NULL) {
-		return -1;
+	od_free(key->heap);
+}
+
+static int pstmt_key_copy(void *dst, const void *src)
+{
+	od_pstmt_key_t *key = dst;
+	const char *name = pstmt_key_name(src);
+	size_t len = strlen(name);
+
+	if (len < sizeof(key->inline_name)) {
+		key->heap = NULL;
+		memcpy(key->inline_name, name, len + 1);
+		return 0;
 	}
 
-	memcpy(dst, &copy, sizeof(char *));
+	key->heap = od_strdup(name);
+	if (key->heap == NULL) {
+		return -1;
+	}
 
 	return 0;
 }
 
-mm_hashmap_t *od_client_pstmt_hashmap_create(void)
+mm_oahm_t *od_client_pstmt_hashmap_create(void)
 {
-	return mm_hashmap_create(
-		50 /* XXX: big enough? */,
-		1 /* nlocks = 1, no fully-concurrent access to client hashmap */,
-		sizeof(char *) /* key size */,
-		sizeof(od_pstmt_t *) /* val size */, str_ptr_cmp /* key cmp */,
-		xxh_str_ptr /* key hash */, str_ptr_dtor /* key dtor */,
-		NULL /* no need to free the pointer from global table */,
-		str_ptr_copy /* key copy */);
+	return mm_oahm_create(sizeof(od_pstmt_key_t) /* key size */,
+			      sizeof(od_pstmt_t *) /* val size */,
+			      pstmt_key_cmp /* key cmp */,
+			      xxh_pstmt_key /* key hash */,
+			      pstmt_key_dtor /* key dtor */,
+			      NULL /* pointer to global table entry */,
+			      pstmt_key_copy /* key copy */);
 }
 
-static int unref_pstmt_entry(mm_hashmap_t *hm, mm_hashmap_kvp_t *kvp,
-			     void **argv)
+static int unref_pstmt_entry(mm_oahm_t *hm, void *key, void *val, void **argv)
 {
+	(void)hm;
+	(void)key;
 	(void)argv;
 
-	od_pstmt_t *pstmt = *(od_pstmt_t **)mm_hashmap_kvp_val(hm, kvp);
+	od_pstmt_t *pstmt = *(od_pstmt_t **)val;
 
 	od_pstmt_unref(pstmt);
 
 	return 0;
 }
 
-void od_client_pstmt_hashmap_free(mm_hashmap_t *hm)
+void od_client_pstmt_hashmap_free(mm_oahm_t *hm)
 {
-	mm_hashmap_foreach(hm, unref_pstmt_entry, NULL);
+	mm_oahm_foreach(hm, unref_pstmt_entry, NULL);
 
-	mm_hashmap_free(hm);
+	mm_oahm_free(hm);
 }
 
 od_pstmt_t *od_client_get_pstmt(od_client_t *client, const char *name)
 {
-	mm_hashmap_keylock_t klock;
-	int rc = mm_hashmap_lock_key(client->prep_stmt_ids, &klock, &name,
-				     0 /* do not create */);
-	(void)rc;
+	od_pstmt_key_t key = pstmt_lookup_key(name);
 
-	if (klock.found) {
-		od_pstmt_t *ps = *(od_pstmt_t **)mm_hashmap_kvp_val(
-			client->prep_stmt_ids, klock.kvp);
-		/* no real concurrent access - can unlock now and return */
-		mm_hashmap_unlock_key(client->prep_stmt_ids, &klock);
-		return ps;
+	od_pstmt_t **val = mm_oahm_get(client->prep_stmt_ids, &key);
+	if (val == NULL) {
+		return NULL;
 	}
 
-	/* lock is not held if key not found */
-	return NULL;
+	return *val;
 }
 
 int od_client_add_pstmt(od_client_t *client, const char *name,
 			od_pstmt_t *pstmt)
 {
-	mm_hashmap_keylock_t klock;
+	od_pstmt_key_t key = pstmt_lookup_key(name);
 	od_pstmt_t *to_unref = NULL;
 	const int unnamed = name[0] == '\0';
+	int found;
 
-	int rc = mm_hashmap_lock_key(client->prep_stmt_ids, &klock, &name,
-				     MM_HASHMAP_CREATE /* do create */);
-	if (rc == -1) {
-		/* cant create and lock is not held */
-		return rc;
+	od_pstmt_t **val = mm_oahm_insert(client->prep_stmt_ids, &key, &found);
+	if (val == NULL) {
+		return -1;
 	}
 
 	int ret = 0;
 
-	void *val = mm_hashmap_kvp_val(client->prep_stmt_ids, klock.kvp);
-	if (unnamed && (*(void **)val) != NULL) {
+	if (unnamed && *val != NULL) {
 		/*
 		 * its ok to redefine "" statement
 		 * (unnamed statemnt is rewritten every Parse,
@@ -136,12 +161,12 @@ int od_client_add_pstmt(od_client_t *client, const char *name,
 		 *
 		 * so need to not forget to unref previous pstmt
 		 */
-		to_unref = *(od_pstmt_t **)val;
+		to_unref = *val;
 	}
 
-	if (!klock.found || unnamed) {
+	if (!found || unnamed) {
 		/* new or "" - save */
-		memcpy(val, &pstmt, sizeof(const od_pstmt_t *));
+		*val = pstmt;
 		od_pstmt_ref(pstmt);
 		ret = 0;
 	} else {
@@ -149,9 +174,6 @@ int od_client_add_pstmt(od_client_t *client, const char *name,
 		ret = 1;
 	}
 
-	/* no real concurrent access - can unlock now and return */
-	mm_hashmap_unlock_key(client->prep_stmt_ids, &klock);
-
 	if (to_unref != NULL) {
 		od_pstmt_unref(to_unref);
 	}
@@ -166,30 +188,21 @@ int od_client_has_pstmt(od_client_t *client, const char *name)
 
 int od_client_remove_pstmt(od_client_t *client, const char *name)
 {
-	mm_hashmap_keylock_t klock;
-	int rc = mm_hashmap_lock_key(client->prep_stmt_ids, &klock, &name,
-				     0 /* do not create */);
-	(void)rc;
-
-	if (klock.kvp != NULL) {
-		od_pstmt_t *pstmt = *(od_pstmt_t **)mm_hashmap_kvp_val(
-			client->prep_stmt_ids, klock.kvp);
-		mm_hashmap_remove(client->prep_stmt_ids, &klock);
-		if (pstmt != NULL) {
-			od_pstmt_unref(pstmt);
-		}
-	}
+	od_pstmt_t *pstmt = od_client_get_pstmt(client, name);
+	od_pstmt_key_t key = pstmt_lookup_key(name);
 
-	/* if not found - lock is not held */
+	if (mm_oahm_remove(client->prep_stmt_ids, &key) && pstmt != NULL) {
+		od_pstmt_unref(pstmt);
+	}
 
 	return 0;
 }
 
 void od_client_pstmts_clear(od_client_t *client)
 {
-	mm_hashmap_foreach(client->prep_stmt_ids, unref_pstmt_entry, NULL);
+	mm_oahm_foreach(client->prep_stmt_ids, unref_pstmt_entry, NULL);
 
-	mm_hashmap_clear(client->prep_stmt_ids);
+	mm_oahm_clear(client->prep_stmt_ids);
 }
 
 /*
@@ -204,53 +217,46 @@ void od_client_pstmts_clear(od_client_t *client)
  * never removes entries; the map is freed on instance shutdown).
  */
 
-mm_hashmap_t *od_client_portal_hashmap_create(void)
+mm_oahm_t *od_client_portal_hashmap_create(void)
 {
-	return mm_hashmap_create(
-		50 /* XXX: big enough? */,
-		1 /* nlocks = 1, no fully-concurrent access */,
-		sizeof(char *) /* key size */,
-		sizeof(od_pstmt_t *) /* value size */,
-		str_ptr_cmp /* key cmp */, xxh_str_ptr /* key hash */,
-		str_ptr_dtor /* key dtor */,
-		NULL /* no need to free the pointer from global table */,
-		str_ptr_copy /* key copy */);
+	return mm_oahm_create(sizeof(od_pstmt_key_t) /* key size */,
+			      sizeof(od_pstmt_t *) /* value size */,
+			      pstmt_key_cmp /* key cmp */,
+			      xxh_pstmt_key /* key hash */,
+			      pstmt_key_dtor /* key dtor */,
+			      NULL /* pointer to global table entry */,
+			      pstmt_key_copy /* key copy */);
 }
 
-void od_client_portal_hashmap_free(mm_hashmap_t *hm)
+void od_client_portal_hashmap_free(mm_oahm_t *hm)
 {
-	mm_hashmap_foreach(hm, unref_pstmt_entry, NULL);
+	mm_oahm_foreach(hm, unref_pstmt_entry, NULL);
 
-	mm_hashmap_free(hm);
+	mm_oahm_free(hm);
 }
 
 od_pstmt_t *od_client_get_portal(od_client_t *client, const char *portal_name)
 {
-	mm_hashmap_keylock_t klock;
-	int rc = mm_hashmap_lock_key(client->portals, &klock, &portal_name,
-				     0 /* do not create */);
-	(void)rc;
+	od_pstmt_key_t key = pstmt_lookup_key(portal_name);
 
-	if (klock.found) {
-		od_pstmt_t *ps = *(od_pstmt_t **)mm_hashmap_kvp_val(
-			client->portals, klock.kvp);
-		mm_hashmap_unlock_key(client->portals, &klock);
-		return ps;
+	od_pstmt_t **val = mm_oahm_get(client->portals, &key);
+	if (val == NULL) {
+		return NULL;
 	}
 
-	return NULL;
+	return *val;
 }
 
 int od_client_add_portal(od_client_t *client, const char *portal_name,
 			 od_pstmt_t *pstmt)
 {
-	mm_hashmap_keylock_t klock;
+	od_pstmt_key_t key = pstmt_lookup_key(portal_name);
 	od_pstmt_t *to_unref = NULL;
+	int found;
 
-	int rc = mm_hashmap_lock_key(client->portals, &klock, &portal_name,
-				     MM_HASHMAP_CREATE /* do create */);
-	if (rc == -1) {
-		return rc;
+	od_pstmt_t **val = mm_oahm_insert(client->portals, &key, &found);
+	if (val == NULL) {
+		return -1;
 	}
 
 	/*
@@ -259,11 +265,9 @@ int od_client_add_portal(od_client_t *client, const char *portal_name,
 	 * the server will enforce that - we just store the mapping here
 	 */
 
-	void *val = mm_hashmap_kvp_val(client->portals, klock.kvp);
-	to_unref = *(od_pstmt_t **)(val);
-	memcpy(val, &pstmt, sizeof(const od_pstmt_t *));
+	to_unref = *val;
+	*val = pstmt;
 	od_pstmt_ref(pstmt);
-	mm_hashmap_unlock_key(client->portals, &klock);
 
 	if (to_unref != NULL) {
 		od_pstmt_unref(to_unref);
@@ -274,20 +278,11 @@ int od_client_add_portal(od_client_t *client, const char *portal_name,
 
 int od_client_remove_portal(od_client_t *client, const char *portal_name)
 {
-	mm_hashmap_keylock_t klock;
-	int rc = mm_hashmap_lock_key(client->portals, &klock, &portal_name,
-				     0 /* do not create */);
-	(void)rc;
-
-	if (klock.kvp != NULL) {
-		od_pstmt_t *pstmt = *(od_pstmt_t **)mm_hashmap_kvp_val(
-			client->portals, klock.kvp);
+	od_pstmt_t *pstmt = od_client_get_portal(client, portal_name);
+	od_pstmt_key_t key = pstmt_lookup_key(portal_name);
 
-		mm_hashmap_remove(client->portals, &klock);
-
-		if (pstmt != NULL) {
-			od_pstmt_unref(pstmt);
-		}
+	if (mm_oahm_remove(client->portals, &key) && pstmt != NULL) {
+		od_pstmt_unref(pstmt);
 	}
 
 	return 0;
@@ -295,9 +290,9 @@ int od_client_remove_portal(od_client_t *client, const char *portal_name)
 
 void od_client_portals_clear(od_client_t *client)
 {
-	mm_hashmap_foreach(client->portals, unref_pstmt_entry, NULL);
+	mm_oahm_foreach(client->portals, unref_pstmt_entry, NULL);
 
-	mm_hashmap_clear(client->portals);
+	mm_oahm_clear(client->portals);
 }
 
 /*
@@ -320,52 +315,36 @@ static int str_inplace_cmp(const void *k1, const void *k2)
 	return strcmp(s1, s2);
 }
 
-mm_hashmap_t *od_server_pstmt_hashmap_create(void)
+mm_oahm_t *od_server_pstmt_hashmap_create(void)
 {
-	return mm_hashmap_create(
-		100 /* XXX: big enough? */,
-		1 /* nlocks = 1, no fully-concurrent access to server hashmap */,
-		sizeof(od_pstmt_name_t) /* key size */,
-		sizeof(od_pstmt_t *) /* value size */,
-		str_inplace_cmp /* key cmp */, xxh_str_inplace /* key hash */,
-		NULL /* no need to free on inplace str */,
-		NULL /* no need to free the pointer from global table */,
-		NULL /* no key copy function */
-	);
+	return mm_oahm_create(sizeof(od_pstmt_name_t) /* key size */,
+			      sizeof(od_pstmt_t *) /* value size */,
+			      str_inplace_cmp /* key cmp */,
+			      xxh_str_inplace /* key hash */,
+			      NULL /* no need to free on inplace str */,
+			      NULL /* pointer to global table entry */,
+			      NULL /* no key copy function */);
 }
 
-void od_server_pstmt_hashmap_free(mm_hashmap_t *hm)
+void od_server_pstmt_hashmap_free(mm_oahm_t *hm)
 {
-	mm_hashmap_foreach(hm, unref_pstmt_entry, NULL);
+	mm_oahm_foreach(hm, unref_pstmt_entry, NULL);
 
-	mm_hashmap_free(hm);
+	mm_oahm_free(hm);
 }
 
 int od_server_has_pstmt(od_server_t *server, const od_pstmt_t *pstmt)
 {
-	mm_hashmap_keylock_t klock;
-	int rc = mm_hashmap_lock_key(server->prep_stmts, &klock, pstmt->name,
-				     0 /* do not create */);
-	(void)rc;
-
-	if (klock.found) {
-		/* no real concurrent access - can unlock now and return */
-		mm_hashmap_unlock_key(server->prep_stmts, &klock);
-		return 1;
-	}
-
-	/* not exists - no lock held */
-	return 0;
+	return mm_oahm_get(server->prep_stmts, pstmt->name) != NULL;
 }
 
 int od_server_add_pstmt(od_server_t *server, od_pstmt_t *pstmt)
 {
-	mm_hashmap_keylock_t klock;
-	int rc = mm_hashmap_lock_key(server->prep_stmts, &klock, pstmt->name,
-				     MM_HASHMAP_CREATE /* do create */);
-	if (rc == -1) {
-		/* cant create and lock is not held */
-		return rc;
+	int found;
+	od_pstmt_t **val = mm_oahm_insert(server->prep_stmts, pstmt->name,
+					  &found);
+	if (val == NULL) {
+		return -1;
 	}
 
 	/*
@@ -374,50 +353,38 @@ int od_server_add_pstmt(od_server_t *server, od_pstmt_t *pstmt)
 	 * because no pstmts can be upserted
 	 */
 
-	int ret = 0;
-
-	if (!klock.found) {
-		/* new element - set the value */
-		void *val = mm_hashmap_kvp_val(server->prep_stmts, klock.kvp);
-		memcpy(val, &pstmt, sizeof(const od_pstmt_t *));
-		od_pstmt_ref(pstmt);
-		ret = 0;
-	} else {
-		ret = 1;
+	if (found) {
+		return 1;
 	}
 
-	/* no real concurrent access - can unlock now and return */
-	mm_hashmap_unlock_key(server->prep_stmts, &klock);
+	/* new element - set the value */
+	*val = pstmt;
+	od_pstmt_ref(pstmt);
 
-	return ret;
+	return 0;
 }
 
 int od_server_remove_pstmt(od_server_t *server, const od_pstmt_t *pstmt)
 {
-	mm_hashmap_keylock_t klock;
-	int rc = mm_hashmap_lock_key(server->prep_stmts, &klock, pstmt->name,
-				     0 /* do not create */);
-	(void)rc;
-
-	if (klock.found) {
-		od_pstmt_t *p = *(od_pstmt_t **)mm_hashmap_kvp_val(
-			server->prep_stmts, klock.kvp);
-		mm_hashmap_remove(server->prep_stmts, &klock);
-		if (p != NULL) {
-			od_pstmt_unref(p);
-		}
+	od_pstmt_t **val = mm_oahm_get(server->prep_stmts, pstmt->name);
+	if (val == NULL) {
+		return 0;
 	}
 
-	/* if not found - lock is not held */
+	od_pstmt_t *p = *val;
+	mm_oahm_remove(server->prep_stmts, pstmt->name);
+	if (p != NULL) {
+		od_pstmt_unref(p);
+	}
 
 	return 0;
 }
 
 void od_server_pstmts_clear(od_server_t *server)
 {
-	mm_hashmap_foreach(server->prep_stmts, unref_pstmt_entry, NULL);
+	mm_oahm_foreach(server->prep_stmts, unref_pstmt_entry, NULL);
 
-	mm_hashmap_clear(server->prep_stmts);
+	mm_oahm_clear(server->prep_stmts);
 }
 
 /*
@@ -45,25 +45,40 @@ int od_readahead_prepare(od_readahead_t *readahead)
 	pthread_once(&vrb_cache_init_ctrl, init_vrb_cache);
 
 	readahead->buf = mm_virtual_rbuf_cache_get(&vrb_cache);
-	if (readahead->buf != NULL) {
-		return 0;
+	if (readahead->buf == NULL) {
+		od_instance_t *instance = od_global_get_instance();
+		size_t size = (size_t)instance->config.readahead;
+
+		readahead->buf = mm_virtual_rbuf_create(size);
+		if (readahead->buf == NULL) {
+			return -1;
+		}
 	}
 
-	od_instance_t *instance = od_global_get_instance();
-	size_t size = (size_t)instance->config.readahead;
+	readahead->resident = mm_virtual_rbuf_capacity(readahead->buf);
+	return 0;
+}
 
-	readahead->buf = mm_virtual_rbuf_create(size);
-	if (readahead->buf != NULL) {
-		return 0;
+void od_readahead_release(od_readahead_t *readahead)
+{
+	if (readahead->buf == NULL) {
+		return;
+	}
+	if (mm_virtual_rbuf_size(readahead->buf) > 0) {
+		return;
 	}
 
-	return -1;
+	mm_virtual_rbuf_cache_put(&vrb_cache, readahead->buf);
+	readahead->buf = NULL;
+	readahead->resident = 0;
 }
 
 void od_readahead_free(od_readahead_t *readahead)
 {
 	if (readahead->buf) {
 		mm_virtual_rbuf_cache_put(&vrb_cache, readahead->buf);
+		readahead->buf = NULL;
+		readahead->resident = 0;
 	}
 }
 
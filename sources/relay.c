@@ -26,9 +26,11 @@
 #include <stream.h>
 #include <xplan.h>
 #include <pstmt.h>
+#include <deploy.h>
 #include <misc.h>
 #include <worker.h>
 #include <sql/minimal/parser.h>
+#include <sql/minimal/prefilter.h>
 
 #define APPLICATION_NAME_STR "application_name"
 #define ODYSSEY_TARGET_SESSION_ATTRS_STR "odyssey.target_session_attrs"
@@ -269,6 +271,10 @@ process_set_appname(od_client_t *client, const od_sql_minimal_set_stmt_t *stmt)
 	od_snprintf(query, sizeof(query), "set application_name to '%.*s';",
 		    appname_len, appname);
 
+	if (od_deploy_flush(client, "query") != OK_RESPONSE) {
+		return OD_ESERVER_WRITE;
+	}
+
 	machine_msg_t *msg;
 	msg = kiwi_fe_write_query(NULL, query, strlen(query) + 1);
 	if (msg == NULL) {
@@ -477,6 +483,32 @@ process_vbegin(od_client_t *client, const od_sql_minimal_begin_stmt_t *stmt)
 	return OD_SKIP;
 }
 
+/*
+ * most of the queries are not the statements that can be processed
+ * virtually, this allows to not run the parser on them
+ */
+static inline int need_parse_query(od_client_t *client, const char *query,
+				   uint32_t query_len)
+{
+	od_instance_t *instance = od_global_get_instance();
+
+	switch (od_sql_minimal_classify(query, query_len - 1)) {
+	case OD_SQL_MINIMAL_STMT_SHOW:
+		return instance->config.virtual_processing;
+	case OD_SQL_MINIMAL_STMT_SET:
+		return client->rule->application_name_add_host ||
+		       instance->config.virtual_processing;
+	case OD_SQL_MINIMAL_STMT_BEGIN:
+		return instance->config.virtual_transaction;
+	case OD_SQL_MINIMAL_STMT_DEALLOCATE:
+		return client->rule->pool->reserve_prepared_statement;
+	case OD_SQL_MINIMAL_STMT_DISCARD:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
 static od_frontend_status_t try_virtual_process_query(od_client_t *client,
 						      od_linear_alloc_t *arena,
 						      const char *query,
@@ -490,6 +522,10 @@ static od_frontend_status_t try_virtual_process_query(od_client_t *client,
 		return OD_OK;
 	}
 
+	if (!need_parse_query(client, query, query_len)) {
+		return OD_OK;
+	}
+
 	od_sql_minimal_node_t *ast = od_sql_minimal_parse(
 		query, query_len - 1 /* zero included */, arena, NULL, NULL);
 	if (ast == NULL) {
@@ -681,24 +717,52 @@ process_query_impl(od_relay_t *relay, machine_msg_t *msg, uint32_t timeout_ms)
 			return OD_ATTACH;
 		}
 
+		machine_msg_t *rewritten = NULL;
 		if (client->pending_begin) {
-			machine_msg_t *rewritten = kiwi_fe_write_query_join(
-				NULL, "BEGIN;", query, NULL);
+			rewritten = kiwi_fe_write_query_join(NULL, "BEGIN;",
+							     query, NULL);
 			if (rewritten == NULL) {
 				return OD_EOOM;
 			}
+		}
 
-			rc = od_io_write(&server->io, rewritten, timeout_ms);
-			machine_msg_free(rewritten);
+		/* the pending deploy is taken, so it must be written now */
+		machine_msg_t *deploy;
+		if (od_deploy_prepare(client, "main", &deploy) != OK_RESPONSE) {
+			machine_msg_free_safe(rewritten);
+			return OD_ESERVER_WRITE;
+		}
+
+		machine_msg_t *out = rewritten != NULL ? rewritten : msg;
+		int deployed = deploy != NULL;
+		if (deployed) {
+			/*
+			 * deploy goes as a separate Query in the same write,
+			 * so it does not share implicit transaction with
+			 * the client query
+			 */
+			rc = machine_msg_write(deploy, machine_msg_data(out),
+					       machine_msg_size(out));
+			if (rc == 0) {
+				rc = od_io_write(&server->io, deploy,
+						 timeout_ms);
+			}
+			machine_msg_free(deploy);
 		} else {
-			rc = od_io_write(&server->io, msg, timeout_ms);
+			rc = od_io_write(&server->io, out, timeout_ms);
 		}
+		machine_msg_free_safe(rewritten);
 
 		if (rc != 0) {
 			return OD_ESERVER_WRITE;
 		}
 
 		od_server_sync_request(server, 1);
+
+		if (deployed &&
+		    od_deploy_complete(client, "main") != OK_RESPONSE) {
+			return OD_ESERVER_READ;
+		}
 	} else {
 		/* not skip, not replace and not ok - need handle on higher level */
 		return status;
@@ -805,6 +869,10 @@ process_fcall_impl(od_relay_t *relay, machine_msg_t *msg, uint32_t timeout_ms)
 		return OD_ATTACH;
 	}
 
+	if (od_deploy_flush(client, "main") != OK_RESPONSE) {
+		return OD_ESERVER_WRITE;
+	}
+
 	/* no need special handling - just write call and wait for rfq */
 
 	int rc = od_io_write(&server->io, msg, timeout_ms);
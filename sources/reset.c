@@ -18,6 +18,23 @@
 #include <query.h>
 #include <cancel.h>
 #include <stream.h>
+#include <router.h>
+#include <client.h>
+
+static inline int reset_append_query(machine_msg_t **msg, int *count,
+				     const char *query, int len)
+{
+	machine_msg_t *next = kiwi_fe_write_query(*msg, query, len);
+	if (next == NULL) {
+		machine_msg_free_safe(*msg);
+		*msg = NULL;
+		return -1;
+	}
+
+	*msg = next;
+	(*count)++;
+	return 0;
+}
 
 int od_reset(od_server_t *server)
 {
@@ -127,31 +144,31 @@ int od_reset(od_server_t *server)
 	od_debug(&instance->logger, "reset", server->client, server,
 		 "synchronized");
 
-	int rc;
+	/*
+	 * rollback and discard queries are independent, so they are
+	 * sent as separate Query messages in one write and waited
+	 * until the server is synchronized again
+	 */
+	machine_msg_t *msg = NULL;
+	int count = 0;
 
 	/* send rollback in case server has an active
 	 * transaction running */
 	if (route->rule->pool->rollback) {
 		if (server->is_transaction) {
 			char query_rlb[] = "ROLLBACK";
-			rc = od_backend_query(server, "reset-rollback",
-					      query_rlb, NULL,
-					      sizeof(query_rlb),
-					      reset_timeout_ms);
-			if (rc == NOT_OK_RESPONSE) {
+			if (reset_append_query(&msg, &count, query_rlb,
+					       sizeof(query_rlb)) != 0) {
 				goto error;
 			}
-			od_assert(!server->is_transaction);
 		}
 	}
 
 	/* send DISCARD ALL */
 	if (route->rule->pool->discard) {
 		char query_discard[] = "DISCARD ALL";
-		rc = od_backend_query(server, "reset-discard", query_discard,
-				      NULL, sizeof(query_discard),
-				      reset_timeout_ms);
-		if (rc == NOT_OK_RESPONSE) {
+		if (reset_append_query(&msg, &count, query_discard,
+				       sizeof(query_discard)) != 0) {
 			goto error;
 		}
 	}
@@ -161,22 +178,40 @@ int od_reset(od_server_t *server)
 	    route->rule->pool->discard_query == NULL) {
 		char query_discard[] =
 			"SET SESSION AUTHORIZATION DEFAULT;RESET ALL;CLOSE ALL;UNLISTEN *;SELECT pg_advisory_unlock_all();DISCARD PLANS;DISCARD SEQUENCES;DISCARD TEMP;";
-		rc = od_backend_query(server, "reset-discard-smart",
-				      query_discard, NULL,
-				      sizeof(query_discard), reset_timeout_ms);
-		if (rc == NOT_OK_RESPONSE) {
+		if (reset_append_query(&msg, &count, query_discard,
+				       sizeof(query_discard)) != 0) {
 			goto error;
 		}
 	}
 	if (route->rule->pool->discard_query != NULL) {
-		rc = od_backend_query(server, "reset-discard-smart-string",
-				      route->rule->pool->discard_query, NULL,
-				      strlen(route->rule->pool->discard_query) +
-					      1,
-				      reset_timeout_ms);
-		if (rc == NOT_OK_RESPONSE) {
+		if (reset_append_query(
+			    &msg, &count, route->rule->pool->discard_query,
+			    strlen(route->rule->pool->discard_query) + 1) !=
+		    0) {
+			goto error;
+		}
+	}
+
+	if (count > 0) {
+		od_debug(&instance->logger, "reset", server->client, server,
+			 "sending %d reset queries", count);
+
+		int rc = od_write2(&server->io, msg, reset_timeout_ms);
+		if (rc == -1) {
+			od_error(&instance->logger, "reset", server->client,
+				 server, "write error: %s",
+				 od_io_error(&server->io));
 			goto error;
 		}
+		od_server_sync_request(server, count);
+
+		while (!od_server_synchronized(server)) {
+			rc = od_backend_ready_wait(server, "reset",
+						   reset_timeout_ms);
+			if (rc == NOT_OK_RESPONSE) {
+				goto error;
+			}
+		}
 	}
 
 	if (od_readahead_unread(&server->io.readahead) > 0) {
@@ -193,3 +228,32 @@ drop:
 error:
 	return -1;
 }
+
+static void reset_async_main(void *arg)
+{
+	od_server_t *server = arg;
+	od_router_t *router = server->global->router;
+
+	int rc = od_reset(server);
+	if (rc != 1) {
+		od_instance_t *instance = server->global->instance;
+		od_log(&instance->logger, "reset", NULL, server,
+		       "background reset unsuccessful, closing server connection");
+	}
+
+	od_router_reset_complete(router, server, rc == 1);
+}
+
+void od_reset_async(od_client_t *client)
+{
+	od_router_t *router = client->global->router;
+
+	od_server_t *server = od_router_detach_for_reset(router, client);
+
+	int64_t id = machine_coroutine_create_named(reset_async_main, server,
+						    "reset");
+	if (id == -1) {
+		/* can't go to background - reset here */
+		reset_async_main(server);
+	}
+}
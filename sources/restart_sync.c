@@ -10,6 +10,7 @@
 #include <pthread.h>
 #include <unistd.h>
 #include <signal.h>
+#include <limits.h>
 
 #include <restart_sync.h>
 #include <global.h>
@@ -19,6 +20,7 @@
 #include <systemd_notify.h>
 
 #define ODYSSEY_PARENT_PID_ENV_NAME "ODY_INHERIT_PPID"
+#define ODYSSEY_TLS_TICKET_KEYS_ENV_NAME "ODY_INHERIT_TLS_TICKET_KEYS_FD"
 
 pid_t od_restart_get_ppid(void)
 {
@@ -79,48 +81,129 @@ void od_restart_terminate_parent(void)
 	 */
 }
 
-char **build_envp(char *inherit_val)
+/*
+ * keys of the client TLS session tickets are passed to the new binary
+ * through the pipe, so tickets issued before restart are still resumed
+ */
+static int od_restart_export_tls_ticket_keys(void)
+{
+	char keys[MACHINE_TLS_TICKET_KEYS_EXPORT_SIZE];
+	ssize_t size = machine_tls_ticket_keys_export(keys, sizeof(keys));
+	if (size <= 0) {
+		/* tickets are disabled */
+		return -1;
+	}
+
+	int fds[2];
+	if (pipe(fds) == -1) {
+		online_restart_error("can't create tls ticket keys pipe: %s",
+				     strerror(errno));
+		explicit_bzero(keys, sizeof(keys));
+		return -1;
+	}
+
+	/* pipe buffer is much larger than keys, so write will not block */
+	ssize_t rc = write(fds[1], keys, size);
+	explicit_bzero(keys, sizeof(keys));
+	close(fds[1]);
+	if (rc != size) {
+		online_restart_error("can't pass tls ticket keys: %s",
+				     strerror(errno));
+		close(fds[0]);
+		return -1;
+	}
+
+	return fds[0];
+}
+
+int od_restart_inherit_tls_ticket_keys(void)
 {
 	od_instance_t *instance = od_global_get_instance();
-	char **envp = instance->cmdline.envp;
-	size_t name_len = strlen(ODYSSEY_PARENT_PID_ENV_NAME);
+	const char *fd_str =
+		od_instance_getenv(instance, ODYSSEY_TLS_TICKET_KEYS_ENV_NAME);
+	if (fd_str == NULL) {
+		return 0;
+	}
 
-	int existed_idx = -1;
-	int count;
+	char *end;
+	long fd = strtol(fd_str, &end, 10);
+	if (*end != 0 || fd < 0 || fd > INT_MAX) {
+		/* parent had no keys */
+		return 0;
+	}
 
-	for (count = 0; envp[count] != NULL; ++count) {
-		if (existed_idx != -1) {
+	char keys[MACHINE_TLS_TICKET_KEYS_EXPORT_SIZE];
+	size_t size = 0;
+	while (size < sizeof(keys)) {
+		ssize_t rc = read((int)fd, keys + size, sizeof(keys) - size);
+		if (rc == -1 && errno == EINTR) {
 			continue;
 		}
+		if (rc <= 0) {
+			break;
+		}
+		size += rc;
+	}
+	close((int)fd);
+
+	int rc = machine_tls_ticket_keys_import(keys, size);
+	explicit_bzero(keys, sizeof(keys));
+	if (rc == -1) {
+		online_restart_error("can't import tls ticket keys of parent");
+		return -1;
+	}
+
+	return 1;
+}
 
-		int name_diff = strncmp(envp[count],
-					ODYSSEY_PARENT_PID_ENV_NAME, name_len);
-		if (name_diff == 0 && envp[count][name_len] == '=') {
-			existed_idx = count;
+static inline int od_restart_env_inherited(const char *env,
+					   char **inherit_vals)
+{
+	for (int i = 0; inherit_vals[i] != NULL; ++i) {
+		const char *val = inherit_vals[i];
+		size_t name_len = strchr(val, '=') - val;
+		if (strncmp(env, val, name_len) == 0 &&
+		    env[name_len] == '=') {
+			return 1;
 		}
 	}
 
-	int new_count = (existed_idx == -1 ? count + 1 : count);
-	char **new_envp =
-		od_malloc(sizeof(char *) * (new_count + 1 /* for NULL */));
+	return 0;
+}
+
+char **build_envp(char **inherit_vals)
+{
+	od_instance_t *instance = od_global_get_instance();
+	char **envp = instance->cmdline.envp;
+
+	int count;
+	for (count = 0; envp[count] != NULL; ++count) {
+	}
+
+	int inherit_count;
+	for (inherit_count = 0; inherit_vals[inherit_count] != NULL;
+	     ++inherit_count) {
+	}
+
+	char **new_envp = od_malloc(sizeof(char *) *
+				    (count + inherit_count + 1 /* for NULL */));
 	if (new_envp == NULL) {
 		return NULL;
 	}
 
-	int i;
-	for (i = 0; i < count; ++i) {
-		if (i != existed_idx) {
-			new_envp[i] = envp[i];
-		} else {
-			new_envp[i] = inherit_val;
+	/* inherited values replace the ones of the parent environment */
+	int n = 0;
+	for (int i = 0; i < count; ++i) {
+		if (!od_restart_env_inherited(envp[i], inherit_vals)) {
+			new_envp[n++] = envp[i];
 		}
 	}
 
-	if (existed_idx == -1) {
-		new_envp[i++] = inherit_val;
+	for (int i = 0; i < inherit_count; ++i) {
+		new_envp[n++] = inherit_vals[i];
 	}
 
-	new_envp[i] = NULL;
+	new_envp[n] = NULL;
 
 	return new_envp;
 }
@@ -132,22 +215,35 @@ pid_t od_restart_run_new_binary(void)
 		 ODYSSEY_PARENT_PID_ENV_NAME,
 		 od_global_get_instance()->pid.pid);
 
+	/* -1 overrides the fd inherited by this binary itself */
+	int keys_fd = od_restart_export_tls_ticket_keys();
+	char keys_str[128];
+	snprintf(keys_str, sizeof(keys_str), "%s=%d",
+		 ODYSSEY_TLS_TICKET_KEYS_ENV_NAME, keys_fd);
+
 	od_instance_t *instance = od_global_get_instance();
 
 	pid_t p = fork();
 	if (p == -1) {
 		online_restart_error("can't fork new binary: %s",
 				     strerror(errno));
+		if (keys_fd != -1) {
+			close(keys_fd);
+		}
 		return -1;
 	}
 
 	if (p != 0) {
+		if (keys_fd != -1) {
+			close(keys_fd);
+		}
 		/* report pid of new odyssey instance */
 		return p;
 	}
 
 	/* will not free any of allocations anyway */
-	char **envp = build_envp(inherit_str);
+	char *inherit_vals[] = { inherit_str, keys_str, NULL };
+	char **envp = build_envp(inherit_vals);
 	if (envp != NULL) {
 		execve(instance->cmdline.argv[0], instance->cmdline.argv, envp);
 	}
@@ -9,6 +9,7 @@
 
 #include <status.h>
 #include <global.h>
+#include <instance.h>
 #include <router.h>
 #include <server.h>
 #include <backend.h>
@@ -32,6 +33,42 @@ od_route_get_server_pool_element_locked(od_route_t *route,
 						  &pool_key);
 }
 
+/*
+ * how many idle servers to look through for the one, that was
+ * used by the current worker last time
+ */
+#define OD_ROUTE_IDLE_AFFINITY_SCAN 16
+
+/*
+ * prefer idle server, which io was attached to the current machine
+ * last time: its readahead and tls state are warm in the worker caches
+ *
+ * io of the idle server is detached from the worker event loop anyway,
+ * so the attach costs the same on any worker
+ */
+static inline od_server_t *pool_next_idle_affine(od_server_pool_t *pool)
+{
+	uint64_t self = machine_self();
+	od_server_t *first = od_pg_server_pool_next(pool, OD_SERVER_IDLE);
+	if (first == NULL || first->last_machine == self) {
+		return first;
+	}
+
+	int scanned = 0;
+	od_list_t *i;
+	od_list_foreach (&pool->idle, i) {
+		if (scanned++ == OD_ROUTE_IDLE_AFFINITY_SCAN) {
+			break;
+		}
+		od_server_t *server = od_container_of(i, od_server_t, link);
+		if (server->last_machine == self) {
+			return server;
+		}
+	}
+
+	return first;
+}
+
 static inline int pool_next_idle_exclusive_locked(od_route_t *route,
 						  const od_address_t *address,
 						  od_server_t **server)
@@ -45,7 +82,7 @@ static inline int pool_next_idle_exclusive_locked(od_route_t *route,
 		return OD_ROUTER_ERROR;
 	}
 
-	*server = od_pg_server_pool_next(&pool_element->pool, OD_SERVER_IDLE);
+	*server = pool_next_idle_affine(&pool_element->pool);
 
 	return OD_ROUTER_OK;
 }
@@ -64,7 +101,7 @@ static inline int pool_next_idle_shared_locked(od_route_t *route,
 		return OD_ROUTER_ERROR;
 	}
 
-	*server = od_pg_server_pool_next(&pool_element->pool, OD_SERVER_IDLE);
+	*server = pool_next_idle_affine(&pool_element->pool);
 
 	if (*server != NULL) {
 		return OD_ROUTER_OK;
@@ -131,25 +168,14 @@ int od_route_server_pool_next_idle_locked(od_route_t *route,
 	return rc;
 }
 
-static inline int filter_by_address(void *arg, const od_multi_pool_key_t *key)
-{
-	const od_address_t *address = arg;
-
-	if (od_address_cmp(address, &key->address) == 0) {
-		return 1;
-	}
-
-	return 0;
-}
-
 int od_route_server_pool_total(od_route_t *route, od_multi_pool_element_t *el)
 {
 	if (od_route_has_exclusive_pool(route)) {
 		return od_server_pool_total(&el->pool);
 	}
 
-	int total = od_multi_pool_total_locked(
-		route->shared_pool->mpool, filter_by_address, &el->key.address);
+	int total = od_multi_pool_total_by_address_locked(
+		route->shared_pool->mpool, &el->key.address);
 
 	return total;
 }
@@ -162,8 +188,8 @@ int od_route_server_pool_can_add_locked(od_route_t *route,
 					    od_server_pool_total(&el->pool));
 	}
 
-	int total = od_multi_pool_total_locked(
-		route->shared_pool->mpool, filter_by_address, &el->key.address);
+	int total = od_multi_pool_total_by_address_locked(
+		route->shared_pool->mpool, &el->key.address);
 
 	/* shared pool can't have size of 0 */
 	return total < route->shared_pool->pool_size;
@@ -195,6 +221,17 @@ void od_route_signal_locked(od_route_t *route, od_server_t *server)
 	od_multi_pool_signal_locked(mpool, el, server);
 }
 
+size_t od_route_stat_shards_count(void)
+{
+	od_global_t *global = od_global_get();
+	if (global == NULL || global->instance == NULL) {
+		return 1;
+	}
+
+	/* one shard per worker and one for system machines */
+	return (size_t)global->instance->config.workers + 1;
+}
+
 od_route_pswd_t *od_route_pswd_create(const char *value)
 {
 	size_t len = strlen(value);
@@ -22,13 +22,21 @@
 #include <util.h>
 #include <stat.h>
 #include <pool.h>
+#include <compression.h>
 
 void od_router_init(od_router_t *router, od_global_t *global)
 {
 	mm_mutex_init(&router->lock);
+	router->lock_acquired = 0;
+	router->lock_contended = 0;
+	router->server_affinity_hits = 0;
+	router->server_affinity_migrations = 0;
 	od_rules_init(&router->rules);
+	router->rules_snapshot = NULL;
+	mm_rwsleeplock_init(&router->rules_snapshot_lock);
 	od_list_init(&router->servers);
 	od_route_pool_init(&router->route_pool);
+	od_cancel_table_init(&router->cancel_table);
 	router->clients = 0;
 	router->servers_routing = 0;
 
@@ -73,8 +81,13 @@ void od_router_free(od_router_t *router)
 	}
 
 	od_router_foreach(router, od_router_immed_close_cb, NULL);
+	if (router->rules_snapshot != NULL) {
+		od_rules_index_unref(router->rules_snapshot);
+		router->rules_snapshot = NULL;
+	}
 	od_rules_free(&router->rules);
 	od_route_pool_free(&router->route_pool);
+	od_cancel_table_free(&router->cancel_table);
 	mm_mutex_destroy(&router->lock);
 	od_err_logger_free(router->router_err_logger);
 }
@@ -111,6 +124,36 @@ static inline int od_drop_obsolete_rule_connections_cb(od_route_t *route,
 	return 0;
 }
 
+void od_router_publish_rules(od_router_t *router)
+{
+	od_rules_index_t *snapshot = router->rules.index;
+	if (snapshot != NULL) {
+		od_rules_index_ref(snapshot);
+	}
+
+	mm_rwsleeplock_wrlock(&router->rules_snapshot_lock);
+	od_rules_index_t *prev = router->rules_snapshot;
+	router->rules_snapshot = snapshot;
+	mm_rwsleeplock_wrunlock(&router->rules_snapshot_lock);
+
+	/* readers, that still use previous snapshot, hold their own refs */
+	if (prev != NULL) {
+		od_rules_index_unref(prev);
+	}
+}
+
+static inline od_rules_index_t *od_router_rules_snapshot(od_router_t *router)
+{
+	mm_rwsleeplock_rdlock(&router->rules_snapshot_lock);
+	od_rules_index_t *snapshot = router->rules_snapshot;
+	if (snapshot != NULL) {
+		od_rules_index_ref(snapshot);
+	}
+	mm_rwsleeplock_rdunlock(&router->rules_snapshot_lock);
+
+	return snapshot;
+}
+
 int od_router_reconfigure(od_router_t *router, od_rules_t *rules)
 {
 	od_instance_t *instance = router->global->instance;
@@ -129,6 +172,7 @@ int od_router_reconfigure(od_router_t *router, od_rules_t *rules)
 
 	updates = od_rules_merge(&router->rules, rules, &added, &deleted,
 				 &to_drop, &not_changed);
+	od_router_publish_rules(router);
 
 	od_list_foreach_safe (&not_changed, i, j) {
 		od_rule_key_t *rk;
@@ -418,6 +462,7 @@ static inline int od_router_create_idle_server(od_route_t *route,
 	 * need to do it manually, because we 'return' the connection to pool
 	 * manually, not by od_router_detach
 	 */
+	od_compression_backend_account(server);
 	od_io_detach(&server->io);
 
 	/* the pool still need in that connection */
@@ -604,10 +649,10 @@ static inline int od_router_gc_cb(od_route_t *route, void **argv)
 		goto done;
 	}
 
-	/* remove route from route pool */
-	od_assert(pool->count > 0);
-	pool->count--;
-	od_list_unlink(&route->link);
+	/* remove route from route pool, unless it is being routed to */
+	if (od_route_pool_remove(pool, route) != OK_RESPONSE) {
+		goto done;
+	}
 
 	od_route_unlock(route);
 
@@ -639,6 +684,142 @@ void od_router_stat(od_router_t *router, uint64_t prev_time_us,
 	od_router_unlock(router);
 }
 
+static inline void od_router_route_id(od_rule_t *rule,
+				      kiwi_be_startup_t *startup,
+				      od_route_id_t *id)
+{
+	/* force settings required by route */
+	od_route_id_t route_id = { .database = startup->database.value,
+				   .user = startup->user.value,
+				   .database_len = startup->database.value_len,
+				   .user_len = startup->user.value_len,
+				   .physical_rep = false,
+				   .logical_rep = false };
+	if (rule->storage_db) {
+		route_id.database = rule->storage_db;
+		route_id.database_len = strlen(rule->storage_db) + 1;
+	}
+	if (rule->storage_user) {
+		route_id.user = rule->storage_user;
+		route_id.user_len = strlen(rule->storage_user) + 1;
+	}
+	*id = route_id;
+}
+
+static inline void od_router_debug_rule(od_instance_t *instance,
+					od_rule_t *rule, od_client_t *client)
+{
+	od_debug(&instance->logger, "routing", NULL, NULL,
+		 "matching rule: %s %s %s with %s routing type to %s client",
+		 rule->db_name, rule->user_name,
+		 rule->address_range.string_value,
+		 rule->pool->routing_type == NULL ? "client visible" :
+						    rule->pool->routing_type,
+		 client->type == OD_POOL_CLIENT_INTERNAL ? "internal" :
+							   "external");
+}
+
+/*
+ * route client to already existing route without router lock:
+ * rule is matched over published rules snapshot and route is pinned
+ * in route pool, so gc can not free it
+ *
+ * returns 0 if client must be routed by locked path: no snapshot,
+ * rule depends on group members or ldap, replication connection,
+ * route does not exist yet or rule was obsoleted by reload
+ */
+static inline int od_router_route_lockless(od_router_t *router,
+					   od_client_t *client,
+					   struct sockaddr_storage *sa,
+					   od_router_status_t *status)
+{
+	kiwi_be_startup_t *startup = &client->startup;
+
+	if (client->type == OD_POOL_CLIENT_UNDEF ||
+	    startup->replication.value_len != 0) {
+		return 0;
+	}
+
+	od_rules_index_t *snapshot = od_router_rules_snapshot(router);
+	if (snapshot == NULL) {
+		return 0;
+	}
+
+	int need_lock;
+	od_rule_t *rule;
+	if (client->type == OD_POOL_CLIENT_INTERNAL) {
+		rule = od_rules_index_forward(snapshot, startup, NULL, 1,
+					      &need_lock);
+	} else {
+		rule = od_rules_index_forward(snapshot, startup, sa, 0,
+					      &need_lock);
+	}
+
+	if (rule == NULL || !od_rule_matches_client(rule->pool, client->type)) {
+		goto fallback;
+	}
+#ifdef LDAP_FOUND
+	if (rule->ldap_storage_credentials_attr) {
+		goto fallback;
+	}
+#endif
+
+	od_route_id_t id;
+	od_router_route_id(rule, startup, &id);
+
+	od_route_t *route;
+	route = od_route_pool_match_pin(&router->route_pool, &id, rule);
+	if (route == NULL) {
+		goto fallback;
+	}
+
+	od_route_lock(route);
+
+	/* reload marks rules obsolete before dropping their clients */
+	if (atomic_load_explicit(&rule->obsolete, memory_order_acquire)) {
+		od_route_unlock(route);
+		od_route_pool_unpin(route);
+		goto fallback;
+	}
+
+	od_router_debug_rule(router->global->instance, rule, client);
+
+	od_rules_ref(rule);
+	client->rule = rule;
+
+	/* increase counter of new tot tcp connections */
+	++route->tcp_connections;
+
+	/* ensure route client_max limit */
+	if (rule->client_max_set &&
+	    od_client_pool_total(&route->client_pool) >= rule->client_max) {
+		od_route_unlock(route);
+
+		*status = OD_ROUTER_ERROR_LIMIT_ROUTE;
+		if (route->extra_logging_enabled) {
+			od_error_logger_store_err(route->err_logger, *status);
+		}
+		od_route_pool_unpin(route);
+		od_rules_index_unref(snapshot);
+		return 1;
+	}
+
+	/* add client to route client pool */
+	od_client_pool_set(&route->client_pool, client, OD_CLIENT_PENDING);
+	client->route = route;
+
+	od_route_unlock(route);
+	od_route_pool_unpin(route);
+	od_rules_index_unref(snapshot);
+
+	*status = OD_ROUTER_OK;
+	return 1;
+
+fallback:
+	od_rules_index_unref(snapshot);
+	return 0;
+}
+
 od_router_status_t od_router_route(od_router_t *router, od_client_t *client)
 {
 	kiwi_be_startup_t *startup = &client->startup;
@@ -661,6 +842,11 @@ od_router_status_t od_router_route(od_router_t *router, od_client_t *client)
 	od_assert(startup->database.value_len);
 	od_assert(startup->user.value_len);
 
+	od_router_status_t status;
+	if (od_router_route_lockless(router, client, &sa, &status)) {
+		return status;
+	}
+
 	od_router_lock(router);
 
 	/* match latest version of route rule */
@@ -682,35 +868,15 @@ od_router_status_t od_router_route(od_router_t *router, od_client_t *client)
 		od_router_unlock(router);
 		return OD_ROUTER_ERROR_NOT_FOUND;
 	}
-	od_debug(&instance->logger, "routing", NULL, NULL,
-		 "matching rule: %s %s %s with %s routing type to %s client",
-		 rule->db_name, rule->user_name,
-		 rule->address_range.string_value,
-		 rule->pool->routing_type == NULL ? "client visible" :
-						    rule->pool->routing_type,
-		 client->type == OD_POOL_CLIENT_INTERNAL ? "internal" :
-							   "external");
+	od_router_debug_rule(instance, rule, client);
 	if (!od_rule_matches_client(rule->pool, client->type)) {
 		/* emulate not found error */
 		od_router_unlock(router);
 		return OD_ROUTER_ERROR_NOT_FOUND;
 	}
 
-	/* force settings required by route */
-	od_route_id_t id = { .database = startup->database.value,
-			     .user = startup->user.value,
-			     .database_len = startup->database.value_len,
-			     .user_len = startup->user.value_len,
-			     .physical_rep = false,
-			     .logical_rep = false };
-	if (rule->storage_db) {
-		id.database = rule->storage_db;
-		id.database_len = strlen(rule->storage_db) + 1;
-	}
-	if (rule->storage_user) {
-		id.user = rule->storage_user;
-		id.user_len = strlen(rule->storage_user) + 1;
-	}
+	od_route_id_t id;
+	od_router_route_id(rule, startup, &id);
 	if (startup->replication.value_len != 0) {
 		if (strcmp(startup->replication.value, "database") == 0) {
 			id.logical_rep = true;
@@ -937,6 +1103,26 @@ od_router_try_create_new_server(od_router_t *router, od_client_t *client,
 	return OD_ROUTER_OK;
 }
 
+static inline void router_attach_server_io(od_router_t *router,
+					   od_server_t *server)
+{
+	if (server->io.io == NULL) {
+		return;
+	}
+
+	uint64_t self = machine_self();
+	if (server->last_machine == self) {
+		server->affinity_hits++;
+		od_atomic_u64_inc(&router->server_affinity_hits);
+	} else if (server->last_machine != UINT64_MAX) {
+		server->affinity_migrations++;
+		od_atomic_u64_inc(&router->server_affinity_migrations);
+	}
+	server->last_machine = self;
+
+	od_io_attach(&server->io);
+}
+
 static inline od_router_status_t
 od_router_try_attach(od_router_t *router, od_client_t *client,
 		     bool wait_for_idle, od_storage_endpoint_t *endpoint)
@@ -1016,9 +1202,7 @@ od_router_try_attach(od_router_t *router, od_client_t *client,
 	od_route_unlock(route);
 
 	/* attach server io to clients machine context */
-	if (server->io.io) {
-		od_io_attach(&server->io);
-	}
+	router_attach_server_io(router, server);
 
 	return OD_ROUTER_OK;
 }
@@ -1116,9 +1300,7 @@ od_router_status_t od_router_attach(od_router_t *router, od_client_t *client,
 			od_client_pool_set(&route->client_pool, client,
 					   OD_CLIENT_ACTIVE);
 			od_route_unlock(route);
-			if (client->server->io.io) {
-				od_io_attach(&client->server->io);
-			}
+			router_attach_server_io(router, client->server);
 			status = OD_ROUTER_OK;
 			break;
 		}
@@ -1161,6 +1343,7 @@ void od_router_detach(od_router_t *router, od_client_t *client)
 
 	od_assert(server != NULL);
 	od_assert(od_server_synchronized(server));
+	od_compression_backend_account(server);
 	od_io_detach(&server->io);
 
 	od_route_lock(route);
@@ -1222,46 +1405,82 @@ void od_router_close(od_router_t *router, od_client_t *client)
 	od_server_free(server);
 }
 
-static inline int od_router_cancel_cmp(od_server_t *server, void **argv)
+od_server_t *od_router_detach_for_reset(od_router_t *router,
+				       od_client_t *client)
 {
-	/* check that server is attached and has corresponding cancellation key */
-	return (server->client != NULL) &&
-	       kiwi_key_cmp(&server->key_client, argv[0]);
+	(void)router;
+	od_route_t *route = client->route;
+	od_assert(route != NULL);
+
+	od_server_t *server = client->server;
+	od_assert(server != NULL);
+
+	od_route_lock(route);
+
+	/* extra ref keeps the server ACTIVE after client detach */
+	od_server_reset_begin(server);
+	od_server_detach_client(server);
+
+	od_client_pool_set(&route->client_pool, client, OD_CLIENT_PENDING);
+
+	od_route_unlock(route);
+
+	return server;
 }
 
-static inline int od_router_cancel_cb(od_route_t *route, void **argv)
+void od_router_reset_complete(od_router_t *router, od_server_t *server,
+			      int success)
 {
+	(void)router;
+	od_route_t *route = server->route;
+	od_assert(route != NULL);
+
+	od_instance_t *instance = server->global->instance;
+
+	int is_repl = route->id.physical_rep || route->id.logical_rep;
+	if (success && (server->offline || is_repl)) {
+		od_debug(&instance->logger, "reset", NULL, server,
+			 "closing obsolete server connection");
+		success = 0;
+	}
+
+	if (success) {
+		/* detach from current machine event loop */
+		od_compression_backend_account(server);
+		od_io_detach(&server->io);
+	} else {
+		od_backend_close_connection(server);
+	}
+
 	od_route_lock(route);
 
-	od_server_t *server;
-	server = od_route_server_pool_foreach_locked(
-		route, OD_SERVER_ACTIVE, od_router_cancel_cmp, argv);
-
-	if (server) {
-		od_router_cancel_t *cancel = argv[1];
-		cancel->id = server->id;
-		cancel->key = server->key;
-		cancel->storage =
-			od_rules_storage_ref(server->endpoint->storage);
-		cancel->address = od_server_pool_address(server);
-		cancel->server = server;
-		od_server_cancel_begin(server);
-		od_route_unlock(route);
-		return 1;
+	int idle = od_server_reset_end(server);
+
+	if (success) {
+		if (idle) {
+			/* otherwise last running cancel will make it IDLE */
+			od_server_set_pool_state(server, OD_SERVER_IDLE);
+			od_route_signal_locked(route, server);
+		}
+	} else {
+		od_server_set_pool_state(server, OD_SERVER_UNDEF);
+		server->route = NULL;
+		od_route_signal_locked(route, NULL);
 	}
 
 	od_route_unlock(route);
-	return 0;
+
+	if (!success) {
+		od_server_free(server);
+	}
 }
 
 od_router_status_t od_router_cancel(od_router_t *router, kiwi_key_t *key,
 				    od_router_cancel_t *cancel)
 {
 	/* match server by client forged key */
-	void *argv[] = { key, cancel };
-	int rc;
-	rc = od_router_foreach(router, od_router_cancel_cb, argv);
-	if (rc <= 0) {
+	if (od_cancel_table_begin(&router->cancel_table, key, cancel) !=
+	    OK_RESPONSE) {
 		return OD_ROUTER_ERROR_NOT_FOUND;
 	}
 	return OD_ROUTER_OK;
@@ -52,6 +52,7 @@ void od_rules_init(od_rules_t *rules)
 #endif
 	od_list_init(&rules->rules);
 	rules->next_order = 0;
+	rules->index = NULL;
 }
 
 void od_rules_rule_free(od_rule_t *);
@@ -59,6 +60,7 @@ void od_rules_rule_free(od_rule_t *);
 void od_rules_free(od_rules_t *rules)
 {
 	mm_mutex_destroy(&rules->mu);
+	od_rules_index_free(rules);
 	od_list_t *i, *n;
 
 #ifdef LDAP_FOUND
@@ -548,12 +550,15 @@ static od_rule_t *od_rules_add(od_rules_t *rules)
 	/* backward compatibility */
 	rule->maintain_params = 1;
 
-	rule->obsolete = 0;
+	atomic_init(&rule->obsolete, 0);
 	rule->mark = 0;
 	atomic_store(&rule->refs, 1);
 
 	rule->order = rules->next_order++;
 
+	/* index is built over sorted list, fallback to linear match */
+	od_rules_index_free(rules);
+
 	rule->conn_type = OD_RULE_CONN_TYPE_DEFAULT;
 
 	rule->target_session_attrs = OD_TARGET_SESSION_ATTRS_UNDEF;
@@ -584,6 +589,7 @@ static od_rule_t *od_rules_add(od_rules_t *rules)
 	od_list_append(&rules->rules, &rule->link);
 
 	rule->quantiles = NULL;
+	rule->quantiles_window = QUANTILES_WINDOW_DEFAULT;
 	return rule;
 }
 
@@ -731,6 +737,8 @@ static void od_rules_rule_free_now(od_rule_t *rule)
 		od_free(rule->address_range.string_value);
 	}
 
+	kiwi_vars_free(&rule->vars);
+
 	machine_wait_flag_destroy(rule->group_checker_online);
 	machine_wait_flag_destroy(rule->group_checker_finished);
 
@@ -955,6 +963,8 @@ void od_rules_stop_checkers(od_rules_t *rules)
 
 int od_rules_sort_for_matching(od_rules_t *rules)
 {
+	od_rules_index_free(rules);
+
 	size_t count = od_list_count(&rules->rules);
 	if (count == 0) {
 		return 0;
@@ -998,6 +1008,9 @@ int od_rules_sort_for_matching(od_rules_t *rules)
 
 	od_free(sorted);
 
+	/* not fatal - matching will scan rules list */
+	od_rules_index_build(rules);
+
 	return 0;
 }
 
@@ -1058,56 +1071,301 @@ static int od_rule_conn_type_match(const od_rule_t *rule,
 	}
 }
 
-static od_rule_t *od_rules_find_first_matching(
-	od_rules_t *rules, const kiwi_be_startup_t *startup,
-	struct sockaddr_storage *user_addr, int pool_internal)
+static int od_rule_matches_startup(const od_rule_t *rule,
+				   const kiwi_be_startup_t *startup,
+				   struct sockaddr_storage *user_addr,
+				   int pool_internal)
 {
-	const char *dbname = startup->database.value;
-	const char *user = startup->user.value;
+	if (rule->obsolete) {
+		return 0;
+	}
+	if (pool_internal) {
+		if (rule->pool->routing != OD_RULE_POOL_INTERNAL) {
+			return 0;
+		}
+	} else {
+		if (rule->pool->routing != OD_RULE_POOL_CLIENT_VISIBLE) {
+			return 0;
+		}
+	}
+
+	if (!od_rule_db_match(rule, startup->database.value)) {
+		return 0;
+	}
 
+	if (!od_rule_user_match(rule, startup->user.value)) {
+		return 0;
+	}
+
+	if (!od_rule_address_match(rule, user_addr)) {
+		return 0;
+	}
+
+	if (!od_rule_conn_type_match(rule, startup, user_addr)) {
+		return 0;
+	}
+
+	return 1;
+}
+
+static od_rules_index_type_t od_rules_index_type_of(const od_rule_t *rule)
+{
 	/*
-	 * Here we can find first matching, because of rules sorting
-	 * in case sequential routing - the rules are sorted by order
-	 * in case of non-sequential routing - the rules are sorted by specificity
-	 * (specificity means a measure of how well the user fits the
-	 *  rule exactly, not just by 'default' comparison)
+	 * group members can be changed by group checker at any time,
+	 * so group rules are never keyed by user name
 	 */
+	int by_user = !rule->user_is_default && rule->group == NULL;
+
+	if (!rule->db_is_default) {
+		return by_user ? OD_RULES_INDEX_DB_USER : OD_RULES_INDEX_DB;
+	}
+
+	return by_user ? OD_RULES_INDEX_USER : OD_RULES_INDEX_ANY;
+}
+
+static inline int od_rules_index_key_cmp(od_rules_index_type_t type_a,
+					 const char *db_a, const char *user_a,
+					 od_rules_index_type_t type_b,
+					 const char *db_b, const char *user_b)
+{
+	if (type_a != type_b) {
+		return type_a < type_b ? -1 : 1;
+	}
+
+	int cmp = strcmp(db_a, db_b);
+	if (cmp != 0) {
+		return cmp;
+	}
+
+	return strcmp(user_a, user_b);
+}
+
+static int od_rules_index_entry_cmp(const void *a, const void *b)
+{
+	const od_rules_index_entry_t *ea = a;
+	const od_rules_index_entry_t *eb = b;
+
+	int cmp = od_rules_index_key_cmp(ea->type, ea->db, ea->user, eb->type,
+					 eb->db, eb->user);
+	if (cmp != 0) {
+		return cmp;
+	}
+
+	if (ea->pos != eb->pos) {
+		return ea->pos < eb->pos ? -1 : 1;
+	}
+
+	return 0;
+}
+
+od_rules_index_t *od_rules_index_ref(od_rules_index_t *index)
+{
+	atomic_fetch_add(&index->refs, 1);
+	return index;
+}
+
+void od_rules_index_unref(od_rules_index_t *index)
+{
+	int64_t r = atomic_fetch_sub(&index->refs, 1);
+	od_assert(r >= 1);
+	if (r != 1) {
+		return;
+	}
+
+	for (size_t i = 0; i < index->count; ++i) {
+		od_rules_unref(index->entries[i].rule);
+	}
+
+	od_free(index->entries);
+	od_free(index);
+}
+
+void od_rules_index_free(od_rules_t *rules)
+{
+	od_rules_index_t *index = rules->index;
+	if (index == NULL) {
+		return;
+	}
+
+	rules->index = NULL;
+
+	od_rules_index_unref(index);
+}
 
+int od_rules_index_build(od_rules_t *rules)
+{
+	od_rules_index_free(rules);
+
+	od_rules_index_t *index = od_malloc(sizeof(od_rules_index_t));
+	if (index == NULL) {
+		return NOT_OK_RESPONSE;
+	}
+
+	atomic_init(&index->refs, 1);
+	index->count = od_list_count(&rules->rules);
+	size_t size = sizeof(od_rules_index_entry_t) * index->count;
+	index->entries = od_malloc(size ? size : 1);
+	if (index->entries == NULL) {
+		od_free(index);
+		return NOT_OK_RESPONSE;
+	}
+
+	size_t pos = 0;
 	od_list_t *i;
 	od_list_foreach (&rules->rules, i) {
 		od_rule_t *rule;
 		rule = od_container_of(i, od_rule_t, link);
-		if (rule->obsolete) {
-			continue;
+
+		od_rules_index_entry_t *entry = &index->entries[pos];
+		entry->type = od_rules_index_type_of(rule);
+		entry->db = "";
+		entry->user = "";
+		if (entry->type == OD_RULES_INDEX_DB_USER ||
+		    entry->type == OD_RULES_INDEX_DB) {
+			entry->db = rule->db_name;
 		}
-		if (pool_internal) {
-			if (rule->pool->routing != OD_RULE_POOL_INTERNAL) {
-				continue;
-			}
+		if (entry->type == OD_RULES_INDEX_DB_USER ||
+		    entry->type == OD_RULES_INDEX_USER) {
+			entry->user = rule->user_name;
+		}
+		entry->pos = pos;
+		entry->rule = rule;
+		od_rules_ref(rule);
+		++pos;
+	}
+
+	qsort(index->entries, index->count, sizeof(od_rules_index_entry_t),
+	      od_rules_index_entry_cmp);
+
+	rules->index = index;
+
+	return OK_RESPONSE;
+}
+
+typedef struct {
+	od_rules_index_entry_t *cur;
+	od_rules_index_entry_t *end;
+} od_rules_index_run_t;
+
+static void od_rules_index_lookup(od_rules_index_t *index,
+				  od_rules_index_type_t type, const char *db,
+				  const char *user, od_rules_index_run_t *run)
+{
+	/* lower bound of (type, db, user) */
+	size_t lo = 0;
+	size_t hi = index->count;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		od_rules_index_entry_t *e = &index->entries[mid];
+		if (od_rules_index_key_cmp(e->type, e->db, e->user, type, db,
+					   user) < 0) {
+			lo = mid + 1;
 		} else {
-			if (rule->pool->routing !=
-			    OD_RULE_POOL_CLIENT_VISIBLE) {
+			hi = mid;
+		}
+	}
+
+	run->cur = &index->entries[lo];
+	run->end = run->cur;
+
+	od_rules_index_entry_t *last = &index->entries[index->count];
+	while (run->end < last &&
+	       od_rules_index_key_cmp(run->end->type, run->end->db,
+				      run->end->user, type, db, user) == 0) {
+		run->end++;
+	}
+}
+
+static od_rule_t *od_rules_index_find_first_matching(
+	od_rules_index_t *index, const kiwi_be_startup_t *startup,
+	struct sockaddr_storage *user_addr, int pool_internal, int *need_lock)
+{
+	const char *dbname = startup->database.value;
+	const char *user = startup->user.value;
+
+	od_rules_index_run_t runs[OD_RULES_INDEX_MAX];
+	od_rules_index_lookup(index, OD_RULES_INDEX_DB_USER, dbname, user,
+			      &runs[OD_RULES_INDEX_DB_USER]);
+	od_rules_index_lookup(index, OD_RULES_INDEX_DB, dbname, "",
+			      &runs[OD_RULES_INDEX_DB]);
+	od_rules_index_lookup(index, OD_RULES_INDEX_USER, "", user,
+			      &runs[OD_RULES_INDEX_USER]);
+	od_rules_index_lookup(index, OD_RULES_INDEX_ANY, "", "",
+			      &runs[OD_RULES_INDEX_ANY]);
+
+	/*
+	 * merge runs by position, so the first matching candidate
+	 * is exactly the first matching rule of the rules list
+	 */
+	for (;;) {
+		od_rules_index_run_t *next = NULL;
+		for (int t = 0; t < OD_RULES_INDEX_MAX; ++t) {
+			od_rules_index_run_t *run = &runs[t];
+			if (run->cur == run->end) {
 				continue;
 			}
+			if (next == NULL || run->cur->pos < next->cur->pos) {
+				next = run;
+			}
 		}
 
-		if (!od_rule_db_match(rule, dbname)) {
-			continue;
+		if (next == NULL) {
+			return NULL;
 		}
 
-		if (!od_rule_user_match(rule, user)) {
-			continue;
+		od_rule_t *rule = next->cur->rule;
+		next->cur++;
+
+		if (need_lock != NULL && rule->group != NULL) {
+			*need_lock = 1;
+			return NULL;
 		}
 
-		if (!od_rule_address_match(rule, user_addr)) {
-			continue;
+		/*
+		 * reload marks rules obsolete before the new snapshot is
+		 * published, skipping them would route to the less specific
+		 * rule of the old snapshot
+		 */
+		if (need_lock != NULL &&
+		    atomic_load_explicit(&rule->obsolete,
+					 memory_order_acquire)) {
+			*need_lock = 1;
+			return NULL;
 		}
 
-		if (!od_rule_conn_type_match(rule, startup, user_addr)) {
-			continue;
+		if (od_rule_matches_startup(rule, startup, user_addr,
+					    pool_internal)) {
+			return rule;
 		}
+	}
+}
 
-		return rule;
+static od_rule_t *od_rules_find_first_matching(
+	od_rules_t *rules, const kiwi_be_startup_t *startup,
+	struct sockaddr_storage *user_addr, int pool_internal)
+{
+	/*
+	 * Here we can find first matching, because of rules sorting
+	 * in case sequential routing - the rules are sorted by order
+	 * in case of non-sequential routing - the rules are sorted by specificity
+	 * (specificity means a measure of how well the user fits the
+	 *  rule exactly, not just by 'default' comparison)
+	 */
+
+	if (rules->index != NULL) {
+		return od_rules_index_find_first_matching(
+			rules->index, startup, user_addr, pool_internal, NULL);
+	}
+
+	od_list_t *i;
+	od_list_foreach (&rules->rules, i) {
+		od_rule_t *rule;
+		rule = od_container_of(i, od_rule_t, link);
+
+		if (od_rule_matches_startup(rule, startup, user_addr,
+					    pool_internal)) {
+			return rule;
+		}
 	}
 
 	return NULL;
@@ -1121,6 +1379,16 @@ od_rule_t *od_rules_forward(od_rules_t *rules, const kiwi_be_startup_t *startup,
 					    pool_internal);
 }
 
+od_rule_t *od_rules_index_forward(od_rules_index_t *index,
+				  const kiwi_be_startup_t *startup,
+				  struct sockaddr_storage *user_addr,
+				  int pool_internal, int *need_lock)
+{
+	*need_lock = 0;
+	return od_rules_index_find_first_matching(index, startup, user_addr,
+						  pool_internal, need_lock);
+}
+
 static inline int od_rule_match(od_rule_t *rule, const char *dbname,
 				const char *user,
 				const od_address_range_t *address_range,
@@ -1225,6 +1493,12 @@ static inline int od_rules_storage_compare(od_rule_storage_t *a,
 		return 0;
 	}
 
+	/* compression */
+	if (a->compression != b->compression ||
+	    a->compression_level != b->compression_level) {
+		return 0;
+	}
+
 	/* host */
 	if (a->host && b->host) {
 		if (strcmp(a->host, b->host) != 0) {
@@ -1327,6 +1601,9 @@ int od_rules_rule_compare(od_rule_t *a, od_rule_t *b)
 	} else {
 		return 0;
 	}
+	if (a->quantiles_window != b->quantiles_window) {
+		return 0;
+	}
 
 	/* auth */
 	if (a->auth_mode != b->auth_mode) {
@@ -1525,6 +1802,9 @@ int od_rules_merge(od_rules_t *rules, od_rules_t *src, od_list_t *added,
 	int count_deleted = 0;
 	int count_new = 0;
 
+	/* rules list is going to change, index is rebuilt on sort below */
+	od_rules_index_free(rules);
+
 	od_list_t *i;
 	/* mark all rules for obsoletion */
 	od_list_foreach (&rules->rules, i) {
@@ -1657,7 +1937,8 @@ int od_rules_merge(od_rules_t *rules, od_rules_t *src, od_list_t *added,
 
 			int is_obsolete = rule->obsolete || rule->mark;
 			rule->mark = 0;
-			rule->obsolete = is_obsolete;
+			atomic_store_explicit(&rule->obsolete, is_obsolete,
+					      memory_order_release);
 
 			if (is_obsolete) {
 				od_list_unlink(&rule->link);
@@ -2287,6 +2568,11 @@ void od_rules_print(od_rules_t *rules, od_logger_t *logger)
 		od_log(logger, "storage", NULL, NULL,
 		       "  endpoints_status_poll_interval_ms %d",
 		       storage->endpoints_status_poll_interval_ms);
+		if (storage->compression) {
+			od_log(logger, "storage", NULL, NULL,
+			       "  compression     yes, level %d",
+			       storage->compression_level);
+		}
 		for (size_t ep_i = 0; ep_i < storage->endpoints_count; ep_i++) {
 			char ep_str[256];
 			od_address_to_str(&storage->endpoints[ep_i].address,
@@ -2447,6 +2733,9 @@ void od_rules_print(od_rules_t *rules, od_logger_t *logger)
 		od_log(logger, "rules", NULL, NULL,
 		       "  pool reset_timeout_ms             %" PRIu64,
 		       rule->pool->reset_timeout_ms);
+		od_log(logger, "rules", NULL, NULL,
+		       "  pool reset_async                  %s",
+		       rule->pool->reset_async ? "yes" : "no");
 		od_log(logger, "rules", NULL, NULL,
 		       "  pool pin_on_listen                %s",
 		       rule->pool->pin_on_listen ? "yes" : "no");
@@ -2596,9 +2885,9 @@ void od_rules_print(od_rules_t *rules, od_logger_t *logger)
 		       "  log_query                         %s",
 		       od_rules_yes_no(rule->log_query));
 
-		for (int vi = 0; vi < KIWI_VAR_MAX; vi++) {
-			kiwi_var_t *v = &rule->vars.vars[vi];
-			if (v->value_len > 0 && v->name) {
+		for (int vi = 0; vi < rule->vars.count; vi++) {
+			kiwi_vars_entry_t *v = &rule->vars.entries[vi];
+			if (v->value_len > 0) {
 				od_log(logger, "rules", NULL, NULL,
 				       "  pgoption %s=%s", v->name, v->value);
 			}
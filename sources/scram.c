@@ -27,6 +27,7 @@
 #include <sasl.h>
 #include <attribute.h>
 #include <scram.h>
+#include <scram_cache.h>
 #include <util.h>
 
 #define od_b64_encode(src, src_len, dst, dst_len) \
@@ -379,7 +380,40 @@ error:
 	return -1;
 }
 
+static void lookup_client_keys(od_scram_state_t *scram_state,
+			      od_scram_cache_t *cache, const char *user,
+			      const char *password, const uint8_t *salt,
+			      int iterations, od_scram_secret_t *secret)
+{
+	memset(secret, 0, sizeof(od_scram_secret_t));
+	secret->iterations = iterations;
+
+	/* salt is announced by server, must fit to the cache entry */
+	if (pg_b64_enc_len(SCRAM_DEFAULT_SALT_LEN) >=
+	    (int)sizeof(secret->salt)) {
+		return;
+	}
+	int salt_len = od_b64_encode(salt, SCRAM_DEFAULT_SALT_LEN,
+				     secret->salt, sizeof(secret->salt));
+	if (salt_len < 0) {
+		return;
+	}
+	secret->salt[salt_len] = '\0';
+
+	if (!od_scram_cache_lookup_salted(cache, user, password, secret)) {
+		return;
+	}
+
+	/* the same as pass-through keys */
+	scram_state->use_passthrough_keys = 1;
+	memcpy(scram_state->client_key, secret->client_key,
+	       OD_SCRAM_MAX_KEY_LEN);
+	memcpy(scram_state->server_key, secret->server_key,
+	       OD_SCRAM_MAX_KEY_LEN);
+}
+
 static int calculate_client_proof(od_scram_state_t *scram_state,
+				  od_scram_cache_t *cache, const char *user,
 				  const char *password, const uint8_t *salt,
 				  int iterations,
 				  const char *client_final_message,
@@ -388,6 +422,13 @@ static int calculate_client_proof(od_scram_state_t *scram_state,
 	const char *errstr = NULL;
 	uint8_t client_key[OD_SCRAM_MAX_KEY_LEN];
 
+	/* keys are reused on hit, as pass-through ones */
+	od_scram_secret_t secret;
+	if (!scram_state->use_passthrough_keys && cache != NULL) {
+		lookup_client_keys(scram_state, cache, user, password, salt,
+				   iterations, &secret);
+	}
+
 	if (scram_state->use_passthrough_keys) {
 		memcpy(client_key, scram_state->client_key,
 		       OD_SCRAM_MAX_KEY_LEN);
@@ -418,6 +459,18 @@ static int calculate_client_proof(od_scram_state_t *scram_state,
 				   &errstr);
 
 		od_free(prepared_password);
+
+		if (cache != NULL) {
+			memcpy(secret.client_key, client_key,
+			       OD_SCRAM_MAX_KEY_LEN);
+			od_scram_ServerKey(scram_state->salted_password,
+					   secret.server_key, &errstr);
+			od_scram_cache_store(cache, user, password, &secret);
+		}
+	}
+
+	if (cache != NULL) {
+		explicit_bzero(&secret, sizeof(secret));
 	}
 
 	uint8_t stored_key[OD_SCRAM_MAX_KEY_LEN];
@@ -481,7 +534,8 @@ static char *calculate_server_signature(od_scram_state_t *scram_state)
 machine_msg_t *
 od_scram_create_client_final_message(od_scram_state_t *scram_state,
 				     char *password, char *auth_data,
-				     size_t auth_data_size)
+				     size_t auth_data_size,
+				     od_scram_cache_t *cache, const char *user)
 {
 	char *server_nonce;
 	size_t server_nonce_size;
@@ -515,8 +569,8 @@ od_scram_create_client_final_message(od_scram_state_t *scram_state,
 	}
 
 	uint8_t client_proof[OD_SCRAM_MAX_KEY_LEN];
-	rc = calculate_client_proof(scram_state, password, salt, iterations,
-				    result, client_proof);
+	rc = calculate_client_proof(scram_state, cache, user, password, salt,
+				    iterations, result, client_proof);
 	od_free(salt);
 	if (rc == -1) {
 		goto error;
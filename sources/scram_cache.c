@@ -0,0 +1,451 @@
+
+/*
+ * Odyssey.
+ *
+ * Scalable PostgreSQL connection pooler.
+ */
+
+#include <odyssey.h>
+
+#include <openssl/rand.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+
+#include <machinarium/machinarium.h>
+#include <machinarium/ds/hm.h>
+
+#include <od_memory.h>
+#include <util.h>
+#include <thread_pool.h>
+#include <scram.h>
+#include <scram_cache.h>
+
+static inline void od_scram_cache_digest(od_scram_cache_t *cache,
+					 const char *password, uint8_t *digest)
+{
+	unsigned int len = OD_SCRAM_CACHE_DIGEST_LEN;
+	HMAC(EVP_sha256(), cache->pepper, sizeof(cache->pepper),
+	     (const unsigned char *)password, strlen(password), digest, &len);
+}
+
+static inline uint64_t od_scram_cache_hash(const char *user,
+					   const uint8_t *digest)
+{
+	uint64_t seed = mm_xxh64_hash(user, strlen(user), 0);
+	return mm_xxh64_hash(digest, OD_SCRAM_CACHE_DIGEST_LEN, seed);
+}
+
+static inline void od_scram_cache_entry_free(od_scram_cache_entry_t *entry)
+{
+	od_free(entry->user);
+	/* do not leave keys in freed memory */
+	explicit_bzero(entry, sizeof(od_scram_cache_entry_t));
+	od_free(entry);
+}
+
+static inline void od_scram_cache_remove(od_scram_cache_t *cache,
+					 od_scram_cache_entry_t *entry)
+{
+	od_list_unlink(&entry->link);
+	od_list_unlink(&entry->lru_link);
+	cache->count--;
+	od_scram_cache_entry_free(entry);
+}
+
+static void od_scram_cache_clear(od_scram_cache_t *cache)
+{
+	od_list_t *i, *n;
+	od_list_foreach_safe (&cache->lru, i, n) {
+		od_scram_cache_entry_t *entry;
+		entry = od_container_of(i, od_scram_cache_entry_t, lru_link);
+		od_scram_cache_remove(cache, entry);
+	}
+}
+
+void od_scram_cache_init(od_scram_cache_t *cache)
+{
+	memset(cache, 0, sizeof(od_scram_cache_t));
+	mm_sleeplock_init(&cache->lock);
+	od_list_init(&cache->lru);
+	RAND_bytes(cache->pepper, sizeof(cache->pepper));
+}
+
+void od_scram_cache_free(od_scram_cache_t *cache)
+{
+	if (cache->derive_pool != NULL) {
+		od_thread_pool_destroy(cache->derive_pool);
+		od_free(cache->derive_pool);
+		cache->derive_pool = NULL;
+	}
+
+	od_scram_cache_clear(cache);
+	if (cache->buckets != NULL) {
+		od_free(cache->buckets);
+		cache->buckets = NULL;
+	}
+	cache->buckets_count = 0;
+	cache->max = 0;
+}
+
+int od_scram_cache_configure(od_scram_cache_t *cache, int size, int ttl_sec)
+{
+	od_list_t *buckets = NULL;
+	size_t buckets_count = 0;
+
+	if (size > 0) {
+		buckets_count = OD_SCRAM_CACHE_MIN_BUCKETS;
+		while (buckets_count < (size_t)size) {
+			buckets_count *= 2;
+		}
+
+		buckets = od_malloc(sizeof(od_list_t) * buckets_count);
+		if (buckets == NULL) {
+			return NOT_OK_RESPONSE;
+		}
+		for (size_t i = 0; i < buckets_count; ++i) {
+			od_list_init(&buckets[i]);
+		}
+	}
+
+	mm_sleeplock_lock(&cache->lock);
+
+	od_scram_cache_clear(cache);
+
+	od_list_t *prev = cache->buckets;
+	cache->buckets = buckets;
+	cache->buckets_count = buckets_count;
+	cache->max = size > 0 ? (size_t)size : 0;
+	cache->ttl_ms = (uint64_t)ttl_sec * 1000;
+
+	mm_sleeplock_unlock(&cache->lock);
+
+	if (prev != NULL) {
+		od_free(prev);
+	}
+
+	return OK_RESPONSE;
+}
+
+int od_scram_cache_start_derive_workers(od_scram_cache_t *cache,
+					size_t count)
+{
+	od_thread_pool_t *pool = od_malloc(sizeof(od_thread_pool_t));
+	if (pool == NULL) {
+		return NOT_OK_RESPONSE;
+	}
+
+	if (od_thread_pool_init(pool, "scram", count, 1024) != 0) {
+		od_free(pool);
+		return NOT_OK_RESPONSE;
+	}
+
+	cache->derive_pool = pool;
+	return OK_RESPONSE;
+}
+
+static od_scram_cache_entry_t *
+od_scram_cache_find(od_scram_cache_t *cache, uint64_t hash, const char *user,
+		    const uint8_t *digest)
+{
+	od_list_t *bucket = &cache->buckets[hash & (cache->buckets_count - 1)];
+
+	od_list_t *i;
+	od_list_foreach (bucket, i) {
+		od_scram_cache_entry_t *entry;
+		entry = od_container_of(i, od_scram_cache_entry_t, link);
+		if (entry->hash == hash && strcmp(entry->user, user) == 0 &&
+		    memcmp(entry->digest, digest, OD_SCRAM_CACHE_DIGEST_LEN) ==
+			    0) {
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+static int od_scram_cache_get(od_scram_cache_t *cache, const char *user,
+			      const char *password, od_scram_secret_t *secret,
+			      int salted)
+{
+	if (cache->max == 0) {
+		return 0;
+	}
+
+	uint8_t digest[OD_SCRAM_CACHE_DIGEST_LEN];
+	od_scram_cache_digest(cache, password, digest);
+	uint64_t hash = od_scram_cache_hash(user, digest);
+
+	int found = 0;
+
+	mm_sleeplock_lock(&cache->lock);
+
+	if (cache->buckets != NULL) {
+		od_scram_cache_entry_t *entry;
+		entry = od_scram_cache_find(cache, hash, user, digest);
+		if (entry != NULL && entry->expire_ms != 0 &&
+		    entry->expire_ms < machine_time_ms()) {
+			od_scram_cache_remove(cache, entry);
+			entry = NULL;
+		}
+
+		/* role password was set again, server has new salt */
+		if (entry != NULL && salted &&
+		    (entry->secret.iterations != secret->iterations ||
+		     strcmp(entry->secret.salt, secret->salt) != 0)) {
+			entry = NULL;
+		}
+
+		if (entry != NULL) {
+			*secret = entry->secret;
+			od_list_unlink(&entry->lru_link);
+			od_list_push(&cache->lru, &entry->lru_link);
+			found = 1;
+		}
+	}
+
+	mm_sleeplock_unlock(&cache->lock);
+
+	if (found) {
+		od_atomic_u64_inc(&cache->hits);
+	} else {
+		od_atomic_u64_inc(&cache->misses);
+	}
+
+	return found;
+}
+
+int od_scram_cache_lookup(od_scram_cache_t *cache, const char *user,
+			  const char *password, od_scram_secret_t *secret)
+{
+	return od_scram_cache_get(cache, user, password, secret, 0);
+}
+
+int od_scram_cache_lookup_salted(od_scram_cache_t *cache, const char *user,
+				 const char *password,
+				 od_scram_secret_t *secret)
+{
+	return od_scram_cache_get(cache, user, password, secret, 1);
+}
+
+void od_scram_cache_store(od_scram_cache_t *cache, const char *user,
+			  const char *password,
+			  const od_scram_secret_t *secret)
+{
+	if (cache->max == 0) {
+		return;
+	}
+
+	od_scram_cache_entry_t *entry;
+	entry = od_malloc(sizeof(od_scram_cache_entry_t));
+	if (entry == NULL) {
+		return;
+	}
+	memset(entry, 0, sizeof(od_scram_cache_entry_t));
+	od_list_init(&entry->link);
+	od_list_init(&entry->lru_link);
+
+	entry->user = od_strdup(user);
+	if (entry->user == NULL) {
+		od_free(entry);
+		return;
+	}
+	od_scram_cache_digest(cache, password, entry->digest);
+	entry->hash = od_scram_cache_hash(user, entry->digest);
+	entry->secret = *secret;
+
+	mm_sleeplock_lock(&cache->lock);
+
+	if (cache->buckets == NULL) {
+		/* disabled by reload */
+		mm_sleeplock_unlock(&cache->lock);
+		od_scram_cache_entry_free(entry);
+		return;
+	}
+
+	if (cache->ttl_ms > 0) {
+		entry->expire_ms = machine_time_ms() + cache->ttl_ms;
+	}
+
+	/* concurrent derivation of the same password */
+	od_scram_cache_entry_t *prev;
+	prev = od_scram_cache_find(cache, entry->hash, user, entry->digest);
+	if (prev != NULL) {
+		od_scram_cache_remove(cache, prev);
+	}
+
+	while (cache->count >= cache->max) {
+		od_scram_cache_entry_t *lru;
+		lru = od_container_of(cache->lru.prev, od_scram_cache_entry_t,
+				      lru_link);
+		od_scram_cache_remove(cache, lru);
+	}
+
+	od_list_t *bucket =
+		&cache->buckets[entry->hash & (cache->buckets_count - 1)];
+	od_list_append(bucket, &entry->link);
+	od_list_push(&cache->lru, &entry->lru_link);
+	cache->count++;
+
+	mm_sleeplock_unlock(&cache->lock);
+}
+
+void od_scram_cache_invalidate_user(od_scram_cache_t *cache,
+				    const char *user)
+{
+	mm_sleeplock_lock(&cache->lock);
+
+	od_list_t *i, *n;
+	od_list_foreach_safe (&cache->lru, i, n) {
+		od_scram_cache_entry_t *entry;
+		entry = od_container_of(i, od_scram_cache_entry_t, lru_link);
+		if (strcmp(entry->user, user) == 0) {
+			od_scram_cache_remove(cache, entry);
+		}
+	}
+
+	mm_sleeplock_unlock(&cache->lock);
+}
+
+static int od_scram_secret_from_state(od_scram_secret_t *secret,
+				      od_scram_state_t *scram_state)
+{
+	size_t salt_len = strlen(scram_state->salt);
+	if (salt_len >= sizeof(secret->salt)) {
+		return -1;
+	}
+
+	secret->iterations = scram_state->iterations;
+	memcpy(secret->salt, scram_state->salt, salt_len + 1);
+	memcpy(secret->stored_key, scram_state->stored_key,
+	       OD_SCRAM_MAX_KEY_LEN);
+	memcpy(secret->server_key, scram_state->server_key,
+	       OD_SCRAM_MAX_KEY_LEN);
+
+	return 0;
+}
+
+static int od_scram_secret_to_state(const od_scram_secret_t *secret,
+				    od_scram_state_t *scram_state)
+{
+	scram_state->salt = od_strdup(secret->salt);
+	if (scram_state->salt == NULL) {
+		return -1;
+	}
+
+	scram_state->iterations = secret->iterations;
+	memcpy(scram_state->stored_key, secret->stored_key,
+	       OD_SCRAM_MAX_KEY_LEN);
+	memcpy(scram_state->server_key, secret->server_key,
+	       OD_SCRAM_MAX_KEY_LEN);
+
+	return 0;
+}
+
+static int od_scram_derive_secret(od_scram_secret_t *secret,
+				  const char *password)
+{
+	od_scram_state_t state;
+	od_scram_state_init(&state);
+
+	int rc = od_scram_init_from_plain_password(&state, (char *)password);
+	if (rc == 0) {
+		rc = od_scram_secret_from_state(secret, &state);
+	}
+
+	od_scram_state_free(&state);
+
+	return rc;
+}
+
+static void *od_scram_derive_task(void *arg)
+{
+	const char *password = arg;
+
+	od_scram_secret_t *secret = od_malloc(sizeof(od_scram_secret_t));
+	if (secret == NULL) {
+		return NULL;
+	}
+
+	if (od_scram_derive_secret(secret, password) == -1) {
+		od_free(secret);
+		return NULL;
+	}
+
+	return secret;
+}
+
+static void od_scram_derive_task_arg_free(void *arg)
+{
+	char *password = arg;
+	explicit_bzero(password, strlen(password));
+	od_free(password);
+}
+
+static void od_scram_derive_result_free(void *result)
+{
+	explicit_bzero(result, sizeof(od_scram_secret_t));
+	od_free(result);
+}
+
+static int od_scram_derive_offload(od_thread_pool_t *pool,
+				   od_scram_secret_t *secret,
+				   const char *password)
+{
+	/* task may outlive the waiter, so it owns its copy of the password */
+	char *arg = od_strdup(password);
+	if (arg == NULL) {
+		return -1;
+	}
+
+	od_future_t *future = od_thread_pool_submit(
+		pool, od_scram_derive_task, arg, od_scram_derive_task_arg_free,
+		od_scram_derive_result_free, 0);
+	if (future == NULL) {
+		/* queue is full, derive in place */
+		od_scram_derive_task_arg_free(arg);
+		return od_scram_derive_secret(secret, password);
+	}
+
+	int rc = -1;
+	if (od_thread_pool_wait(future, UINT32_MAX) == 0) {
+		od_scram_secret_t *result = od_future_get_result(future);
+		if (result != NULL) {
+			*secret = *result;
+			rc = 0;
+		}
+	}
+
+	od_future_unref(future);
+
+	return rc;
+}
+
+int od_scram_init_from_plain_password_cached(od_scram_cache_t *cache,
+					     od_scram_state_t *scram_state,
+					     const char *user,
+					     const char *password)
+{
+	od_scram_secret_t secret;
+
+	if (od_scram_cache_lookup(cache, user, password, &secret)) {
+		return od_scram_secret_to_state(&secret, scram_state);
+	}
+
+	int rc;
+	if (cache->derive_pool != NULL) {
+		rc = od_scram_derive_offload(cache->derive_pool, &secret,
+					     password);
+	} else {
+		rc = od_scram_derive_secret(&secret, password);
+	}
+	if (rc == -1) {
+		return -1;
+	}
+
+	od_scram_cache_store(cache, user, password, &secret);
+
+	rc = od_scram_secret_to_state(&secret, scram_state);
+	explicit_bzero(&secret, sizeof(secret));
+
+	return rc;
+}
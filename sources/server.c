@@ -12,6 +12,8 @@
 #include <server.h>
 #include <pstmt.h>
 #include <multi_pool.h>
+#include <router.h>
+#include <global.h>
 
 static inline void od_server_free_now(od_server_t *server)
 {
@@ -31,6 +33,7 @@ static inline void od_server_free_now(od_server_t *server)
 		od_server_pstmt_hashmap_free(server->prep_stmts);
 	}
 	od_scram_state_free(&server->scram_state);
+	kiwi_vars_free(&server->vars);
 	od_free(server);
 }
 
@@ -100,6 +103,18 @@ void od_server_cancel_end(od_server_t *server)
 	}
 }
 
+void od_server_reset_begin(od_server_t *server)
+{
+	od_server_ref(server);
+}
+
+/* returns 1 if only the pool holds the server after reset */
+int od_server_reset_end(od_server_t *server)
+{
+	/* pool ref always outlives the reset */
+	return od_server_unref(server) == 2;
+}
+
 void od_server_attach_client(od_server_t *server, od_client_t *client)
 {
 	od_assert(server->client == NULL);
@@ -112,6 +127,11 @@ void od_server_attach_client(od_server_t *server, od_client_t *client)
 	server->idle_time = 0;
 	od_server_set_pool_state(server, OD_SERVER_ACTIVE);
 	od_server_ref(server);
+
+	if (server->global != NULL) {
+		od_cancel_table_add(&server->global->router->cancel_table,
+				    server);
+	}
 }
 
 void od_server_detach_client(od_server_t *server)
@@ -123,6 +143,8 @@ void od_server_detach_client(od_server_t *server)
 	od_assert(server == client->server);
 
 	server->client_pinned = 0;
+	/* not sent deploy belongs to the detached client */
+	server->deploy_pending = 0;
 
 	client->server = NULL;
 	server->client = NULL;
@@ -136,6 +158,10 @@ void od_server_detach_client(od_server_t *server)
 	 * that does nothing than sending cancel to another
 	 * than current client
 	 */
+	if (server->global != NULL) {
+		od_cancel_table_remove(&server->global->router->cancel_table,
+				       server);
+	}
 	kiwi_key_init(&server->key_client);
 
 	if (od_server_unref(server) == 2) {
@@ -163,7 +189,9 @@ void od_server_set_pool_state(od_server_t *server, od_server_state_t state)
 	od_server_pool_t *pool;
 	pool = od_server_pool(server);
 
+	od_server_state_t prev = server->state;
 	od_pg_server_pool_set(pool, server, state);
+	od_multi_pool_element_set_state(server->pool_element, prev, state);
 
 	if (state == OD_SERVER_UNDEF) {
 		server->pool_element = NULL;
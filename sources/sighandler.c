@@ -75,12 +75,14 @@ static void start_timeout_thread(uint64_t timeout_ms)
 
 static void shutdown_servers(od_router_t *router)
 {
+	od_router_lock(router);
 	od_list_t *i;
 	od_list_foreach (&router->servers, i) {
 		od_system_server_t *server;
 		server = od_container_of(i, od_system_server_t, link);
 		od_system_server_shutdown(server);
 	}
+	od_router_unlock(router);
 }
 
 static void shutdown_worker(void *arg)
@@ -0,0 +1,165 @@
+/*
+ * Odyssey.
+ *
+ * Scalable PostgreSQL connection pooler.
+ *
+ * First keyword classifier, which allows to not run the parser on
+ * statements that can never be processed virtually.
+ */
+
+#include <odyssey.h>
+#include <pg_compat.h>
+#include <port/simd.h>
+
+#include <sql/minimal/prefilter.h>
+
+/* indexed by length, which differs for all of the keywords */
+static const struct {
+	const char *name;
+	od_sql_minimal_stmt_kind_t kind;
+} keywords[] = {
+	[3] = { "set", OD_SQL_MINIMAL_STMT_SET },
+	[4] = { "show", OD_SQL_MINIMAL_STMT_SHOW },
+	[5] = { "begin", OD_SQL_MINIMAL_STMT_BEGIN },
+	[7] = { "discard", OD_SQL_MINIMAL_STMT_DISCARD },
+	[10] = { "deallocate", OD_SQL_MINIMAL_STMT_DEALLOCATE },
+};
+
+/* character classes of scan.l */
+
+static inline int is_space(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static inline int is_ident_start(char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static inline int is_ident_cont(char c)
+{
+	return is_ident_start(c) || (c >= '0' && c <= '9');
+}
+
+static inline const char *skip_spaces(const char *pos, const char *end)
+{
+#ifndef USE_NO_SIMD
+	Vector8 space = vector8_broadcast(' ');
+	Vector8 tab = vector8_broadcast('\t');
+	Vector8 cr = vector8_broadcast('\r');
+	Vector8 lf = vector8_broadcast('\n');
+
+	while (end - pos >= (ptrdiff_t)sizeof(Vector8)) {
+		Vector8 chunk;
+		vector8_load(&chunk, (const uint8 *)pos);
+
+		Vector8 spaces = vector8_or(vector8_eq(chunk, space),
+					    vector8_eq(chunk, tab));
+		spaces = vector8_or(spaces, vector8_eq(chunk, cr));
+		spaces = vector8_or(spaces, vector8_eq(chunk, lf));
+
+		uint32 mask = ~vector8_highbit_mask(spaces) & 0xffff;
+		if (mask != 0) {
+			return pos + __builtin_ctz(mask);
+		}
+		pos += sizeof(Vector8);
+	}
+#endif
+
+	while (pos < end && is_space(*pos)) {
+		pos++;
+	}
+	return pos;
+}
+
+/* first occurrence of the character or NULL */
+static inline const char *find_char(const char *pos, const char *end, char c)
+{
+#ifndef USE_NO_SIMD
+	Vector8 needle = vector8_broadcast((uint8)c);
+
+	while (end - pos >= (ptrdiff_t)sizeof(Vector8)) {
+		Vector8 chunk;
+		vector8_load(&chunk, (const uint8 *)pos);
+
+		uint32 mask = vector8_highbit_mask(vector8_eq(chunk, needle));
+		if (mask != 0) {
+			return pos + __builtin_ctz(mask);
+		}
+		pos += sizeof(Vector8);
+	}
+#endif
+
+	return memchr(pos, c, end - pos);
+}
+
+/* position after the comment end or NULL if it is not terminated */
+static inline const char *skip_block_comment(const char *pos, const char *end)
+{
+	for (;;) {
+		const char *star = find_char(pos, end, '*');
+		if (star == NULL || star + 1 == end) {
+			return NULL;
+		}
+		if (star[1] == '/') {
+			return star + 2;
+		}
+		pos = star + 1;
+	}
+}
+
+od_sql_minimal_stmt_kind_t od_sql_minimal_classify(const char *input,
+						   size_t input_len)
+{
+	if (input == NULL) {
+		return OD_SQL_MINIMAL_STMT_OTHER;
+	}
+
+	const char *pos = input;
+	const char *end = input + input_len;
+
+	for (;;) {
+		pos = skip_spaces(pos, end);
+		if (end - pos < 2) {
+			break;
+		}
+
+		if (pos[0] == '-' && pos[1] == '-') {
+			pos = find_char(pos + 2, end, '\n');
+		} else if (pos[0] == '/' && pos[1] == '*') {
+			pos = skip_block_comment(pos + 2, end);
+		} else {
+			break;
+		}
+
+		if (pos == NULL) {
+			/* nothing but comments */
+			return OD_SQL_MINIMAL_STMT_OTHER;
+		}
+	}
+
+	if (pos == end || !is_ident_start(*pos)) {
+		return OD_SQL_MINIMAL_STMT_OTHER;
+	}
+
+	const char *word = pos;
+	while (pos < end && is_ident_cont(*pos)) {
+		pos++;
+	}
+	size_t len = pos - word;
+
+	if (len >= sizeof(keywords) / sizeof(keywords[0]) ||
+	    keywords[len].name == NULL) {
+		return OD_SQL_MINIMAL_STMT_OTHER;
+	}
+
+	/* the word has only ascii letters, digits and underscores */
+	const char *name = keywords[len].name;
+	for (size_t i = 0; i < len; i++) {
+		if ((word[i] | 0x20) != name[i]) {
+			return OD_SQL_MINIMAL_STMT_OTHER;
+		}
+	}
+	return keywords[len].kind;
+}
@@ -159,6 +159,12 @@ od_rule_storage_t *od_rules_storage_allocate(void)
 		od_free(storage);
 		return NULL;
 	}
+	storage->tls_opts->session_cache = machine_tls_session_cache_create();
+	if (storage->tls_opts->session_cache == NULL) {
+		od_tls_opts_free(storage->tls_opts);
+		od_free(storage);
+		return NULL;
+	}
 
 	atomic_init(&storage->refs, 1);
 
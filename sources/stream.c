@@ -66,6 +66,12 @@ typedef struct {
 	/* amount of bytes that must not be handled - just streamed */
 	size_t skip_left;
 
+	/*
+	 * runs of DataRow are skipped without per-message handling,
+	 * disabled when every message must be logged
+	 */
+	int bulk;
+
 	/* stop criteria */
 	stream_stop_t stop;
 
@@ -121,6 +127,7 @@ static void stream_init(stream_t *stream, int nresponses,
 	stream->msg_wpos = 0;
 	stream->msg_left = 0;
 	stream->skip_left = 0;
+	stream->bulk = 1;
 	stream->on_response = on_response;
 	stream->on_reponse_arg = arg;
 
@@ -337,6 +344,43 @@ static od_frontend_status_t stream_handle_message(stream_t *stream, char *ctx,
 	return OD_OK;
 }
 
+/*
+ * DataRow needs no handling, only its boundaries matter - so skip
+ * the whole run of rows by headers, the bytes are written to client
+ * right from the readahead
+ *
+ * returns amount of bytes skipped, the tail of a partly read row
+ * is accounted in skip_left
+ */
+static size_t stream_skip_data_rows(stream_t *stream, char *data, size_t size)
+{
+	size_t pos = 0;
+
+	while (size - pos >= sizeof(kiwi_header_t)) {
+		char *pkt = data + pos;
+		if (((kiwi_header_t *)pkt)->type != KIWI_BE_DATA_ROW) {
+			break;
+		}
+
+		uint32_t len = kiwi_read_size(pkt, sizeof(kiwi_header_t));
+		if (od_unlikely(len < sizeof(uint32_t) ||
+				len > PQ_LARGE_MESSAGE_LIMIT)) {
+			/* let the full path report it */
+			break;
+		}
+
+		size_t packet_size = sizeof(uint8_t) + len;
+		if (size - pos < packet_size) {
+			stream->skip_left = packet_size - (size - pos);
+			return size;
+		}
+
+		pos += packet_size;
+	}
+
+	return pos;
+}
+
 static od_frontend_status_t stream_eat(char *ctx, stream_t *stream,
 				       od_server_t *server, int is_service,
 				       int ignore_errors, char *data,
@@ -379,6 +423,13 @@ static od_frontend_status_t stream_eat(char *ctx, stream_t *stream,
 
 	/* new package */
 
+	if (stream->bulk) {
+		*processed = stream_skip_data_rows(stream, data, size);
+		if (*processed > 0) {
+			return OD_OK;
+		}
+	}
+
 	if (size < sizeof(kiwi_header_t)) {
 		/* package cannot be recognized - read more */
 		return OD_UNDEF;
@@ -526,6 +577,10 @@ od_stream_server_impl(char *ctx, od_server_t *server, int is_service,
 
 	stream_t stream;
 	stream_init(&stream, nresponses, on_response, arg);
+	od_route_t *route = server->route;
+	int log_debug = server->global->instance->config.log_debug ||
+			(route != NULL && route->rule->log_debug);
+	stream.bulk = !log_debug;
 
 	/*
 	 * set up the server io operations to be interrupted if
@@ -100,6 +100,7 @@ static inline void od_system_server(void *arg)
 			}
 			continue;
 		}
+		od_atomic_u64_inc(&server->accepted);
 
 		/* set network options */
 		mm_io_set_nodelay(client_io, instance->config.nodelay);
@@ -138,23 +139,11 @@ static inline void od_system_server(void *arg)
 		}
 		client->rule = NULL;
 		client->config_listen = server->config;
+		client->listener = server;
 		client->tls = server->tls;
 		client->time_accept = 0;
 		client->time_accept = machine_time_us();
 
-		/* create new client event and pass it to worker pool */
-		machine_msg_t *msg;
-		msg = machine_msg_create(sizeof(od_client_t *));
-		if (msg == NULL) {
-			od_error(&instance->logger, "server", NULL, NULL,
-				 "failed to allocate client message");
-			od_io_close(&client->io);
-			od_client_free(client);
-			continue;
-		}
-		machine_msg_set_type(msg, OD_MSG_CLIENT_NEW);
-		memcpy(machine_msg_data(msg), &client, sizeof(od_client_t *));
-
 		od_global_t *global = server->global;
 		rc = od_routing_slot_acquire(global,
 					     od_client_login_timeout(client));
@@ -169,13 +158,34 @@ static inline void od_system_server(void *arg)
 			 * 'server sent an error response during SSL exchange', so
 			 * let it be more clear 'server closed the connection unexpectedly'
 			 */
-			machine_msg_free(msg);
 			od_io_close(&client->io);
 			od_client_free(client);
 			continue;
 		}
+
+		if (server->worker != NULL) {
+			/* accepted by the worker itself, start client here */
+			od_worker_client_new(server->worker, client);
+			continue;
+		}
+
+		/* create new client event and pass it to worker pool */
+		machine_msg_t *msg;
+		msg = machine_msg_create(sizeof(od_client_t *));
+		if (msg == NULL) {
+			od_error(&instance->logger, "server", NULL, NULL,
+				 "failed to allocate client message");
+			od_io_close(&client->io);
+			od_client_free(client);
+			od_routing_slot_release(global);
+			continue;
+		}
+		machine_msg_set_type(msg, OD_MSG_CLIENT_NEW);
+		memcpy(machine_msg_data(msg), &client, sizeof(od_client_t *));
+
 		od_worker_pool_t *worker_pool = server->global->worker_pool;
-		od_worker_pool_feed(worker_pool, msg);
+		od_worker_pool_feed(worker_pool,
+				    instance->config.worker_placement, msg);
 	}
 
 	mm_eventfd_remove_peer_to(&server->shutdown_efd, server->io);
@@ -213,11 +223,56 @@ od_system_server_t *od_system_server_init(void)
 	server->tls = NULL;
 	od_id_generate(&server->sid, "sid");
 	atomic_init(&server->closed, false);
+	server->worker = NULL;
+	server->accepted = 0;
+	server->accepted_prev = 0;
+	server->accept_rate = 0;
+	server->tls_full = 0;
+	server->tls_resumed = 0;
 	server->coro_id = -1;
 
 	return server;
 }
 
+int od_system_server_spawn(od_system_server_t *server)
+{
+	int64_t coroutine_id;
+	coroutine_id = machine_coroutine_create(od_system_server, server);
+	if (coroutine_id == -1) {
+		return -1;
+	}
+
+	server->coro_id = coroutine_id;
+	return 0;
+}
+
+/* listen servers list is read by workers, cron and signal handler */
+static inline void od_system_server_register(od_system_server_t *server)
+{
+	od_router_t *router = server->global->router;
+	od_router_lock(router);
+	od_list_append(&router->servers, &server->link);
+	od_router_unlock(router);
+}
+
+static inline void od_system_server_unregister(od_system_server_t *server)
+{
+	od_router_t *router = server->global->router;
+	od_router_lock(router);
+	od_list_unlink(&server->link);
+	od_list_init(&server->link);
+	od_router_unlock(router);
+}
+
+void od_system_server_remove(od_system_server_t *server)
+{
+	od_system_server_unregister(server);
+
+	mm_io_close(server->io);
+	mm_io_free(server->io);
+	od_system_server_free(server);
+}
+
 void od_system_server_free(od_system_server_t *server)
 {
 	mm_eventfd_destroy(&server->shutdown_efd);
@@ -236,7 +291,8 @@ void od_system_server_free(od_system_server_t *server)
 
 static inline od_retcode_t od_system_server_start(od_system_t *system,
 						  od_config_listen_t *config,
-						  mm_addrinfo_t *addr)
+						  mm_addrinfo_t *addr,
+						  od_worker_t *worker)
 {
 	od_instance_t *instance;
 	od_system_server_t *server;
@@ -254,6 +310,7 @@ static inline od_retcode_t od_system_server_start(od_system_t *system,
 	server->config = config;
 	server->addr = addr;
 	server->global = system->global;
+	server->worker = worker;
 
 	/* create server tls */
 	if (server->config->tls_opts->tls_mode != OD_CONFIG_TLS_DISABLE) {
@@ -331,22 +388,43 @@ static inline od_retcode_t od_system_server_start(od_system_t *system,
 		}
 	}
 
-	od_log(&instance->logger, "server", NULL, NULL, "listening on %s",
-	       addr_name);
+	if (worker != NULL) {
+		/*
+		 * registered before the worker gets it, as the worker
+		 * removes the server if the accept loop fails to start
+		 */
+		od_system_server_register(server);
 
-	int64_t coroutine_id;
-	coroutine_id = machine_coroutine_create(od_system_server, server);
-	if (coroutine_id == -1) {
+		/*
+		 * socket starts to listen on the first accept, so the
+		 * kernel will not route connections to it, until the
+		 * worker starts the accept loop
+		 */
+		rc = od_worker_listen(worker, server);
+		if (rc == -1) {
+			od_error(&instance->logger, "system", NULL, NULL,
+				 "failed to pass server to worker[%d]",
+				 worker->id);
+			od_system_server_unregister(server);
+			goto error;
+		}
+		od_log(&instance->logger, "server", NULL, NULL,
+		       "listening on %s in worker[%d]", addr_name,
+		       worker->id);
+		return OK_RESPONSE;
+	}
+
+	rc = od_system_server_spawn(server);
+	if (rc == -1) {
 		od_error(&instance->logger, "system", NULL, NULL,
 			 "failed to start server coroutine");
 		goto error;
 	}
-
-	server->coro_id = coroutine_id;
+	od_log(&instance->logger, "server", NULL, NULL, "listening on %s",
+	       addr_name);
 
 	/* register server in list for possible TLS reload */
-	od_router_t *router = system->global->router;
-	od_list_append(&router->servers, &server->link);
+	od_system_server_register(server);
 	return OK_RESPONSE;
 
 error:
@@ -361,6 +439,34 @@ error:
 	return NOT_OK_RESPONSE;
 }
 
+/*
+ * returns count of started servers: one for the system machine accept
+ * loop or one per worker with listen_per_worker
+ */
+static inline int od_system_servers_start(od_system_t *system,
+					  od_config_listen_t *listen,
+					  mm_addrinfo_t *addr)
+{
+	od_instance_t *instance = system->global->instance;
+	od_worker_pool_t *worker_pool = system->global->worker_pool;
+
+	/* unix sockets can not be shared with SO_REUSEPORT */
+	if (!instance->config.listen_per_worker || addr == NULL) {
+		return od_system_server_start(system, listen, addr, NULL) ==
+		       OK_RESPONSE;
+	}
+
+	int started = 0;
+	for (uint32_t i = 0; i < worker_pool->count; ++i) {
+		int rc = od_system_server_start(system, listen, addr,
+						&worker_pool->pool[i]);
+		if (rc == OK_RESPONSE) {
+			started++;
+		}
+	}
+	return started;
+}
+
 static inline int od_system_listen(od_system_t *system)
 {
 	od_instance_t *instance = system->global->instance;
@@ -373,10 +479,7 @@ static inline int od_system_listen(od_system_t *system)
 		/* unix socket */
 		int rc;
 		if (listen->host == NULL) {
-			rc = od_system_server_start(system, listen, NULL);
-			if (rc == 0) {
-				binded++;
-			}
+			binded += od_system_servers_start(system, listen, NULL);
 			continue;
 		}
 
@@ -408,19 +511,13 @@ static inline int od_system_listen(od_system_t *system)
 
 		/* listen resolved addresses */
 		if (host) {
-			rc = od_system_server_start(system, listen, ai);
-			if (rc == 0) {
-				binded++;
-			}
+			binded += od_system_servers_start(system, listen, ai);
 			mm_freeaddrinfo(ai);
 			continue;
 		}
 		mm_addrinfo_t *orig = ai;
 		while (ai) {
-			rc = od_system_server_start(system, listen, ai);
-			if (rc == 0) {
-				binded++;
-			}
+			binded += od_system_servers_start(system, listen, ai);
 			ai = ai->ai_next;
 		}
 		mm_freeaddrinfo(orig);
@@ -527,6 +624,21 @@ void od_system_config_reload(od_system_t *system)
 	}
 	od_config_reload(&instance->config, &config);
 	od_logger_set_debug(&instance->logger, instance->config.log_debug);
+
+	/* passwords might be changed */
+	rc = od_scram_cache_configure(&system->global->scram_cache,
+				      instance->config.scram_cache_size,
+				      instance->config.scram_cache_ttl);
+	if (rc == OK_RESPONSE) {
+		rc = od_scram_cache_configure(
+			&system->global->server_scram_cache,
+			instance->config.scram_cache_size,
+			instance->config.scram_cache_ttl);
+	}
+	if (rc == NOT_OK_RESPONSE) {
+		od_error(&instance->logger, "config", NULL, NULL,
+			 "failed to allocate scram cache");
+	}
 	od_hba_reload(hba, &hba_rules);
 
 	/* auto-generate default rule for auth_query if none specified */
@@ -544,6 +656,7 @@ void od_system_config_reload(od_system_t *system)
 	od_rules_unlock(&router->rules);
 
 	/* Reload TLS certificates */
+	od_router_lock(router);
 	od_list_foreach (&router->servers, i) {
 		od_system_server_t *server;
 		od_config_listen_t *listen_config = NULL;
@@ -592,6 +705,7 @@ void od_system_config_reload(od_system_t *system)
 			}
 		}
 	}
+	od_router_unlock(router);
 
 	od_config_free(&config);
 
@@ -657,6 +771,33 @@ static inline void od_system(void *arg)
 		return;
 	}
 
+	rc = od_scram_cache_configure(&global->scram_cache,
+				      instance->config.scram_cache_size,
+				      instance->config.scram_cache_ttl);
+	if (rc == OK_RESPONSE) {
+		rc = od_scram_cache_configure(
+			&global->server_scram_cache,
+			instance->config.scram_cache_size,
+			instance->config.scram_cache_ttl);
+	}
+	if (rc == NOT_OK_RESPONSE) {
+		od_error(&instance->logger, "system", NULL, NULL,
+			 "failed to allocate scram cache");
+		return;
+	}
+
+	if (instance->config.scram_derive_workers > 0) {
+		rc = od_scram_cache_start_derive_workers(
+			&global->scram_cache,
+			(size_t)instance->config.scram_derive_workers);
+		if (rc == NOT_OK_RESPONSE) {
+			od_error(&instance->logger, "system", NULL, NULL,
+				 "failed to start scram derive pool, errno = %d (%s)",
+				 machine_errno(), strerror(machine_errno()));
+			return;
+		}
+	}
+
 #ifdef LDAP_FOUND
 	rc = od_ldap_workers_init(instance->config.workers);
 	if (rc == -1) {
@@ -700,10 +841,18 @@ static inline void od_system(void *arg)
 
 	machine_wait_nb(system->sighandler_machine);
 
+	/*
+	 * workers are stopped by the signal handler, so the list can
+	 * not change anymore
+	 */
 	od_list_t *i, *n;
 	od_list_foreach_safe (&router->servers, i, n) {
 		od_system_server_t *server;
 		server = od_container_of(i, od_system_server_t, link);
+		if (server->worker != NULL) {
+			/* joined by its worker on shutdown */
+			continue;
+		}
 		machine_join(server->coro_id);
 	}
 
@@ -713,6 +862,9 @@ static inline void od_system(void *arg)
 	od_ldap_workers_destroy();
 #endif
 
+	od_scram_cache_free(&global->scram_cache);
+	od_scram_cache_free(&global->server_scram_cache);
+
 	if (instance->config.host_watcher_enabled) {
 		od_host_watcher_destroy(&global->host_watcher);
 	}
@@ -110,7 +110,11 @@ void td_safe_free(td_histogram_t *h)
 void td_copy(td_histogram_t *dst, td_histogram_t *src)
 {
 	od_assert(dst->compression == src->compression);
+	mm_sleeplock_lock(&src->lock);
 	memcpy(dst, src, td_required_buf_size(src->compression));
+	mm_sleeplock_unlock(&src->lock);
+	/* lock state was copied together with the nodes */
+	mm_sleeplock_init(&dst->lock);
 }
 
 void td_free(td_histogram_t *h)
@@ -128,15 +132,34 @@ void td_merge(td_histogram_t *into, td_histogram_t *from)
 	}
 }
 
+static void reset(td_histogram_t *h)
+{
+	bzero((void *)(&h->nodes[0]), sizeof(node_t) * h->cap);
+	h->merged_nodes = 0;
+	h->merged_count = 0;
+	h->unmerged_nodes = 0;
+	h->unmerged_count = 0;
+}
+
+void td_drain(td_histogram_t *into, td_histogram_t *from)
+{
+	mm_sleeplock_lock(&from->lock);
+	{
+		merge(from);
+		for (int i = 0; i < from->merged_nodes; i++) {
+			node_t *n = &from->nodes[i];
+			td_add(into, n->mean, n->count);
+		}
+		reset(from);
+	}
+	mm_sleeplock_unlock(&from->lock);
+}
+
 void td_reset(td_histogram_t *h)
 {
 	mm_sleeplock_lock(&h->lock);
 	{
-		bzero((void *)(&h->nodes[0]), sizeof(node_t) * h->cap);
-		h->merged_nodes = 0;
-		h->merged_count = 0;
-		h->unmerged_nodes = 0;
-		h->unmerged_count = 0;
+		reset(h);
 	}
 	mm_sleeplock_unlock(&h->lock);
 }
@@ -43,9 +43,14 @@ static inline void do_pgoptions_test(const char *str, int expected_rc,
 	} else {
 		for (kiwi_var_type_t type = KIWI_VAR_CLIENT_ENCODING;
 		     type < KIWI_VAR_MAX; ++type) {
-			kiwi_var_t *expected_var =
-				kiwi_vars_of(&expected_vars, type);
-			kiwi_var_t *var = kiwi_vars_of(&vars, type);
+			kiwi_vars_entry_t *expected_var =
+				kiwi_vars_get(&expected_vars, type);
+			kiwi_vars_entry_t *var = kiwi_vars_get(&vars, type);
+			if (expected_var == NULL) {
+				test(var == NULL);
+				continue;
+			}
+			test(var != NULL);
 
 			test(var->name_len == expected_var->name_len);
 			test(strncasecmp(var->name, expected_var->name,
@@ -54,8 +59,13 @@ static inline void do_pgoptions_test(const char *str, int expected_rc,
 			test(strncmp(var->value, expected_var->value,
 				     var->value_len) == 0);
 		}
+		test(vars.count == expected_vars.count);
+		test(vars.hash == expected_vars.hash);
 	}
 
+	kiwi_vars_free(&expected_vars);
+	kiwi_vars_free(&vars);
+
 	va_end(ap);
 }
 
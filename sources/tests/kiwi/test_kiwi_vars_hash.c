@@ -0,0 +1,252 @@
+#include <kiwi/kiwi.h>
+#include <tests/odyssey_test.h>
+
+#define SET(vars, type, value) \
+	test(kiwi_vars_set(vars, type, value, sizeof(value)) == 0)
+
+static int vars_cas_size(kiwi_vars_t *client, kiwi_vars_t *server)
+{
+	char query[1024];
+	return kiwi_vars_cas(client, server, query, sizeof(query), 0);
+}
+
+static void test_hash_is_order_independent(void)
+{
+	kiwi_vars_t a, b;
+	kiwi_vars_init(&a);
+	kiwi_vars_init(&b);
+	test(a.hash == 0);
+
+	SET(&a, KIWI_VAR_DATESTYLE, "ISO");
+	SET(&a, KIWI_VAR_TIMEZONE, "UTC");
+	SET(&a, KIWI_VAR_SEARCH_PATH, "public");
+
+	SET(&b, KIWI_VAR_SEARCH_PATH, "other");
+	SET(&b, KIWI_VAR_TIMEZONE, "UTC");
+	SET(&b, KIWI_VAR_APPLICATION_NAME, "app");
+	SET(&b, KIWI_VAR_DATESTYLE, "ISO");
+	test(a.hash != b.hash);
+
+	SET(&b, KIWI_VAR_SEARCH_PATH, "public");
+	kiwi_vars_unset(&b, KIWI_VAR_APPLICATION_NAME);
+	test(a.hash == b.hash);
+	test(vars_cas_size(&a, &b) == 0);
+
+	kiwi_vars_unset(&a, KIWI_VAR_DATESTYLE);
+	kiwi_vars_unset(&a, KIWI_VAR_TIMEZONE);
+	kiwi_vars_unset(&a, KIWI_VAR_SEARCH_PATH);
+	test(a.hash == 0);
+	test(a.count == 0);
+
+	kiwi_vars_free(&a);
+	kiwi_vars_free(&b);
+}
+
+static void test_hash_tracks_type(void)
+{
+	kiwi_vars_t a, b;
+	kiwi_vars_init(&a);
+	kiwi_vars_init(&b);
+
+	/* same value under different names must not collide */
+	SET(&a, KIWI_VAR_DATESTYLE, "x");
+	SET(&b, KIWI_VAR_TIMEZONE, "x");
+	test(a.hash != b.hash);
+	test(vars_cas_size(&a, &b) > 0);
+
+	kiwi_vars_t c;
+	kiwi_vars_init(&c);
+	SET(&c, KIWI_VAR_DATESTYLE, "x");
+	SET(&c, KIWI_VAR_DATESTYLE, "y");
+	SET(&c, KIWI_VAR_DATESTYLE, "x");
+	test(a.hash == c.hash);
+
+	kiwi_vars_free(&a);
+	kiwi_vars_free(&b);
+	kiwi_vars_free(&c);
+}
+
+/* only set vars are stored, ordered by type */
+static void test_sparse(void)
+{
+	kiwi_vars_t vars;
+	kiwi_vars_init(&vars);
+
+	SET(&vars, KIWI_VAR_SEARCH_PATH, "schema");
+	SET(&vars, KIWI_VAR_CLIENT_ENCODING, "UTF8");
+	SET(&vars, KIWI_VAR_APPLICATION_NAME, "app");
+	SET(&vars, KIWI_VAR_ODYSSEY_TARGET_SESSION_ATTRS, "any");
+	test(vars.count == 4);
+	for (int i = 1; i < vars.count; i++) {
+		test(vars.entries[i - 1].type < vars.entries[i].type);
+	}
+
+	kiwi_vars_entry_t *var = kiwi_vars_get(&vars, KIWI_VAR_SEARCH_PATH);
+	test(var != NULL);
+	test(strcmp(var->name, "search_path") == 0);
+	test(var->name_len == sizeof("search_path"));
+	test(strcmp(var->value, "schema") == 0);
+	test(kiwi_vars_get(&vars, KIWI_VAR_TIMEZONE) == NULL);
+	test(kiwi_vars_get(&vars, KIWI_VAR_UNDEF) == NULL);
+
+	/* values over the limit are not set */
+	char big[KIWI_MAX_VAR_SIZE + 1];
+	memset(big, 'x', sizeof(big));
+	test(kiwi_vars_set(&vars, KIWI_VAR_WORK_MEM, big, sizeof(big)) == -1);
+	test(kiwi_vars_get(&vars, KIWI_VAR_WORK_MEM) == NULL);
+
+	/* not terminated values are stored terminated */
+	test(kiwi_vars_set(&vars, KIWI_VAR_ROLE, "admin", 5) == 0);
+	var = kiwi_vars_get(&vars, KIWI_VAR_ROLE);
+	test(var->value_len == 5);
+	test(strcmp(var->value, "admin") == 0);
+
+	kiwi_vars_unset(&vars, KIWI_VAR_CLIENT_ENCODING);
+	kiwi_vars_unset(&vars, KIWI_VAR_TIMEZONE);
+	test(vars.count == 4);
+	test(vars.entries[0].type == KIWI_VAR_APPLICATION_NAME);
+
+	kiwi_vars_free(&vars);
+	test(vars.count == 0);
+	test(vars.hash == 0);
+}
+
+/* common values are shared, others are copied */
+static void test_interned(void)
+{
+	kiwi_vars_t a, b;
+	kiwi_vars_init(&a);
+	kiwi_vars_init(&b);
+
+	SET(&a, KIWI_VAR_DATESTYLE, "ISO, MDY");
+	SET(&b, KIWI_VAR_DATESTYLE, "ISO, MDY");
+	SET(&a, KIWI_VAR_APPLICATION_NAME, "app");
+	SET(&b, KIWI_VAR_APPLICATION_NAME, "app");
+
+	kiwi_vars_entry_t *a_var = kiwi_vars_get(&a, KIWI_VAR_DATESTYLE);
+	kiwi_vars_entry_t *b_var = kiwi_vars_get(&b, KIWI_VAR_DATESTYLE);
+	test(a_var->interned && b_var->interned);
+	test(a_var->value == b_var->value);
+
+	a_var = kiwi_vars_get(&a, KIWI_VAR_APPLICATION_NAME);
+	b_var = kiwi_vars_get(&b, KIWI_VAR_APPLICATION_NAME);
+	test(!a_var->interned && !b_var->interned);
+	test(a_var->value != b_var->value);
+	test(a.hash == b.hash);
+
+	/* interned value is replaced by own one and back */
+	SET(&a, KIWI_VAR_DATESTYLE, "Postgres, MDY");
+	test(!kiwi_vars_get(&a, KIWI_VAR_DATESTYLE)->interned);
+	SET(&a, KIWI_VAR_DATESTYLE, "ISO, MDY");
+	test(kiwi_vars_get(&a, KIWI_VAR_DATESTYLE)->interned);
+	test(a.hash == b.hash);
+
+	kiwi_vars_free(&a);
+	kiwi_vars_free(&b);
+}
+
+/* server has vars, that client did not set */
+static void test_cas(void)
+{
+	kiwi_vars_t client, server;
+	kiwi_vars_init(&client);
+	kiwi_vars_init(&server);
+
+	SET(&server, KIWI_VAR_CLIENT_ENCODING, "UTF8");
+	SET(&server, KIWI_VAR_DATESTYLE, "ISO, MDY");
+	SET(&server, KIWI_VAR_TIMEZONE, "UTC");
+	SET(&server, KIWI_VAR_APPLICATION_NAME, "old");
+
+	SET(&client, KIWI_VAR_TIMEZONE, "UTC");
+	SET(&client, KIWI_VAR_COMPRESSION, "on");
+	test(vars_cas_size(&client, &server) == 0);
+
+	char query[1024];
+	SET(&client, KIWI_VAR_APPLICATION_NAME, "new");
+	SET(&client, KIWI_VAR_SEARCH_PATH, "public");
+	int size = kiwi_vars_cas(&client, &server, query, sizeof(query), 0);
+	test(size > 0);
+	query[size] = 0;
+	test(strcmp(query, "SET application_name=E'new';"
+			   "SET search_path=E'public';") == 0);
+
+	kiwi_vars_free(&client);
+	kiwi_vars_free(&server);
+}
+
+/* equal hashes of different sets do not skip the deploy */
+static void test_cas_hash_collision(void)
+{
+	kiwi_vars_t client, server;
+	kiwi_vars_init(&client);
+	kiwi_vars_init(&server);
+
+	SET(&client, KIWI_VAR_SEARCH_PATH, "public");
+	SET(&server, KIWI_VAR_SEARCH_PATH, "evil");
+	test(!kiwi_vars_equal(&client, &server));
+
+	/* as if the values collided */
+	server.hash = client.hash;
+	test(!kiwi_vars_equal(&client, &server));
+
+	char query[1024];
+	int size = kiwi_vars_cas(&client, &server, query, sizeof(query), 0);
+	test(size > 0);
+	query[size] = 0;
+	test(strcmp(query, "SET search_path=E'public';") == 0);
+
+	/* same for the different count of vars */
+	SET(&server, KIWI_VAR_SEARCH_PATH, "public");
+	SET(&server, KIWI_VAR_TIMEZONE, "UTC");
+	server.hash = client.hash;
+	test(!kiwi_vars_equal(&client, &server));
+
+	kiwi_vars_unset(&server, KIWI_VAR_TIMEZONE);
+	test(kiwi_vars_equal(&client, &server));
+	test(vars_cas_size(&client, &server) == 0);
+
+	kiwi_vars_free(&client);
+	kiwi_vars_free(&server);
+}
+
+/* stamps identify the values without collisions */
+static void test_stamp(void)
+{
+	kiwi_vars_t a, b;
+	kiwi_vars_init(&a);
+	kiwi_vars_init(&b);
+	test(a.stamp == 0 && b.stamp == 0);
+
+	SET(&a, KIWI_VAR_TIMEZONE, "UTC");
+	uint64_t stamp = a.stamp;
+	test(stamp != 0);
+
+	/* same value is not a change */
+	SET(&a, KIWI_VAR_TIMEZONE, "UTC");
+	test(a.stamp == stamp);
+
+	/* same values set separately get own stamps */
+	SET(&b, KIWI_VAR_TIMEZONE, "UTC");
+	test(b.stamp != 0 && b.stamp != stamp);
+
+	SET(&a, KIWI_VAR_TIMEZONE, "MSK");
+	test(a.stamp != stamp && a.stamp != b.stamp);
+	stamp = a.stamp;
+	kiwi_vars_unset(&a, KIWI_VAR_TIMEZONE);
+	test(a.stamp != stamp);
+
+	kiwi_vars_free(&a);
+	kiwi_vars_free(&b);
+	test(a.stamp == 0 && b.stamp == 0);
+}
+
+void kiwi_test_vars_hash(void)
+{
+	test_hash_is_order_independent();
+	test_hash_tracks_type();
+	test_sparse();
+	test_interned();
+	test_cas();
+	test_cas_hash_collision();
+	test_stamp();
+}
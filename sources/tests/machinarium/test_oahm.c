@@ -0,0 +1,270 @@
+#include <machinarium/machinarium.h>
+#include <machinarium/ds/oahm.h>
+#include <tests/odyssey_test.h>
+
+static mm_hash_t int_hash(const void *key)
+{
+	return mm_xxh64_hash(key, sizeof(int), 0);
+}
+
+static int int_cmp(const void *k1, const void *k2)
+{
+	return *(const int *)k1 != *(const int *)k2;
+}
+
+/* all keys in one probe sequence */
+static mm_hash_t bad_hash(const void *key)
+{
+	(void)key;
+	return 42;
+}
+
+static int vdtor_calls = 0;
+
+static void count_vdtor(void *val)
+{
+	(void)val;
+	++vdtor_calls;
+}
+
+static int sum_cb(mm_oahm_t *hm, void *key, void *val, void **argv)
+{
+	(void)hm;
+	(void)key;
+	*(long *)argv[0] += *(long *)val;
+	return 0;
+}
+
+static void test_basic(void)
+{
+	mm_oahm_t *hm = mm_oahm_create(sizeof(int), sizeof(long), int_cmp,
+				       int_hash, NULL, count_vdtor, NULL);
+	test(hm != NULL);
+
+	/* nothing is allocated until first insert */
+	test(mm_oahm_capacity(hm) == 0);
+	int key = 1;
+	test(mm_oahm_get(hm, &key) == NULL);
+	test(mm_oahm_remove(hm, &key) == 0);
+
+	int found;
+	long *val = mm_oahm_insert(hm, &key, &found);
+	test(val != NULL);
+	test(found == 0);
+	test(*val == 0);
+	*val = 100;
+
+	val = mm_oahm_insert(hm, &key, &found);
+	test(found == 1);
+	test(*val == 100);
+	test(mm_oahm_count(hm) == 1);
+
+	test(mm_oahm_remove(hm, &key) == 1);
+	test(vdtor_calls == 1);
+	test(mm_oahm_get(hm, &key) == NULL);
+	test(mm_oahm_count(hm) == 0);
+
+	/* empty map releases its table */
+	test(mm_oahm_capacity(hm) == 0);
+
+	mm_oahm_free(hm);
+}
+
+static void test_grow(void)
+{
+	const int n = 100000;
+
+	mm_oahm_t *hm = mm_oahm_create(sizeof(int), sizeof(long), int_cmp,
+				       int_hash, NULL, NULL, NULL);
+	test(hm != NULL);
+
+	for (int i = 0; i < n; ++i) {
+		int found;
+		long *val = mm_oahm_insert(hm, &i, &found);
+		test(val != NULL);
+		test(found == 0);
+		*val = i;
+
+		/* moved entries are still found */
+		int k = i / 2;
+		long *v = mm_oahm_get(hm, &k);
+		test(v != NULL);
+		test(*v == k);
+
+		/* and removed ones are not, even while moving */
+		if (i % 1000 == 999) {
+			test(mm_oahm_remove(hm, &k) == 1);
+			test(mm_oahm_get(hm, &k) == NULL);
+			val = mm_oahm_insert(hm, &k, &found);
+			test(val != NULL);
+			test(found == 0);
+			*val = k;
+		}
+	}
+	test(mm_oahm_count(hm) == (size_t)n);
+
+	long sum = 0;
+	void *argv[] = { &sum };
+	test(mm_oahm_foreach(hm, sum_cb, argv) == 0);
+	test(sum == (long)n * (n - 1) / 2);
+
+	for (int i = 0; i < n; i += 2) {
+		test(mm_oahm_remove(hm, &i) == 1);
+	}
+	test(mm_oahm_count(hm) == (size_t)n / 2);
+
+	for (int i = 0; i < n; ++i) {
+		long *v = mm_oahm_get(hm, &i);
+		if (i % 2 == 0) {
+			test(v == NULL);
+		} else {
+			test(v != NULL);
+			test(*v == i);
+		}
+	}
+
+	mm_oahm_clear(hm);
+	test(mm_oahm_count(hm) == 0);
+	test(mm_oahm_capacity(hm) == 0);
+
+	mm_oahm_free(hm);
+}
+
+static void test_churn(void)
+{
+	/* deleted slots must not make the table grow forever */
+	mm_oahm_t *hm = mm_oahm_create(sizeof(int), sizeof(long), int_cmp,
+				       int_hash, NULL, NULL, NULL);
+	test(hm != NULL);
+
+	for (int i = 0; i < 100000; ++i) {
+		int found;
+		test(mm_oahm_insert(hm, &i, &found) != NULL);
+		int k = i - 10;
+		if (k >= 0) {
+			test(mm_oahm_remove(hm, &k) == 1);
+		}
+	}
+	test(mm_oahm_count(hm) == 10);
+	test(mm_oahm_capacity(hm) <= 128);
+
+	mm_oahm_free(hm);
+}
+
+static void test_grow_after_removes(void)
+{
+	/*
+	 * grow caused by deleted slots makes a small table for few live
+	 * entries, while the big old one is still moved: moves must never
+	 * overfill the new table
+	 */
+	int found;
+
+	/* number of keys, which fills the big table up to the load factor */
+	mm_oahm_t *hm = mm_oahm_create(sizeof(int), sizeof(long), int_cmp,
+				       int_hash, NULL, NULL, NULL);
+	test(hm != NULL);
+	int n = 0;
+	for (;;) {
+		size_t capacity = mm_oahm_capacity(hm);
+		test(mm_oahm_insert(hm, &n, &found) != NULL);
+		/* there is no old table and the current one is full */
+		if (capacity >= 16384 && (capacity & (capacity - 1)) == 0 &&
+		    mm_oahm_capacity(hm) > capacity) {
+			break;
+		}
+		n++;
+	}
+	mm_oahm_free(hm);
+
+	hm = mm_oahm_create(sizeof(int), sizeof(long), int_cmp, int_hash,
+			    NULL, NULL, NULL);
+	test(hm != NULL);
+	for (int i = 0; i < n; ++i) {
+		long *val = mm_oahm_insert(hm, &i, &found);
+		test(val != NULL);
+		*val = i;
+	}
+
+	/* leave a few live entries among the deleted ones */
+	const int live = 15;
+	for (int i = live; i < n; ++i) {
+		test(mm_oahm_remove(hm, &i) == 1);
+	}
+	size_t capacity = mm_oahm_capacity(hm);
+
+	/* grows into the small table */
+	int next = n;
+	long *val = mm_oahm_insert(hm, &next, &found);
+	test(val != NULL);
+	*val = next++;
+	test(mm_oahm_capacity(hm) - capacity <= 32);
+
+	/* fill it almost up to the load factor */
+	for (int i = 0; i < 20; ++i, ++next) {
+		val = mm_oahm_insert(hm, &next, &found);
+		test(val != NULL);
+		test(found == 0);
+		*val = next;
+	}
+
+	/* removes of unknown keys move the rest of the old table */
+	for (int i = 0; i < n; ++i) {
+		int k = -1 - i;
+		test(mm_oahm_remove(hm, &k) == 0);
+	}
+	test(mm_oahm_count(hm) == (size_t)(live + next - n));
+
+	for (int i = 0; i < next; ++i) {
+		long *v = mm_oahm_get(hm, &i);
+		if (i >= live && i < n) {
+			test(v == NULL);
+		} else {
+			test(v != NULL && *v == i);
+		}
+	}
+
+	mm_oahm_free(hm);
+}
+
+static void test_collisions(void)
+{
+	mm_oahm_t *hm = mm_oahm_create(sizeof(int), sizeof(long), int_cmp,
+				       bad_hash, NULL, NULL, NULL);
+	test(hm != NULL);
+
+	for (int i = 0; i < 200; ++i) {
+		int found;
+		long *val = mm_oahm_insert(hm, &i, &found);
+		test(val != NULL);
+		*val = i;
+	}
+
+	for (int i = 0; i < 200; i += 3) {
+		test(mm_oahm_remove(hm, &i) == 1);
+	}
+
+	for (int i = 0; i < 200; ++i) {
+		long *v = mm_oahm_get(hm, &i);
+		if (i % 3 == 0) {
+			test(v == NULL);
+		} else {
+			test(v != NULL && *v == i);
+		}
+	}
+
+	mm_oahm_free(hm);
+}
+
+void machinarium_test_oahm(void)
+{
+	machinarium_init();
+
+	test_basic();
+	test_grow();
+	test_churn();
+	test_grow_after_removes();
+	test_collisions();
+
+	machinarium_free();
+}
@@ -0,0 +1,64 @@
+
+#include <unistd.h>
+#include <machinarium/machinarium.h>
+#include <machinarium/sleep_lock.h>
+#include <tests/odyssey_test.h>
+
+mm_rwsleeplock_t global_rwlock;
+
+static uint64_t writes;
+static uint64_t shadow;
+
+static void test_writer(void *arg)
+{
+	(void)arg;
+	for (int i = 0; i < (1 << 18); i++) {
+		mm_rwsleeplock_wrlock(&global_rwlock);
+		writes++;
+		shadow++;
+		mm_rwsleeplock_wrunlock(&global_rwlock);
+	}
+}
+
+static void test_reader(void *arg)
+{
+	uint64_t *torn = (uint64_t *)arg;
+	for (int i = 0; i < (1 << 18); i++) {
+		mm_rwsleeplock_rdlock(&global_rwlock);
+		if (writes != shadow) {
+			__atomic_fetch_add(torn, 1, __ATOMIC_RELAXED);
+		}
+		mm_rwsleeplock_rdunlock(&global_rwlock);
+	}
+}
+
+void machinarium_test_rwsleeplock(void)
+{
+	machinarium_init();
+
+	uint64_t torn = 0;
+	writes = 0;
+	shadow = 0;
+	mm_rwsleeplock_init(&global_rwlock);
+
+	int id0, id1, id2, id3;
+	id0 = machine_create("test", test_writer, NULL);
+	id1 = machine_create("test", test_writer, NULL);
+	id2 = machine_create("test", test_reader, &torn);
+	id3 = machine_create("test", test_reader, &torn);
+	test(id0 != -1);
+	test(id1 != -1);
+	test(id2 != -1);
+	test(id3 != -1);
+
+	test(machine_wait(id0) != -1);
+	test(machine_wait(id1) != -1);
+	test(machine_wait(id2) != -1);
+	test(machine_wait(id3) != -1);
+
+	test(writes == (2L << 18));
+	test(torn == 0);
+	test(atomic_load(&global_rwlock) == 0);
+
+	machinarium_free();
+}
@@ -0,0 +1,193 @@
+#include <machinarium/machinarium.h>
+#include <machinarium/clock.h>
+#include <tests/odyssey_test.h>
+
+#include <string.h>
+
+#define TIMERS 512
+#define STEPS 20000
+
+typedef struct {
+	mm_timer_t timer;
+	uint64_t *fired_at;
+	mm_clock_t *clock;
+} el_t;
+
+static el_t heap_timers[TIMERS];
+static el_t wheel_timers[TIMERS];
+static uint64_t heap_fired_at[TIMERS];
+static uint64_t wheel_fired_at[TIMERS];
+
+static uint64_t seed = 42;
+
+static uint32_t rnd(void)
+{
+	seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+	return seed >> 33;
+}
+
+static void on_timer(mm_timer_t *timer)
+{
+	el_t *el = timer->arg;
+	*el->fired_at = el->clock->time_ms;
+}
+
+static void clock_set(mm_clock_t *clock, uint64_t now)
+{
+	clock->time_ms = now;
+	clock->time_cached = 1;
+}
+
+static uint32_t random_interval(void)
+{
+	switch (rnd() % 8) {
+	case 0:
+		return 0;
+	case 1:
+	case 2:
+	case 3:
+		return rnd() % 300;
+	case 4:
+	case 5:
+		return rnd() % 70000;
+	case 6:
+		return rnd() % (1U << 25);
+	default:
+		return rnd();
+	}
+}
+
+/* wheel fires every timer at the same step as the heap */
+static void test_same_as_heap(void)
+{
+	mm_clock_t heap;
+	mm_clock_t wheel;
+	test(mm_clock_init(&heap, 0) == 0);
+	test(mm_clock_init(&wheel, 1) == 0);
+
+	/* cross the 2^32 ms boundary, where overflow timers move */
+	uint64_t now = (1ULL << 32) - 100000;
+	clock_set(&heap, now);
+	clock_set(&wheel, now);
+
+	for (int i = 0; i < TIMERS; i++) {
+		heap_timers[i].fired_at = &heap_fired_at[i];
+		heap_timers[i].clock = &heap;
+		wheel_timers[i].fired_at = &wheel_fired_at[i];
+		wheel_timers[i].clock = &wheel;
+		mm_timer_init(&heap_timers[i].timer, on_timer, &heap_timers[i],
+			      0);
+		mm_timer_init(&wheel_timers[i].timer, on_timer,
+			      &wheel_timers[i], 0);
+	}
+	memset(heap_fired_at, 0, sizeof(heap_fired_at));
+	memset(wheel_fired_at, 0, sizeof(wheel_fired_at));
+
+	for (int step = 0; step < STEPS; step++) {
+		/* start, restart or stop some timers */
+		for (int n = rnd() % 16; n > 0; n--) {
+			int i = rnd() % TIMERS;
+			if (heap_timers[i].timer.active && rnd() % 2) {
+				mm_timer_stop(&heap_timers[i].timer);
+				mm_timer_stop(&wheel_timers[i].timer);
+				test(!wheel_timers[i].timer.active);
+				continue;
+			}
+			mm_timer_stop(&heap_timers[i].timer);
+			mm_timer_stop(&wheel_timers[i].timer);
+			uint32_t interval = random_interval();
+			heap_timers[i].timer.interval = interval;
+			wheel_timers[i].timer.interval = interval;
+			mm_clock_timer_add(&heap, &heap_timers[i].timer);
+			mm_clock_timer_add(&wheel, &wheel_timers[i].timer);
+		}
+		test(mm_clock_timers_count(&heap) ==
+		     mm_clock_timers_count(&wheel));
+
+		/* wheel never sleeps past the earliest timer */
+		uint64_t heap_next;
+		uint64_t wheel_next;
+		int rc = mm_clock_timer_next(&heap, &heap_next);
+		test(mm_clock_timer_next(&wheel, &wheel_next) == rc);
+		if (rc == 0) {
+			test(wheel_next <= heap_next);
+		}
+
+		/* mostly short sleeps, sometimes long ones */
+		if (rnd() % 100 == 0) {
+			now += rnd() % (1U << 24);
+		} else {
+			now += rnd() % 700;
+		}
+		clock_set(&heap, now);
+		clock_set(&wheel, now);
+		mm_clock_step(&heap);
+		mm_clock_step(&wheel);
+
+		for (int i = 0; i < TIMERS; i++) {
+			test(heap_fired_at[i] == wheel_fired_at[i]);
+			test(heap_timers[i].timer.active ==
+			     wheel_timers[i].timer.active);
+		}
+	}
+
+	/* everything fires eventually */
+	now += 1ULL << 33;
+	clock_set(&heap, now);
+	clock_set(&wheel, now);
+	mm_clock_step(&heap);
+	mm_clock_step(&wheel);
+	test(mm_clock_timers_count(&heap) == 0);
+	test(mm_clock_timers_count(&wheel) == 0);
+	for (int i = 0; i < TIMERS; i++) {
+		test(heap_fired_at[i] == wheel_fired_at[i]);
+	}
+
+	mm_clock_free(&heap);
+	mm_clock_free(&wheel);
+}
+
+static int sleeps_done;
+
+static void sleeper(void *arg)
+{
+	uint32_t time_ms = (uint32_t)(uintptr_t)arg;
+	uint64_t start = machine_time_ms();
+	machine_sleep(time_ms);
+	test(machine_time_ms() - start >= time_ms);
+	/* shorter sleeps wake up first */
+	test(sleeps_done == (int)(time_ms / 10) - 1);
+	sleeps_done++;
+}
+
+static void test_machine(void *arg)
+{
+	(void)arg;
+	for (int i = 5; i > 0; i--) {
+		int rc;
+		rc = machine_coroutine_create(sleeper,
+					      (void *)(uintptr_t)(i * 10));
+		test(rc != -1);
+	}
+	machine_sleep(100);
+	test(sleeps_done == 5);
+}
+
+void machinarium_test_timer_wheel(void)
+{
+	test_same_as_heap();
+
+	machinarium_set_timer_wheel(1);
+	machinarium_init();
+
+	int id;
+	id = machine_create("test", test_machine, NULL);
+	test(id != -1);
+
+	int rc;
+	rc = machine_wait(id);
+	test(rc != -1);
+
+	machinarium_free();
+	machinarium_set_timer_wheel(0);
+}
@@ -0,0 +1,202 @@
+#include <machinarium/machinarium.h>
+#include <machinarium/io.h>
+#include <tests/odyssey_test.h>
+
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define CONNECTIONS 5
+
+static machine_tls_session_cache_t *session_cache;
+
+/* handshakes of the connections, 1 is resumed */
+static const int resumed[CONNECTIONS] = { 0, 1, 0, 0, 1 };
+
+static machine_tls_t *server_tls_create(void)
+{
+	machine_tls_t *tls;
+	tls = machine_tls_create();
+	test(tls != NULL);
+	int rc;
+	rc = machine_tls_set_verify(tls, "none");
+	test(rc == 0);
+	rc = machine_tls_set_ca_file(tls, "./machinarium/ca.crt");
+	test(rc == 0);
+	rc = machine_tls_set_cert_file(tls, "./machinarium/server.crt");
+	test(rc == 0);
+	rc = machine_tls_set_key_file(tls, "./machinarium/server.key");
+	test(rc == 0);
+	return tls;
+}
+
+static void server(void *arg)
+{
+	(void)arg;
+	mm_io_t *server = mm_io_create();
+	test(server != NULL);
+
+	struct sockaddr_in sa;
+	sa.sin_family = AF_INET;
+	sa.sin_addr.s_addr = inet_addr("127.0.0.1");
+	sa.sin_port = htons(7778);
+	int rc;
+	rc = mm_io_bind(server, (struct sockaddr *)&sa,
+			MM_BINDWITH_SO_REUSEADDR);
+	test(rc == 0);
+
+	/* two tls objects have own contexts, as different workers do */
+	machine_tls_t *tls[2];
+	tls[0] = server_tls_create();
+	tls[1] = server_tls_create();
+
+	char keys[MACHINE_TLS_TICKET_KEYS_EXPORT_SIZE];
+	ssize_t keys_size = 0;
+
+	for (int i = 0; i < CONNECTIONS; i++) {
+		switch (i) {
+		case 2:
+			/* tickets of the dropped keys are not accepted */
+			keys_size = machine_tls_ticket_keys_export(
+				keys, sizeof(keys));
+			test(keys_size > 0);
+			rc = machine_tls_ticket_keys_rotate();
+			test(rc == 0);
+			rc = machine_tls_ticket_keys_rotate();
+			test(rc == 0);
+			break;
+		case 3:
+			/* as new process after restart */
+			rc = machine_tls_ticket_keys_import(keys, keys_size);
+			test(rc == 0);
+			break;
+		}
+
+		mm_io_t *client = NULL;
+		rc = mm_io_accept(server, &client, 16, 1, UINT32_MAX);
+		test(rc == 0);
+		test(client != NULL);
+
+		rc = mm_io_set_tls(client, tls[i % 2], UINT32_MAX);
+		if (rc == -1) {
+			printf("%s\n", mm_io_error(client));
+			test(rc == 0);
+		}
+		test(mm_io_is_tls_resumed(client) == resumed[i]);
+
+		machine_msg_t *msg;
+		msg = machine_msg_create(0);
+		test(msg != NULL);
+		char text[] = "hello world";
+		rc = machine_msg_write(msg, text, sizeof(text));
+		test(rc == 0);
+
+		rc = machine_write(client, msg, UINT32_MAX);
+		test(rc == 0);
+
+		msg = machine_read(client, 1, UINT32_MAX);
+		/* eof */
+		test(msg == NULL);
+
+		rc = mm_io_close(client);
+		test(rc == 0);
+		mm_io_free(client);
+	}
+
+	rc = mm_io_close(server);
+	test(rc == 0);
+	mm_io_free(server);
+
+	machine_tls_free(tls[0]);
+	machine_tls_free(tls[1]);
+}
+
+static void client(void *arg)
+{
+	(void)arg;
+
+	for (int i = 0; i < CONNECTIONS; i++) {
+		mm_io_t *client = mm_io_create();
+		test(client != NULL);
+
+		struct sockaddr_in sa;
+		sa.sin_family = AF_INET;
+		sa.sin_addr.s_addr = inet_addr("127.0.0.1");
+		sa.sin_port = htons(7778);
+		int rc;
+		rc = mm_io_connect(client, (struct sockaddr *)&sa, UINT32_MAX);
+		test(rc == 0);
+
+		machine_tls_t *tls;
+		tls = machine_tls_create();
+		rc = machine_tls_set_verify(tls, "none");
+		test(rc == 0);
+		rc = machine_tls_set_ca_file(tls, "./machinarium/ca.crt");
+		test(rc == 0);
+		rc = machine_tls_set_session_cache(tls, session_cache,
+						   "tcp://127.0.0.1:7778");
+		test(rc == 0);
+		rc = mm_io_set_tls(client, tls, UINT32_MAX);
+		if (rc == -1) {
+			printf("%s\n", mm_io_error(client));
+			test(rc == 0);
+		}
+
+		machine_msg_t *msg;
+		msg = machine_read(client, 12, UINT32_MAX);
+		test(msg != NULL);
+		test(memcmp(machine_msg_data(msg), "hello world", 12) == 0);
+		machine_msg_free(msg);
+
+		rc = mm_io_close(client);
+		test(rc == 0);
+		mm_io_free(client);
+
+		machine_tls_free(tls);
+	}
+}
+
+static void test_cs(void *arg)
+{
+	(void)arg;
+	int rc;
+	rc = machine_coroutine_create(server, NULL);
+	test(rc != -1);
+
+	rc = machine_coroutine_create(client, NULL);
+	test(rc != -1);
+}
+
+void machinarium_test_tls_ticket_keys(void)
+{
+	machinarium_init();
+
+	char keys[MACHINE_TLS_TICKET_KEYS_EXPORT_SIZE];
+	test(machine_tls_ticket_keys_export(keys, sizeof(keys)) == 0);
+	test(machine_tls_ticket_keys_import(keys, 8) == -1);
+
+	int rc;
+	rc = machine_tls_ticket_keys_rotate();
+	test(rc == 0);
+
+	session_cache = machine_tls_session_cache_create();
+	test(session_cache != NULL);
+
+	int id;
+	id = machine_create("test", test_cs, NULL);
+	test(id != -1);
+
+	rc = machine_wait(id);
+	test(rc != -1);
+
+	uint64_t hits;
+	uint64_t misses;
+	machine_tls_session_cache_stats(session_cache, &hits, &misses);
+	test(hits == 2);
+	test(misses == 3);
+
+	machine_tls_session_cache_free(session_cache);
+
+	machinarium_free();
+}
@@ -0,0 +1,202 @@
+#include <machinarium/machinarium.h>
+#include <machinarium/zpq_stream.h>
+#include <tests/odyssey_test.h>
+
+#define WIRE_SIZE (1024 * 1024)
+#define RAW_SIZE (3 * 100000)
+
+typedef struct {
+	char data[WIRE_SIZE];
+	size_t size;
+	size_t pos;
+	/* accept no more than this per tx call, 0 means no limit */
+	size_t tx_limit;
+	/* fail every second tx call with EAGAIN */
+	int tx_flaky;
+	int tx_calls;
+} wire_t;
+
+static ssize_t wire_tx(void *arg, void const *data, size_t size)
+{
+	wire_t *wire = arg;
+
+	if (wire->tx_flaky && (wire->tx_calls++ % 2) == 0) {
+		errno = EAGAIN;
+		return -1;
+	}
+
+	if (wire->tx_limit != 0 && size > wire->tx_limit) {
+		size = wire->tx_limit;
+	}
+	test(wire->size + size <= WIRE_SIZE);
+	memcpy(wire->data + wire->size, data, size);
+	wire->size += size;
+	return size;
+}
+
+static ssize_t wire_rx(void *arg, void *data, size_t size)
+{
+	wire_t *wire = arg;
+
+	size_t left = wire->size - wire->pos;
+	if (left == 0) {
+		errno = EAGAIN;
+		return -1;
+	}
+	if (size > left) {
+		size = left;
+	}
+	memcpy(data, wire->data + wire->pos, size);
+	wire->pos += size;
+	return size;
+}
+
+static void fill(char *buf, size_t size, int compressible)
+{
+	if (compressible) {
+		for (size_t i = 0; i < size; ++i) {
+			buf[i] = "odyssey"[i % 7] + (char)(i / 4096);
+		}
+		return;
+	}
+
+	/* xorshift, so compressor output is bigger than the input */
+	uint32_t x = 2463534242u;
+	for (size_t i = 0; i < size; ++i) {
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		buf[i] = (char)x;
+	}
+}
+
+static void test_roundtrip(int impl, int level, size_t buffer_size,
+			   size_t tx_limit, int tx_flaky, int compressible,
+			   size_t size)
+{
+	static wire_t wire;
+	memset(&wire, 0, sizeof(wire));
+	wire.tx_limit = tx_limit;
+	wire.tx_flaky = tx_flaky;
+
+	mm_zpq_stream_t *tx = zpq_create(impl, level, buffer_size, wire_tx,
+					 wire_rx, &wire, NULL, 0);
+	test(tx != NULL);
+
+	static char raw[RAW_SIZE];
+	test(size >= 15 && size <= RAW_SIZE);
+	fill(raw, size, compressible);
+
+	/* few segments of different sizes, including empty one */
+	struct iovec iov[4];
+	iov[0].iov_base = raw;
+	iov[0].iov_len = 5;
+	iov[1].iov_base = raw + 5;
+	iov[1].iov_len = 0;
+	iov[2].iov_base = raw + 5;
+	iov[2].iov_len = size / 3 - 5;
+	iov[3].iov_base = raw + size / 3;
+	iov[3].iov_len = size - size / 3;
+
+	/* write the same way od_io_writev does */
+	struct iovec *pos = iov;
+	int n = 4;
+	size_t total = 0;
+	while (n > 0 || mm_zpq_buffered_tx(tx) > 0) {
+		size_t processed = 0;
+		ssize_t rc = mm_zpq_writev(tx, pos, n, &processed);
+		if (rc < 0) {
+			test(errno == EAGAIN);
+			rc = processed;
+		}
+		total += rc;
+		while (n > 0 && (size_t)rc >= pos->iov_len) {
+			rc -= pos->iov_len;
+			++pos;
+			--n;
+		}
+		if (n > 0) {
+			pos->iov_base = (char *)pos->iov_base + rc;
+			pos->iov_len -= rc;
+		}
+	}
+	test(total == size);
+	if (compressible) {
+		test(wire.size < size);
+	}
+
+	mm_zpq_stats_t stats;
+	mm_zpq_stats(tx, &stats);
+	test(stats.tx_raw == size);
+	test(stats.tx_compressed == wire.size);
+	test(stats.rx_raw == 0 && stats.rx_compressed == 0);
+
+	/* start of the stream is already read by the caller */
+	wire.pos = 77;
+	mm_zpq_stream_t *rx = zpq_create(impl, level, buffer_size, wire_tx,
+					 wire_rx, &wire, wire.data, wire.pos);
+	test(rx != NULL);
+
+	static char out[RAW_SIZE];
+	size_t got = 0;
+	while (got < size) {
+		ssize_t rc = mm_zpq_read(rx, out + got, size - got);
+		test(rc > 0);
+		got += rc;
+	}
+	test(memcmp(raw, out, size) == 0);
+
+	mm_zpq_stats(rx, &stats);
+	test(stats.rx_raw == size);
+	test(stats.rx_compressed == wire.size);
+	test(stats.tx_raw == 0 && stats.tx_compressed == 0);
+
+	mm_zpq_free(tx);
+	mm_zpq_free(rx);
+}
+
+static void test_algorithms(void)
+{
+	char algorithms[MM_ZPQ_MAX_ALGORITHMS];
+	mm_zpq_get_supported_algorithms(algorithms);
+
+	for (char *alg = algorithms; *alg != '\0'; ++alg) {
+		int impl = mm_zpq_get_algorithm_impl(*alg);
+		test(impl >= 0);
+
+		test_roundtrip(impl, 0, 0, 0, 0, 1, RAW_SIZE);
+		test_roundtrip(impl, 6, 1024, 0, 0, 1, RAW_SIZE);
+		test_roundtrip(impl, 100, 65536, 0, 0, 1, RAW_SIZE);
+		test_roundtrip(impl, 1, 4096, 100, 0, 1, RAW_SIZE);
+		test_roundtrip(impl, 1, 4096, 0, 1, 1, RAW_SIZE);
+
+		test_roundtrip(impl, 1, 4096, 0, 0, 0, RAW_SIZE);
+		test_roundtrip(impl, 1, 4096, 100, 0, 0, RAW_SIZE);
+		test_roundtrip(impl, 1, 4096, 0, 1, 0, RAW_SIZE);
+
+		/*
+		 * incompressible block is stored as is, so one of the tx
+		 * buffer sizes around the block size is filled exactly by
+		 * the last compress call, which leaves the tail of the
+		 * input inside the compressor
+		 */
+		for (size_t size = 128 * 1024; size < 128 * 1024 + 64;
+		     ++size) {
+			test_roundtrip(impl, 1, size, 0, 0, 0,
+				       128 * 1024 + 100);
+		}
+	}
+
+#ifndef MM_BUILD_COMPRESSION
+	test(algorithms[0] == '\0');
+#endif
+}
+
+void machinarium_test_zpq_stream(void)
+{
+	machinarium_init();
+
+	test_algorithms();
+
+	machinarium_free();
+}
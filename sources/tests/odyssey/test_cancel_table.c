@@ -0,0 +1,223 @@
+#include <machinarium/machinarium.h>
+
+#include <odyssey.h>
+#include <cancel_table.h>
+#include <server.h>
+#include <storage.h>
+#include <multi_pool.h>
+#include <tests/odyssey_test.h>
+
+typedef struct {
+	od_rule_storage_t *storage;
+	od_storage_endpoint_t endpoint;
+	od_multi_pool_element_t element;
+	od_server_t **servers;
+	int count;
+} cancel_table_fixture_t;
+
+static void fixture_init(cancel_table_fixture_t *f, int count)
+{
+	memset(f, 0, sizeof(cancel_table_fixture_t));
+
+	f->storage = od_rules_storage_allocate();
+	test(f->storage != NULL);
+	f->endpoint.storage = f->storage;
+
+	f->count = count;
+	f->servers = od_malloc(sizeof(od_server_t *) * count);
+	test(f->servers != NULL);
+
+	for (int i = 0; i < count; ++i) {
+		od_server_t *server = od_server_allocate(0);
+		test(server != NULL);
+		server->endpoint = &f->endpoint;
+		server->pool_element = &f->element;
+		server->key.key = i;
+		server->key.key_pid = i;
+		server->key_client.key = (uint32_t)i * 2654435761u + 1;
+		server->key_client.key_pid = i + 1;
+		f->servers[i] = server;
+	}
+}
+
+static void fixture_free(cancel_table_fixture_t *f)
+{
+	for (int i = 0; i < f->count; ++i) {
+		/* endpoint is not owned by the server */
+		f->servers[i]->endpoint = NULL;
+		od_server_free(f->servers[i]);
+	}
+	od_free(f->servers);
+	od_rules_storage_free(f->storage);
+}
+
+static void test_cancel_table_lookup(void *arg)
+{
+	(void)arg;
+
+	cancel_table_fixture_t f;
+	fixture_init(&f, 10000);
+
+	od_cancel_table_t table;
+	od_cancel_table_init(&table);
+
+	for (int i = 0; i < f.count; ++i) {
+		od_cancel_table_add(&table, f.servers[i]);
+	}
+
+	for (int i = 0; i < f.count; ++i) {
+		od_server_t *server = f.servers[i];
+		od_router_cancel_t cancel;
+		od_router_cancel_init(&cancel);
+
+		test(od_cancel_table_begin(&table, &server->key_client,
+					   &cancel) == OK_RESPONSE);
+		test(cancel.server == server);
+		test(kiwi_key_cmp(&cancel.key, &server->key));
+		test(cancel.storage == f.storage);
+
+		od_server_cancel_end(server);
+		od_router_cancel_free(&cancel);
+	}
+
+	/* detached servers can't be canceled */
+	for (int i = 0; i < f.count; i += 2) {
+		od_cancel_table_remove(&table, f.servers[i]);
+	}
+	for (int i = 0; i < f.count; ++i) {
+		od_router_cancel_t cancel;
+		od_router_cancel_init(&cancel);
+		int rc = od_cancel_table_begin(
+			&table, &f.servers[i]->key_client, &cancel);
+		test((rc == OK_RESPONSE) == (i % 2 == 1));
+		if (rc == OK_RESPONSE) {
+			od_server_cancel_end(f.servers[i]);
+			od_router_cancel_free(&cancel);
+		}
+	}
+
+	/* unknown key and servers without cancel key */
+	kiwi_key_t key;
+	kiwi_key_init(&key);
+	od_router_cancel_t cancel;
+	od_router_cancel_init(&cancel);
+	test(od_cancel_table_begin(&table, &key, &cancel) == NOT_OK_RESPONSE);
+
+	kiwi_key_init(&f.servers[0]->key_client);
+	od_cancel_table_add(&table, f.servers[0]);
+	test(od_list_empty(&f.servers[0]->cancel_link));
+
+	for (int i = 1; i < f.count; i += 2) {
+		od_cancel_table_remove(&table, f.servers[i]);
+	}
+	for (int i = 0; i < OD_CANCEL_TABLE_STRIPES; ++i) {
+		test(table.stripes[i].count == 0);
+	}
+
+	od_cancel_table_free(&table);
+	fixture_free(&f);
+}
+
+void odyssey_test_cancel_table(void)
+{
+	machinarium_init();
+
+	int64_t rc;
+	rc = machine_create("test_cancel_table_lookup",
+			    test_cancel_table_lookup, NULL);
+	test(rc > 0);
+
+	test(machine_wait(rc) == 0);
+
+	machinarium_free();
+}
+
+#define BENCHMARK_CANCELS 100000
+
+static void benchmark_cancel_table_servers(int count)
+{
+	cancel_table_fixture_t f;
+	fixture_init(&f, count);
+
+	od_cancel_table_t table;
+	od_cancel_table_init(&table);
+
+	/* previous implementation: scan every attached server */
+	od_list_t servers;
+	od_list_init(&servers);
+
+	for (int i = 0; i < f.count; ++i) {
+		od_cancel_table_add(&table, f.servers[i]);
+		od_list_append(&servers, &f.servers[i]->link);
+	}
+
+	benchmark_timer_t timer;
+
+	timer_start(&timer);
+	for (int i = 0; i < BENCHMARK_CANCELS; ++i) {
+		od_server_t *server = f.servers[rand() % f.count];
+		od_router_cancel_t cancel;
+		od_router_cancel_init(&cancel);
+		if (od_cancel_table_begin(&table, &server->key_client,
+					  &cancel) != OK_RESPONSE) {
+			abort();
+		}
+		od_server_cancel_end(server);
+		od_router_cancel_free(&cancel);
+	}
+	double table_time = timer_end(&timer);
+
+	int scans = BENCHMARK_CANCELS / 100;
+	timer_start(&timer);
+	for (int i = 0; i < scans; ++i) {
+		od_server_t *target = f.servers[rand() % f.count];
+		od_list_t *j;
+		od_list_foreach (&servers, j) {
+			od_server_t *server;
+			server = od_container_of(j, od_server_t, link);
+			if (kiwi_key_cmp(&server->key_client,
+					 &target->key_client)) {
+				break;
+			}
+		}
+	}
+	double scan_time = timer_end(&timer);
+
+	printf("servers %7d: table %8.1f ns/cancel, scan %10.1f ns/cancel\n",
+	       count, table_time * 1e9 / BENCHMARK_CANCELS,
+	       scan_time * 1e9 / scans);
+
+	od_list_t *j, *n;
+	od_list_foreach_safe (&servers, j, n) {
+		od_list_unlink(j);
+	}
+	for (int i = 0; i < f.count; ++i) {
+		od_cancel_table_remove(&table, f.servers[i]);
+	}
+	od_cancel_table_free(&table);
+	fixture_free(&f);
+}
+
+static void benchmark_cancel_table(void *arg)
+{
+	(void)arg;
+
+	printf("\n");
+	for (int count = 100; count <= 100000; count *= 10) {
+		benchmark_cancel_table_servers(count);
+	}
+}
+
+void odyssey_cancel_table_benchmark(void)
+{
+	machinarium_init();
+
+	int64_t rc;
+	rc = machine_create("benchmark_cancel_table", benchmark_cancel_table,
+			    NULL);
+	test(rc > 0);
+
+	test(machine_wait(rc) == 0);
+
+	machinarium_free();
+}
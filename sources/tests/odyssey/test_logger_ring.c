@@ -0,0 +1,507 @@
+#include <machinarium/machinarium.h>
+#include <machinarium/ds/queue.h>
+#include <machinarium/spinlock.h>
+
+#include <odyssey.h>
+#include <logger.h>
+#include <logger_ring.h>
+#include <list.h>
+#include <pid.h>
+#include <util.h>
+#include <od_memory.h>
+#include <tests/odyssey_test.h>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+
+#define TEST_LINES 200000
+#define TEST_LOGGER_MACHINES 4
+#define TEST_LOGGER_LINES 1000
+
+#define BENCHMARK_LINES 200000
+#define BENCHMARK_QUEUE_DEPTH 30000
+
+static void test_ring_wrap(void)
+{
+	od_logger_ring_t ring;
+	test(od_logger_ring_init(&ring, 0) == OK_RESPONSE);
+	test(ring.size == OD_LOGGER_RING_MIN_SIZE);
+
+	char line[OD_LOGLINE_MAXLEN];
+	struct iovec iovecs[8];
+	int levels[8];
+	size_t pending;
+	size_t bytes;
+
+	/* lines of every length, wrapping the buffer many times */
+	int written = 0;
+	int read = 0;
+	for (int round = 0; round < 2000; round++) {
+		for (int i = 0; i < 3; i++, written++) {
+			size_t len = (written * 37) % sizeof(line);
+			memset(line, 'a' + written % 26, len);
+			test(od_logger_ring_push(&ring, written % 4, line, len,
+						 &pending) == 0);
+		}
+
+		size_t n;
+		n = od_logger_ring_peek(&ring, iovecs, levels, 8, &bytes);
+		test(n == 3);
+		for (size_t i = 0; i < n; i++, read++) {
+			size_t len = (read * 37) % sizeof(line);
+			test(iovecs[i].iov_len == len);
+			test(levels[i] == read % 4);
+			char *text = iovecs[i].iov_base;
+			for (size_t j = 0; j < len; j++) {
+				test(text[j] == 'a' + read % 26);
+			}
+		}
+		od_logger_ring_advance(&ring, bytes);
+		test(od_logger_ring_pending(&ring) == 0);
+	}
+
+	/* full ring drops lines until it is read */
+	memset(line, 'x', sizeof(line));
+	int pushed = 0;
+	while (od_logger_ring_push(&ring, 0, line, 100, &pending) == 0) {
+		pushed++;
+	}
+	test(pushed > 0);
+	test(pending > ring.size - 200);
+
+	size_t n = od_logger_ring_peek(&ring, iovecs, levels, 8, &bytes);
+	test(n == 8);
+	od_logger_ring_advance(&ring, bytes);
+	test(od_logger_ring_push(&ring, 0, line, 100, &pending) == 0);
+
+	/* line must not take most of the ring */
+	test(od_logger_ring_push(&ring, 0, line, ring.size, &pending) == -1);
+
+	od_logger_ring_free(&ring);
+}
+
+static void ring_producer(void *arg)
+{
+	od_logger_ring_t *ring = arg;
+
+	char line[64];
+	for (int i = 0; i < TEST_LINES; i++) {
+		int len = od_snprintf(line, sizeof(line), "line %d", i);
+		size_t pending;
+		while (od_logger_ring_push(ring, i % 4, line, len, &pending) ==
+		       -1) {
+			sched_yield();
+		}
+	}
+}
+
+static void ring_consumer(void *arg)
+{
+	od_logger_ring_t *ring = arg;
+
+	struct iovec iovecs[64];
+	int levels[64];
+	char expected[64];
+
+	int i = 0;
+	while (i < TEST_LINES) {
+		size_t bytes;
+		size_t n;
+		n = od_logger_ring_peek(ring, iovecs, levels, 64, &bytes);
+		if (n == 0) {
+			sched_yield();
+		}
+		for (size_t j = 0; j < n; j++, i++) {
+			int len = od_snprintf(expected, sizeof(expected),
+					      "line %d", i);
+			test(iovecs[j].iov_len == (size_t)len);
+			test(memcmp(iovecs[j].iov_base, expected, len) == 0);
+			test(levels[j] == i % 4);
+		}
+		od_logger_ring_advance(ring, bytes);
+	}
+}
+
+static void test_ring_threads(void)
+{
+	od_logger_ring_t ring;
+	test(od_logger_ring_init(&ring, 0) == OK_RESPONSE);
+
+	int64_t producer = machine_create("ring_producer", ring_producer,
+					  &ring);
+	test(producer != -1);
+	int64_t consumer = machine_create("ring_consumer", ring_consumer,
+					  &ring);
+	test(consumer != -1);
+
+	test(machine_wait(producer) == 0);
+	test(machine_wait(consumer) == 0);
+	test(od_logger_ring_pending(&ring) == 0);
+
+	od_logger_ring_free(&ring);
+}
+
+static void logger_writer(void *arg)
+{
+	od_logger_t *logger = arg;
+	for (int i = 0; i < TEST_LOGGER_LINES; i++) {
+		od_log(logger, "test", NULL, NULL, "line %d", i);
+	}
+}
+
+/* lines of all threads get to the file through own rings */
+static void test_logger_async(void)
+{
+	od_pid_t pid;
+	od_pid_init(&pid);
+
+	od_logger_t logger;
+	test(od_logger_init(&logger, &pid) == OK_RESPONSE);
+	od_logger_set_stdout(&logger, 0);
+	od_logger_set_async(&logger, 1);
+	od_logger_set_queue_depth(&logger, 100000);
+	od_logger_set_format(&logger, "%m\n");
+
+	char path[] = "/tmp/odyssey_test_logger_XXXXXX";
+	int fd = mkstemp(path);
+	test(fd != -1);
+	close(fd);
+	test(od_logger_open(&logger, path) == 0);
+
+	test(od_logger_load(&logger) == OK_RESPONSE);
+	while (atomic_load(&logger.state) != OD_LOGGER_ONLINE) {
+		sched_yield();
+	}
+
+	int64_t ids[TEST_LOGGER_MACHINES];
+	for (int i = 0; i < TEST_LOGGER_MACHINES; i++) {
+		ids[i] = machine_create("logger_writer", logger_writer,
+					&logger);
+		test(ids[i] != -1);
+	}
+	for (int i = 0; i < TEST_LOGGER_MACHINES; i++) {
+		test(machine_wait(ids[i]) == 0);
+	}
+
+	od_logger_shutdown(&logger);
+	od_logger_wait_finish(&logger);
+	od_logger_close(&logger);
+	test(atomic_load(&logger.dropped_lines) == 0);
+
+	FILE *file = fopen(path, "r");
+	test(file != NULL);
+	int lines[TEST_LOGGER_LINES] = { 0 };
+	char line[64];
+	while (fgets(line, sizeof(line), file) != NULL) {
+		int i;
+		test(sscanf(line, "line %d", &i) == 1);
+		test(i >= 0 && i < TEST_LOGGER_LINES);
+		lines[i]++;
+	}
+	fclose(file);
+	unlink(path);
+
+	for (int i = 0; i < TEST_LOGGER_LINES; i++) {
+		test(lines[i] == TEST_LOGGER_MACHINES);
+	}
+}
+
+/* the ring cached by the thread is not used by the next logger */
+static void test_logger_reload(void)
+{
+	od_pid_t pid;
+	od_pid_init(&pid);
+
+	char path[] = "/tmp/odyssey_test_logger_XXXXXX";
+	int fd = mkstemp(path);
+	test(fd != -1);
+	close(fd);
+
+	od_logger_t logger;
+	for (int round = 0; round < 2; round++) {
+		test(od_logger_init(&logger, &pid) == OK_RESPONSE);
+		od_logger_set_stdout(&logger, 0);
+		od_logger_set_async(&logger, 1);
+		od_logger_set_format(&logger, "%m\n");
+		test(od_logger_open(&logger, path) == 0);
+
+		test(od_logger_load(&logger) == OK_RESPONSE);
+		while (atomic_load(&logger.state) != OD_LOGGER_ONLINE) {
+			sched_yield();
+		}
+
+		od_log(&logger, "test", NULL, NULL, "round %d", round);
+		od_logger_flush(&logger);
+
+		od_logger_shutdown(&logger);
+		od_logger_wait_finish(&logger);
+		od_logger_close(&logger);
+		test(atomic_load(&logger.dropped_lines) == 0);
+	}
+
+	FILE *file = fopen(path, "r");
+	test(file != NULL);
+	char line[64];
+	int rounds = 0;
+	while (fgets(line, sizeof(line), file) != NULL) {
+		int round;
+		test(sscanf(line, "round %d", &round) == 1);
+		test(round == rounds);
+		rounds++;
+	}
+	fclose(file);
+	unlink(path);
+
+	test(rounds == 2);
+}
+
+void odyssey_test_logger_ring(void)
+{
+	machinarium_init();
+
+	test_ring_wrap();
+	test_ring_threads();
+	test_logger_async();
+	test_logger_reload();
+
+	machinarium_free();
+}
+
+/*
+ * previous implementation: slots with the fixed size text are taken
+ * from the spinlocked free list and passed through the spinlocked queue
+ */
+typedef struct {
+	od_logger_level_t level;
+	od_list_t link;
+	size_t len;
+	char text[OD_LOGLINE_MAXLEN];
+} benchmark_slot_t;
+
+typedef struct {
+	int use_rings;
+
+	/* previous implementation */
+	benchmark_slot_t *slots;
+	mm_queue_t tasks;
+	od_list_t free_slots;
+	size_t free_slots_count;
+	mm_spinlock_t free_slots_lock;
+
+	/* per producer rings */
+	od_logger_ring_t *rings;
+
+	atomic_int producers;
+	atomic_uint_fast64_t dropped;
+	int fd;
+} benchmark_log_t;
+
+typedef struct {
+	benchmark_log_t *log;
+	int id;
+} benchmark_producer_t;
+
+static void benchmark_format(char *line, size_t size, int *len, int id,
+			     int i)
+{
+	*len = od_snprintf(line, size,
+			   "1234 2025-01-01 00:00:00.000 info [c%08x s%08x] "
+			   "(query) client %d: SELECT id, name, email FROM "
+			   "users WHERE id = %d\n",
+			   i, id, id, i);
+}
+
+static void benchmark_producer(void *arg)
+{
+	benchmark_producer_t *producer = arg;
+	benchmark_log_t *log = producer->log;
+
+	for (int i = 0; i < BENCHMARK_LINES; i++) {
+		int len;
+		if (log->use_rings) {
+			char line[OD_LOGLINE_MAXLEN];
+			benchmark_format(line, sizeof(line), &len,
+					 producer->id, i);
+			size_t pending;
+			if (od_logger_ring_push(&log->rings[producer->id],
+						OD_LOG, line, len,
+						&pending) == -1) {
+				atomic_fetch_add(&log->dropped, 1);
+			}
+			continue;
+		}
+
+		benchmark_slot_t *slot = NULL;
+		mm_spinlock_lock(&log->free_slots_lock);
+		if (log->free_slots_count > 0) {
+			od_list_t *j = od_list_pop(&log->free_slots);
+			slot = od_container_of(j, benchmark_slot_t, link);
+			log->free_slots_count--;
+		}
+		mm_spinlock_unlock(&log->free_slots_lock);
+		if (slot == NULL) {
+			atomic_fetch_add(&log->dropped, 1);
+			continue;
+		}
+		benchmark_format(slot->text, sizeof(slot->text), &len,
+				 producer->id, i);
+		slot->len = len;
+		slot->level = OD_LOG;
+		mm_queue_push_extended(&log->tasks, &slot);
+	}
+
+	atomic_fetch_sub(&log->producers, 1);
+}
+
+static size_t benchmark_drain(benchmark_log_t *log, int count)
+{
+	static struct iovec iovecs[IOV_MAX];
+	static int levels[IOV_MAX];
+	static benchmark_slot_t *slot_buf[IOV_MAX];
+
+	if (log->use_rings) {
+		size_t total = 0;
+		for (int i = 0; i < count; i++) {
+			size_t bytes;
+			size_t n = od_logger_ring_peek(&log->rings[i], iovecs,
+						       levels, IOV_MAX, &bytes);
+			if (n > 0) {
+				test(writev(log->fd, iovecs, n) > 0);
+			}
+			od_logger_ring_advance(&log->rings[i], bytes);
+			total += n;
+		}
+		return total;
+	}
+
+	size_t n = mm_queue_pop_batch(&log->tasks, slot_buf, IOV_MAX);
+	if (n == 0) {
+		return 0;
+	}
+	for (size_t i = 0; i < n; i++) {
+		iovecs[i].iov_base = slot_buf[i]->text;
+		iovecs[i].iov_len = slot_buf[i]->len;
+	}
+	test(writev(log->fd, iovecs, n) > 0);
+
+	mm_spinlock_lock(&log->free_slots_lock);
+	for (size_t i = 0; i < n; i++) {
+		od_list_append(&log->free_slots, &slot_buf[i]->link);
+	}
+	log->free_slots_count += n;
+	mm_spinlock_unlock(&log->free_slots_lock);
+	return n;
+}
+
+static void benchmark_log_init(benchmark_log_t *log, int use_rings,
+			       int count)
+{
+	memset(log, 0, sizeof(benchmark_log_t));
+	log->use_rings = use_rings;
+	atomic_init(&log->producers, count);
+	atomic_init(&log->dropped, 0);
+	log->fd = open("/dev/null", O_WRONLY);
+	test(log->fd != -1);
+
+	if (use_rings) {
+		size_t size = BENCHMARK_QUEUE_DEPTH * OD_LOGGER_RING_LINE_SIZE;
+		log->rings = od_malloc(count * sizeof(od_logger_ring_t));
+		test(log->rings != NULL);
+		for (int i = 0; i < count; i++) {
+			test(od_logger_ring_init(&log->rings[i], size) ==
+			     OK_RESPONSE);
+		}
+		return;
+	}
+
+	test(mm_queue_init(&log->tasks, BENCHMARK_QUEUE_DEPTH,
+			   sizeof(benchmark_slot_t *), NULL) == 0);
+	log->slots =
+		od_malloc(BENCHMARK_QUEUE_DEPTH * sizeof(benchmark_slot_t));
+	test(log->slots != NULL);
+	od_list_init(&log->free_slots);
+	mm_spinlock_init(&log->free_slots_lock);
+	for (int i = 0; i < BENCHMARK_QUEUE_DEPTH; i++) {
+		od_list_init(&log->slots[i].link);
+		od_list_append(&log->free_slots, &log->slots[i].link);
+	}
+	log->free_slots_count = BENCHMARK_QUEUE_DEPTH;
+}
+
+static void benchmark_log_free(benchmark_log_t *log, int count)
+{
+	close(log->fd);
+	if (log->use_rings) {
+		for (int i = 0; i < count; i++) {
+			od_logger_ring_free(&log->rings[i]);
+		}
+		od_free(log->rings);
+		return;
+	}
+	mm_queue_destroy(&log->tasks);
+	mm_spinlock_destroy(&log->free_slots_lock);
+	od_free(log->slots);
+}
+
+static void benchmark_log_run(int use_rings, int count)
+{
+	benchmark_log_t log;
+	benchmark_log_init(&log, use_rings, count);
+
+	benchmark_producer_t producers[count];
+	int64_t ids[count];
+
+	benchmark_timer_t timer;
+	timer_start(&timer);
+
+	for (int i = 0; i < count; i++) {
+		producers[i].log = &log;
+		producers[i].id = i;
+		ids[i] = machine_create("log_producer", benchmark_producer,
+					&producers[i]);
+		test(ids[i] != -1);
+	}
+
+	/* the logger machine */
+	size_t written = 0;
+	for (;;) {
+		int done = atomic_load(&log.producers) == 0;
+		size_t n = benchmark_drain(&log, count);
+		written += n;
+		if (n == 0) {
+			if (done) {
+				break;
+			}
+			sched_yield();
+		}
+	}
+	double time = timer_end(&timer);
+
+	for (int i = 0; i < count; i++) {
+		test(machine_wait(ids[i]) == 0);
+	}
+
+	uint64_t dropped = atomic_load(&log.dropped);
+	test(written + dropped == (size_t)count * BENCHMARK_LINES);
+
+	printf("%s producers %2d: %10.0f lines/sec, %9.0f written/sec, "
+	       "dropped %" PRIu64 "\n",
+	       use_rings ? "rings" : "queue", count,
+	       count * BENCHMARK_LINES / time, written / time, dropped);
+
+	benchmark_log_free(&log, count);
+}
+
+void odyssey_logger_ring_benchmark(void)
+{
+	machinarium_init();
+
+	printf("\n");
+	for (int count = 1; count <= 16; count *= 2) {
+		benchmark_log_run(0, count);
+		benchmark_log_run(1, count);
+	}
+
+	machinarium_free();
+}
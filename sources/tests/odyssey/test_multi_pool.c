@@ -0,0 +1,128 @@
+#include <machinarium/machinarium.h>
+
+#include <odyssey.h>
+#include <multi_pool.h>
+#include <server.h>
+#include <util.h>
+#include <tests/odyssey_test.h>
+
+#define TEST_USERS 50
+#define TEST_HOSTS 4
+
+static void make_key(od_multi_pool_key_t *key, char *db, char *user,
+		     char *host, int u, int h)
+{
+	od_snprintf(db, 32, "db%d", u % 3);
+	od_snprintf(user, 32, "user%d", u);
+	od_snprintf(host, 32, "host%d", h);
+
+	memset(key, 0, sizeof(od_multi_pool_key_t));
+	key->dbname = db;
+	key->username = user;
+	key->address.type = OD_ADDRESS_TYPE_TCP;
+	key->address.host = host;
+	key->address.port = 5432;
+}
+
+static int filter_by_host(void *arg, const od_multi_pool_key_t *key)
+{
+	return strcmp(key->address.host, arg) == 0;
+}
+
+static void test_multi_pool_index(void *arg)
+{
+	(void)arg;
+
+	od_multi_pool_t *mpool = od_multi_pool_create(od_pg_server_pool_free);
+	test(mpool != NULL);
+
+	char db[32], user[32], host[32];
+	od_multi_pool_key_t key;
+	od_multi_pool_element_t *elements[TEST_USERS][TEST_HOSTS];
+
+	for (int u = 0; u < TEST_USERS; ++u) {
+		for (int h = 0; h < TEST_HOSTS; ++h) {
+			make_key(&key, db, user, host, u, h);
+			elements[u][h] =
+				od_multi_pool_get_or_create_locked(mpool, &key);
+			test(elements[u][h] != NULL);
+		}
+	}
+	test(mpool->index.count == TEST_USERS * TEST_HOSTS);
+	test(mpool->address_index.count == TEST_HOSTS);
+
+	for (int u = 0; u < TEST_USERS; ++u) {
+		for (int h = 0; h < TEST_HOSTS; ++h) {
+			make_key(&key, db, user, host, u, h);
+			test(od_multi_pool_get_or_create_locked(mpool, &key) ==
+			     elements[u][h]);
+		}
+	}
+
+	/* servers: idle on every element, active on every second */
+	for (int u = 0; u < TEST_USERS; ++u) {
+		for (int h = 0; h < TEST_HOSTS; ++h) {
+			od_server_t *server = od_server_allocate(0);
+			test(server != NULL);
+			server->pool_element = elements[u][h];
+			od_server_set_pool_state(server, OD_SERVER_IDLE);
+
+			if ((u + h) % 2 == 0) {
+				server = od_server_allocate(0);
+				test(server != NULL);
+				server->pool_element = elements[u][h];
+				od_server_set_pool_state(server,
+							 OD_SERVER_ACTIVE);
+			}
+		}
+	}
+
+	int idle = TEST_USERS * TEST_HOSTS;
+	int active = TEST_USERS * TEST_HOSTS / 2;
+	test(od_multi_pool_count_idle_locked(mpool, NULL, NULL) == idle);
+	test(od_multi_pool_count_active_locked(mpool, NULL, NULL) == active);
+	test(od_multi_pool_total_locked(mpool, NULL, NULL) == idle + active);
+
+	for (int h = 0; h < TEST_HOSTS; ++h) {
+		make_key(&key, db, user, host, 0, h);
+		test(od_multi_pool_total_by_address_locked(mpool,
+							   &key.address) ==
+		     od_multi_pool_total_locked(mpool, filter_by_host, host));
+	}
+
+	/* move some idle servers out of the pool */
+	for (int u = 0; u < TEST_USERS; u += 5) {
+		od_server_t *server;
+		server = od_pg_server_pool_next(&elements[u][0]->pool,
+						OD_SERVER_IDLE);
+		test(server != NULL);
+		od_server_set_pool_state(server, OD_SERVER_UNDEF);
+		od_server_free(server);
+		--idle;
+	}
+	test(od_multi_pool_count_idle_locked(mpool, NULL, NULL) == idle);
+
+	make_key(&key, db, user, host, 0, 0);
+	test(od_multi_pool_total_by_address_locked(mpool, &key.address) ==
+	     od_multi_pool_total_locked(mpool, filter_by_host, host));
+
+	/* unknown address */
+	make_key(&key, db, user, host, 0, TEST_HOSTS);
+	test(od_multi_pool_total_by_address_locked(mpool, &key.address) == 0);
+
+	od_multi_pool_destroy(mpool);
+}
+
+void odyssey_test_multi_pool(void)
+{
+	machinarium_init();
+
+	int64_t rc;
+	rc = machine_create("test_multi_pool_index", test_multi_pool_index,
+			    NULL);
+	test(rc > 0);
+
+	test(machine_wait(rc) == 0);
+
+	machinarium_free();
+}
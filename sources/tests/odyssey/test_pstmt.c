@@ -198,6 +198,12 @@ void test_pstmt_client_hashmap(void)
 	test(od_client_has_pstmt(client, "dangling") == 1);
 	test(od_client_get_pstmt(client, "dangling") == dangling);
 
+	/* long names are not stored inline */
+	const char *long_name = "statement_name_that_is_longer_than_inline_key";
+	test(od_client_add_pstmt(client, long_name, dangling) == 0);
+	test(od_client_get_pstmt(client, long_name) == dangling);
+	test(od_client_has_pstmt(client, "statement_name_that_is") == 0);
+
 	od_pstmt_unref(dangling);
 
 	od_client_free(client);
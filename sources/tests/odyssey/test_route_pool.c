@@ -0,0 +1,100 @@
+#include <machinarium/machinarium.h>
+
+#include <odyssey.h>
+#include <rules.h>
+#include <route_pool.h>
+#include <util.h>
+#include <tests/odyssey_test.h>
+
+#define TEST_ROUTES 1000
+
+static void make_id(od_route_id_t *id, char *db, char *user, int n)
+{
+	od_snprintf(db, 32, "db%d", n % 7);
+	od_snprintf(user, 32, "user%d", n);
+
+	od_route_id_init(id);
+	id->database = db;
+	id->database_len = strlen(db) + 1;
+	id->user = user;
+	id->user_len = strlen(user) + 1;
+}
+
+static void test_route_pool_match(void *arg)
+{
+	(void)arg;
+
+	od_rules_t rules;
+	od_rules_init(&rules);
+
+	od_address_range_t range = od_address_range_create_default();
+	od_rule_t *rule = od_rules_add_new_rule(&rules, "default_db", 1,
+						"default_user", 1, &range,
+						OD_RULE_CONN_TYPE_DEFAULT, 0);
+	test(rule != NULL);
+
+	od_route_pool_t pool;
+	od_route_pool_init(&pool);
+
+	char db[32], user[32];
+	od_route_id_t id;
+
+	for (int n = 0; n < TEST_ROUTES; ++n) {
+		make_id(&id, db, user, n);
+		test(od_route_pool_match(&pool, &id, rule) == NULL);
+		test(od_route_pool_new(&pool, &id, rule) != NULL);
+	}
+	test(pool.count == TEST_ROUTES);
+	test(pool.index_size >= TEST_ROUTES);
+
+	for (int n = 0; n < TEST_ROUTES; ++n) {
+		make_id(&id, db, user, n);
+		od_route_t *route = od_route_pool_match(&pool, &id, rule);
+		test(route != NULL);
+		test(od_route_id_compare(&route->id, &id));
+
+		/* replication flags are part of the key */
+		id.logical_rep = true;
+		test(od_route_pool_match(&pool, &id, rule) == NULL);
+
+		if (n % 2 == 0) {
+			id.logical_rep = false;
+
+			/* pinned route can't be removed */
+			test(od_route_pool_match_pin(&pool, &id, rule) ==
+			     route);
+			test(od_route_pool_remove(&pool, route) ==
+			     NOT_OK_RESPONSE);
+			od_route_pool_unpin(route);
+
+			test(od_route_pool_remove(&pool, route) ==
+			     OK_RESPONSE);
+			od_route_free(route);
+		}
+	}
+	test(pool.count == TEST_ROUTES / 2);
+
+	for (int n = 0; n < TEST_ROUTES; ++n) {
+		make_id(&id, db, user, n);
+		od_route_t *route = od_route_pool_match(&pool, &id, rule);
+		test((route == NULL) == (n % 2 == 0));
+	}
+
+	od_route_pool_free(&pool);
+	od_rules_free(&rules);
+	od_address_range_destroy(&range);
+}
+
+void odyssey_test_route_pool(void)
+{
+	machinarium_init();
+
+	int64_t rc;
+	rc = machine_create("test_route_pool_match", test_route_pool_match,
+			    NULL);
+	test(rc > 0);
+
+	test(machine_wait(rc) == 0);
+
+	machinarium_free();
+}
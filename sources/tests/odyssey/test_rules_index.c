@@ -0,0 +1,193 @@
+#include <machinarium/machinarium.h>
+
+#include <odyssey.h>
+#include <rules.h>
+#include <pool.h>
+#include <util.h>
+#include <tests/odyssey_test.h>
+
+#define TEST_NAMES 5
+
+static void make_name(char *buf, const char *prefix, int n)
+{
+	od_snprintf(buf, 32, "%s%d", prefix, n);
+}
+
+static void add_random_rules(od_rules_t *rules, int count)
+{
+	od_address_range_t range = od_address_range_create_default();
+
+	for (int n = 0; n < count; ++n) {
+		char db[32], user[32];
+		int db_is_default = rand() % 4 == 0;
+		int user_is_default = rand() % 4 == 0;
+
+		if (db_is_default) {
+			strcpy(db, "default_db");
+		} else {
+			make_name(db, "db", rand() % TEST_NAMES);
+		}
+		if (user_is_default) {
+			strcpy(user, "default_user");
+		} else {
+			make_name(user, "user", rand() % TEST_NAMES);
+		}
+
+		int internal = rand() % 8 == 0;
+		od_rule_t *rule = od_rules_add_new_rule(
+			rules, db, db_is_default, user, user_is_default, &range,
+			rand() % (OD_RULE_CONN_TYPE_HOSTNOSSL + 1), internal);
+		if (rule == NULL) {
+			/* already defined */
+			continue;
+		}
+
+		rule->pool->routing = internal ? OD_RULE_POOL_INTERNAL :
+						 OD_RULE_POOL_CLIENT_VISIBLE;
+	}
+
+	od_address_range_destroy(&range);
+}
+
+static void test_same_first_match(od_rules_t *rules)
+{
+	test(od_rules_index_build(rules) == OK_RESPONSE);
+	test(rules->index != NULL);
+	test(rules->index->count == od_list_count(&rules->rules));
+
+	for (int d = 0; d <= TEST_NAMES; ++d) {
+		for (int u = 0; u <= TEST_NAMES; ++u) {
+			for (int v = 0; v < 8; ++v) {
+				kiwi_be_startup_t startup;
+				kiwi_be_startup_init(&startup);
+				startup.is_ssl_request = v & 1;
+
+				char name[32];
+				make_name(name, "db", d);
+				kiwi_var_set(&startup.database, KIWI_VAR_UNDEF,
+					     name, strlen(name) + 1);
+				make_name(name, "user", u);
+				kiwi_var_set(&startup.user, KIWI_VAR_UNDEF,
+					     name, strlen(name) + 1);
+
+				struct sockaddr_storage sa;
+				memset(&sa, 0, sizeof(sa));
+				sa.ss_family = (v & 2) ? AF_UNIX : AF_INET;
+
+				int internal = (v & 4) != 0;
+
+				od_rule_t *indexed = od_rules_forward(
+					rules, &startup, &sa, internal);
+
+				od_rules_index_t *index = rules->index;
+				rules->index = NULL;
+				od_rule_t *linear = od_rules_forward(
+					rules, &startup, &sa, internal);
+				rules->index = index;
+
+				test(indexed == linear);
+			}
+		}
+	}
+}
+
+static void startup_init(kiwi_be_startup_t *startup, const char *db,
+			 const char *user)
+{
+	kiwi_be_startup_init(startup);
+	kiwi_var_set(&startup->database, KIWI_VAR_UNDEF, db, strlen(db) + 1);
+	kiwi_var_set(&startup->user, KIWI_VAR_UNDEF, user, strlen(user) + 1);
+}
+
+/*
+ * reload marks the old rules obsolete before the new snapshot is
+ * published, lockless matching over the old snapshot must not fall
+ * through to the less specific rule
+ */
+static void test_obsolete_before_publish(void)
+{
+	od_rules_t rules;
+	od_rules_init(&rules);
+
+	od_address_range_t range = od_address_range_create_default();
+	od_rule_t *specific = od_rules_add_new_rule(
+		&rules, "db", 0, "user", 0, &range, OD_RULE_CONN_TYPE_DEFAULT,
+		0);
+	od_rule_t *fallback = od_rules_add_new_rule(
+		&rules, "default_db", 1, "default_user", 1, &range,
+		OD_RULE_CONN_TYPE_DEFAULT, 0);
+	test(specific != NULL && fallback != NULL);
+	specific->pool->routing = OD_RULE_POOL_CLIENT_VISIBLE;
+	fallback->pool->routing = OD_RULE_POOL_CLIENT_VISIBLE;
+	od_address_range_destroy(&range);
+
+	test(od_rules_index_build(&rules) == OK_RESPONSE);
+	od_rules_index_t *snapshot = od_rules_index_ref(rules.index);
+
+	kiwi_be_startup_t startup;
+	startup_init(&startup, "db", "user");
+	struct sockaddr_storage sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.ss_family = AF_INET;
+
+	int need_lock;
+	test(od_rules_index_forward(snapshot, &startup, &sa, 0, &need_lock) ==
+	     specific);
+	test(need_lock == 0);
+
+	/* merged, but not published */
+	atomic_store(&specific->obsolete, 1);
+
+	test(od_rules_index_forward(snapshot, &startup, &sa, 0, &need_lock) ==
+	     NULL);
+	test(need_lock == 1);
+
+	/* candidates before the obsolete one are still routed lockless */
+	startup_init(&startup, "other_db", "other_user");
+	test(od_rules_index_forward(snapshot, &startup, &sa, 0, &need_lock) ==
+	     fallback);
+	test(need_lock == 0);
+
+	od_rules_index_unref(snapshot);
+	od_rules_free(&rules);
+}
+
+static void test_rules_index(void *arg)
+{
+	(void)arg;
+
+	srand(1);
+
+	for (int iter = 0; iter < 20; ++iter) {
+		od_rules_t rules;
+		od_rules_init(&rules);
+
+		add_random_rules(&rules, 10 * (iter + 1));
+		test_same_first_match(&rules);
+
+		/* adding a rule drops the index */
+		od_address_range_t range = od_address_range_create_default();
+		test(od_rules_add_new_rule(&rules, "new_db", 0, "new_user", 0,
+					   &range, OD_RULE_CONN_TYPE_DEFAULT,
+					   0) != NULL);
+		test(rules.index == NULL);
+		od_address_range_destroy(&range);
+
+		od_rules_free(&rules);
+	}
+
+	test_obsolete_before_publish();
+}
+
+void odyssey_test_rules_index(void)
+{
+	machinarium_init();
+
+	int64_t rc;
+	rc = machine_create("test_rules_index", test_rules_index, NULL);
+	test(rc > 0);
+
+	test(machine_wait(rc) == 0);
+
+	machinarium_free();
+}
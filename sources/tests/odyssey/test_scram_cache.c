@@ -0,0 +1,190 @@
+#include <machinarium/machinarium.h>
+
+#include <odyssey.h>
+#include <scram.h>
+#include <scram_cache.h>
+#include <util.h>
+#include <tests/odyssey_test.h>
+
+static void make_secret(od_scram_secret_t *secret, int n)
+{
+	memset(secret, 0, sizeof(od_scram_secret_t));
+	secret->iterations = n;
+	od_snprintf(secret->salt, sizeof(secret->salt), "salt%d", n);
+	memset(secret->stored_key, n, sizeof(secret->stored_key));
+	memset(secret->server_key, n + 1, sizeof(secret->server_key));
+}
+
+static void test_scram_cache_lru(void)
+{
+	od_scram_cache_t cache;
+	od_scram_cache_init(&cache);
+	test(od_scram_cache_configure(&cache, 4, 0) == OK_RESPONSE);
+
+	od_scram_secret_t secret, found;
+	char user[32];
+
+	for (int n = 0; n < 4; ++n) {
+		od_snprintf(user, sizeof(user), "user%d", n);
+		make_secret(&secret, n);
+		test(od_scram_cache_lookup(&cache, user, "pwd", &found) == 0);
+		od_scram_cache_store(&cache, user, "pwd", &secret);
+	}
+	test(od_scram_cache_count(&cache) == 4);
+
+	/* another password is another key */
+	test(od_scram_cache_lookup(&cache, "user0", "other", &found) == 0);
+
+	/* touch user0, so user1 is evicted */
+	test(od_scram_cache_lookup(&cache, "user0", "pwd", &found) == 1);
+	test(found.iterations == 0);
+	make_secret(&secret, 4);
+	od_scram_cache_store(&cache, "user4", "pwd", &secret);
+	test(od_scram_cache_count(&cache) == 4);
+	test(od_scram_cache_lookup(&cache, "user1", "pwd", &found) == 0);
+	test(od_scram_cache_lookup(&cache, "user4", "pwd", &found) == 1);
+	test(found.iterations == 4);
+	test(strcmp(found.salt, "salt4") == 0);
+	test(found.stored_key[0] == 4 && found.server_key[0] == 5);
+
+	od_scram_cache_invalidate_user(&cache, "user4");
+	test(od_scram_cache_lookup(&cache, "user4", "pwd", &found) == 0);
+	test(od_scram_cache_count(&cache) == 3);
+
+	/* reload drops everything */
+	test(od_scram_cache_configure(&cache, 4, 0) == OK_RESPONSE);
+	test(od_scram_cache_count(&cache) == 0);
+	test(od_scram_cache_lookup(&cache, "user0", "pwd", &found) == 0);
+
+	/* disabled cache stores nothing */
+	test(od_scram_cache_configure(&cache, 0, 0) == OK_RESPONSE);
+	od_scram_cache_store(&cache, "user0", "pwd", &secret);
+	test(od_scram_cache_count(&cache) == 0);
+
+	od_scram_cache_free(&cache);
+}
+
+static void test_scram_cache_derive(int workers)
+{
+	od_scram_cache_t cache;
+	od_scram_cache_init(&cache);
+	test(od_scram_cache_configure(&cache, 16, 0) == OK_RESPONSE);
+	if (workers > 0) {
+		test(od_scram_cache_start_derive_workers(&cache, workers) ==
+		     OK_RESPONSE);
+	}
+
+	od_scram_state_t first, second, other;
+	od_scram_state_init(&first);
+	od_scram_state_init(&second);
+	od_scram_state_init(&other);
+
+	test(od_scram_init_from_plain_password_cached(&cache, &first, "user",
+						      "password") == 0);
+	test(od_scram_init_from_plain_password_cached(&cache, &second, "user",
+						      "password") == 0);
+	test(od_scram_init_from_plain_password_cached(&cache, &other, "user",
+						      "changed") == 0);
+
+	test(od_atomic_u64_of(&cache.hits) == 1);
+	test(od_atomic_u64_of(&cache.misses) == 2);
+
+	/* cached secret is the same as derived one */
+	test(first.iterations == OD_SCRAM_SHA_256_DEFAULT_ITERATIONS);
+	test(first.iterations == second.iterations);
+	test(strcmp(first.salt, second.salt) == 0);
+	test(memcmp(first.stored_key, second.stored_key,
+		    OD_SCRAM_MAX_KEY_LEN) == 0);
+	test(memcmp(first.server_key, second.server_key,
+		    OD_SCRAM_MAX_KEY_LEN) == 0);
+
+	test(memcmp(first.stored_key, other.stored_key,
+		    OD_SCRAM_MAX_KEY_LEN) != 0);
+
+	od_scram_state_free(&first);
+	od_scram_state_free(&second);
+	od_scram_state_free(&other);
+
+	od_scram_cache_free(&cache);
+}
+
+static void client_final(od_scram_cache_t *cache, const char *salt,
+			 char *result, size_t size)
+{
+	od_scram_state_t state;
+	od_scram_state_init(&state);
+	state.client_nonce = od_strdup("nonce");
+	state.client_first_message = od_strdup("n=,r=nonce");
+
+	char server_first[128];
+	int len = od_snprintf(server_first, sizeof(server_first),
+			      "r=nonceserver,s=%s,i=4096", salt);
+
+	machine_msg_t *msg = od_scram_create_client_final_message(
+		&state, "password", server_first, len, cache, "user");
+	test(msg != NULL);
+	test((size_t)machine_msg_size(msg) < size);
+	memset(result, 0, size);
+	memcpy(result, machine_msg_data(msg), machine_msg_size(msg));
+	machine_msg_free(msg);
+
+	/* server signature is checked with cached server key */
+	test(state.use_passthrough_keys ||
+	     state.salted_password != NULL);
+
+	od_scram_state_free(&state);
+}
+
+static void test_scram_cache_server(void)
+{
+	od_scram_cache_t cache;
+	od_scram_cache_init(&cache);
+	test(od_scram_cache_configure(&cache, 16, 0) == OK_RESPONSE);
+
+	char derived[256], cached[256], uncached[256];
+	client_final(&cache, "MDEyMzQ1Njc4OWFiY2RlZg==", derived,
+		     sizeof(derived));
+	client_final(&cache, "MDEyMzQ1Njc4OWFiY2RlZg==", cached,
+		     sizeof(cached));
+	client_final(NULL, "MDEyMzQ1Njc4OWFiY2RlZg==", uncached,
+		     sizeof(uncached));
+	test(od_atomic_u64_of(&cache.hits) == 1);
+	test(od_atomic_u64_of(&cache.misses) == 1);
+
+	/* proof made from cached keys is the same */
+	test(memcmp(derived, cached, sizeof(derived)) == 0);
+	test(memcmp(derived, uncached, sizeof(derived)) == 0);
+
+	/* new salt, keys must be derived again */
+	client_final(&cache, "ZmVkY2JhOTg3NjU0MzIxMA==", cached,
+		     sizeof(cached));
+	test(od_atomic_u64_of(&cache.hits) == 1);
+	test(od_atomic_u64_of(&cache.misses) == 2);
+	test(memcmp(derived, cached, sizeof(derived)) != 0);
+	test(od_scram_cache_count(&cache) == 1);
+
+	od_scram_cache_free(&cache);
+}
+
+static void test_scram_cache(void *arg)
+{
+	(void)arg;
+
+	test_scram_cache_lru();
+	test_scram_cache_derive(0);
+	test_scram_cache_derive(2);
+	test_scram_cache_server();
+}
+
+void odyssey_test_scram_cache(void)
+{
+	machinarium_init();
+
+	int64_t rc;
+	rc = machine_create("test_scram_cache", test_scram_cache, NULL);
+	test(rc > 0);
+
+	test(machine_wait(rc) == 0);
+
+	machinarium_free();
+}
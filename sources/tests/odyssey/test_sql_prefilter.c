@@ -0,0 +1,211 @@
+#include <odyssey.h>
+#include <tests/odyssey_test.h>
+
+#include <sql/minimal/ast.h>
+#include <sql/minimal/parser.h>
+#include <sql/minimal/prefilter.h>
+#include <alloc/linear.h>
+
+#define ARENA_SIZE 8192
+#define BENCHMARK_ROUNDS 20000
+
+static uint8_t s_arena_buf[ARENA_SIZE];
+static od_linear_alloc_t s_arena;
+
+typedef struct {
+	const char *query;
+	od_sql_minimal_stmt_kind_t kind;
+} classify_case_t;
+
+static const classify_case_t cases[] = {
+	{ "SET search_path TO public", OD_SQL_MINIMAL_STMT_SET },
+	{ "set application_name = 'app'", OD_SQL_MINIMAL_STMT_SET },
+	{ "SeT LOCAL x TO 1", OD_SQL_MINIMAL_STMT_SET },
+	{ "SHOW server_version", OD_SQL_MINIMAL_STMT_SHOW },
+	{ "BEGIN", OD_SQL_MINIMAL_STMT_BEGIN },
+	{ "begin;", OD_SQL_MINIMAL_STMT_BEGIN },
+	{ "DEALLOCATE ALL", OD_SQL_MINIMAL_STMT_DEALLOCATE },
+	{ "DISCARD ALL", OD_SQL_MINIMAL_STMT_DISCARD },
+	{ "discard\tplans", OD_SQL_MINIMAL_STMT_DISCARD },
+
+	/* whitespace and comments, longer than a vector */
+	{ "   \t\r\n  \n\n  \t    \t\t  SHOW x", OD_SQL_MINIMAL_STMT_SHOW },
+	{ "-- comment\nSET x TO 1", OD_SQL_MINIMAL_STMT_SET },
+	{ "--\n--\n\n-- SELECT\nBEGIN", OD_SQL_MINIMAL_STMT_BEGIN },
+	{ "/* app:web, controller:users, action:index */ DISCARD ALL",
+	  OD_SQL_MINIMAL_STMT_DISCARD },
+	{ "/**/SET x = 1", OD_SQL_MINIMAL_STMT_SET },
+	{ "/***/SET x = 1", OD_SQL_MINIMAL_STMT_SET },
+	{ "/* a * b ** c */ /* SELECT */\n  -- x\n  SHOW x",
+	  OD_SQL_MINIMAL_STMT_SHOW },
+	/* block comments do not nest */
+	{ "/* /* */ SET x = 1", OD_SQL_MINIMAL_STMT_SET },
+
+	/* never processed virtually */
+	{ "SELECT 1", OD_SQL_MINIMAL_STMT_OTHER },
+	{ "select * from users where id = 42", OD_SQL_MINIMAL_STMT_OTHER },
+	{ "INSERT INTO t VALUES (1)", OD_SQL_MINIMAL_STMT_OTHER },
+	{ "COMMIT", OD_SQL_MINIMAL_STMT_OTHER },
+	{ "RESET ALL", OD_SQL_MINIMAL_STMT_OTHER },
+	{ "settings", OD_SQL_MINIMAL_STMT_OTHER },
+	{ "set_config('a', 'b', false)", OD_SQL_MINIMAL_STMT_OTHER },
+	{ "SET1", OD_SQL_MINIMAL_STMT_OTHER },
+	{ "SE", OD_SQL_MINIMAL_STMT_OTHER },
+	{ "\"set\" x", OD_SQL_MINIMAL_STMT_OTHER },
+	{ "(SELECT 1)", OD_SQL_MINIMAL_STMT_OTHER },
+	{ "-- SET x TO 1", OD_SQL_MINIMAL_STMT_OTHER },
+	{ "/* SET x TO 1", OD_SQL_MINIMAL_STMT_OTHER },
+	{ "/* SET x TO 1 *", OD_SQL_MINIMAL_STMT_OTHER },
+	{ "- SET x TO 1", OD_SQL_MINIMAL_STMT_OTHER },
+	{ "", OD_SQL_MINIMAL_STMT_OTHER },
+	{ "    ", OD_SQL_MINIMAL_STMT_OTHER },
+	{ ";", OD_SQL_MINIMAL_STMT_OTHER },
+};
+
+static od_sql_minimal_stmt_kind_t kind_of_node(od_sql_minimal_node_t *node)
+{
+	switch (node->type) {
+	case OD_SQL_MINIMAL_NODE_TYPE_SET_STMT:
+		return OD_SQL_MINIMAL_STMT_SET;
+	case OD_SQL_MINIMAL_NODE_TYPE_SHOW_STMT:
+		return OD_SQL_MINIMAL_STMT_SHOW;
+	case OD_SQL_MINIMAL_NODE_TYPE_BEGIN_STMT:
+		return OD_SQL_MINIMAL_STMT_BEGIN;
+	case OD_SQL_MINIMAL_NODE_TYPE_DEALLOCATE_STMT:
+		return OD_SQL_MINIMAL_STMT_DEALLOCATE;
+	case OD_SQL_MINIMAL_NODE_TYPE_DISCARD_STMT:
+		return OD_SQL_MINIMAL_STMT_DISCARD;
+	default:
+		return OD_SQL_MINIMAL_STMT_OTHER;
+	}
+}
+
+static void test_classify(void)
+{
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		const char *query = cases[i].query;
+		od_sql_minimal_stmt_kind_t kind;
+		kind = od_sql_minimal_classify(query, strlen(query));
+		if (kind != cases[i].kind) {
+			fprintf(stderr, "classify: [%s] got %d, expected %d\n",
+				query, kind, cases[i].kind);
+		}
+		test(kind == cases[i].kind);
+	}
+
+	/* only input_len bytes are looked at */
+	test(od_sql_minimal_classify("SETTINGS", 3) == OD_SQL_MINIMAL_STMT_SET);
+	test(od_sql_minimal_classify("/* */ SHOW", 8) ==
+	     OD_SQL_MINIMAL_STMT_OTHER);
+	test(od_sql_minimal_classify(NULL, 0) == OD_SQL_MINIMAL_STMT_OTHER);
+}
+
+/* prefilter never drops the statement that parser accepts */
+static void test_same_as_parser(void)
+{
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		const char *query = cases[i].query;
+		od_linear_alloc_reset(&s_arena);
+		od_sql_minimal_node_t *node;
+		node = od_sql_minimal_parse(query, strlen(query), &s_arena,
+					    NULL, NULL);
+		if (node == NULL) {
+			continue;
+		}
+		test(kind_of_node(node) ==
+		     od_sql_minimal_classify(query, strlen(query)));
+	}
+}
+
+void odyssey_test_sql_minimal_prefilter(void)
+{
+	od_linear_alloc_init(&s_arena, s_arena_buf, sizeof(s_arena_buf));
+
+	test_classify();
+	test_same_as_parser();
+
+	od_linear_alloc_destroy(&s_arena);
+}
+
+/* mostly the application traffic with the usual pooler statements */
+static const char *corpus[] = {
+	"SELECT 1",
+	"SELECT id, name, email FROM users WHERE id = 42",
+	"select count(*) from orders where created_at > now() - "
+	"interval '1 day'",
+	"/* app:web, controller:orders, action:show */ SELECT o.id, "
+	"o.total FROM orders o JOIN users u ON u.id = o.user_id "
+	"WHERE o.id = 1001",
+	"INSERT INTO events (kind, payload) VALUES ('click', '{}') "
+	"RETURNING id",
+	"UPDATE users SET last_seen = now() WHERE id = 42",
+	"DELETE FROM sessions WHERE expires_at < now()",
+	"  \n\tSELECT * FROM pg_catalog.pg_type WHERE typname = 'int4'",
+	"-- healthcheck\nSELECT 1",
+	"WITH t AS (SELECT 1) SELECT * FROM t",
+	"COMMIT",
+	"BEGIN",
+	"SET application_name = 'worker-1'",
+	"SET search_path TO public",
+	"SHOW transaction_isolation",
+	"DISCARD ALL",
+	"DEALLOCATE ALL",
+};
+
+#define CORPUS_SIZE (sizeof(corpus) / sizeof(corpus[0]))
+
+static double benchmark_run(size_t *lens, int parse, int classify)
+{
+	int found = 0;
+
+	benchmark_timer_t timer;
+	timer_start(&timer);
+	for (int r = 0; r < BENCHMARK_ROUNDS; r++) {
+		for (size_t i = 0; i < CORPUS_SIZE; i++) {
+			if (classify) {
+				od_sql_minimal_stmt_kind_t kind;
+				kind = od_sql_minimal_classify(corpus[i],
+							       lens[i]);
+				if (kind == OD_SQL_MINIMAL_STMT_OTHER) {
+					continue;
+				}
+				found++;
+			}
+			if (parse) {
+				od_linear_alloc_reset(&s_arena);
+				found += od_sql_minimal_parse(
+						 corpus[i], lens[i], &s_arena,
+						 NULL, NULL) != NULL;
+			}
+		}
+	}
+	double time = timer_end(&timer);
+
+	/* keep the loop from being optimized out */
+	test(found >= 0);
+
+	return time * 1e9 / ((double)BENCHMARK_ROUNDS * CORPUS_SIZE);
+}
+
+void odyssey_sql_minimal_classify_benchmark(void)
+{
+	od_linear_alloc_init(&s_arena, s_arena_buf, sizeof(s_arena_buf));
+
+	size_t lens[CORPUS_SIZE];
+	size_t candidates = 0;
+	for (size_t i = 0; i < CORPUS_SIZE; i++) {
+		lens[i] = strlen(corpus[i]);
+		candidates += od_sql_minimal_classify(corpus[i], lens[i]) !=
+			      OD_SQL_MINIMAL_STMT_OTHER;
+	}
+
+	printf("\n%zu queries, %zu candidates\n", CORPUS_SIZE, candidates);
+	printf("classify:          %6.1f ns/query\n",
+	       benchmark_run(lens, 0, 1));
+	printf("parse:             %6.1f ns/query\n",
+	       benchmark_run(lens, 1, 0));
+	printf("classify + parse:  %6.1f ns/query\n",
+	       benchmark_run(lens, 1, 1));
+
+	od_linear_alloc_destroy(&s_arena);
+}
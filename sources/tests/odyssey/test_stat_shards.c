@@ -0,0 +1,207 @@
+#include <machinarium/machinarium.h>
+
+#include <odyssey.h>
+#include <stat.h>
+#include <tdigest.h>
+#include <tests/odyssey_test.h>
+
+#define TEST_MACHINES 4
+#define TEST_UPDATES 100000
+
+#define BENCHMARK_UPDATES 2000000
+
+typedef struct {
+	od_stat_t *stat;
+	int updates;
+} stat_writer_arg_t;
+
+static void stat_writer(void *arg)
+{
+	stat_writer_arg_t *writer = arg;
+
+	for (int i = 0; i < writer->updates; ++i) {
+		od_stat_recv_client(writer->stat, 2);
+		od_stat_recv_server(writer->stat, 3);
+		od_stat_parse(writer->stat);
+		od_stat_wait_time(writer->stat, 1);
+	}
+}
+
+static void stat_run_writers(od_stat_t *stat, int machines, int updates)
+{
+	stat_writer_arg_t writer = { .stat = stat, .updates = updates };
+	int64_t ids[machines];
+
+	for (int i = 0; i < machines; ++i) {
+		ids[i] = machine_create("stat_writer", stat_writer, &writer);
+		test(ids[i] != -1);
+	}
+	for (int i = 0; i < machines; ++i) {
+		test(machine_wait(ids[i]) == 0);
+	}
+}
+
+static void test_stat_merge(od_stat_t *stat, uint64_t updates)
+{
+	od_stat_t current;
+	od_stat_init(&current);
+	od_stat_copy(&current, stat);
+
+	test(current.recv_client == updates * 2);
+	test(current.recv_server == updates * 3);
+	test(current.count_parse == updates);
+	test(current.count_wait == updates);
+	test(current.wait_time_us == updates);
+
+	/* sum over several stats must add merged shards */
+	od_stat_t sum;
+	od_stat_init(&sum);
+	od_stat_sum(&sum, stat);
+	od_stat_sum(&sum, &current);
+	test(sum.recv_client == updates * 4);
+	test(sum.count_parse == updates * 2);
+}
+
+void odyssey_test_stat_shards(void)
+{
+	machinarium_init();
+
+	od_stat_t stat;
+	od_stat_init(&stat);
+	test(od_stat_shards_init(&stat, TEST_MACHINES) == OK_RESPONSE);
+	test(stat.shards != NULL);
+	test(((uintptr_t)stat.shards % OD_STAT_SHARD_ALIGN) == 0);
+
+	stat_run_writers(&stat, TEST_MACHINES, TEST_UPDATES);
+	test_stat_merge(&stat, TEST_MACHINES * TEST_UPDATES);
+
+	/* writers are spread across shards */
+	size_t used = 0;
+	for (size_t i = 0; i < stat.shards_count; ++i) {
+		if (stat.shards[i].count_parse != 0) {
+			++used;
+		}
+	}
+	test(used == TEST_MACHINES);
+	od_stat_free(&stat);
+	test(stat.shards == NULL);
+
+	/* unsharded stat keeps shared counters */
+	od_stat_init(&stat);
+	stat_run_writers(&stat, TEST_MACHINES, TEST_UPDATES);
+	test_stat_merge(&stat, TEST_MACHINES * TEST_UPDATES);
+	od_stat_free(&stat);
+
+	machinarium_free();
+}
+
+static void stat_quantiles_writer(void *arg)
+{
+	stat_writer_arg_t *writer = arg;
+
+	for (int i = 1; i <= writer->updates; ++i) {
+		od_stat_state_t state;
+		od_stat_state_init(&state);
+		/* query time of i us */
+		state.query_time_start = machine_time_us() - i;
+		state.tx_time_start = state.query_time_start;
+
+		int64_t query_time;
+		od_stat_query_end(writer->stat, &state, 0, &query_time);
+	}
+}
+
+static double stat_quantile(od_stat_t *stat, double q)
+{
+	td_histogram_t *transactions = td_new(QUANTILES_COMPRESSION);
+	td_histogram_t *queries = td_new(QUANTILES_COMPRESSION);
+	td_histogram_t *freeze = td_new(QUANTILES_COMPRESSION);
+
+	od_stat_quantiles_merge(stat, transactions, queries, freeze);
+	test(td_total_count(transactions) == td_total_count(queries));
+	double value = td_value_at(queries, q);
+
+	td_free(transactions);
+	td_free(queries);
+	td_free(freeze);
+	return value;
+}
+
+void odyssey_test_stat_quantiles(void)
+{
+	machinarium_init();
+
+	od_stat_t stat;
+	od_stat_init(&stat);
+	test(od_stat_quantiles_init(&stat, 3) == NOT_OK_RESPONSE);
+	test(od_stat_shards_init(&stat, TEST_MACHINES) == OK_RESPONSE);
+	test(od_stat_quantiles_init(&stat, 3) == OK_RESPONSE);
+
+	stat_writer_arg_t writer = { .stat = &stat, .updates = 10000 };
+	int64_t ids[TEST_MACHINES];
+	for (int i = 0; i < TEST_MACHINES; ++i) {
+		ids[i] = machine_create("stat_quantiles_writer",
+					stat_quantiles_writer, &writer);
+		test(ids[i] != -1);
+	}
+	for (int i = 0; i < TEST_MACHINES; ++i) {
+		test(machine_wait(ids[i]) == 0);
+	}
+
+	/* shard digests are not visible until the cron tick */
+	test(isnan(stat_quantile(&stat, 0.5)));
+
+	od_stat_quantiles_tick(&stat);
+	double p50 = stat_quantile(&stat, 0.5);
+	double p99 = stat_quantile(&stat, 0.99);
+	test(fabs(p50 - 5000) < 250);
+	test(fabs(p99 - 9900) < 250);
+
+	/* interval stays in the window for quantiles_window ticks */
+	od_stat_quantiles_tick(&stat);
+	od_stat_quantiles_tick(&stat);
+	test(fabs(stat_quantile(&stat, 0.5) - p50) < 1e-6);
+	od_stat_quantiles_tick(&stat);
+	test(isnan(stat_quantile(&stat, 0.5)));
+
+	od_stat_free(&stat);
+
+	machinarium_free();
+}
+
+static double benchmark_stat_run(int machines, int sharded)
+{
+	od_stat_t stat;
+	od_stat_init(&stat);
+	if (sharded &&
+	    od_stat_shards_init(&stat, machines) != OK_RESPONSE) {
+		abort();
+	}
+
+	benchmark_timer_t timer;
+	timer_start(&timer);
+	stat_run_writers(&stat, machines, BENCHMARK_UPDATES);
+	double time = timer_end(&timer);
+
+	od_stat_free(&stat);
+	return time;
+}
+
+void odyssey_stat_shards_benchmark(void)
+{
+	machinarium_init();
+
+	printf("\n");
+	for (int machines = 1; machines <= 16; machines *= 2) {
+		double shared = benchmark_stat_run(machines, 0);
+		double sharded = benchmark_stat_run(machines, 1);
+		double updates = (double)machines * BENCHMARK_UPDATES;
+
+		printf("machines %2d: shared %6.1f ns/update, "
+		       "sharded %6.1f ns/update\n",
+		       machines, shared * 1e9 / updates,
+		       sharded * 1e9 / updates);
+	}
+
+	machinarium_free();
+}
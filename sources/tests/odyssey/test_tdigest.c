@@ -121,6 +121,29 @@ void merge_several_digests_test(void)
 	td_safe_free(common_hist);
 }
 
+void drain_test(void)
+{
+	td_histogram_t *from = td_new(100);
+	td_histogram_t *into = td_new(100);
+
+	for (int i = 1; i <= 1000; i++) {
+		td_add(from, i, 1);
+	}
+	td_add(into, 0, 1);
+
+	td_drain(into, from);
+	test(td_total_count(from) == 0);
+	test(td_total_count(into) == 1001);
+	test(fabs(td_value_at(into, 0.5) - 500) < 5);
+
+	/* drained digest is reusable */
+	td_add(from, 1, 1);
+	test(td_value_at(from, 0.5) == 1);
+
+	td_free(from);
+	td_free(into);
+}
+
 void tdigest_forward_test(void);
 
 void tdigest_backward_test(void);
@@ -214,5 +237,6 @@ void odyssey_test_tdigest(void)
 	extreme_quantiles_test();
 	three_point_test();
 	merge_several_digests_test();
+	drain_test();
 	machinarium_test_tdigest();
 }
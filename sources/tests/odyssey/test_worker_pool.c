@@ -0,0 +1,83 @@
+#include <machinarium/machinarium.h>
+
+#include <odyssey.h>
+#include <worker_pool.h>
+#include <tests/odyssey_test.h>
+
+#define TEST_WORKERS 8
+
+static void set_clients(od_worker_pool_t *pool, const uint32_t *clients)
+{
+	for (uint32_t i = 0; i < pool->count; ++i) {
+		pool->pool[i].clients = clients[i];
+	}
+}
+
+static void test_worker_pool_placement(void *arg)
+{
+	(void)arg;
+
+	od_worker_t workers[TEST_WORKERS];
+	od_worker_pool_t pool;
+	od_worker_pool_init(&pool);
+	pool.pool = workers;
+	pool.count = TEST_WORKERS;
+	for (int i = 0; i < TEST_WORKERS; ++i) {
+		od_worker_init(&workers[i], NULL, i);
+	}
+
+	uint32_t clients[TEST_WORKERS] = { 5, 7, 3, 9, 1, 4, 8, 6 };
+	set_clients(&pool, clients);
+
+	/* least loaded is the same from any round robin position */
+	for (int i = 0; i < 2 * TEST_WORKERS; ++i) {
+		test(od_worker_pool_next_least_loaded(&pool) == 4);
+	}
+
+	/* busy time counts as well */
+	workers[4].busy_permille = 1000;
+	test(od_worker_load(&workers[4]) == 101);
+	test(od_worker_pool_next_least_loaded(&pool) == 2);
+	workers[4].busy_permille = 0;
+
+	/* clients passed to worker are counted before they start */
+	workers[4].pending = 10;
+	test(od_worker_pool_next_least_loaded(&pool) == 2);
+	workers[4].pending = 0;
+
+	/* p2c never chooses the most loaded one of two workers */
+	od_worker_pool_init(&pool);
+	pool.pool = workers;
+	pool.count = 2;
+	for (int i = 0; i < 100; ++i) {
+		test(od_worker_pool_next_p2c(&pool) == 0);
+	}
+
+	/* and chooses both of equally loaded */
+	workers[1].clients = workers[0].clients;
+	int chosen[2] = { 0, 0 };
+	for (int i = 0; i < 100; ++i) {
+		chosen[od_worker_pool_next_p2c(&pool)]++;
+	}
+	test(chosen[0] > 0 && chosen[1] > 0);
+
+	od_worker_pool_init(&pool);
+	pool.pool = workers;
+	pool.count = 1;
+	test(od_worker_pool_next_p2c(&pool) == 0);
+	test(od_worker_pool_next_least_loaded(&pool) == 0);
+}
+
+void odyssey_test_worker_pool(void)
+{
+	machinarium_init();
+
+	int64_t rc;
+	rc = machine_create("test_worker_pool_placement",
+			    test_worker_pool_placement, NULL);
+	test(rc > 0);
+
+	test(machine_wait(rc) == 0);
+
+	machinarium_free();
+}
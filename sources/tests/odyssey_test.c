@@ -23,6 +23,7 @@ char test_substring[1024] = { 0 };
 extern void kiwi_test_enquote(void);
 extern void kiwi_test_pgoptions(void);
 extern void kiwi_test_fe_read_auth(void);
+extern void kiwi_test_vars_hash(void);
 
 /* MACHINARIUM */
 extern void machinarium_test_init(void);
@@ -52,6 +53,7 @@ extern void machinarium_test_channel_shared_rw0(void);
 extern void machinarium_test_channel_shared_rw1(void);
 extern void machinarium_test_channel_shared_rw2(void);
 extern void machinarium_test_sleeplock(void);
+extern void machinarium_test_rwsleeplock(void);
 extern void machinarium_test_producer_consumer0(void);
 extern void machinarium_test_producer_consumer1(void);
 extern void machinarium_test_producer_consumer2(void);
@@ -79,7 +81,11 @@ extern void machinarium_test_read_timeout(void);
 extern void machinarium_test_read_cancel(void);
 extern void machinarium_test_read_var(void);
 extern void machinarium_test_hm_hash(void);
+extern void machinarium_test_oahm(void);
+extern void machinarium_test_zpq_stream(void);
 extern void machinarium_test_tls0(void);
+extern void machinarium_test_tls_session_cache(void);
+extern void machinarium_test_tls_ticket_keys(void);
 extern void machinarium_test_tls_unix_socket_no_msg(void);
 extern void machinarium_test_tls_unix_socket(void);
 extern void machinarium_test_tls_read_10mb0(void);
@@ -104,6 +110,7 @@ extern void machinarium_test_wait_flag_timeout(void);
 extern void machinarium_test_ring_buffer(void);
 extern void machinarium_test_vrb(void);
 extern void machinarium_test_heap(void);
+extern void machinarium_test_timer_wheel(void);
 extern void machinarium_test_queue(void);
 extern void machinarium_vrb_benchmark(void);
 extern void machinarium_test_eventfd(void);
@@ -125,7 +132,21 @@ extern void odyssey_test_affinity(void);
 extern void odyssey_test_duration_parse(void);
 extern void odyssey_test_thread_pool(void);
 extern void odyssey_test_linear_alloc(void);
+extern void odyssey_test_route_pool(void);
+extern void odyssey_test_worker_pool(void);
+extern void odyssey_test_scram_cache(void);
+extern void odyssey_test_rules_index(void);
+extern void odyssey_test_cancel_table(void);
+extern void odyssey_cancel_table_benchmark(void);
+extern void odyssey_test_stat_shards(void);
+extern void odyssey_test_stat_quantiles(void);
+extern void odyssey_stat_shards_benchmark(void);
+extern void odyssey_test_multi_pool(void);
 extern void odyssey_test_sql_minimal_parser(void);
+extern void odyssey_test_sql_minimal_prefilter(void);
+extern void odyssey_sql_minimal_classify_benchmark(void);
+extern void odyssey_test_logger_ring(void);
+extern void odyssey_logger_ring_benchmark(void);
 
 extern void machinarium_test_tsan_simple_race_example(void);
 
@@ -146,6 +167,7 @@ int main(int argc, char *argv[])
 	odyssey_test(kiwi_test_enquote);
 	odyssey_test(kiwi_test_pgoptions);
 	odyssey_test(kiwi_test_fe_read_auth);
+	odyssey_test(kiwi_test_vars_hash);
 	odyssey_test(machinarium_test_init);
 	odyssey_test(machinarium_test_create0);
 	odyssey_test(machinarium_test_create1);
@@ -173,6 +195,7 @@ int main(int argc, char *argv[])
 	odyssey_test(machinarium_test_channel_shared_rw1);
 	odyssey_test(machinarium_test_channel_shared_rw2);
 	odyssey_test(machinarium_test_sleeplock);
+	odyssey_test(machinarium_test_rwsleeplock);
 	odyssey_test(machinarium_test_producer_consumer0);
 	odyssey_test(machinarium_test_producer_consumer1);
 	odyssey_test(machinarium_test_producer_consumer2);
@@ -200,7 +223,11 @@ int main(int argc, char *argv[])
 	odyssey_test(machinarium_test_read_cancel);
 	odyssey_test(machinarium_test_read_var);
 	odyssey_test(machinarium_test_hm_hash);
+	odyssey_test(machinarium_test_oahm);
+	odyssey_test(machinarium_test_zpq_stream);
 	odyssey_test(machinarium_test_tls0);
+	odyssey_test(machinarium_test_tls_session_cache);
+	odyssey_test(machinarium_test_tls_ticket_keys);
 	odyssey_test(machinarium_test_tls_unix_socket_no_msg);
 	odyssey_test(machinarium_test_tls_unix_socket);
 	odyssey_test(machinarium_test_tls_read_10mb0);
@@ -227,6 +254,7 @@ int main(int argc, char *argv[])
 	odyssey_test(machinarium_test_vrb);
 	odyssey_test(machinarium_test_queue);
 	odyssey_test(machinarium_test_heap);
+	odyssey_test(machinarium_test_timer_wheel);
 	odyssey_playground_test(machinarium_vrb_benchmark);
 	odyssey_test(machinarium_test_mutex_threads);
 	odyssey_test(machinarium_test_mutex_coroutines);
@@ -245,7 +273,21 @@ int main(int argc, char *argv[])
 	odyssey_test(odyssey_test_duration_parse);
 	odyssey_test(odyssey_test_thread_pool);
 	odyssey_test(odyssey_test_linear_alloc);
+	odyssey_test(odyssey_test_route_pool);
+	odyssey_test(odyssey_test_worker_pool);
+	odyssey_test(odyssey_test_scram_cache);
+	odyssey_test(odyssey_test_rules_index);
+	odyssey_test(odyssey_test_cancel_table);
+	odyssey_playground_test(odyssey_cancel_table_benchmark);
+	odyssey_test(odyssey_test_stat_shards);
+	odyssey_test(odyssey_test_stat_quantiles);
+	odyssey_playground_test(odyssey_stat_shards_benchmark);
+	odyssey_test(odyssey_test_multi_pool);
 	odyssey_test(odyssey_test_sql_minimal_parser);
+	odyssey_test(odyssey_test_sql_minimal_prefilter);
+	odyssey_playground_test(odyssey_sql_minimal_classify_benchmark);
+	odyssey_test(odyssey_test_logger_ring);
+	odyssey_playground_test(odyssey_logger_ring_benchmark);
 
 	odyssey_playground_test(machinarium_test_tsan_simple_race_example);
 
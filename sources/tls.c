@@ -15,6 +15,7 @@
 #include <client.h>
 #include <server.h>
 #include <frontend.h>
+#include <system.h>
 
 machine_tls_t *od_tls_frontend(od_config_listen_t *config)
 {
@@ -120,12 +121,19 @@ int od_tls_frontend_accept(od_client_t *client, od_logger_t *logger,
 		return -1;
 	}
 
-	od_debug(logger, "tls", client, NULL, "ok");
+	int resumed = mm_io_is_tls_resumed(client->io.io);
+	if (client->listener != NULL) {
+		od_atomic_u64_inc(resumed ? &client->listener->tls_resumed :
+					    &client->listener->tls_full);
+	}
+
+	od_debug(logger, "tls", client, NULL, "ok%s",
+		 resumed ? ", session resumed" : "");
 
 	return 0;
 }
 
-machine_tls_t *od_tls_backend(od_tls_opts_t *opts)
+machine_tls_t *od_tls_backend(od_tls_opts_t *opts, const od_address_t *address)
 {
 	int rc;
 	machine_tls_t *tls;
@@ -168,6 +176,17 @@ machine_tls_t *od_tls_backend(od_tls_opts_t *opts)
 			return NULL;
 		}
 	}
+	if (opts->session_cache) {
+		/* sessions are resumed only with the same endpoint */
+		char key[256];
+		od_address_to_str(address, key, sizeof(key));
+		rc = machine_tls_set_session_cache(tls, opts->session_cache,
+						   key);
+		if (rc == -1) {
+			machine_tls_free(tls);
+			return NULL;
+		}
+	}
 	return tls;
 }
 
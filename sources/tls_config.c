@@ -44,6 +44,10 @@ od_retcode_t od_tls_opts_free(od_tls_opts_t *opts)
 		od_free(opts->tls_protocols);
 	}
 
+	if (opts->session_cache) {
+		machine_tls_session_cache_free(opts->session_cache);
+	}
+
 	od_free(opts);
 	return OK_RESPONSE;
 }
@@ -32,7 +32,7 @@ od_target_session_attrs_t od_tsa_get_effective(od_client_t *client)
 		effective_tsa = default_tsa;
 	}
 
-	kiwi_var_t *hint_var = kiwi_vars_get(
+	kiwi_vars_entry_t *hint_var = kiwi_vars_get(
 		&client->vars, KIWI_VAR_ODYSSEY_TARGET_SESSION_ATTRS);
 
 	/* XXX: TODO refactor kiwi_vars_get to avoid strcmp */
@@ -21,6 +21,8 @@
 #include <instance.h>
 #include <msg.h>
 #include <frontend.h>
+#include <system.h>
+#include <router.h>
 #include <alloc/linear.h>
 
 #ifdef PROM_FOUND
@@ -30,6 +32,7 @@
 
 static OD_THREAD_LOCAL uint8_t *linear_alloc_buf = NULL;
 static OD_THREAD_LOCAL od_linear_alloc_t linear_alloc;
+static OD_THREAD_LOCAL od_worker_t *current_worker = NULL;
 
 static void setup_affinity(od_instance_t *instance, int wid)
 {
@@ -85,6 +88,39 @@ static void setup_affinity(od_instance_t *instance, int wid)
 #endif
 }
 
+/*
+ * join accept loops of own listen sockets, the signal handler shuts
+ * down all listen servers before it sends shutdown to workers
+ */
+static inline void od_worker_join_servers(od_worker_t *worker)
+{
+	od_router_t *router = worker->global->router;
+
+	for (;;) {
+		int64_t coro_id = -1;
+
+		od_router_lock(router);
+		od_list_t *i;
+		od_list_foreach (&router->servers, i) {
+			od_system_server_t *server;
+			server = od_container_of(i, od_system_server_t, link);
+			if (server->worker != worker || server->coro_id == -1) {
+				continue;
+			}
+			od_assert(atomic_load(&server->closed));
+			coro_id = server->coro_id;
+			server->coro_id = -1;
+			break;
+		}
+		od_router_unlock(router);
+
+		if (coro_id == -1) {
+			break;
+		}
+		machine_join(coro_id);
+	}
+}
+
 static inline void od_worker(void *arg)
 {
 	od_worker_t *worker = arg;
@@ -107,6 +143,9 @@ static inline void od_worker(void *arg)
 
 	(*gl)->wid = worker->id;
 
+	current_worker = worker;
+	atomic_store(&worker->loop_load, machine_load_self());
+
 	bool run = true;
 
 	memset(&linear_alloc, 0, sizeof(linear_alloc));
@@ -144,27 +183,22 @@ static inline void od_worker(void *arg)
 		case OD_MSG_CLIENT_NEW: {
 			od_client_t *client;
 			client = *(od_client_t **)machine_msg_data(msg);
-			client->global = worker->global;
-
-			/* for NULL-terminator and prefix, just in case */
-			char coro_name[10 + OD_ID_LEN];
-			od_id_write_to_string(&client->id, coro_name,
-					      10 + OD_ID_LEN);
-
-			int64_t coroutine_id;
-			coroutine_id = machine_coroutine_create_named(
-				od_frontend, client, coro_name);
-			if (coroutine_id == -1) {
-				od_error(&instance->logger, "worker", client,
-					 NULL, "failed to create coroutine");
-				od_io_close(&client->io);
-				od_client_free(client);
-				od_routing_slot_release(worker->global);
-				break;
+			od_atomic_u32_dec(&worker->pending);
+			od_worker_client_new(worker, client);
+			break;
+		}
+		case OD_MSG_LISTEN: {
+			od_system_server_t *server;
+			server = *(od_system_server_t **)machine_msg_data(msg);
+			if (od_system_server_spawn(server) == -1) {
+				/* other sockets of the address still accept */
+				od_error(&instance->logger, "worker", NULL,
+					 NULL,
+					 "worker[%d]: failed to start accept "
+					 "coroutine, listen socket is closed",
+					 worker->id);
+				od_system_server_remove(server);
 			}
-			client->coroutine_id = coroutine_id;
-
-			worker->clients_processed++;
 			break;
 		}
 		case OD_MSG_STAT: {
@@ -190,11 +224,15 @@ static inline void od_worker(void *arg)
 			       " allocated, %" PRIu64 " cached, %" PRIu64
 			       " freed, %" PRIu64 " cache_size), "
 			       "coroutines (%" PRIu64 " active, %" PRIu64
-			       " cached), clients_processed: %" PRIu64,
+			       " cached), clients_processed: %" PRIu64
+			       ", clients: %u, busy: %u%%, load: %u",
 			       worker->id, msg_allocated, msg_cache_count,
 			       msg_cache_gc_count, msg_cache_size,
 			       count_coroutine, count_coroutine_cache,
-			       worker->clients_processed);
+			       worker->clients_processed,
+			       od_atomic_u32_of(&worker->clients),
+			       od_atomic_u32_of(&worker->busy_permille) / 10,
+			       od_worker_load(worker));
 			break;
 		}
 		case OD_MSG_SHUTDOWN:
@@ -211,16 +249,63 @@ static inline void od_worker(void *arg)
 		machine_msg_free(msg);
 	}
 
+	atomic_store(&worker->loop_load, NULL);
+
+	od_worker_join_servers(worker);
+
 	od_log(&instance->logger, "worker", NULL, NULL,
 	       "worker[%d] stopped processing new connections", worker->id);
 }
 
+static void od_worker_frontend(void *arg)
+{
+	od_worker_t *worker = current_worker;
+
+	od_frontend(arg);
+
+	od_atomic_u32_dec(&worker->clients);
+}
+
+void od_worker_client_new(od_worker_t *worker, od_client_t *client)
+{
+	od_instance_t *instance = worker->global->instance;
+
+	client->global = worker->global;
+
+	/* for NULL-terminator and prefix, just in case */
+	char coro_name[10 + OD_ID_LEN];
+	od_id_write_to_string(&client->id, coro_name, 10 + OD_ID_LEN);
+
+	od_atomic_u32_inc(&worker->clients);
+
+	int64_t coroutine_id;
+	coroutine_id = machine_coroutine_create_named(od_worker_frontend,
+						      client, coro_name);
+	if (coroutine_id == -1) {
+		od_error(&instance->logger, "worker", client, NULL,
+			 "failed to create coroutine");
+		od_atomic_u32_dec(&worker->clients);
+		od_io_close(&client->io);
+		od_client_free(client);
+		od_routing_slot_release(worker->global);
+		return;
+	}
+	client->coroutine_id = coroutine_id;
+
+	worker->clients_processed++;
+}
+
 void od_worker_init(od_worker_t *worker, od_global_t *global, int id)
 {
 	worker->machine = -1;
 	worker->id = id;
 	worker->global = global;
 	worker->clients_processed = 0;
+	worker->clients = 0;
+	worker->pending = 0;
+	worker->busy_permille = 0;
+	worker->busy_us_prev = 0;
+	atomic_init(&worker->loop_load, NULL);
 }
 
 int od_worker_start(od_worker_t *worker)
@@ -253,6 +338,19 @@ od_linear_alloc_t *od_worker_get_local_linear_alloc(void)
 	return &linear_alloc;
 }
 
+int od_worker_listen(od_worker_t *worker, od_system_server_t *server)
+{
+	machine_msg_t *msg;
+	msg = machine_msg_create(sizeof(od_system_server_t *));
+	if (msg == NULL) {
+		return -1;
+	}
+	machine_msg_set_type(msg, OD_MSG_LISTEN);
+	memcpy(machine_msg_data(msg), &server, sizeof(od_system_server_t *));
+	machine_channel_write(worker->task_channel, msg);
+	return 0;
+}
+
 void od_worker_shutdown(od_worker_t *worker)
 {
 	machine_msg_t *msg;
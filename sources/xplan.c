@@ -11,6 +11,7 @@
 #include <route.h>
 #include <rules.h>
 #include <stream.h>
+#include <deploy.h>
 #include <relay.h>
 #include <xplan.h>
 #include <misc.h>
@@ -532,6 +533,9 @@ void od_xplan_destroy(od_xplan_t *xp)
 void od_xplan_clear(od_xplan_t *xp)
 {
 	mm_vector_clear(&xp->entries);
+
+	machine_msg_free_safe(xp->deploy);
+	xp->deploy = NULL;
 }
 
 static od_pstmt_t *plan_client_get_pstmt(od_xplan_t *xp, od_client_t *client,
@@ -1290,11 +1294,30 @@ od_frontend_status_t od_xplan_make_from_xbuf(od_xplan_t *xp, od_relay_t *relay)
 	od_rule_t *rule = route->rule;
 	int reserve_prepared = rule->pool->reserve_prepared_statement;
 
+	od_frontend_status_t status;
 	if (!reserve_prepared) {
-		return plan_simple(xp, relay);
+		status = plan_simple(xp, relay);
+	} else {
+		status = plan_with_pstmt_support(xp, relay);
+	}
+	if (status != OD_OK) {
+		return status;
+	}
+
+	/*
+	 * take the deploy only when the plan is made, it is not
+	 * pending anymore and must be sent with the plan
+	 *
+	 * simple Query can't be put in the middle of xproto batch
+	 */
+	if (!server->xproto_mode) {
+		if (od_deploy_prepare(client, "main", &xp->deploy) !=
+		    OK_RESPONSE) {
+			return OD_ESERVER_WRITE;
+		}
 	}
 
-	return plan_with_pstmt_support(xp, relay);
+	return OD_OK;
 }
 
 static od_frontend_status_t
@@ -1738,6 +1761,13 @@ static od_frontend_status_t run_plan_impl(od_xplan_t *xp, od_relay_t *relay,
 	 * no response awaiting from server
 	 */
 
+	if (xp->deploy != NULL) {
+		/* deploy must be done before switching to xproto mode */
+		if (od_deploy_complete(client, "main") != OK_RESPONSE) {
+			return OD_ESERVER_READ;
+		}
+	}
+
 	od_stat_query_start(&server->stats_state);
 
 	if (!server->xproto_mode) {
@@ -1947,13 +1977,17 @@ od_frontend_status_t od_xplan_run(od_xplan_t *xp, od_relay_t *relay,
 	size_t count = mm_vector_size(&xp->entries);
 	od_assert(count > 0);
 
-	size_t niovecs = count;
+	size_t niovecs = count + 1;
 	struct iovec *iovecs = od_malloc(sizeof(struct iovec) * niovecs);
 	if (iovecs == NULL) {
 		return OD_EOOM;
 	}
 
-	size_t written = prepare_send_iovecs(xp, iovecs);
+	size_t written = 0;
+	if (xp->deploy != NULL) {
+		iovecs[written++] = machine_msg_iovec(xp->deploy);
+	}
+	written += prepare_send_iovecs(xp, iovecs + written);
 
 	if (instance->config.log_debug || rule->log_debug) {
 		log_xbuf(instance, client, &relay->xbuf);
@@ -5,15 +5,21 @@ set -ex
 /usr/bin/odyssey /tests/min_pool_size/config.conf
 sleep 1
 
+# affinity counters at the end of show servers rows grow with usage,
+# so compare only server identity columns
+show_servers() {
+	psql 'host=localhost port=6432 user=console dbname=console' -t -c 'show servers' | sed '/^$/d' | cut -d '|' -f 1-17 | sort
+}
+
 # create some connections for od_frontend_setup_params
 pgbench 'host=localhost port=6432 user=postgres dbname=postgres' --select-only --progress 1 --no-vacuum -T 5 -j 1 -c 5
 
-psql 'host=localhost port=6432 user=console dbname=console' -t -c 'show servers' | sed '/^$/d' | sort > /tmp/setup-connections
+show_servers > /tmp/setup-connections
 
 # wait for this connections to expire by ttl and new connections created
 sleep 11
 
-psql 'host=localhost port=6432 user=console dbname=console' -t -c 'show servers' | sed '/^$/d' | sort > /tmp/newly-preallocated
+show_servers > /tmp/newly-preallocated
 
 if diff /tmp/setup-connections /tmp/newly-preallocated; then
 	echo "setup connections must be differ from newly preallocated"
@@ -33,7 +39,7 @@ fi
 pgbench 'host=localhost port=6432 user=postgres dbname=postgres' --select-only --progress 1 --no-vacuum -T 5 -j 1 -c 5
 
 # make sure that no new connections was created
-psql 'host=localhost port=6432 user=console dbname=console' -t -c 'show servers' | sed '/^$/d' | sort > /tmp/post-usage
+show_servers > /tmp/post-usage
 
 diff /tmp/newly-preallocated /tmp/post-usage || {
 	echo "server lists are different"